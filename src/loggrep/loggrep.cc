@@ -1,53 +1,276 @@
-#include <re2/re2.h>
-#include <list>
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
 #include <iostream>
-#include <fstream>
+#include <pthread.h>
+#include <re2/re2.h>
+#include <re2/set.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
 
+#include "core/StatLogReader.h"
 #include "core/Utils.h"
 #include "core/Timer.h"
 
 using namespace re2;
 
-typedef std::list<RE2*> RegexList;
+typedef std::vector<RE2*> RegexVector;
 
-int grepFile(std::string& filename, RegexList& regexes) {
-  Timer grepTimer;
-  grepTimer.start();
+// Binary stat logs are decoded into text this many bytes at a time before
+// being grepped
+static const uint64_t DECODED_BATCH_SIZE = 64 * 1048576;
+
+/**
+   Matches lines against every regex at once. All of the regexes are compiled
+   into a single RE2::Set, so each line is scanned once no matter how many
+   regexes there are, and lines that match nothing (the vast majority) are
+   rejected after that single scan. If the set can't be built, every regex is
+   tried in turn instead.
+ */
+class LineMatcher {
+public:
+  LineMatcher(const RegexVector& _regexes)
+    : regexes(_regexes),
+      regexSet(RE2::DefaultOptions, RE2::ANCHOR_BOTH),
+      useSet(true) {
+
+    for (RegexVector::const_iterator iter = regexes.begin();
+         iter != regexes.end(); iter++) {
+      if (regexSet.Add((*iter)->pattern(), NULL) < 0) {
+        useSet = false;
+      }
+    }
+
+    if (useSet && !regexSet.Compile()) {
+      useSet = false;
+    }
+
+    if (!useSet) {
+      std::cerr << "Couldn't combine regular expressions; matching them "
+                << "one at a time" << std::endl;
+    }
+  }
+
+  /// Find the regexes that a line matches, in increasing order
+  void match(const StringPiece& line, std::vector<int>& matches) const {
+    matches.clear();
+
+    if (useSet) {
+      if (regexSet.Match(line, &matches)) {
+        std::sort(matches.begin(), matches.end());
+      }
+    } else {
+      for (uint64_t i = 0; i < regexes.size(); i++) {
+        if (RE2::FullMatch(line, *regexes[i])) {
+          matches.push_back(i);
+        }
+      }
+    }
+  }
+
+private:
+  const RegexVector& regexes;
+  RE2::Set regexSet;
+  bool useSet;
+};
+
+/// A contiguous range of whole lines to be grepped by a single thread
+struct GrepChunk {
+  const char* begin;
+  const char* end;
+  const LineMatcher* matcher;
 
-  std::ifstream fileStream(filename.c_str());
+  // Matching lines are buffered here so that chunks can be printed in order
+  std::string output;
+  uint64_t linesGrepped;
+};
+
+void* grepChunk(void* arg) {
+  GrepChunk* chunk = static_cast<GrepChunk*>(arg);
+
+  std::vector<int> matches;
+  char regexNumberBuffer[32];
+
+  const char* lineStart = chunk->begin;
+
+  while (lineStart < chunk->end) {
+    const char* lineEnd = static_cast<const char*>(
+      memchr(lineStart, '\n', chunk->end - lineStart));
+
+    if (lineEnd == NULL) {
+      lineEnd = chunk->end;
+    }
+
+    StringPiece line(lineStart, lineEnd - lineStart);
+    chunk->matcher->match(line, matches);
+
+    for (std::vector<int>::iterator iter = matches.begin();
+         iter != matches.end(); iter++) {
+      int length = snprintf(
+        regexNumberBuffer, sizeof(regexNumberBuffer), "%d\t", *iter);
+      chunk->output.append(regexNumberBuffer, length);
+      chunk->output.append(line.data(), line.size());
+      chunk->output.push_back('\n');
+    }
+
+    chunk->linesGrepped++;
+    lineStart = lineEnd + 1;
+  }
+
+  return NULL;
+}
+
+/**
+   Grep a buffer of lines using several threads, each of which is given a
+   contiguous range of whole lines. Matches are written to standard output in
+   the order in which they appear in the buffer.
+
+   \return the number of lines grepped
+ */
+uint64_t grepBuffer(
+  const char* data, uint64_t size, const LineMatcher& matcher,
+  uint64_t numThreads) {
+
+  std::vector<GrepChunk> chunks(numThreads);
+
+  const char* chunkStart = data;
+  const char* dataEnd = data + size;
+
+  for (uint64_t i = 0; i < numThreads; i++) {
+    GrepChunk& chunk = chunks[i];
+
+    // Move each chunk boundary forward to the start of the next line.
+    const char* chunkEnd = data + (size * (i + 1)) / numThreads;
+    if (chunkEnd < chunkStart) {
+      chunkEnd = chunkStart;
+    }
+    if (chunkEnd < dataEnd) {
+      const char* newline = static_cast<const char*>(
+        memchr(chunkEnd, '\n', dataEnd - chunkEnd));
+      chunkEnd = (newline == NULL) ? dataEnd : newline + 1;
+    }
+
+    chunk.begin = chunkStart;
+    chunk.end = chunkEnd;
+    chunk.matcher = &matcher;
+    chunk.linesGrepped = 0;
+
+    chunkStart = chunkEnd;
+  }
+
+  std::vector<pthread_t> threads(numThreads);
+
+  for (uint64_t i = 0; i < numThreads; i++) {
+    int status = pthread_create(&threads[i], NULL, &grepChunk, &chunks[i]);
+    ABORT_IF(status != 0, "pthread_create() failed with error %d: %s",
+             status, strerror(status));
+  }
 
   uint64_t linesGrepped = 0;
 
-  std::string currentLine;
+  for (uint64_t i = 0; i < numThreads; i++) {
+    int status = pthread_join(threads[i], NULL);
+    ABORT_IF(status != 0, "pthread_join() failed with error %d: %s",
+             status, strerror(status));
 
-  while (fileStream) {
-    std::getline(fileStream, currentLine);
+    GrepChunk& chunk = chunks[i];
+    fwrite(chunk.output.data(), 1, chunk.output.size(), stdout);
+    linesGrepped += chunk.linesGrepped;
+  }
 
-    uint64_t regexNumber = 0;
+  return linesGrepped;
+}
 
-    for (RegexList::iterator regexIter = regexes.begin();
-         regexIter != regexes.end(); regexIter++) {
+uint64_t grepTextFile(
+  const std::string& filename, const LineMatcher& matcher,
+  uint64_t numThreads) {
 
-      RE2* regex = *regexIter;
+  int fd = open(filename.c_str(), O_RDONLY);
+  ABORT_IF(fd == -1, "open() of '%s' failed with error %d: %s",
+           filename.c_str(), errno, strerror(errno));
 
-      if (RE2::FullMatch(currentLine, *regex)) {
-        std::cout << regexNumber << '\t' << currentLine << std::endl;
-      }
+  uint64_t fileSize = getFileSize(fd);
+  uint64_t linesGrepped = 0;
 
-      regexNumber++;
+  if (fileSize > 0) {
+    void* data = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ABORT_IF(data == MAP_FAILED, "mmap() of '%s' failed with error %d: %s",
+             filename.c_str(), errno, strerror(errno));
+
+    madvise(data, fileSize, MADV_SEQUENTIAL);
+
+    linesGrepped = grepBuffer(
+      static_cast<const char*>(data), fileSize, matcher, numThreads);
+
+    munmap(data, fileSize);
+  }
+
+  close(fd);
+
+  return linesGrepped;
+}
+
+uint64_t grepBinaryFile(
+  StatLogReader& reader, const LineMatcher& matcher, uint64_t numThreads) {
+
+  uint64_t linesGrepped = 0;
+
+  std::string decodedLines;
+  std::string currentLine;
+
+  bool moreLines = true;
+
+  while (moreLines) {
+    decodedLines.clear();
+
+    while (decodedLines.size() < DECODED_BATCH_SIZE &&
+           (moreLines = reader.getNextLine(currentLine))) {
+      decodedLines.append(currentLine);
+      decodedLines.push_back('\n');
     }
-    linesGrepped ++;
+
+    linesGrepped += grepBuffer(
+      decodedLines.data(), decodedLines.size(), matcher, numThreads);
+  }
+
+  return linesGrepped;
+}
+
+int grepFile(std::string& filename, RegexVector& regexes) {
+  Timer grepTimer;
+  grepTimer.start();
+
+  LineMatcher matcher(regexes);
+
+  long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t numThreads = (numCPUs > 0) ? numCPUs : 1;
+
+  uint64_t linesGrepped = 0;
+
+  // Binary stat logs are decoded into the same lines a text log would contain,
+  // so the same regexes work on both.
+  StatLogReader reader(filename);
+
+  if (reader.isBinary()) {
+    linesGrepped = grepBinaryFile(reader, matcher, numThreads);
+  } else {
+    linesGrepped = grepTextFile(filename, matcher, numThreads);
   }
 
-  fileStream.close();
+  fflush(stdout);
+
   grepTimer.stop();
 
   double elapsedTimeInSeconds = grepTimer.getElapsed() / 1000000.0;
 
   std::cerr << "Grepped " << linesGrepped << " lines in "
-            << elapsedTimeInSeconds << " seconds. Rate: "
-            << getFileSize(filename.c_str()) / grepTimer.getElapsed() << " MBps"
-            << std::endl;
+            << elapsedTimeInSeconds << " seconds with " << numThreads
+            << " threads. Rate: "
+            << getFileSize(filename.c_str()) / std::max<uint64_t>(
+              grepTimer.getElapsed(), 1) << " MBps" << std::endl;
 
   return 0;
 }
@@ -58,7 +281,7 @@ void printUsage() {
 }
 
 int main (int argc, char** argv) {
-  RegexList regexes;
+  RegexVector regexes;
 
   if (argc <= 2) {
     std::cerr << "Expected at least one regular expression argument"
@@ -69,7 +292,7 @@ int main (int argc, char** argv) {
 
   std::string filename(argv[1]);
 
-  for (uint64_t arg_index = 2; arg_index < argc; arg_index++) {
+  for (int arg_index = 2; arg_index < argc; arg_index++) {
     RE2* regex = new RE2(argv[arg_index]);
     std::cerr << regex->pattern() << std::endl;
     regexes.push_back(regex);
@@ -0,0 +1,179 @@
+#!/usr/bin/env python
+
+import os, sys, argparse, json, math, glob
+
+"""
+Turns the *_buffer_trace.log files written when BUFFER_TRACE is enabled into
+per-stage queueing and service time histograms, and optionally into a Chrome
+trace-event file that can be loaded into chrome://tracing.
+
+Queueing time is the time between a buffer being enqueued at a stage and a
+worker of that stage dequeueing it. Service time is the time between a worker
+dequeueing a buffer and that buffer either being emitted downstream or being
+destroyed.
+"""
+
+# Breaks ties between events with the same timestamp; a buffer is emitted by
+# one stage immediately before it is enqueued at the next.
+EVENT_ORDER = { "EMIT" : 0, "ENQUEUE" : 1, "DEQUEUE" : 2, "DESTROY" : 3 }
+
+def load_trace_file(filename):
+    stage_names = {}
+    events = {}
+    dropped = 0
+
+    with open(filename, 'r') as fp:
+        for line in fp:
+            fields = line.rstrip('\n').split('\t')
+
+            if fields[0] == "STAGE":
+                stage_names[int(fields[1])] = fields[2]
+            elif fields[0] == "EVENT":
+                trace_id = int(fields[1])
+                event = (int(fields[5]), EVENT_ORDER[fields[2]], fields[2],
+                         int(fields[3]), int(fields[4]))
+
+                if trace_id not in events:
+                    events[trace_id] = []
+                events[trace_id].append(event)
+            elif fields[0] == "DROPPED":
+                dropped += int(fields[1])
+
+    # Events for a buffer may have been recorded by several threads, so put
+    # them back in time order.
+    for trace_id in events:
+        events[trace_id].sort()
+
+    return stage_names, events, dropped
+
+def extract_intervals(events):
+    """
+    Pair up each buffer's events into (kind, stage, worker, start, end)
+    intervals, where kind is either "queue" or "service"
+    """
+    intervals = []
+
+    for trace_id, buffer_events in events.iteritems():
+        enqueued = None
+        dequeued = None
+
+        for timestamp, order, event_type, stage, worker in buffer_events:
+            if event_type == "ENQUEUE":
+                enqueued = (timestamp, stage)
+            elif event_type == "DEQUEUE":
+                if enqueued is not None and enqueued[1] == stage:
+                    intervals.append(
+                        ("queue", stage, worker, enqueued[0], timestamp))
+                enqueued = None
+                dequeued = (timestamp, stage, worker)
+            elif event_type in ("EMIT", "DESTROY"):
+                if dequeued is not None:
+                    intervals.append(
+                        ("service", dequeued[1], dequeued[2], dequeued[0],
+                         timestamp))
+                dequeued = None
+
+    return intervals
+
+def percentile(sorted_values, fraction):
+    index = min(int(math.ceil(fraction * len(sorted_values))) - 1,
+                len(sorted_values) - 1)
+    return sorted_values[max(index, 0)]
+
+def print_histogram(title, durations):
+    durations.sort()
+
+    print "  %s: %d buffers, mean %.1f us, p50 %d us, p90 %d us, p99 %d us" % (
+        title, len(durations), float(sum(durations)) / len(durations),
+        percentile(durations, 0.5), percentile(durations, 0.9),
+        percentile(durations, 0.99))
+
+    # Bucket durations by powers of two microseconds.
+    buckets = {}
+    for duration in durations:
+        bucket = 0
+        while (1 << bucket) <= duration:
+            bucket += 1
+        buckets[bucket] = buckets.get(bucket, 0) + 1
+
+    max_count = max(buckets.values())
+    for bucket in xrange(min(buckets), max(buckets) + 1):
+        count = buckets.get(bucket, 0)
+        upper = 1 << bucket
+        print "    < %10d us %8d %s" % (
+            upper, count, '#' * int(math.ceil(50.0 * count / max_count)))
+
+def buffer_trace(input_directory, chrome_trace):
+    trace_files = glob.glob(
+        os.path.join(input_directory, "*_buffer_trace.log"))
+
+    if len(trace_files) == 0:
+        sys.exit("No buffer trace logs found in %s" % (input_directory))
+
+    chrome_events = []
+
+    for trace_file in sorted(trace_files):
+        host = os.path.basename(trace_file)[:-len("_buffer_trace.log")]
+
+        stage_names, events, dropped = load_trace_file(trace_file)
+        intervals = extract_intervals(events)
+
+        print "%s:" % (host)
+        if dropped > 0:
+            print ("  Warning: %d events were overwritten; increase "
+                   "BUFFER_TRACE_RING_SIZE for complete traces" % (dropped))
+
+        durations = {}
+        for kind, stage, worker, start, end in intervals:
+            key = (stage, kind)
+            if key not in durations:
+                durations[key] = []
+            durations[key].append(end - start)
+
+            if chrome_trace is not None:
+                stage_name = stage_names.get(stage, str(stage))
+                if kind == "queue":
+                    thread_name = "%s queue" % (stage_name)
+                else:
+                    thread_name = "%s %d" % (stage_name, worker)
+
+                chrome_events.append({
+                        "name" : "%s %s" % (stage_name, kind),
+                        "cat" : kind,
+                        "ph" : "X",
+                        "ts" : start,
+                        "dur" : end - start,
+                        "pid" : host,
+                        "tid" : thread_name
+                        })
+
+        for stage in sorted(stage_names):
+            for kind in ("queue", "service"):
+                if (stage, kind) in durations:
+                    print_histogram("%s %s time" % (stage_names[stage], kind),
+                                    durations[(stage, kind)])
+
+    if chrome_trace is not None:
+        with open(chrome_trace, 'w') as fp:
+            json.dump({ "traceEvents" : chrome_events }, fp)
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="break per-stage buffer latency down into queueing and "
+        "service time using the logs written when BUFFER_TRACE is enabled")
+
+    parser.add_argument("input_directory", help="log directory to analyze")
+    parser.add_argument(
+        "-c", "--chrome_trace", default=None,
+        help="also write a Chrome trace-event JSON file to this path")
+    args = parser.parse_args()
+
+    if (not os.path.exists(args.input_directory) or
+        not os.path.isdir(args.input_directory)):
+        parser.error("'%s' doesn't exist or is not a directory" %
+                     (args.input_directory))
+
+    buffer_trace(**vars(args))
+
+if __name__ == "__main__":
+    main()
@@ -1,6 +1,11 @@
 #!/usr/bin/env python
 
-import sys, argparse, re
+import os, sys, argparse, re
+
+sys.path.append(os.path.abspath(os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), os.pardir)))
+
+import utils
 
 connection_time_regex = re.compile(r"^DATM\t.*sender\t(\d+)\tconnection_time_(\d+)_(\d+)\t\d+\t\d+\t(\d+)")
 bytes_sent_regex = re.compile(r"^DATM\t.*sender\t(\d+)\ttotal_bytes_sent_(\d+)_(\d+)\t(\d+)")
@@ -17,51 +22,56 @@ def get_peer_data(log_file):
     flow_data = {}
     peer_flow_data = {}
 
-    with open(log_file, "r") as fp:
-        for line in fp:
-            line = line.strip()
+    # Read the log through loggrep so that binary stat logs can be analyzed
+    # too. loggrep matches whole lines, so let each regex match to the end of
+    # the line.
+    loggrep_patterns = [regex.pattern + ".*" for regex in
+                        [connection_time_regex, bytes_sent_regex]]
+
+    for (pattern_number, line) in utils.grep_log_file(
+        log_file, loggrep_patterns):
 
-            if connection_time_regex.match(line) is not None:
-                matched_groups = connection_time_regex.match(line)
-                sender = int(matched_groups.group(1))
+        if connection_time_regex.match(line) is not None:
+            matched_groups = connection_time_regex.match(line)
+            sender = int(matched_groups.group(1))
 
-                if sender not in peer_flow_data:
-                    peer_flow_data[sender] = {}
+            if sender not in peer_flow_data:
+                peer_flow_data[sender] = {}
 
-                flow = int(matched_groups.group(2))
-                peer = int(matched_groups.group(3))
+            flow = int(matched_groups.group(2))
+            peer = int(matched_groups.group(3))
 
-                if peer not in peer_flow_data[sender]:
-                    peer_flow_data[sender][peer] = {}
+            if peer not in peer_flow_data[sender]:
+                peer_flow_data[sender][peer] = {}
 
-                connection_time = int(matched_groups.group(4))
-                # Convert to seconds
-                connection_time /= 1000000.0
+            connection_time = int(matched_groups.group(4))
+            # Convert to seconds
+            connection_time /= 1000000.0
 
-                if flow not in peer_flow_data[sender][peer]:
-                    peer_flow_data[sender][peer][flow] = {}
-                peer_flow_data[sender][peer][flow]["sec"] = connection_time
+            if flow not in peer_flow_data[sender][peer]:
+                peer_flow_data[sender][peer][flow] = {}
+            peer_flow_data[sender][peer][flow]["sec"] = connection_time
 
-            elif bytes_sent_regex.match(line) is not None:
-                matched_groups = bytes_sent_regex.match(line)
-                sender = int(matched_groups.group(1))
+        elif bytes_sent_regex.match(line) is not None:
+            matched_groups = bytes_sent_regex.match(line)
+            sender = int(matched_groups.group(1))
 
-                if sender not in peer_flow_data:
-                    peer_flow_data[sender] = {}
+            if sender not in peer_flow_data:
+                peer_flow_data[sender] = {}
 
-                flow = int(matched_groups.group(2))
-                peer = int(matched_groups.group(3))
+            flow = int(matched_groups.group(2))
+            peer = int(matched_groups.group(3))
 
-                if peer not in peer_flow_data[sender]:
-                    peer_flow_data[sender][peer] = {}
+            if peer not in peer_flow_data[sender]:
+                peer_flow_data[sender][peer] = {}
 
-                bytes_sent = int(matched_groups.group(4))
-                # Convert to MB
-                MB_sent = bytes_sent / 1000000.0
+            bytes_sent = int(matched_groups.group(4))
+            # Convert to MB
+            MB_sent = bytes_sent / 1000000.0
 
-                if flow not in peer_flow_data[sender][peer]:
-                    peer_flow_data[sender][peer][flow] = {}
-                peer_flow_data[sender][peer][flow]["MB"] = MB_sent
+            if flow not in peer_flow_data[sender][peer]:
+                peer_flow_data[sender][peer][flow] = {}
+            peer_flow_data[sender][peer][flow]["MB"] = MB_sent
 
     # Compute peer throughput totals
     peer_total_bytes = {}
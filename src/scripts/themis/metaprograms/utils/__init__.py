@@ -2,4 +2,4 @@ from StatContainer import StatContainer
 from LogLineDescription import LogLineDescription, load_descriptions_from_file
 from StatQuery import StatQuery
 from utils import process_queries, populate_nested_dictionary, job_sequence, \
-    job_description
+    job_description, grep_log_file
@@ -1,4 +1,4 @@
-import os, sys, subprocess, shlex, json, re
+import os, sys, subprocess, json, re
 
 from LogLineDescription import load_descriptions_from_file
 
@@ -122,35 +122,28 @@ def load_experiment_files(experiment_log_directory, skipped_phases=[]):
                  (experiment_log_directory))
     return experiment_files
 
-def run_queries_on_log_file(
-    queries, log_file, job_name, hostname, output_data, verbose):
+def grep_log_file(log_file, patterns):
     """
-    Run a list of queries on a given log file
+    Run loggrep on a stat log file, which may be in either the text or the
+    binary format, and return a (pattern number, line) pair for each line that
+    matches one of the given patterns. Patterns must match the entire line.
     """
+    if not os.path.exists(LOGGREP_PATH):
+        sys.exit("Can't find '%s'; be sure you've compiled loggrep and, "
+                 "if you're doing an out-of-source build, that you've "
+                 "symlinked loggrep into this location" % (LOGGREP_PATH))
 
-    if verbose:
-        print "Running queries on '%s' ..." % (log_file)
-
-    regexPatterns = [query.get_regex().pattern.replace('\t', '\\t')
-                     for query in queries]
-
-    loggrep_regex_args = ' '.join('"%s"' % (pattern)
-                                  for pattern in regexPatterns)
-
-    loggrep_command_str = "%(loggrep)s %(log_file)s %(args)s" % {
-        "loggrep" : LOGGREP_PATH,
-        "log_file" : log_file,
-        "args" : loggrep_regex_args}
-
-    loggrep_cmd = subprocess.Popen(shlex.split(loggrep_command_str),
+    loggrep_cmd = subprocess.Popen([LOGGREP_PATH, log_file] + patterns,
                                    stdout=subprocess.PIPE,
                                    stderr=subprocess.PIPE)
 
     (stdout, stderr) = loggrep_cmd.communicate()
 
     if loggrep_cmd.returncode != 0:
-        sys.exit("An error occurred while processing '%s': %s" % (
-                loggrep_command_str, stderr))
+        sys.exit("An error occurred while running loggrep on '%s': %s" % (
+                log_file, stderr))
+
+    matches = []
 
     for line in stdout.split('\n'):
         line = line.strip()
@@ -158,10 +151,25 @@ def run_queries_on_log_file(
         if len(line) == 0:
             continue
 
-        line_chunks = line.split('\t')
+        (pattern_number, matching_line) = line.split('\t', 1)
+        matches.append((int(pattern_number), matching_line))
+
+    return matches
+
+def run_queries_on_log_file(
+    queries, log_file, job_name, hostname, output_data, verbose):
+    """
+    Run a list of queries on a given log file
+    """
+
+    if verbose:
+        print "Running queries on '%s' ..." % (log_file)
+
+    regexPatterns = [query.get_regex().pattern.replace('\t', '\\t')
+                     for query in queries]
 
-        query_number = int(line_chunks[0])
-        match_parts = line_chunks[1:]
+    for (query_number, line) in grep_log_file(log_file, regexPatterns):
+        match_parts = line.split('\t')
 
         matching_query = queries[query_number]
 
@@ -0,0 +1,121 @@
+#include "benchmarks/mergebench/common/PrefilledWorkerTracker.h"
+#include "core/Resource.h"
+#include "core/TritonSortAssert.h"
+#include "core/WorkQueue.h"
+
+PrefilledWorkerTracker::PrefilledWorkerTracker(
+  const std::string& _stageName, uint64_t numQueues)
+  : stageName(_stageName),
+    queues(numQueues) {
+}
+
+PrefilledWorkerTracker::~PrefilledWorkerTracker() {
+  for (std::vector< std::queue<Resource*> >::iterator iter = queues.begin();
+       iter != queues.end(); iter++) {
+    while (!iter->empty()) {
+      delete iter->front();
+      iter->pop();
+    }
+  }
+}
+
+void PrefilledWorkerTracker::addWorkUnit(
+  uint64_t queueID, Resource* workUnit) {
+  ABORT_IF(queueID >= queues.size(), "Queue ID %llu out of range; there are "
+           "only %llu queues", queueID, queues.size());
+  queues[queueID].push(workUnit);
+}
+
+void PrefilledWorkerTracker::addWorkUnit(Resource* workUnit) {
+  addWorkUnit(0, workUnit);
+}
+
+uint64_t PrefilledWorkerTracker::size(uint64_t queueID) const {
+  return queues.at(queueID).size();
+}
+
+Resource* PrefilledWorkerTracker::getNewWork(uint64_t queueID) {
+  std::queue<Resource*>& queue = queues.at(queueID);
+
+  if (queue.empty()) {
+    return NULL;
+  }
+
+  Resource* workUnit = queue.front();
+  queue.pop();
+  return workUnit;
+}
+
+void PrefilledWorkerTracker::getNewWork(
+  uint64_t queueID, WorkQueue& destWorkQueue) {
+  std::queue<Resource*>& queue = queues.at(queueID);
+
+  while (!queue.empty()) {
+    destWorkQueue.push(queue.front());
+    queue.pop();
+  }
+}
+
+bool PrefilledWorkerTracker::attemptGetNewWork(
+  uint64_t queueID, Resource*& workUnit) {
+  workUnit = getNewWork(queueID);
+  return true;
+}
+
+bool PrefilledWorkerTracker::waitForWork(
+  uint64_t queueID, uint64_t timeoutMicros) {
+  return true;
+}
+
+void PrefilledWorkerTracker::spawn() {
+  // No-op
+}
+
+void PrefilledWorkerTracker::addSource(WorkerTrackerInterface* prevTracker) {
+  // No-op
+}
+
+bool PrefilledWorkerTracker::hasAlreadySpawned() const {
+  return true;
+}
+
+void PrefilledWorkerTracker::noMoreWork() {
+  // No-op
+}
+
+void PrefilledWorkerTracker::notifyWorkerCompleted(uint64_t id) {
+  // No-op
+}
+
+void PrefilledWorkerTracker::createWorkers() {
+  // No-op
+}
+
+void PrefilledWorkerTracker::destroyWorkers() {
+  // No-op
+}
+
+void PrefilledWorkerTracker::waitForWorkersToFinish() {
+  // No-op
+}
+
+void PrefilledWorkerTracker::addDownstreamTracker(
+  WorkerTrackerInterface* downstreamTracker) {
+  downstreamTrackerVector.push_back(downstreamTracker);
+}
+
+void PrefilledWorkerTracker::addDownstreamTracker(
+  WorkerTrackerInterface* downstreamTracker,
+  const std::string& trackerDescription) {
+
+  ABORT("Not implemented");
+}
+
+const WorkerTrackerInterface::WorkerTrackerVector&
+PrefilledWorkerTracker::downstreamTrackers() const {
+  return downstreamTrackerVector;
+}
+
+const std::string& PrefilledWorkerTracker::getStageName() const {
+  return stageName;
+}
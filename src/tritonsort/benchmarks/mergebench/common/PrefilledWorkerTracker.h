@@ -0,0 +1,113 @@
+#ifndef THEMIS_MERGEBENCH_PREFILLED_WORKER_TRACKER_H
+#define THEMIS_MERGEBENCH_PREFILLED_WORKER_TRACKER_H
+
+#include <queue>
+#include <vector>
+
+#include "core/WorkerTrackerInterface.h"
+
+/**
+   PrefilledWorkerTracker lets a benchmark drive a worker directly, without
+   spawning threads or going through a WorkerFactory. Work units are loaded
+   into its queues before the worker runs, and the worker pulls them out with
+   getNewWork() just as it would from a real tracker. Since every work unit is
+   already present, getNewWork() never blocks; an empty queue is treated as
+   having no more work.
+
+   It can also be used as a sink for the work units a worker emits, which
+   the benchmark can then drain with getNewWork().
+ */
+class PrefilledWorkerTracker : public WorkerTrackerInterface {
+public:
+  /// Constructor
+  /**
+     \param stageName the name of the stage corresponding to this tracker
+
+     \param numQueues the number of queues to create
+   */
+  PrefilledWorkerTracker(const std::string& stageName, uint64_t numQueues);
+
+  /// Destructor
+  virtual ~PrefilledWorkerTracker();
+
+  /// Add a work unit to a particular queue
+  /**
+     \param queueID the queue to which to add the work unit
+
+     \param workUnit the work unit to add
+   */
+  void addWorkUnit(uint64_t queueID, Resource* workUnit);
+
+  /// Add a work unit to the first queue
+  virtual void addWorkUnit(Resource* workUnit);
+
+  /// \return the number of work units in a queue
+  uint64_t size(uint64_t queueID) const;
+
+  /// Pop a work unit from a queue
+  /**
+     \return the work unit, or NULL if the queue is empty
+   */
+  Resource* getNewWork(uint64_t queueID);
+
+  /// Move every work unit in a queue into another work queue
+  void getNewWork(uint64_t queueID, WorkQueue& destWorkQueue);
+
+  /// Pop a work unit from a queue, setting workUnit to NULL if the queue is
+  /// empty
+  /**
+     \return true, since the queue either has work or never will
+   */
+  bool attemptGetNewWork(uint64_t queueID, Resource*& workUnit);
+
+  /// \return true, since the queue either has work or never will
+  bool waitForWork(uint64_t queueID, uint64_t timeoutMicros);
+
+  /// No-op
+  virtual void spawn();
+
+  /// No-op
+  virtual void addSource(WorkerTrackerInterface* prevTracker);
+
+  /// Consider this tracker as always spawned
+  /**
+     \return true
+   */
+  virtual bool hasAlreadySpawned() const;
+
+  /// No-op
+  virtual void noMoreWork();
+
+  /// No-op
+  virtual void notifyWorkerCompleted(uint64_t id);
+
+  /// No-op
+  virtual void createWorkers();
+
+  /// No-op
+  virtual void destroyWorkers();
+
+  /// No-op
+  virtual void waitForWorkersToFinish();
+
+  /// Add a downstream tracker to the list of downstream trackers
+  virtual void addDownstreamTracker(WorkerTrackerInterface* downstreamTracker);
+
+  /// \warning Not implemented
+  virtual void addDownstreamTracker(
+    WorkerTrackerInterface* downstreamTracker,
+    const std::string& trackerDescription);
+
+  /// \return the list of downstream trackers added to this stage
+  virtual const WorkerTrackerVector& downstreamTrackers() const;
+
+  /// \return the name of the stage
+  virtual const std::string& getStageName() const;
+
+private:
+  const std::string stageName;
+  WorkerTrackerVector downstreamTrackerVector;
+  std::vector< std::queue<Resource*> > queues;
+};
+
+#endif // THEMIS_MERGEBENCH_PREFILLED_WORKER_TRACKER_H
@@ -0,0 +1,520 @@
+/**
+   Merge Benchmark
+
+   Measures the hot loops of phases two and three in isolation: the Merger,
+   which merges sorted chunks of a partition into a single sorted stream, and
+   the reduce loop, which walks merged tuples with a ReduceKVPairIterator and
+   writes them back out through a PartialKVPairWriter.
+
+   The benchmark generates FAN_IN sorted chunks of TUPLES_PER_CHUNK tuples each,
+   with KEY_LENGTH-byte keys and VALUE_LENGTH-byte values. DUPLICATE_RATIO of
+   the tuples share their key with some other tuple, which exercises the
+   merger's heap ties and makes the reducer's key groups larger than one.
+   Chunks are cut into INPUT_BUFFER_SIZE-byte buffers and fed to a Merger
+   whose output buffers are OUTPUT_BUFFER_SIZE bytes; the merged buffers are
+   then reduced with the identity reduce function.
+
+   Each of ITERATIONS runs checks that the merged output is sorted and
+   complete, and then the benchmark prints a JSON report of tuples per second,
+   bytes per second and heap allocations per tuple for each loop, so that
+   reports from before and after a change to the merge engine can be compared.
+
+   Usage: mergebench [params file] -LOG_DIR dir -param1 val1 ...
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <new>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "benchmarks/mergebench/common/PrefilledWorkerTracker.h"
+#include "common/DummyWorker.h"
+#include "common/MainUtils.h"
+#include "common/SimpleMemoryAllocator.h"
+#include "common/WriteTokenPool.h"
+#include "core/Comparison.h"
+#include "core/MemoryUtils.h"
+#include "core/Params.h"
+#include "core/StatusPrinter.h"
+#include "core/Timer.h"
+#include "core/TritonSortAssert.h"
+#include "mapreduce/common/ChunkMap.h"
+#include "mapreduce/common/KVPairBufferFactory.h"
+#include "mapreduce/common/KeyValuePair.h"
+#include "mapreduce/common/PartialKVPairWriter.h"
+#include "mapreduce/functions/reduce/IdentityReduceFunction.h"
+#include "mapreduce/workers/merger/Merger.h"
+#include "mapreduce/workers/reducer/ReduceKVPairIterator.h"
+#include "third-party/jsoncpp.h"
+
+// Every heap allocation made through operator new is counted, so that the
+// benchmark can report allocations per tuple. Only the count is tracked; the
+// memory itself comes from malloc() as usual.
+static uint64_t numAllocations = 0;
+
+static void* countedAllocation(size_t size) {
+  __sync_fetch_and_add(&numAllocations, 1);
+  return malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(size_t size) {
+  void* memory = countedAllocation(size);
+  if (memory == NULL) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](size_t size) {
+  void* memory = countedAllocation(size);
+  if (memory == NULL) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) {
+  return countedAllocation(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) {
+  return countedAllocation(size);
+}
+
+void operator delete(void* memory) {
+  free(memory);
+}
+
+void operator delete[](void* memory) {
+  free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) {
+  free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) {
+  free(memory);
+}
+
+// The merger only looks at one partition's worth of chunks; the partition and
+// job IDs are arbitrary
+static const uint64_t PARTITION_ID = 0;
+static const uint64_t JOB_ID = 1;
+
+/// A chunk serialized as it would have been written by phase three's
+/// splitsort half, split into the buffers that will be fed to the merger
+struct Chunk {
+  std::vector<uint8_t> data;
+  // The offset into data at which each buffer ends
+  std::vector<uint64_t> bufferEnds;
+};
+
+/// Orders key pool indices by the keys they refer to
+class KeyIndexComparator {
+public:
+  KeyIndexComparator(const std::vector<uint8_t>& _keys, uint64_t _keyLength)
+    : keys(_keys),
+      keyLength(_keyLength) {
+  }
+
+  bool operator()(uint64_t index1, uint64_t index2) const {
+    return compare(
+      &keys[index1 * keyLength], keyLength,
+      &keys[index2 * keyLength], keyLength) < 0;
+  }
+
+private:
+  const std::vector<uint8_t>& keys;
+  const uint64_t keyLength;
+};
+
+/**
+   Generate FAN_IN sorted chunks. Keys are drawn from a pool of distinct random
+   keys that is sorted once up front, so that sorting each chunk only requires
+   sorting indices into the pool.
+ */
+void generateChunks(
+  std::vector<Chunk>& chunks, uint64_t fanIn, uint64_t tuplesPerChunk,
+  uint64_t keyLength, uint64_t valueLength, double duplicateRatio,
+  uint64_t inputBufferSize) {
+
+  uint64_t numTuples = fanIn * tuplesPerChunk;
+  uint64_t numDistinctKeys = std::max<uint64_t>(
+    1, static_cast<uint64_t>(numTuples * (1.0 - duplicateRatio)));
+
+  std::vector<uint8_t> keys(numDistinctKeys * keyLength);
+  for (uint64_t i = 0; i < keys.size(); i++) {
+    keys[i] = rand() % 256;
+  }
+
+  std::vector<uint64_t> sortedKeys(numDistinctKeys);
+  for (uint64_t i = 0; i < numDistinctKeys; i++) {
+    sortedKeys[i] = i;
+  }
+  std::sort(
+    sortedKeys.begin(), sortedKeys.end(), KeyIndexComparator(keys, keyLength));
+
+  std::vector<uint8_t> value(valueLength);
+  for (uint64_t i = 0; i < valueLength; i++) {
+    value[i] = rand() % 256;
+  }
+
+  uint64_t tupleSize = KeyValuePair::tupleSize(keyLength, valueLength);
+  ABORT_IF(tupleSize > inputBufferSize, "A %llu-byte tuple won't fit in a "
+           "%llu-byte input buffer", tupleSize, inputBufferSize);
+
+  chunks.resize(fanIn);
+
+  std::vector<uint64_t> keyRanks(tuplesPerChunk);
+  KeyValuePair kvPair;
+
+  for (uint64_t chunkID = 0; chunkID < fanIn; chunkID++) {
+    // Every distinct key appears at least once across all chunks, and the
+    // remaining tuples duplicate randomly chosen keys.
+    for (uint64_t i = 0; i < tuplesPerChunk; i++) {
+      uint64_t tupleNumber = chunkID * tuplesPerChunk + i;
+      keyRanks[i] = (tupleNumber < numDistinctKeys) ?
+        tupleNumber : rand() % numDistinctKeys;
+    }
+    std::sort(keyRanks.begin(), keyRanks.end());
+
+    Chunk& chunk = chunks[chunkID];
+    chunk.data.resize(tuplesPerChunk * tupleSize);
+
+    uint64_t offset = 0;
+    uint64_t bufferStart = 0;
+
+    for (uint64_t i = 0; i < tuplesPerChunk; i++) {
+      kvPair.setKey(&keys[sortedKeys[keyRanks[i]] * keyLength], keyLength);
+      kvPair.setValue(&value[0], valueLength);
+
+      if (offset + tupleSize - bufferStart > inputBufferSize) {
+        chunk.bufferEnds.push_back(offset);
+        bufferStart = offset;
+      }
+
+      kvPair.serialize(&chunk.data[offset]);
+      offset += tupleSize;
+    }
+
+    chunk.bufferEnds.push_back(offset);
+  }
+}
+
+/// Cut every chunk into buffers and queue them for the merger
+void loadChunks(
+  const std::vector<Chunk>& chunks, PrefilledWorkerTracker& mergerTracker) {
+  for (uint64_t chunkID = 0; chunkID < chunks.size(); chunkID++) {
+    const Chunk& chunk = chunks[chunkID];
+    uint64_t bufferStart = 0;
+
+    for (std::vector<uint64_t>::const_iterator iter = chunk.bufferEnds.begin();
+         iter != chunk.bufferEnds.end(); iter++) {
+      uint64_t bufferEnd = *iter;
+
+      KVPairBuffer* buffer = new (themis::memcheck) KVPairBuffer(
+        bufferEnd - bufferStart);
+      buffer->append(&chunk.data[bufferStart], bufferEnd - bufferStart);
+      buffer->setLogicalDiskID(PARTITION_ID);
+      buffer->setChunkID(chunkID);
+      buffer->addJobID(JOB_ID);
+
+      mergerTracker.addWorkUnit(chunkID, buffer);
+      bufferStart = bufferEnd;
+    }
+  }
+}
+
+/// Check that the merged buffers hold every tuple in sorted order
+void verifyMergedBuffers(
+  const std::vector<KVPairBuffer*>& mergedBuffers, uint64_t numTuples) {
+  KeyValuePair kvPair;
+  KeyValuePair previousKVPair;
+  bool havePrevious = false;
+  uint64_t tuplesSeen = 0;
+
+  for (std::vector<KVPairBuffer*>::const_iterator iter =
+         mergedBuffers.begin(); iter != mergedBuffers.end(); iter++) {
+    KVPairBuffer* buffer = *iter;
+    buffer->resetIterator();
+
+    while (buffer->getNextKVPair(kvPair)) {
+      if (havePrevious) {
+        ABORT_IF(compare(
+                   previousKVPair.getKey(), previousKVPair.getKeyLength(),
+                   kvPair.getKey(), kvPair.getKeyLength()) > 0,
+                 "Merged output is out of order at tuple %llu", tuplesSeen);
+      }
+
+      previousKVPair.setKey(kvPair.getKey(), kvPair.getKeyLength());
+      havePrevious = true;
+      tuplesSeen++;
+    }
+
+    buffer->resetIterator();
+  }
+
+  ABORT_IF(tuplesSeen != numTuples, "Merged output has %llu tuples, but "
+           "expected %llu", tuplesSeen, numTuples);
+}
+
+/// Counts and frees the buffers the reduce loop's writer emits
+class ReduceOutputSink {
+public:
+  ReduceOutputSink(KVPairBufferFactory& _bufferFactory)
+    : bufferFactory(_bufferFactory),
+      bytesEmitted(0) {
+  }
+
+  void emitBuffer(KVPairBuffer* buffer, uint64_t partition) {
+    bytesEmitted += buffer->getCurrentSize();
+    delete buffer;
+  }
+
+  KVPairBuffer* newBuffer() {
+    KVPairBuffer* buffer = bufferFactory.newInstance();
+    buffer->clear();
+    buffer->addJobID(JOB_ID);
+    return buffer;
+  }
+
+  uint64_t getBytesEmitted() const {
+    return bytesEmitted;
+  }
+
+private:
+  KVPairBufferFactory& bufferFactory;
+  uint64_t bytesEmitted;
+};
+
+/// Summarize one timed loop as a JSON object
+void addLoopStats(
+  Json::Value& obj, uint64_t numTuples, uint64_t numBytes,
+  uint64_t elapsedMicros, uint64_t allocations) {
+  double elapsedSeconds = std::max<uint64_t>(elapsedMicros, 1) / 1000000.0;
+
+  obj["elapsed_micros"] = Json::UInt64(elapsedMicros);
+  obj["tuples_per_second"] = numTuples / elapsedSeconds;
+  obj["bytes_per_second"] = numBytes / elapsedSeconds;
+  obj["allocations"] = Json::UInt64(allocations);
+  obj["allocations_per_tuple"] = static_cast<double>(allocations) / numTuples;
+}
+
+template <typename T> T getParamOrDefault(
+  Params& params, const std::string& name, T defaultValue) {
+  if (!params.contains(name)) {
+    params.add<T>(name, defaultValue);
+  }
+
+  return params.get<T>(name);
+}
+
+int main(int argc, char** argv) {
+  signal(SIGSEGV, sigsegvHandler);
+
+  if (argc == 1 ||
+      (argc == 2 && (!strcmp(argv[1], "-h") ||
+                     !strcmp(argv[1], "-help") ||
+                     !strcmp(argv[1], "--help")))) {
+    std::cerr << "Usage: " << argv[0]
+              << " [params file] -param1 val 1 -param2 val2 ..."
+              << std::endl << std::endl
+              << "Required parameters:" << std::endl
+              << "LOG_DIR = path to log directory" << std::endl << std::endl
+              << "Optional parameters:" << std::endl
+              << "FAN_IN = number of sorted chunks to merge (8)" << std::endl
+              << "TUPLES_PER_CHUNK = tuples in each chunk (250000)"
+              << std::endl
+              << "KEY_LENGTH = key length in bytes (10)" << std::endl
+              << "VALUE_LENGTH = value length in bytes (90)" << std::endl
+              << "DUPLICATE_RATIO = fraction of tuples whose key is shared "
+              << "with another tuple (0)" << std::endl
+              << "INPUT_BUFFER_SIZE = size of the buffers chunks are fed to "
+              << "the merger in (1048576)" << std::endl
+              << "OUTPUT_BUFFER_SIZE = size of merger and reducer output "
+              << "buffers (4194304)" << std::endl
+              << "ITERATIONS = number of times to run each loop (3)"
+              << std::endl
+              << "RANDOM_SEED = seed for data generation (0)" << std::endl;
+    exit(1);
+  }
+
+  Params params;
+  params.parseCommandLine(argc, argv);
+
+  params.add<std::string>("CHANNEL_STATUS_HEADER", "STATUS");
+  params.add<std::string>("CHANNEL_STATISTIC_HEADER", "STATISTIC");
+  params.add<std::string>("CHANNEL_PARAM_HEADER", "PARAM");
+
+  StatusPrinter::init(&params);
+  StatusPrinter::spawn();
+
+  const uint64_t FAN_IN = getParamOrDefault<uint64_t>(params, "FAN_IN", 8);
+  const uint64_t TUPLES_PER_CHUNK = getParamOrDefault<uint64_t>(
+    params, "TUPLES_PER_CHUNK", 250000);
+  const uint64_t KEY_LENGTH = getParamOrDefault<uint64_t>(
+    params, "KEY_LENGTH", 10);
+  const uint64_t VALUE_LENGTH = getParamOrDefault<uint64_t>(
+    params, "VALUE_LENGTH", 90);
+  const double DUPLICATE_RATIO = getParamOrDefault<double>(
+    params, "DUPLICATE_RATIO", 0.0);
+  const uint64_t INPUT_BUFFER_SIZE = getParamOrDefault<uint64_t>(
+    params, "INPUT_BUFFER_SIZE", 1048576);
+  const uint64_t OUTPUT_BUFFER_SIZE = getParamOrDefault<uint64_t>(
+    params, "OUTPUT_BUFFER_SIZE", 4194304);
+  const uint64_t ITERATIONS = getParamOrDefault<uint64_t>(
+    params, "ITERATIONS", 3);
+  const uint64_t RANDOM_SEED = getParamOrDefault<uint64_t>(
+    params, "RANDOM_SEED", 0);
+
+  ABORT_IF(FAN_IN == 0 || TUPLES_PER_CHUNK == 0, "Need at least one chunk "
+           "and one tuple per chunk");
+  ABORT_IF(ITERATIONS == 0, "Need at least one iteration");
+  ABORT_IF(DUPLICATE_RATIO < 0.0 || DUPLICATE_RATIO >= 1.0,
+           "DUPLICATE_RATIO must be in [0, 1)");
+
+  srand(RANDOM_SEED);
+
+  std::vector<Chunk> chunks;
+  generateChunks(
+    chunks, FAN_IN, TUPLES_PER_CHUNK, KEY_LENGTH, VALUE_LENGTH,
+    DUPLICATE_RATIO, INPUT_BUFFER_SIZE);
+
+  const uint64_t numTuples = FAN_IN * TUPLES_PER_CHUNK;
+  const uint64_t numBytes =
+    numTuples * KeyValuePair::tupleSize(KEY_LENGTH, VALUE_LENGTH);
+
+  SimpleMemoryAllocator memoryAllocator;
+
+  Json::Value report;
+  report["fan_in"] = Json::UInt64(FAN_IN);
+  report["tuples_per_chunk"] = Json::UInt64(TUPLES_PER_CHUNK);
+  report["key_length"] = Json::UInt64(KEY_LENGTH);
+  report["value_length"] = Json::UInt64(VALUE_LENGTH);
+  report["duplicate_ratio"] = DUPLICATE_RATIO;
+  report["input_buffer_size"] = Json::UInt64(INPUT_BUFFER_SIZE);
+  report["output_buffer_size"] = Json::UInt64(OUTPUT_BUFFER_SIZE);
+
+  Json::Value& iterations = report["iterations"];
+
+  for (uint64_t iteration = 0; iteration < ITERATIONS; iteration++) {
+    Json::Value& iterationStats = iterations[static_cast<int>(iteration)];
+
+    // The merger consumes its chunk map, input buffers and token pool, so
+    // build new ones every time.
+    ChunkMap chunkMap(1);
+    for (uint64_t chunkID = 0; chunkID < FAN_IN; chunkID++) {
+      chunkMap.addChunk(PARTITION_ID, chunks[chunkID].data.size());
+    }
+
+    WriteTokenPool tokenPool(1, 1);
+
+    PrefilledWorkerTracker mergerTracker("merger", FAN_IN);
+    PrefilledWorkerTracker mergedBufferTracker("reducer", 1);
+
+    loadChunks(chunks, mergerTracker);
+
+    Merger merger(
+      "merger", 0, memoryAllocator, chunkMap, OUTPUT_BUFFER_SIZE, 0,
+      tokenPool);
+    merger.setTracker(&mergerTracker);
+    merger.addDownstreamTracker(&mergedBufferTracker);
+
+    // Merge
+    uint64_t allocationsBefore = numAllocations;
+    Timer mergeTimer;
+    mergeTimer.start();
+
+    merger.run();
+
+    mergeTimer.stop();
+    addLoopStats(
+      iterationStats["merge"], numTuples, numBytes, mergeTimer.getElapsed(),
+      numAllocations - allocationsBefore);
+
+    merger.teardown();
+
+    std::vector<KVPairBuffer*> mergedBuffers;
+    while (mergedBufferTracker.size(0) > 0) {
+      mergedBuffers.push_back(
+        dynamic_cast<KVPairBuffer*>(mergedBufferTracker.getNewWork(0)));
+    }
+
+    verifyMergedBuffers(mergedBuffers, numTuples);
+
+    // Reduce the merged buffers the way Reducer does, one buffer at a time.
+    DummyWorker reducer(0, "reducer");
+    KVPairBufferFactory reduceBufferFactory(
+      reducer, memoryAllocator, OUTPUT_BUFFER_SIZE);
+    ReduceOutputSink reduceOutputSink(reduceBufferFactory);
+    IdentityReduceFunction reduceFunction;
+
+    PartialKVPairWriter writer(
+      boost::bind(&ReduceOutputSink::emitBuffer, &reduceOutputSink, _1, _2),
+      boost::bind(&ReduceOutputSink::newBuffer, &reduceOutputSink), false);
+
+    allocationsBefore = numAllocations;
+    Timer reduceTimer;
+    reduceTimer.start();
+
+    for (std::vector<KVPairBuffer*>::iterator iter = mergedBuffers.begin();
+         iter != mergedBuffers.end(); iter++) {
+      ReduceKVPairIterator iterator(**iter);
+
+      const uint8_t* key = NULL;
+      uint32_t keyLength = 0;
+
+      while (iterator.startNextKey(key, keyLength)) {
+        reduceFunction.reduce(key, keyLength, iterator, writer);
+      }
+    }
+    writer.flushBuffers();
+
+    reduceTimer.stop();
+    addLoopStats(
+      iterationStats["reduce"], writer.getNumTuplesWritten(),
+      reduceOutputSink.getBytesEmitted(), reduceTimer.getElapsed(),
+      numAllocations - allocationsBefore);
+
+    ABORT_IF(writer.getNumTuplesWritten() != numTuples, "Reduced %llu "
+             "tuples, but expected %llu", writer.getNumTuplesWritten(),
+             numTuples);
+
+    for (std::vector<KVPairBuffer*>::iterator iter = mergedBuffers.begin();
+         iter != mergedBuffers.end(); iter++) {
+      delete *iter;
+    }
+  }
+
+  // Summarize across iterations so that reports can be compared at a glance
+  const char* loops[] = {"merge", "reduce"};
+  for (uint64_t i = 0; i < 2; i++) {
+    double tuplesPerSecond = 0.0;
+    double allocationsPerTuple = 0.0;
+
+    for (uint64_t iteration = 0; iteration < ITERATIONS; iteration++) {
+      const Json::Value& loopStats =
+        iterations[static_cast<int>(iteration)][loops[i]];
+      tuplesPerSecond += loopStats["tuples_per_second"].asDouble();
+      allocationsPerTuple += loopStats["allocations_per_tuple"].asDouble();
+    }
+
+    Json::Value& summary = report["mean"][loops[i]];
+    summary["tuples_per_second"] = tuplesPerSecond / ITERATIONS;
+    summary["allocations_per_tuple"] = allocationsPerTuple / ITERATIONS;
+  }
+
+  std::cout << report.toStyledString();
+
+  StatusPrinter::flush();
+  StatusPrinter::teardown();
+
+  return 0;
+}
@@ -10,6 +10,7 @@ const char* malloc_conf = "lg_chunk:20,lg_tcache_gc_sweep:30";
 
 #include "benchmarks/mixediobench/workers/MixedIOBenchWorkerImpls.h"
 #include "benchmarks/storagebench/workers/StorageBenchWorkerImpls.h"
+#include "common/DiskIOScheduler.h"
 #include "common/MainUtils.h"
 #include "common/SimpleMemoryAllocator.h"
 #include "core/CPUAffinitySetter.h"
@@ -185,6 +186,23 @@ void executeBenchmark(Params* params) {
   workerFactory.addDependency("sender", "sockets", &senderSockets);
   workerFactory.addDependency("receiver", "sockets", &receiverSockets);
 
+  // Readers and writers share disks through the scheduler if requested, so
+  // that runs with and without it can be compared.
+  DiskIOScheduler* ioScheduler = NULL;
+  if (params->get<bool>("DISK_IO_SCHEDULING")) {
+    // Synchronous readers never wait for the scheduler.
+    std::string readerImpl =
+      params->get<std::string>("WORKER_IMPLS.mixediobench.reader");
+    ABORT_IF(readerImpl != "LibAIOReader" && readerImpl != "PosixAIOReader",
+             "DISK_IO_SCHEDULING requires an asynchronous reader, but the "
+             "reader is %s", readerImpl.c_str());
+
+    ioScheduler = new DiskIOScheduler(
+      params->get<uint64_t>("DISK_IO_BURST_LENGTH"),
+      params->get<double>("DISK_IO_READ_SHARE"));
+    workerFactory.addDependency("io_scheduler", ioScheduler);
+  }
+
   // Create workers
   trackers.createWorkers();
 
@@ -208,11 +226,23 @@ void executeBenchmark(Params* params) {
 
   phaseStatLogger.logDatum("phase_runtime", phaseTimer);
 
+  // Every byte of data is both read and written on this node, so report the
+  // rate at which it moved through the node's disks.
+  uint64_t runtime = phaseTimer.getElapsed();
+  if (runtime > 0) {
+    phaseStatLogger.logDatum(
+      "throughput_bytes_per_second", (dataSize * 1000000) / runtime);
+  }
+
   delete memoryAllocator;
 
   // Destroy workers
   trackers.destroyWorkers();
 
+  if (ioScheduler != NULL) {
+    delete ioScheduler;
+  }
+
   StatusPrinter::add("Phase 1 complete");
   StatusPrinter::flush();
 }
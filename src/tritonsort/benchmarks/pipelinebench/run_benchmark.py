@@ -0,0 +1,279 @@
+#!/usr/bin/env python
+
+import os, sys, argparse, shutil, subprocess, shlex, json, time, resource
+
+BENCHMARK_DIR = os.path.dirname(os.path.abspath(__file__))
+
+TRITONSORT_DIR = os.path.join(BENCHMARK_DIR, os.pardir, os.pardir)
+
+MAPREDUCE_DIR = os.path.join(TRITONSORT_DIR, "mapreduce")
+
+THEMIS_SCRIPTS_DIR = os.path.join(
+    TRITONSORT_DIR, os.pardir, "scripts", "themis")
+
+sys.path.append(THEMIS_SCRIPTS_DIR)
+
+from metaprograms.runtime_info.gather_runtime_info import gather_runtime_info
+
+# gensort records are 100 bytes
+RECORD_SIZE = 100
+
+# Keep each input file at most this many records (100MB) so that the reader
+# gets several read requests
+RECORDS_PER_FILE = 1000000
+
+# The job ID that the debug coordinator client assigns to its one job
+JOB_ID = 1
+
+def generate_input(gensort, input_directory, data_size, skew):
+    job_directory = os.path.join(input_directory, "job_%d" % JOB_ID)
+    os.makedirs(job_directory)
+
+    num_records = data_size / RECORD_SIZE
+    starting_record = 0
+    file_number = 0
+
+    while starting_record < num_records:
+        file_records = min(RECORDS_PER_FILE, num_records - starting_record)
+
+        command = [gensort, "-b%d" % starting_record]
+        if skew:
+            command.append("-s")
+        command += [str(file_records), os.path.join(
+                job_directory, "%08d.partition" % file_number)]
+
+        subprocess.check_call(command)
+
+        starting_record += file_records
+        file_number += 1
+
+    return num_records * RECORD_SIZE
+
+def run_pipeline(binary, defaults, config, log_directory, input_directory,
+                 intermediate_directory, output_directory, num_partitions,
+                 params):
+    command = [
+        binary,
+        "-DEFAULT_CONFIG", defaults,
+        "-CONFIG", config,
+        "-PEER_LIST", "127.0.0.1",
+        "-MYPEERID", "0",
+        "-NUM_INPUT_DISKS", "1",
+        "-INPUT_DISK_LIST.phase_one", input_directory,
+        "-INTERMEDIATE_DISK_LIST", intermediate_directory,
+        "-OUTPUT_DISK_LIST", output_directory,
+        "-NUM_PARTITIONS", str(num_partitions),
+        "-LOG_DIR", log_directory] + shlex.split(params)
+
+    # getrusage() only covers children that have been waited for, so take the
+    # difference across the run to get the pipeline's own CPU time.
+    usage_before = resource.getrusage(resource.RUSAGE_CHILDREN)
+    start_time = time.time()
+
+    status = subprocess.call(command)
+
+    elapsed = time.time() - start_time
+    usage_after = resource.getrusage(resource.RUSAGE_CHILDREN)
+
+    if status != 0:
+        sys.exit("%s failed with status %d" % (binary, status))
+
+    cpu_time = {
+        "user" : usage_after.ru_utime - usage_before.ru_utime,
+        "system" : usage_after.ru_stime - usage_before.ru_stime
+        }
+
+    return (elapsed, cpu_time)
+
+def stage_report(stage_info):
+    """
+    Keep the cluster-wide statistics for a stage that are useful for spotting
+    regressions. Rates are in bytes per second and times in seconds.
+    """
+    worker_runtime = stage_info["worker_runtime"] / 1000000.0
+
+    report = {
+        "num_workers" : stage_info.get("num_workers", 0),
+        "bytes_in" : stage_info["total_bytes_in"],
+        "bytes_out" : stage_info["total_bytes_out"],
+        "worker_runtime" : worker_runtime,
+        "total_processing_time" :
+            stage_info["total_processing_time"] / 1000000.0,
+        "useful_processing_time" :
+            stage_info["useful_processing_time"] / 1000000.0,
+        "percent_useful_processing" :
+            stage_info.get("percent_useful_processing", 0),
+        "bytes_per_second" : 0.0
+        }
+
+    if worker_runtime > 0:
+        report["bytes_per_second"] = stage_info["total_bytes_in"] / \
+            worker_runtime
+
+    return report
+
+def build_report(runtime_info, data_size, skew, num_partitions, elapsed,
+                 cpu_time):
+    report = {
+        "data_size" : data_size,
+        "skew" : skew,
+        "num_partitions" : num_partitions,
+        "elapsed" : elapsed,
+        "bytes_per_second" : data_size / elapsed,
+        "cpu_time" : cpu_time,
+        "phases" : {}
+        }
+
+    for epoch_info in runtime_info:
+        stages = {}
+
+        for stage_info in epoch_info["stages"]:
+            # Only report on whole stages rather than individual hosts or
+            # workers, since there's only one host.
+            if len(stage_info["stats_info"]) != 1:
+                continue
+
+            stages[stage_info["stats_info"]["stage"]] = stage_report(stage_info)
+
+        report["phases"][epoch_info["phase"]] = stages
+
+    return report
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run phases one and two of the mapreduce pipeline on this "
+        "machine against generated input, and report per-stage throughput")
+    parser.add_argument(
+        "--config", "-c", help="config file to use for the benchmark "
+        "(default: %(default)s)",
+        default=os.path.join(BENCHMARK_DIR, "config.yaml"), type=str)
+    parser.add_argument(
+        "--binary", help="path to the mapreduce binary (default: %(default)s)",
+        default=os.path.join(MAPREDUCE_DIR, "mapreduce"))
+    parser.add_argument(
+        "--default_config", help="path to the default config file "
+        "(default: %(default)s)",
+        default=os.path.join(MAPREDUCE_DIR, "defaults.yaml"))
+    parser.add_argument(
+        "--gensort", help="path to the gensort binary (default: %(default)s)",
+        default=os.path.join(TRITONSORT_DIR, os.pardir, "gensort", "gensort"))
+    parser.add_argument(
+        "--work_directory", "-w", help="directory in which to put input, "
+        "intermediate and output files; tmpfs keeps the benchmark from being "
+        "bound by disk (default: %(default)s)",
+        default="/dev/shm/pipelinebench")
+    parser.add_argument(
+        "--log_directory", "-l", help="directory in which to put logs "
+        "(default: <work_directory>/logs)", default=None)
+    parser.add_argument(
+        "--data_size", "-d", help="bytes of input to generate "
+        "(default: %(default)s)", type=int, default=1000000000)
+    parser.add_argument(
+        "--skew", "-s", help="generate input with skewed keys",
+        action="store_true", default=False)
+    parser.add_argument(
+        "--num_partitions", "-p", help="number of partitions (default: enough "
+        "that each is about half of PARTITION_SIZE)", type=int, default=None)
+    parser.add_argument(
+        "--partition_size", help="the config's PARTITION_SIZE, used to pick a "
+        "default number of partitions (default: %(default)s)", type=int,
+        default=100000000)
+    parser.add_argument(
+        "--output", "-o", help="file to which to write the JSON report "
+        "(default: report.json in the run's batch_# log directory)",
+        default=None)
+    parser.add_argument(
+        "--keep_data", help="don't delete input, intermediate and output "
+        "files after the run", action="store_true", default=False)
+    parser.add_argument(
+        "--params", help="extra parameters surrounded by quotes to pass to the "
+        "binary, for example \"-NUM_WORKERS.phase_one.mapper 2\"", type=str,
+        default="")
+
+    args = parser.parse_args()
+
+    for path in [args.binary, args.default_config, args.config, args.gensort]:
+        if not os.path.exists(path):
+            sys.exit("Can't find %s" % (path))
+
+    work_directory = os.path.abspath(args.work_directory)
+    input_directory = os.path.join(work_directory, "input")
+    intermediate_directory = os.path.join(work_directory, "intermediate")
+    output_directory = os.path.join(work_directory, "output")
+
+    log_directory = args.log_directory
+    if log_directory is None:
+        log_directory = os.path.join(work_directory, "logs")
+    log_directory = os.path.abspath(log_directory)
+
+    # Pick a unique batch ID, since the log processing scripts expect logs for
+    # a run to be in a batch_# directory
+    batch = 0
+    while os.path.exists(os.path.join(log_directory, "batch_%d" % batch)):
+        batch += 1
+    batch_directory = os.path.join(log_directory, "batch_%d" % batch)
+    phase_directory = os.path.join(batch_directory, "mapreduce")
+
+    for directory in [input_directory, intermediate_directory,
+                      output_directory]:
+        if os.path.exists(directory):
+            shutil.rmtree(directory)
+        os.makedirs(directory)
+
+    os.makedirs(phase_directory)
+
+    # Copy description files so stages are reported in pipeline order
+    for filename in ["stages.json", "structure.json"]:
+        shutil.copy(os.path.join(MAPREDUCE_DIR, "description", filename),
+                    batch_directory)
+    shutil.copy(args.config, os.path.join(batch_directory, "config.yaml"))
+
+    print "Generating %d bytes of %sinput in %s ..." % (
+        args.data_size, "skewed " if args.skew else "", input_directory)
+    data_size = generate_input(
+        os.path.abspath(args.gensort), input_directory, args.data_size,
+        args.skew)
+
+    num_partitions = args.num_partitions
+    if num_partitions is None:
+        num_partitions = max(1, (2 * data_size + args.partition_size - 1) /
+                             args.partition_size)
+
+    print "Logging to %s" % (batch_directory)
+    print "Running phases one and two with %d partitions ..." % (
+        num_partitions)
+
+    (elapsed, cpu_time) = run_pipeline(
+        os.path.abspath(args.binary), os.path.abspath(args.default_config),
+        os.path.abspath(args.config), phase_directory, input_directory,
+        intermediate_directory, output_directory, num_partitions, args.params)
+
+    runtime_info = gather_runtime_info(batch_directory, False)
+
+    report = build_report(
+        runtime_info, data_size, args.skew, num_partitions, elapsed, cpu_time)
+
+    output_filename = args.output
+    if output_filename is None:
+        output_filename = os.path.join(batch_directory, "report.json")
+
+    with open(output_filename, "w") as fp:
+        json.dump(report, fp, indent=4, sort_keys=True)
+
+    print "Completed in %.2f seconds (%.2f MB/s)" % (
+        elapsed, report["bytes_per_second"] / 1000000)
+    print "  CPU time: %.2f seconds user, %.2f seconds system" % (
+        cpu_time["user"], cpu_time["system"])
+    for phase in sorted(report["phases"]):
+        for stage, stage_info in sorted(report["phases"][phase].items()):
+            print "  %s %s: %.2f MB/s" % (
+                phase, stage, stage_info["bytes_per_second"] / 1000000)
+    print "Report written to %s" % (output_filename)
+
+    if not args.keep_data:
+        for directory in [input_directory, intermediate_directory,
+                          output_directory]:
+            shutil.rmtree(directory)
+
+if __name__ == "__main__":
+    sys.exit(main())
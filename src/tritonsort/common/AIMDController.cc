@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "common/AIMDController.h"
+#include "core/TritonSortAssert.h"
+
+const double AIMDController::BASELINE_DRIFT = 1.0 / 64;
+
+AIMDController::AIMDController(
+  uint64_t _minimumLimit, uint64_t _maximumLimit, double _latencyThreshold)
+  : minimumLimit(_minimumLimit),
+    maximumLimit(_maximumLimit),
+    latencyThreshold(_latencyThreshold),
+    limit(_maximumLimit),
+    baselineLatency(0.0),
+    fullOperationSize(0),
+    uncongestedCompletions(0),
+    completionsSinceDecrease(0) {
+
+  ABORT_IF(minimumLimit == 0 || minimumLimit > maximumLimit,
+           "Invalid AIMD limits [%llu, %llu]", minimumLimit, maximumLimit);
+  ABORT_IF(latencyThreshold < 1.0, "AIMD latency threshold must be at least "
+           "1, but was %f", latencyThreshold);
+}
+
+uint64_t AIMDController::getLimit() const {
+  return limit;
+}
+
+void AIMDController::recordLatency(uint64_t latency, uint64_t size) {
+  if (size < fullOperationSize) {
+    // Short operations aren't comparable to full-size ones.
+    return;
+  }
+
+  if (size > fullOperationSize) {
+    // Earlier samples were all shorter than this one, so start over.
+    fullOperationSize = size;
+    baselineLatency = 0.0;
+  }
+
+  double sample = static_cast<double>(latency);
+
+  if (baselineLatency == 0.0 || sample < baselineLatency) {
+    baselineLatency = sample;
+  } else {
+    baselineLatency += (sample - baselineLatency) * BASELINE_DRIFT;
+  }
+
+  completionsSinceDecrease++;
+
+  if (sample > baselineLatency * latencyThreshold) {
+    uncongestedCompletions = 0;
+
+    if (completionsSinceDecrease >= limit) {
+      limit = std::max(minimumLimit, limit / 2);
+      completionsSinceDecrease = 0;
+    }
+  } else {
+    uncongestedCompletions++;
+
+    if (uncongestedCompletions >= limit) {
+      limit = std::min(maximumLimit, limit + 1);
+      uncongestedCompletions = 0;
+    }
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef THEMIS_AIMD_CONTROLLER_H
+#define THEMIS_AIMD_CONTROLLER_H
+
+#include <stdint.h>
+
+/**
+   An additive-increase, multiplicative-decrease controller for the number of
+   operations that should be outstanding on a device at once, driven by the
+   latency of operations as they complete.
+
+   The controller keeps a baseline latency for the device, which is the lowest
+   latency it has seen, drifting slowly upward toward recent latencies so that
+   a few unusually fast operations (a cache hit, for example) don't set an
+   unreachable baseline forever. Only full-size operations, the largest the
+   controller has seen, are sampled, since short operations like the tail of a
+   file would otherwise drag the baseline down and make every full-size
+   operation look congested. If a larger operation completes, the baseline
+   starts over from it. An operation whose latency is more than
+   latencyThreshold times the baseline is a sign that the device is
+   congested, and halves the limit. Once the limit's worth of consecutive
+   operations completes without congestion, the limit grows by one. The limit
+   is halved at most once for each limit's worth of completed operations,
+   since operations issued before a decrease are still draining after it.
+ */
+class AIMDController {
+public:
+  /// Constructor
+  /**
+     \param minimumLimit the smallest limit the controller will set
+
+     \param maximumLimit the largest limit the controller will set, which is
+     also the initial limit
+
+     \param latencyThreshold how many times the baseline latency an
+     operation's latency must be before the device is considered congested
+   */
+  AIMDController(
+    uint64_t minimumLimit, uint64_t maximumLimit, double latencyThreshold);
+
+  /// \return the number of operations that should be outstanding at once
+  uint64_t getLimit() const;
+
+  /**
+     Update the limit based on the latency of a completed operation.
+
+     \param latency the operation's latency in microseconds
+
+     \param size the number of bytes the operation transferred
+   */
+  void recordLatency(uint64_t latency, uint64_t size);
+
+private:
+  // The baseline rises by this fraction of the difference between it and
+  // each sample that's above it
+  static const double BASELINE_DRIFT;
+
+  const uint64_t minimumLimit;
+  const uint64_t maximumLimit;
+  const double latencyThreshold;
+
+  uint64_t limit;
+  double baselineLatency;
+  uint64_t fullOperationSize;
+
+  uint64_t uncongestedCompletions;
+  uint64_t completionsSinceDecrease;
+};
+
+#endif // THEMIS_AIMD_CONTROLLER_H
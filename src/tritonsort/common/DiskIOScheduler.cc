@@ -0,0 +1,67 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/DiskIOScheduler.h"
+#include "core/File.h"
+#include "core/ScopedLock.h"
+#include "core/Timer.h"
+#include "core/TritonSortAssert.h"
+
+DiskIOScheduler::DiskIOScheduler(uint64_t _burstLength, double readShare)
+  : burstLength(_burstLength),
+    readBurstLength(static_cast<uint64_t>(_burstLength * readShare)) {
+  ABORT_IF(burstLength == 0, "Burst length must be positive");
+  ABORT_IF(readShare <= 0.0 || readShare >= 1.0,
+           "Read share must be strictly between 0 and 1, but got %f",
+           readShare);
+
+  pthread_mutex_init(&lock, NULL);
+}
+
+DiskIOScheduler::~DiskIOScheduler() {
+  pthread_mutex_destroy(&lock);
+}
+
+uint64_t DiskIOScheduler::waitForTurn(const File& file, IOType type) {
+  struct stat fileStat;
+  ABORT_IF(fstat(file.getFileDescriptor(), &fileStat) != 0,
+           "fstat() of %s failed with error %d: %s",
+           file.getFilename().c_str(), errno, strerror(errno));
+  uint64_t deviceID = fileStat.st_dev;
+
+  uint64_t waitTime = 0;
+  uint64_t delay = getDelay(deviceID, type, Timer::posixTimeInMicros());
+  while (delay > 0) {
+    usleep(delay);
+    waitTime += delay;
+
+    // Check again in case the other type of I/O stopped in the meantime.
+    delay = getDelay(deviceID, type, Timer::posixTimeInMicros());
+  }
+
+  return waitTime;
+}
+
+uint64_t DiskIOScheduler::getDelay(
+  uint64_t deviceID, IOType type, uint64_t currentTime) {
+  ScopedLock scopedLock(&lock);
+
+  DeviceState& state = devices[deviceID];
+  state.lastRequestTime[type] = currentTime;
+
+  uint64_t otherRequestTime = state.lastRequestTime[1 - type];
+  if (otherRequestTime == 0 ||
+      otherRequestTime + burstLength < currentTime) {
+    // The device isn't contended, so don't hold this request back.
+    return 0;
+  }
+
+  uint64_t position = currentTime % burstLength;
+  if (type == READ) {
+    return position < readBurstLength ? 0 : burstLength - position;
+  } else {
+    return position >= readBurstLength ? 0 : readBurstLength - position;
+  }
+}
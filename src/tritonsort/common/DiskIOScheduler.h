@@ -0,0 +1,100 @@
+#ifndef THEMIS_DISK_IO_SCHEDULER_H
+#define THEMIS_DISK_IO_SCHEDULER_H
+
+#include <map>
+#include <pthread.h>
+#include <stdint.h>
+
+class File;
+
+/**
+   A scheduler shared by the readers and writers of a phase that keeps reads
+   and writes to the same physical device from interleaving at a fine
+   granularity, which turns two sequential streams into a seek-bound one.
+
+   Time is divided into cycles of burstLength microseconds. The first
+   readShare of each cycle is a read burst and the rest is a write burst.
+   Before starting a buffer's worth of I/O to a file, a worker calls
+   waitForTurn(), which returns right away if the file's device is in a burst
+   of the right type and otherwise sleeps until the next such burst begins.
+   The reads or writes for a buffer that was admitted during a burst are
+   issued without consulting the scheduler again, so each burst can run over
+   into the next by at most one buffer per outstanding I/O.
+
+   Bursts are only enforced while a device is contended. If there hasn't been
+   a request of the other type for a device within the last cycle, requests
+   are admitted immediately, so a device that only one kind of worker is using
+   runs at full speed.
+
+   Devices are identified by the device ID of the filesystem containing each
+   file, so readers and writers that use different directories on the same
+   disk are scheduled together.
+ */
+class DiskIOScheduler {
+public:
+  enum IOType {
+    READ = 0,
+    WRITE = 1
+  };
+
+  /// Constructor
+  /**
+     \param burstLength the length of a read burst followed by a write burst
+     in microseconds
+
+     \param readShare the fraction of each cycle devoted to reads
+   */
+  DiskIOScheduler(uint64_t burstLength, double readShare);
+
+  /// Destructor
+  virtual ~DiskIOScheduler();
+
+  /**
+     Block until I/O of the given type may start on the device containing a
+     file.
+
+     \param file the file about to be read or written
+
+     \param type whether the I/O is a read or a write
+
+     \return the time spent waiting in microseconds
+   */
+  uint64_t waitForTurn(const File& file, IOType type);
+
+  /**
+     Record a request for I/O on a device and determine how long it must wait
+     before it may start.
+
+     \param deviceID the ID of the device
+
+     \param type whether the I/O is a read or a write
+
+     \param currentTime the time of the request in microseconds
+
+     \return the number of microseconds until the request may start, or 0 if
+     it may start now
+   */
+  uint64_t getDelay(uint64_t deviceID, IOType type, uint64_t currentTime);
+
+private:
+  struct DeviceState {
+    // The most recent request time for each type of I/O, or 0 if there
+    // hasn't been one
+    uint64_t lastRequestTime[2];
+
+    DeviceState() {
+      lastRequestTime[READ] = 0;
+      lastRequestTime[WRITE] = 0;
+    }
+  };
+
+  typedef std::map<uint64_t, DeviceState> DeviceStateMap;
+
+  const uint64_t burstLength;
+  const uint64_t readBurstLength;
+
+  pthread_mutex_t lock;
+  DeviceStateMap devices;
+};
+
+#endif // THEMIS_DISK_IO_SCHEDULER_H
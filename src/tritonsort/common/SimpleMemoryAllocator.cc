@@ -2,6 +2,33 @@
 #include "core/BaseWorker.h"
 #include "core/MemoryAllocationContext.h"
 #include "core/MemoryUtils.h"
+#include "core/ResourceMonitor.h"
+
+uint64_t SimpleMemoryAllocator::nextInstanceID = 0;
+
+SimpleMemoryAllocator::SimpleMemoryAllocator()
+  : trackUsage(ResourceMonitor::isStreaming()),
+    allocatedBytes(0),
+    numAllocations(0) {
+  if (!trackUsage) {
+    return;
+  }
+
+  uint64_t instanceID = __sync_fetch_and_add(&nextInstanceID, 1);
+  ResourceMonitor::registerCounter(
+    &allocatedBytes, "simple_memory_allocator.%llu.allocated_bytes",
+    instanceID);
+  ResourceMonitor::registerCounter(
+    &numAllocations, "simple_memory_allocator.%llu.num_allocations",
+    instanceID);
+}
+
+SimpleMemoryAllocator::~SimpleMemoryAllocator() {
+  if (trackUsage) {
+    ResourceMonitor::unregisterCounter(&allocatedBytes);
+    ResourceMonitor::unregisterCounter(&numAllocations);
+  }
+}
 
 uint64_t SimpleMemoryAllocator::registerCaller(BaseWorker& caller) {
   /// \todo(AR) This is a kludge designed to avoid concurrent access to a
@@ -36,7 +63,21 @@ void* SimpleMemoryAllocator::allocate(const MemoryAllocationContext& context,
     size = std::max<uint64_t>(*iter, size);
   }
 
-  uint8_t* memoryRegion = new (themis::memcheck) uint8_t[size];
+  uint8_t* memoryRegion = NULL;
+
+  if (trackUsage) {
+    // Remember the region's size in front of it so deallocate() can update
+    // the counters.
+    memoryRegion =
+      new (themis::memcheck) uint8_t[size + SIZE_HEADER_BYTES];
+    *reinterpret_cast<uint64_t*>(memoryRegion) = size;
+    memoryRegion += SIZE_HEADER_BYTES;
+
+    __sync_fetch_and_add(&allocatedBytes, size);
+    __sync_fetch_and_add(&numAllocations, 1);
+  } else {
+    memoryRegion = new (themis::memcheck) uint8_t[size];
+  }
 
   caller->stopMemoryAllocationTimer();
   return memoryRegion;
@@ -44,5 +85,14 @@ void* SimpleMemoryAllocator::allocate(const MemoryAllocationContext& context,
 
 void SimpleMemoryAllocator::deallocate(void* memory) {
   uint8_t* castedMemory = static_cast<uint8_t*>(memory);
+
+  if (trackUsage) {
+    castedMemory -= SIZE_HEADER_BYTES;
+    uint64_t size = *reinterpret_cast<uint64_t*>(castedMemory);
+
+    __sync_fetch_and_sub(&allocatedBytes, size);
+    __sync_fetch_and_sub(&numAllocations, 1);
+  }
+
   delete[] castedMemory;
 }
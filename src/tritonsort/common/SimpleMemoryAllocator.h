@@ -7,9 +7,21 @@
    This memory allocator is "simple" in that it does no scheduling, provides no
    memory bound checking, and picks the largest allocation size when given
    a choice between sizes.
+
+   If the resource monitor is streaming counters when the allocator is
+   constructed, the number of bytes and regions it has outstanding are
+   streamed. To track them without a lock, each region is preceded by a small
+   header recording its size, and the counters are updated atomically.
+   Otherwise regions have no header and no counters are maintained.
  */
 class SimpleMemoryAllocator : public MemoryAllocatorInterface {
 public:
+  /// Constructor
+  SimpleMemoryAllocator();
+
+  /// Destructor
+  virtual ~SimpleMemoryAllocator();
+
   /**
      This method is a no-op, since we don't care about caller IDs for an
      allocator this simple.
@@ -44,6 +56,20 @@ public:
      \sa MemoryAllocatorInterface::deallocate
    */
   void deallocate(void* memory);
+
+private:
+  /// The size of the header preceding each region when tracking usage; 16
+  /// bytes keeps regions as aligned as new[] makes them
+  static const uint64_t SIZE_HEADER_BYTES = 16;
+
+  // Distinguishes the streamed counters of allocators that exist at the same
+  // time
+  static uint64_t nextInstanceID;
+
+  const bool trackUsage;
+
+  uint64_t allocatedBytes;
+  uint64_t numAllocations;
 };
 
 #endif // THEMIS_SIMPLE_MEMORY_ALLOCATOR_H
@@ -27,7 +27,7 @@ public:
   /**
      \param _diskID the ID of the disk to which this token belongs
    */
-  WriteToken(uint64_t _diskID) : diskID(_diskID) {}
+  WriteToken(uint64_t _diskID) : diskID(_diskID), checkoutTime(0) {}
 
   /**
      \return the ID of the disk to which this token belongs
@@ -36,6 +36,22 @@ public:
     return diskID;
   }
 
+  /**
+     \return the time, in microseconds since the epoch, at which this token
+     was last taken from its pool
+   */
+  uint64_t getCheckoutTime() const {
+    return checkoutTime;
+  }
+
+  /**
+     \param checkoutTime the time, in microseconds since the epoch, at which
+     this token was taken from its pool
+   */
+  void setCheckoutTime(uint64_t checkoutTime) {
+    this->checkoutTime = checkoutTime;
+  }
+
   /// \sa Resource::getCurrentSize
   uint64_t getCurrentSize() const {
     return 0;
@@ -43,6 +59,7 @@ public:
 
 private:
   const uint64_t diskID;
+  uint64_t checkoutTime;
 };
 
 #endif // TRITONSORT_WRITE_TOKEN_H
@@ -1,23 +1,37 @@
 #include <sstream>
-#include <unistd.h>
 
 #include "common/WriteToken.h"
 #include "common/WriteTokenPool.h"
 #include "core/MemoryUtils.h"
 #include "core/ResourceMonitor.h"
-#include "core/ThreadSafeQueue.h"
+#include "core/ScopedLock.h"
+#include "core/StatLogger.h"
+#include "core/Timer.h"
 #include "core/TritonSortAssert.h"
 
+const double WriteTokenPool::WRITE_LATENCY_SMOOTHING = 0.25;
+
 WriteTokenPool::WriteTokenPool(uint64_t _tokensPerDisk, uint64_t _numDisks)
   : tokensPerDisk(_tokensPerDisk),
-    numDisks(_numDisks) {
+    numDisks(_numDisks),
+    nextDiskID(0) {
+
+  pthread_mutex_init(&lock, NULL);
+  pthread_cond_init(&tokenReturned, NULL);
 
-  tokenQueues = new ThreadSafeQueue<WriteToken*>[numDisks];
+  availableTokens.resize(numDisks);
+  writeLatencies.resize(numDisks, 0.0);
 
   for (uint64_t diskNumber = 0; diskNumber < numDisks; diskNumber++) {
     for (uint64_t tokenCount = 0; tokenCount < tokensPerDisk; tokenCount++) {
-      tokenQueues[diskNumber].push(new WriteToken(diskNumber));
+      availableTokens[diskNumber].push_back(new WriteToken(diskNumber));
     }
+
+    StatLogger* diskLogger = new StatLogger("write_token_pool", diskNumber);
+    // Every logger registers the same stats, so they share stat IDs.
+    waitTimeStatID = diskLogger->registerSummaryStat("wait_time");
+    holdTimeStatID = diskLogger->registerSummaryStat("hold_time");
+    diskLoggers.push_back(diskLogger);
   }
 
   ResourceMonitor::registerClient(this, "write_token_pool");
@@ -26,47 +40,59 @@ WriteTokenPool::WriteTokenPool(uint64_t _tokensPerDisk, uint64_t _numDisks)
 WriteTokenPool::~WriteTokenPool() {
   ResourceMonitor::unregisterClient(this);
 
-  if (tokenQueues != NULL) {
-    for (uint64_t diskNumber = 0; diskNumber < numDisks; diskNumber++) {
-      ThreadSafeQueue<WriteToken*>& currentQueue = tokenQueues[diskNumber];
-
-      uint64_t tokensPopped = 0;
+  for (uint64_t diskNumber = 0; diskNumber < numDisks; diskNumber++) {
+    TokenVector& tokens = availableTokens[diskNumber];
 
-      while (!currentQueue.empty()) {
-        tokensPopped++;
-        WriteToken* token = currentQueue.blockingPop();
-        delete token;
-      }
+    uint64_t tokensPopped = tokens.size();
 
-      ABORT_IF(tokensPopped != tokensPerDisk, "Not all tokens were returned "
-               "to disk %llu in this token pool (%llu token(s) missing)",
-               diskNumber, tokensPerDisk - tokensPopped);
+    for (TokenVector::iterator iter = tokens.begin(); iter != tokens.end();
+         iter++) {
+      delete *iter;
     }
+    tokens.clear();
+
+    ABORT_IF(tokensPopped != tokensPerDisk, "Not all tokens were returned "
+             "to disk %llu in this token pool (%llu token(s) missing)",
+             diskNumber, tokensPerDisk - tokensPopped);
 
-    delete[] tokenQueues;
-    tokenQueues = NULL;
+    delete diskLoggers[diskNumber];
   }
+  diskLoggers.clear();
+
+  pthread_mutex_destroy(&lock);
+  pthread_cond_destroy(&tokenReturned);
 }
 
 void WriteTokenPool::resourceMonitorOutput(Json::Value& obj) {
+  ScopedLock scopedLock(&lock);
+
   for (uint64_t diskNumber = 0; diskNumber < numDisks; diskNumber++) {
     std::ostringstream oss;
     oss << "tokens_in_pool_" << diskNumber;
-    obj[oss.str()] = Json::UInt64(tokenQueues[diskNumber].size());
+    obj[oss.str()] = Json::UInt64(availableTokens[diskNumber].size());
   }
 }
 
 
 WriteToken* WriteTokenPool::getToken(const std::set<uint64_t>& diskIDSet) {
-  WriteToken* token = NULL;
+  ScopedLock scopedLock(&lock);
+
+  WriteToken* token = popLeastLoadedToken(diskIDSet);
 
-  do {
-    token = attemptGetToken(diskIDSet);
+  if (token == NULL) {
+    Timer waitTimer;
+    waitTimer.start();
 
-    if (token == NULL) {
-      usleep(100);
+    // Tokens are only ever returned by putToken(), which wakes every waiter,
+    // so sleep until one of them is for a disk we want.
+    while (token == NULL) {
+      pthread_cond_wait(&tokenReturned, &lock);
+      token = popLeastLoadedToken(diskIDSet);
     }
-  } while (token == NULL);
+
+    waitTimer.stop();
+    diskLoggers[token->getDiskID()]->add(waitTimeStatID, waitTimer);
+  }
 
   return token;
 }
@@ -74,22 +100,99 @@ WriteToken* WriteTokenPool::getToken(const std::set<uint64_t>& diskIDSet) {
 WriteToken* WriteTokenPool::attemptGetToken(
   const std::set<uint64_t>& diskIDSet) {
 
-  bool successfulPop = false;
-  WriteToken* token = NULL;
+  ScopedLock scopedLock(&lock);
+  return popLeastLoadedToken(diskIDSet);
+}
+
+void WriteTokenPool::putToken(WriteToken* token) {
+  uint64_t diskID = token->getDiskID();
+
+  ScopedLock scopedLock(&lock);
+  availableTokens[diskID].push_back(token);
+
+  // Waiters may each want tokens for different disks, so wake all of them.
+  pthread_cond_broadcast(&tokenReturned);
+}
+
+void WriteTokenPool::putToken(WriteToken* token, uint64_t bytesWritten) {
+  uint64_t diskID = token->getDiskID();
+  uint64_t holdTime = Timer::posixTimeInMicros() - token->getCheckoutTime();
+
+  ScopedLock scopedLock(&lock);
+  diskLoggers[diskID]->add(holdTimeStatID, holdTime);
+
+  if (bytesWritten > 0) {
+    double latency = static_cast<double>(holdTime) / bytesWritten;
+    double& averageLatency = writeLatencies[diskID];
+
+    if (averageLatency == 0.0) {
+      averageLatency = latency;
+    } else {
+      averageLatency = (WRITE_LATENCY_SMOOTHING * latency) +
+        ((1.0 - WRITE_LATENCY_SMOOTHING) * averageLatency);
+    }
+  }
+
+  availableTokens[diskID].push_back(token);
+  pthread_cond_broadcast(&tokenReturned);
+}
+
+uint64_t WriteTokenPool::getNumOutstandingTokens(uint64_t diskID) {
+  TRITONSORT_ASSERT(diskID < numDisks, "Disk ID out of bounds (%llu [received] > "
+         "%llu [numDisks])", diskID, numDisks);
+
+  ScopedLock scopedLock(&lock);
+  return tokensPerDisk - availableTokens[diskID].size();
+}
+
+double WriteTokenPool::getWriteLatency(uint64_t diskID) {
+  TRITONSORT_ASSERT(diskID < numDisks, "Disk ID out of bounds (%llu [received] > "
+         "%llu [numDisks])", diskID, numDisks);
+
+  ScopedLock scopedLock(&lock);
+  return writeLatencies[diskID];
+}
+
+WriteToken* WriteTokenPool::popLeastLoadedToken(
+  const std::set<uint64_t>& diskIDSet) {
+
+  if (diskIDSet.empty()) {
+    return NULL;
+  }
+
+  // Visit the requested disks in round-robin order starting from nextDiskID,
+  // so that the first disk visited wins ties.
+  std::set<uint64_t>::const_iterator iter = diskIDSet.lower_bound(nextDiskID);
+
+  uint64_t leastLoadedDiskID = numDisks;
+  uint64_t mostAvailableTokens = 0;
+
+  for (uint64_t i = 0; i < diskIDSet.size(); i++, iter++) {
+    if (iter == diskIDSet.end()) {
+      iter = diskIDSet.begin();
+    }
 
-  for (std::set<uint64_t>::iterator iter = diskIDSet.begin();
-       !successfulPop && iter != diskIDSet.end(); iter++) {
     uint64_t diskID = *iter;
     TRITONSORT_ASSERT(diskID < numDisks, "Disk ID out of bounds (%llu [received] > "
            "%llu [numDisks])", diskID, numDisks);
-    successfulPop = tokenQueues[diskID].pop(token);
+
+    uint64_t numAvailableTokens = availableTokens[diskID].size();
+    if (numAvailableTokens > mostAvailableTokens) {
+      leastLoadedDiskID = diskID;
+      mostAvailableTokens = numAvailableTokens;
+    }
   }
 
-  return token;
-}
+  if (mostAvailableTokens == 0) {
+    return NULL;
+  }
 
-void WriteTokenPool::putToken(WriteToken* token) {
-  uint64_t diskID = token->getDiskID();
+  nextDiskID = (leastLoadedDiskID + 1) % numDisks;
+
+  TokenVector& tokens = availableTokens[leastLoadedDiskID];
+  WriteToken* token = tokens.back();
+  tokens.pop_back();
+  token->setCheckoutTime(Timer::posixTimeInMicros());
 
-  tokenQueues[diskID].push(token);
+  return token;
 }
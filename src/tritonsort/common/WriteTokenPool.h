@@ -1,17 +1,36 @@
 #ifndef THEMIS_WRITE_TOKEN_POOL_H
 #define THEMIS_WRITE_TOKEN_POOL_H
 
-#include <stdint.h>
+#include <pthread.h>
 #include <set>
+#include <stdint.h>
+#include <vector>
 
 #include "core/ResourceMonitorClient.h"
 
+class StatLogger;
 class WriteToken;
-template <typename T> class ThreadSafeQueue;
 
 /**
    A shared pool of write tokens. Chainers must acquire a write token for the
    appropriate disk before sending data to its downstream writer.
+
+   When a caller is willing to take a token for any of several disks, the pool
+   hands out a token for the requested disk with the fewest tokens
+   outstanding, breaking ties in round-robin order so that no disk is
+   systematically favored. Callers that block in getToken() sleep until a
+   token is returned rather than polling.
+
+   The time each blocking getToken() call spends waiting is logged as the
+   wait_time statistic of the disk whose token it eventually received.
+
+   Writers that return tokens with putToken(token, bytesWritten) also give the
+   pool feedback about how quickly each disk is completing writes. The pool
+   keeps an exponentially weighted moving average of the time each such token
+   was held per byte written, which covers both the time the write spent
+   queued behind other writes to the disk and the write itself. Along with the
+   number of tokens outstanding for each disk, this lets callers tell slow or
+   backed-up disks from fast or idle ones.
  */
 class WriteTokenPool : public ResourceMonitorClient {
 public:
@@ -59,15 +78,75 @@ public:
    */
   void putToken(WriteToken* token);
 
+  /// Return a token to the pool after using it to write some data
+  /**
+     The time that the token was held is used to update its disk's write
+     latency.
+
+     \param token the token to return to the pool
+
+     \param bytesWritten the number of bytes written to the token's disk while
+     the token was held
+   */
+  void putToken(WriteToken* token, uint64_t bytesWritten);
+
+  /**
+     \param diskID the disk to query
+
+     \return the number of the disk's tokens that haven't been returned
+   */
+  uint64_t getNumOutstandingTokens(uint64_t diskID);
+
+  /**
+     \param diskID the disk to query
+
+     \return a moving average of the time, in microseconds per byte, that the
+     disk's tokens have been held for writes, or 0 if no writes to the disk
+     have completed yet
+   */
+  double getWriteLatency(uint64_t diskID);
+
 private:
+  typedef std::vector<WriteToken*> TokenVector;
+  typedef std::vector<TokenVector> TokenVectorVector;
+  typedef std::vector<StatLogger*> StatLoggerVector;
+
+  // The weight given to each new sample of a disk's write latency
+  static const double WRITE_LATENCY_SMOOTHING;
+
+  /// Take a token for the least loaded disk in a set of disks
+  /**
+     Must be called with the pool's lock held.
+
+     \param diskIDSet a set of disk IDs for which the caller is willing to
+     receive a token
+
+     \return a token for one of the disk IDs in diskIDSet, or NULL if no
+     token is available for any disk ID in diskIDSet
+   */
+  WriteToken* popLeastLoadedToken(const std::set<uint64_t>& diskIDSet);
+
   const uint64_t tokensPerDisk;
   const uint64_t numDisks;
 
-  // One thread-safe queue of tokens per writer. Opted to use an array here
-  // rather than a std::vector because I don't think STL vectors are guaranteed
-  // thread-safe and I wanted concurrent access to different token queues to
-  // work properly without unnecessary blocking.
-  ThreadSafeQueue<WriteToken*>* tokenQueues;
+  // The tokens currently available for each disk. Every disk has the same
+  // number of tokens, so the disk with the most available tokens is the one
+  // with the fewest outstanding.
+  TokenVectorVector availableTokens;
+
+  // The moving average write latency of each disk in microseconds per byte
+  std::vector<double> writeLatencies;
+
+  // The disk at which to start looking for the least loaded disk, so that
+  // ties are broken in round-robin order.
+  uint64_t nextDiskID;
+
+  StatLoggerVector diskLoggers;
+  uint64_t waitTimeStatID;
+  uint64_t holdTimeStatID;
+
+  pthread_mutex_t lock;
+  pthread_cond_t tokenReturned;
 };
 
 #endif // THEMIS_WRITE_TOKEN_POOL_H
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "core/FixedSizeResource.h"
+#include "core/Traceable.h"
 #include "core/TritonSortAssert.h"
 
 class MemoryAllocatorInterface;
@@ -15,7 +16,7 @@ class WriteToken;
    for all buffers. It is deliberately designed to be minimal; any
    additional functionality should be implemented in subclasses.
  */
-class BaseBuffer : public FixedSizeResource {
+class BaseBuffer : public FixedSizeResource, public Traceable {
 public:
   /// Constructor
   /**
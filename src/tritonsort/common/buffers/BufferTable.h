@@ -2,6 +2,7 @@
 #define THEMIS_BUFFER_TABLE_H
 
 #include <set>
+#include <vector>
 
 #include "common/buffers/BufferList.h"
 #include "core/StatusPrinter.h"
@@ -242,6 +243,30 @@ public:
     }
   }
 
+  /// Get a set of physical disks whose lists have some minimum amount of bytes
+  /// in them, where the minimum can be different for each disk
+  /**
+     \param minimumSizes the least number of bytes a list must have in it to
+     be considered as a candidate list for each of the table's physical disks,
+     starting with the table's lowest-numbered disk
+
+     \param[out] diskSet a set that will be populated with physical disk IDs of
+     all disks that have at least one list above their minimum size threshold
+   */
+  void getPhysicalDisksWithListsAboveMinimumSize(
+    const std::vector<uint64_t>& minimumSizes, std::set<uint64_t>& diskSet) {
+    TRITONSORT_ASSERT(minimumSizes.size() == numPhysicalDisks, "Expected a "
+                      "minimum size for each of the table's %llu disks, but "
+                      "got %llu", numPhysicalDisks, minimumSizes.size());
+
+    for (uint64_t i = 0; i < numPhysicalDisks; i++) {
+      BufferList<T>* currList = largestLists[i];
+      if (currList != NULL && currList->getTotalDataSize() >= minimumSizes[i]) {
+        diskSet.insert(basePhysicalDiskID + i);
+      }
+    }
+  }
+
 private:
   // The lowest-numbered physical disk that this table supports; used to split
   // buffer tables among groups of physical disks.
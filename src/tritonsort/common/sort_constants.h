@@ -5,7 +5,8 @@ enum SortAlgorithm {
   UNDEFINED,
   RADIX_SORT_AP,
   RADIX_SORT_MAPREDUCE,
-  QUICK_SORT
+  QUICK_SORT,
+  IN_PLACE_SORT
 };
 
 #endif //TRITONSORT_SORT_CONSTANTS_H
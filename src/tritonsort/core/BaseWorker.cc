@@ -2,10 +2,15 @@
 #include <stdexcept>
 
 #include "core/BaseWorker.h"
+#include "core/BufferTracer.h"
 #include "core/IntervalStatLogger.h"
+#include "core/PerfCounters.h"
 #include "core/Resource.h"
 #include "core/ResourceMonitor.h"
 #include "core/ScopedLock.h"
+#include "core/StatWriter.h"
+
+bool BaseWorker::warnedPerfCountersUnavailable = false;
 
 BaseWorker::BaseWorker(uint64_t _id, const std::string& _name)
     : themis::Thread(static_cast<std::ostringstream&>(
@@ -17,9 +22,15 @@ BaseWorker::BaseWorker(uint64_t _id, const std::string& _name)
     name(_name),
     idle(false),
     logger(name, id),
+    statPhaseName(StatWriter::getThreadPhaseName()),
     workUnitsProduced(0),
     bytesProduced(0),
-    pipelineSaturated(false) {
+    pipelineSaturated(false),
+    traceStageID(0),
+    monitorCounterPrefix(static_cast<std::ostringstream&>(
+             std::ostringstream().flush() << _name << '.' << _id).str()),
+    perfCountersEnabled(false),
+    perfCounters(NULL) {
   // TODO: thresholds should be user-configurable somehow
   runTimeStatID = logger.registerSummaryStat("runtime");
   waitTimeStatID = logger.registerSummaryStat("wait");
@@ -37,6 +48,11 @@ BaseWorker::~BaseWorker() {
   logger.logDatum("work_units_consumed", workUnitsConsumed);
   logger.logDatum("bytes_produced", bytesProduced);
   logger.logDatum("bytes_consumed", bytesConsumed);
+
+  if (perfCounters != NULL) {
+    delete perfCounters;
+    perfCounters = NULL;
+  }
 }
 
 StatLogger* BaseWorker::initIntervalStatLogger() {
@@ -72,6 +88,12 @@ void BaseWorker::resourceMonitorOutput(Json::Value& obj) {
   obj["work_units_consumed"] = Json::UInt64(workUnitsConsumed);
   obj["bytes_produced"] = Json::UInt64(bytesProduced);
   obj["bytes_consumed"] = Json::UInt64(bytesConsumed);
+
+  if (perfCounters != NULL) {
+    Json::Value perfCountersObj(Json::objectValue);
+    perfCounters->addToJson(perfCountersObj, getBytesProcessed());
+    obj["perf_counters"] = perfCountersObj;
+  }
 }
 
 void BaseWorker::spawn() {
@@ -102,6 +124,23 @@ void BaseWorker::setTracker(WorkerTrackerInterface* workerTracker) {
   tracker = workerTracker;
 }
 
+void BaseWorker::setTraceStageID(uint64_t stageID) {
+  traceStageID = stageID;
+}
+
+void BaseWorker::setMonitorCounterPrefix(const std::string& prefix) {
+  monitorCounterPrefix.assign(prefix);
+}
+
+void BaseWorker::enablePerfCounters() {
+  perfCountersEnabled = true;
+}
+
+uint64_t BaseWorker::getBytesProcessed() const {
+  // Source stages don't consume buffers, so measure them by what they produce.
+  return (bytesConsumed > 0) ? bytesConsumed : bytesProduced;
+}
+
 uint64_t BaseWorker::addDownstreamTrackerReturningID(
   WorkerTrackerInterface* downstreamTracker) {
 
@@ -245,6 +284,30 @@ void BaseWorker::resetRuntimeInformation() {
 void BaseWorker::mainLoop(bool testing) {
   bool done = false;
 
+  BufferTracer::setThreadContext(traceStageID, id);
+
+  // Log anything this thread registers under the same phase as the worker's
+  // own logger, which was registered by the thread that constructed it.
+  if (!statPhaseName.empty()) {
+    StatWriter::setThreadPhaseName(statPhaseName);
+  }
+
+  if (perfCountersEnabled) {
+    // Counters measure the thread that opens them, so open them here.
+    perfCounters = new PerfCounters();
+
+    if (!perfCounters->open()) {
+      if (__sync_bool_compare_and_swap(
+            &warnedPerfCountersUnavailable, false, true)) {
+        StatusPrinter::add("Hardware performance counters are unavailable; "
+                           "not counting them");
+      }
+
+      delete perfCounters;
+      perfCounters = NULL;
+    }
+  }
+
   try {
     initTimer.start();
     init();
@@ -258,9 +321,17 @@ void BaseWorker::mainLoop(bool testing) {
   // initialized properly.
   registerWithResourceMonitor();
   IntervalStatLogger::registerClient(this);
+  ResourceMonitor::registerCounter(
+    &bytesConsumed, "%s.bytes_consumed", monitorCounterPrefix.c_str());
+  ResourceMonitor::registerCounter(
+    &bytesProduced, "%s.bytes_produced", monitorCounterPrefix.c_str());
 
   logger.logDatum("init", initTimer);
 
+  if (perfCounters != NULL) {
+    perfCounters->start();
+  }
+
   totalRuntimeTimer.start();
   while (!done) {
     done = processIncomingWorkUnits();
@@ -268,6 +339,11 @@ void BaseWorker::mainLoop(bool testing) {
   totalRuntimeTimer.stop();
   logger.logDatum("worker_runtime", totalRuntimeTimer);
 
+  if (perfCounters != NULL) {
+    perfCounters->stop();
+    perfCounters->logCounters(logger, getBytesProcessed());
+  }
+
   teardownTimer.start();
 
   // Un-register the worker before calling teardown for safety.
@@ -276,6 +352,11 @@ void BaseWorker::mainLoop(bool testing) {
 
   teardown();
   teardownTimer.stop();
+
+  // Keep streaming byte counts through teardown, since some workers emit
+  // their last work units there.
+  ResourceMonitor::unregisterCounter(&bytesConsumed);
+  ResourceMonitor::unregisterCounter(&bytesProduced);
   logger.logDatum("teardown", teardownTimer);
   // Log the actual time this worker stops processing useful work (including
   // teardown), but only if we actually got a work unit.
@@ -287,6 +368,10 @@ void BaseWorker::mainLoop(bool testing) {
     tracker->notifyWorkerCompleted(id);
   }
 
+  if (!statPhaseName.empty()) {
+    StatWriter::clearThreadPhaseName();
+  }
+
   // For the purposes of checking for deadlock, consider this worker as waiting
   // for work, since it cannot make forward progress anymore.
   idle = true;
@@ -311,6 +396,10 @@ void BaseWorker::emitWorkUnit(
 
   bytesProduced += workUnit->getCurrentSize();
 
+  if (BufferTracer::isEnabled()) {
+    BufferTracer::trace(workUnit, BufferTracer::EMIT);
+  }
+
   startEnqueueTimer();
   tracker->addWorkUnit(workUnit);
   stopEnqueueTimer();
@@ -329,6 +418,10 @@ void BaseWorker::emitWorkUnit(Resource* workUnit) {
 void BaseWorker::logConsumed(Resource* workUnit) {
   bytesConsumed += workUnit->getCurrentSize();
   workUnitsConsumed++;
+
+  if (BufferTracer::isEnabled()) {
+    BufferTracer::trace(workUnit, BufferTracer::DEQUEUE);
+  }
 }
 
 void BaseWorker::logConsumed(uint64_t numWorkUnits, uint64_t numBytes) {
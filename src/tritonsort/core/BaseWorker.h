@@ -31,6 +31,7 @@
 #include "core/WorkerTrackerInterface.h"
 #include "core/constants.h"
 
+class PerfCounters;
 class ResourceQueue;
 
 typedef unsigned int uint;
@@ -112,6 +113,34 @@ public:
   */
   virtual void setTracker(WorkerTrackerInterface* workerTracker);
 
+  /// Set the stage ID under which this worker's buffer trace events are
+  /// recorded
+  /**
+     \param stageID the stage's ID from BufferTracer::registerStage()
+   */
+  void setTraceStageID(uint64_t stageID);
+
+  /// Set the prefix of the names under which this worker's counters are
+  /// streamed by the ResourceMonitor
+  /**
+     By default, the prefix is the worker's name and ID, which is only unique
+     within a phase.
+
+     \param prefix the prefix, to which ".bytes_consumed" and
+     ".bytes_produced" are appended
+   */
+  void setMonitorCounterPrefix(const std::string& prefix);
+
+  /// Count hardware events for this worker's thread while it processes work
+  /**
+     Counters are logged when the worker finishes and are included in the
+     worker's ResourceMonitor output. If the machine doesn't support hardware
+     counters, this has no effect.
+
+     \sa PerfCounters
+   */
+  void enablePerfCounters();
+
   /// Add a downstream tracker to this worker's downstream tracker list
   /**
      \param downstreamTracker the tracker to add
@@ -353,6 +382,10 @@ private:
   /// The private logger for the worker's internal statistics
   StatLogger logger;
 
+  /// The phase name that the constructing thread logged under, if it set one
+  /// with StatWriter::setThreadPhaseName
+  const std::string statPhaseName;
+
   /// The number of work units produced by this worker
   uint64_t workUnitsProduced;
 
@@ -371,6 +404,20 @@ private:
 
   // Has the pipeline been saturated yet? Determines how wait times get logged.
   bool pipelineSaturated;
+
+  // The stage ID used when recording buffer trace events
+  uint64_t traceStageID;
+
+  std::string monitorCounterPrefix;
+
+  bool perfCountersEnabled;
+  PerfCounters* perfCounters;
+
+  static bool warnedPerfCountersUnavailable;
+
+  // The number of bytes against which per-byte perf counter values are
+  // normalized
+  uint64_t getBytesProcessed() const;
 }; // BaseWorker
 
 #endif //_TRITONSORT_BASE_WORKER_H
@@ -1,3 +1,5 @@
+#include <unistd.h>
+
 #include "core/BatchRunnable.h"
 
 BatchRunnable::BatchRunnable(
@@ -31,6 +33,15 @@ void BatchRunnable::getNewWork() {
   }
 }
 
+bool BatchRunnable::waitForWork(uint64_t timeoutMicros) {
+  if (maxInternalStateSize != 0 && internalStateSize >= maxInternalStateSize) {
+    usleep(timeoutMicros);
+    return false;
+  }
+
+  return tracker->waitForWork(getID(), timeoutMicros);
+}
+
 void BatchRunnable::startWaitForWorkTimer() {
   // To prevent inaccurate pipeline saturation logging, don't actually log the
   // wait unless we've fetched our first work unit.
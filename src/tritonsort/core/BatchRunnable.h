@@ -63,6 +63,18 @@ public:
 protected:
   void getNewWork();
 
+  /**
+     Block until the tracker has work for this worker, or until a timeout
+     expires. If the worker's internal state is full, getNewWork() won't fetch
+     anything, so this simply sleeps for the timeout instead.
+
+     \param timeoutMicros the maximum amount of time to wait in microseconds
+
+     \return true if the tracker has work for this worker (or will never have
+     any more), false if the wait timed out
+   */
+  bool waitForWork(uint64_t timeoutMicros);
+
   void startWaitForWorkTimer();
 
   void stopWaitForWorkTimer();
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <sstream>
+
+#include "core/BufferTracer.h"
+#include "core/File.h"
+#include "core/Params.h"
+#include "core/Resource.h"
+#include "core/ScopedLock.h"
+#include "core/Timer.h"
+#include "core/Traceable.h"
+#include "core/TritonSortAssert.h"
+#include "core/Utils.h"
+
+bool BufferTracer::enabled = false;
+uint64_t BufferTracer::ringSize = 0;
+std::string BufferTracer::logDirName;
+uint64_t BufferTracer::nextTraceID = 1;
+pthread_mutex_t BufferTracer::lock = PTHREAD_MUTEX_INITIALIZER;
+std::vector<std::string> BufferTracer::stageNames;
+BufferTracer::TraceRingVector BufferTracer::rings;
+uint64_t BufferTracer::generation = 0;
+
+__thread BufferTracer::TraceRing* BufferTracer::threadRing = NULL;
+__thread uint64_t BufferTracer::threadStageID = 0;
+__thread uint64_t BufferTracer::threadWorkerID = 0;
+__thread uint64_t BufferTracer::threadRingGeneration = 0;
+
+void BufferTracer::init(Params& params) {
+  ScopedLock scopedLock(&lock);
+
+  if (!params.contains("BUFFER_TRACE") || !params.get<bool>("BUFFER_TRACE")) {
+    return;
+  }
+
+  ringSize = params.get<uint64_t>("BUFFER_TRACE_RING_SIZE");
+  ABORT_IF(ringSize == 0, "BUFFER_TRACE_RING_SIZE must be positive");
+
+  logDirName.assign(params.get<std::string>("LOG_DIR"));
+
+  // Stage 0 is used for events from threads that aren't workers.
+  stageNames.clear();
+  stageNames.push_back("unknown");
+
+  // Rings from any previous tracing session have been freed, so make sure
+  // threads allocate new ones.
+  generation++;
+
+  enabled = true;
+}
+
+void BufferTracer::teardown() {
+  ScopedLock scopedLock(&lock);
+
+  if (!enabled) {
+    return;
+  }
+
+  enabled = false;
+
+  std::string hostname;
+  getHostname(hostname);
+
+  std::ostringstream oss;
+  oss << logDirName << '/' << hostname << "_buffer_trace.log";
+
+  File traceFile(oss.str());
+  traceFile.open(File::WRITE, true);
+
+  for (uint64_t stageID = 0; stageID < stageNames.size(); stageID++) {
+    oss.str("");
+    oss << "STAGE\t" << stageID << '\t' << stageNames[stageID] << '\n';
+    traceFile.write(oss.str());
+  }
+
+  const char* eventNames[] = { "ENQUEUE", "DEQUEUE", "EMIT", "DESTROY" };
+
+  for (TraceRingVector::iterator iter = rings.begin(); iter != rings.end();
+       iter++) {
+    TraceRing* ring = *iter;
+
+    // If the ring wrapped around, its oldest surviving event is the one that
+    // would have been overwritten next.
+    uint64_t numRetained = std::min<uint64_t>(ring->numEvents, ringSize);
+    uint64_t start = ring->numEvents - numRetained;
+
+    oss.str("");
+    for (uint64_t i = start; i < ring->numEvents; i++) {
+      const TraceEvent& event = ring->events[i % ringSize];
+      oss << "EVENT\t" << event.traceID << '\t'
+          << eventNames[event.eventType] << '\t' << event.stageID << '\t'
+          << event.workerID << '\t' << event.timestamp << '\n';
+    }
+
+    if (start > 0) {
+      oss << "DROPPED\t" << start << '\n';
+    }
+
+    traceFile.write(oss.str());
+
+    delete ring;
+  }
+  rings.clear();
+
+  traceFile.sync();
+  traceFile.close();
+}
+
+uint64_t BufferTracer::newTraceID() {
+  if (!enabled) {
+    return 0;
+  }
+
+  return __sync_fetch_and_add(&nextTraceID, 1);
+}
+
+uint64_t BufferTracer::registerStage(const std::string& stageName) {
+  ScopedLock scopedLock(&lock);
+
+  if (!enabled) {
+    return 0;
+  }
+
+  stageNames.push_back(stageName);
+  return stageNames.size() - 1;
+}
+
+void BufferTracer::setThreadContext(uint64_t stageID, uint64_t workerID) {
+  threadStageID = stageID;
+  threadWorkerID = workerID;
+}
+
+void BufferTracer::trace(Resource* workUnit, EventType eventType) {
+  trace(workUnit, eventType, threadStageID);
+}
+
+void BufferTracer::trace(
+  Resource* workUnit, EventType eventType, uint64_t stageID) {
+
+  if (!enabled) {
+    return;
+  }
+
+  Traceable* traceable = dynamic_cast<Traceable*>(workUnit);
+
+  if (traceable != NULL && traceable->getTraceID() != 0) {
+    record(traceable->getTraceID(), eventType, stageID, threadWorkerID);
+  }
+}
+
+void BufferTracer::trace(uint64_t traceID, EventType eventType) {
+  if (!enabled) {
+    return;
+  }
+
+  record(traceID, eventType, threadStageID, threadWorkerID);
+}
+
+void BufferTracer::record(
+  uint64_t traceID, EventType eventType, uint64_t stageID,
+  uint64_t workerID) {
+
+  TraceRing* ring = getThreadRing();
+
+  TraceEvent& event = ring->events[ring->numEvents % ringSize];
+  event.traceID = traceID;
+  event.timestamp = Timer::posixTimeInMicros();
+  event.stageID = stageID;
+  event.workerID = workerID;
+  event.eventType = eventType;
+
+  ring->numEvents++;
+}
+
+BufferTracer::TraceRing* BufferTracer::getThreadRing() {
+  if (threadRing == NULL || threadRingGeneration != generation) {
+    // This is the first event on this thread, so give it a ring. Rings are
+    // owned by the tracer so they outlive their threads.
+    threadRing = new TraceRing();
+    threadRing->events.resize(ringSize);
+    threadRing->numEvents = 0;
+    threadRingGeneration = generation;
+
+    ScopedLock scopedLock(&lock);
+    rings.push_back(threadRing);
+  }
+
+  return threadRing;
+}
@@ -0,0 +1,158 @@
+#ifndef THEMIS_BUFFER_TRACER_H
+#define THEMIS_BUFFER_TRACER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class Params;
+class Resource;
+
+/**
+   BufferTracer records the lifecycle of individual buffers as they move
+   through the pipeline, so that the time a buffer spends waiting in each
+   stage's work queue can be separated from the time it spends being processed.
+
+   Tracing is opt-in and is enabled by setting BUFFER_TRACE to true. When it
+   is enabled, every Traceable work unit is given a unique trace ID, and the
+   following events are recorded against that ID:
+
+   - ENQUEUE: the work unit was added to a stage's work queue
+   - DEQUEUE: a worker took the work unit from its stage's work queue
+   - EMIT: a worker emitted the work unit to a downstream stage
+   - DESTROY: the work unit was destroyed
+
+   Events are recorded into a fixed-size ring per thread, so recording never
+   takes a lock. If a ring fills up, its oldest events are overwritten. Each
+   ring holds BUFFER_TRACE_RING_SIZE events.
+
+   When the tracer is torn down, every ring is written to
+   LOG_DIR/<hostname>_buffer_trace.log. The buffer_trace metaprogram turns
+   these logs into per-stage queueing and service time histograms and a
+   Chrome trace-event file.
+ */
+class BufferTracer {
+public:
+  /// The kinds of events that can be traced
+  enum EventType {
+    ENQUEUE,
+    DEQUEUE,
+    EMIT,
+    DESTROY
+  };
+
+  /**
+     Initialize the tracer. Tracing is only enabled if BUFFER_TRACE is true.
+
+     \param params the global params object
+   */
+  static void init(Params& params);
+
+  /// Write all recorded events to the trace log and disable tracing.
+  /**
+     \warning Must only be called after every thread that records events has
+     finished.
+   */
+  static void teardown();
+
+  /// \return true if tracing is enabled
+  static inline bool isEnabled() {
+    return enabled;
+  }
+
+  /// \return a new unique trace ID, or 0 if tracing is disabled
+  static uint64_t newTraceID();
+
+  /**
+     Register a stage with the tracer so its events can be told apart from
+     other stages' events.
+
+     \param stageName a name for the stage that is unique across phases, e.g.
+     "phase_one.demux"
+
+     \return an ID for the stage, or 0 if tracing is disabled
+   */
+  static uint64_t registerStage(const std::string& stageName);
+
+  /**
+     Associate the calling thread with a worker. Events recorded by this
+     thread without an explicit stage are attributed to this worker.
+
+     \param stageID the ID of the worker's stage, from registerStage()
+
+     \param workerID the ID of the worker within its stage
+   */
+  static void setThreadContext(uint64_t stageID, uint64_t workerID);
+
+  /**
+     Record an event for a work unit on behalf of the calling thread's worker.
+     Work units that aren't Traceable are ignored.
+
+     \param workUnit the work unit
+
+     \param eventType the kind of event
+   */
+  static void trace(Resource* workUnit, EventType eventType);
+
+  /**
+     Record an event for a work unit on behalf of a particular stage. Work
+     units that aren't Traceable are ignored.
+
+     \param workUnit the work unit
+
+     \param eventType the kind of event
+
+     \param stageID the ID of the stage, from registerStage()
+   */
+  static void trace(Resource* workUnit, EventType eventType, uint64_t stageID);
+
+  /**
+     Record an event for a trace ID on behalf of the calling thread's worker.
+
+     \param traceID the trace ID of the work unit
+
+     \param eventType the kind of event
+   */
+  static void trace(uint64_t traceID, EventType eventType);
+
+private:
+  struct TraceEvent {
+    uint64_t traceID;
+    uint64_t timestamp;
+    uint32_t stageID;
+    uint16_t workerID;
+    uint16_t eventType;
+  };
+
+  struct TraceRing {
+    std::vector<TraceEvent> events;
+    uint64_t numEvents;
+  };
+
+  typedef std::vector<TraceRing*> TraceRingVector;
+
+  static void record(
+    uint64_t traceID, EventType eventType, uint64_t stageID,
+    uint64_t workerID);
+
+  static TraceRing* getThreadRing();
+
+  static bool enabled;
+  static uint64_t ringSize;
+  static std::string logDirName;
+
+  static uint64_t nextTraceID;
+
+  static pthread_mutex_t lock;
+  static std::vector<std::string> stageNames;
+  static TraceRingVector rings;
+  static uint64_t generation;
+
+  static __thread TraceRing* threadRing;
+  static __thread uint64_t threadStageID;
+  static __thread uint64_t threadWorkerID;
+  static __thread uint64_t threadRingGeneration;
+};
+
+#endif // THEMIS_BUFFER_TRACER_H
@@ -5,8 +5,10 @@
 #include "core/LoggableUInt64Datum.h"
 #include "core/Timer.h"
 
-LogDataContainer::LogDataContainer(const LogLineDescriptor& parentDescriptor)
-  : baseLogLineDescriptor(parentDescriptor) {
+LogDataContainer::LogDataContainer(
+  const LogLineDescriptor& parentDescriptor, uint64_t _parentLoggerID)
+  : baseLogLineDescriptor(parentDescriptor),
+    parentLoggerID(_parentLoggerID) {
 
   baseLogLineDescriptor.setLogLineTypeName("DATM");
 }
@@ -53,7 +55,7 @@ void LogDataContainer::add(const std::string& statName,
   }
 }
 
-void LogDataContainer::write(int fileDescriptor, const std::string& phaseName,
+void LogDataContainer::write(StatLogFile& file, const std::string& phaseName,
                              uint64_t epoch) {
   for (LoggableDatumMapIter iter = data.begin(); iter != data.end(); iter++) {
     const std::string& statName = iter->first;
@@ -67,7 +69,7 @@ void LogDataContainer::write(int fileDescriptor, const std::string& phaseName,
     for (LoggableDatumList::iterator listIter = list.begin();
          listIter != list.end(); listIter++) {
       LoggableDatum* datum = *listIter;
-      datum->write(fileDescriptor, phaseName, epoch, *descriptor);
+      datum->write(file, phaseName, epoch, *descriptor);
       delete datum;
     }
 
@@ -87,3 +89,7 @@ void LogDataContainer::addLogLineDescriptions(
 bool LogDataContainer::empty() const {
   return data.empty();
 }
+
+uint64_t LogDataContainer::getParentLoggerID() const {
+  return parentLoggerID;
+}
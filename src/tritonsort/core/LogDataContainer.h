@@ -11,6 +11,7 @@
 #include "core/LogLineDescriptor.h"
 
 class LoggableDatum;
+class StatLogFile;
 class Timer;
 
 /**
@@ -29,8 +30,11 @@ public:
   /**
      \param loggerPrintPrefix the prefix that will be written to a log file
      before each data point in this container is written
+
+     \param parentLoggerID the ID of the StatLogger that owns this container
    */
-  LogDataContainer(const LogLineDescriptor& parentDescriptor);
+  LogDataContainer(
+    const LogLineDescriptor& parentDescriptor, uint64_t parentLoggerID);
 
   /// Destructor
   virtual ~LogDataContainer();
@@ -60,16 +64,18 @@ public:
   /// Is the container empty?
   bool empty() const;
 
+  /// \return the ID of the StatLogger that owns this container
+  uint64_t getParentLoggerID() const;
+
   /// Write the contents of this container to a file
   /**
-     \param fileDescriptor an open file descriptor corresponding to the file to
-     which to write
+     \param file the stat log file to which to write
 
      \param phaseName the name of the phase during which this data was logged
 
      \param epoch the epoch of the phase during which this data was logged
    */
-  void write(int fileDescriptor, const std::string& phaseName, uint64_t epoch);
+  void write(StatLogFile& file, const std::string& phaseName, uint64_t epoch);
 
   /// Insert description strings for all data logged to this container into the
   /// given set
@@ -86,6 +92,7 @@ private:
   typedef LogLineDescriptorMap::iterator LogLineDescriptorMapIter;
 
   LogLineDescriptor baseLogLineDescriptor;
+  const uint64_t parentLoggerID;
 
   LoggableDatumMap data;
   LogLineDescriptorMap descriptors;
@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include "core/LogLineDescriptor.h"
+#include "core/StatLogFile.h"
 #include "core/TritonSortAssert.h"
 #include "third-party/jsoncpp.h"
 
@@ -26,8 +27,12 @@ LogLineDescriptor::LogLineDescriptor(const LogLineDescriptor& descriptor)
     init();
   } else {
     description = descriptor.description;
+    schema = descriptor.schema;
+    variableFieldTypes = descriptor.variableFieldTypes;
     formatString.assign(descriptor.formatString);
     finalized = true;
+    schemaFileID = 0;
+    schemaID = 0;
   }
 }
 
@@ -48,6 +53,8 @@ LogLineDescriptor& LogLineDescriptor::setLogLineTypeName(
 
 void LogLineDescriptor::init() {
   finalized = false;
+  schemaFileID = 0;
+  schemaID = 0;
 }
 
 LogLineDescriptor& LogLineDescriptor::addField(
@@ -118,6 +125,11 @@ void LogLineDescriptor::finalize() {
 
   Json::Value& descriptionFields = description["fields"];
 
+  schema["type"] = logLineTypeName;
+  schema["fields"] = Json::Value(Json::arrayValue);
+
+  Json::Value& schemaFields = schema["fields"];
+
   FieldList::iterator fieldIter = fields.begin();
 
   for (uint64_t fieldID = 0; fieldID < numFields; fieldID++) {
@@ -127,6 +139,14 @@ void LogLineDescriptor::finalize() {
 
     descriptionFields.append(fieldInfo->getDescriptionJson());
 
+    Json::Value schemaField(fieldInfo->getDescriptionJson());
+    if (fieldInfo->isConstant()) {
+      schemaField["value"] = fieldInfo->getFormatString();
+    } else {
+      variableFieldTypes.push_back(fieldInfo->getFieldType());
+    }
+    schemaFields.append(schemaField);
+
     if (fieldID != numFields - 1) {
       formatStringStream << '\t';
     }
@@ -143,18 +163,14 @@ void LogLineDescriptor::finalize() {
   finalized = true;
 }
 
-void LogLineDescriptor::writeLogLineToFile(int fileDescriptor ...) const {
+void LogLineDescriptor::writeLogLine(StatLogFile* file ...) const {
   TRITONSORT_ASSERT(finalized, "Can't write log lines for an unfinalized "
          "LogLineDescriptor");
 
-  const char* format = formatString.c_str();
-
   va_list ap;
-  va_start(ap, fileDescriptor);
-
-  int status = vdprintf(fileDescriptor, format, ap);
+  va_start(ap, file);
 
-  ABORT_IF(status < 0, "vdprintf() failed with error %d", status);
+  file->writeLogLine(*this, ap);
 
   va_end(ap);
 }
@@ -170,3 +186,16 @@ const std::string& LogLineDescriptor::getLogLineFormatString() const {
          "log line format string");
   return formatString;
 }
+
+const Json::Value& LogLineDescriptor::getSchemaJson() const {
+  TRITONSORT_ASSERT(finalized, "Descriptor must be finalized before returning "
+         "schema");
+  return schema;
+}
+
+const std::vector<LogLineFieldInfo::FieldType>&
+LogLineDescriptor::getVariableFieldTypes() const {
+  TRITONSORT_ASSERT(finalized, "Descriptor must be finalized before returning "
+         "variable field types");
+  return variableFieldTypes;
+}
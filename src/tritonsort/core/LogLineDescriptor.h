@@ -6,9 +6,12 @@
 #include <map>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include "LogLineFieldInfo.h"
 
+class StatLogFile;
+
 /**
    LogLineDescriptors are used by stat containers (see StatContainerInterface)
    to describe the log lines they write to stat log files.
@@ -111,26 +114,54 @@ public:
    */
   const std::string& getLogLineFormatString() const;
 
-  /// Write this log line to a file
+  /// Get a JSON object describing the binary encoding of this log line
+  /**
+     The schema is like the description returned by getDescriptionJson(), but
+     each constant field also carries its value, so that a reader can rebuild
+     the text log line from a binary record.
+
+     \return a reference to the JSON object that describes this log line's
+     binary records
+   */
+  const Json::Value& getSchemaJson() const;
+
+  /// Get the types of this log line's variable fields
   /**
-     \param fileDescriptor an open file descriptor referring to the file to
-     which to write
+     \return the type of each variable field, in order of declaration
+   */
+  const std::vector<LogLineFieldInfo::FieldType>& getVariableFieldTypes()
+    const;
+
+  /// Write this log line to a stat log file
+  /**
+     \param file the stat log file to which to write. A pointer rather than a
+     reference, since it precedes the variable arguments.
 
      \param ... the variable arguments for this log line, in order of their
      declaration
    */
-  void writeLogLineToFile(int fileDescriptor ...) const;
+  void writeLogLine(StatLogFile* file ...) const;
 private:
+  friend class StatLogFile;
+
   typedef std::list<LogLineFieldInfo*> FieldList;
 
   std::string logLineTypeName;
   std::string formatString;
   Json::Value description;
+  Json::Value schema;
+  std::vector<LogLineFieldInfo::FieldType> variableFieldTypes;
 
   bool finalized;
 
   FieldList fields;
 
+  // The binary schema ID that the StatLogFile with ID schemaFileID assigned to
+  // this descriptor. Cached here so that StatLogFile doesn't have to look up
+  // the schema for every record it writes.
+  mutable uint64_t schemaFileID;
+  mutable uint32_t schemaID;
+
   void init();
 };
 
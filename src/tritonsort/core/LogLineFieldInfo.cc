@@ -10,7 +10,9 @@ LogLineFieldInfo::LogLineFieldInfo(const std::string& fieldName,
                                    const std::string& valueFormatString,
                                    FieldType fieldType)
   : formatString(valueFormatString),
-    description(Json::objectValue) {
+    description(Json::objectValue),
+    constant(false),
+    fieldType(fieldType) {
   description["name"] = fieldName;
 
   switch (fieldType) {
@@ -29,7 +31,9 @@ LogLineFieldInfo::LogLineFieldInfo(const std::string& fieldName,
 LogLineFieldInfo::LogLineFieldInfo(
   const std::string& fieldName, uint64_t constantValue)
   : formatString(boost::lexical_cast<std::string>(constantValue)),
-    description(Json::objectValue) {
+    description(Json::objectValue),
+    constant(true),
+    fieldType(UNSIGNED_INTEGER) {
   description["name"] = fieldName;
   description["type"] = "uint";
 }
@@ -37,7 +41,9 @@ LogLineFieldInfo::LogLineFieldInfo(
 LogLineFieldInfo::LogLineFieldInfo(
   const std::string& fieldName, int64_t constantValue)
   : formatString(boost::lexical_cast<std::string>(constantValue)),
-    description(Json::objectValue) {
+    description(Json::objectValue),
+    constant(true),
+    fieldType(SIGNED_INTEGER) {
 
   description["name"] = fieldName;
   description["type"] = "int";
@@ -46,7 +52,9 @@ LogLineFieldInfo::LogLineFieldInfo(
 LogLineFieldInfo::LogLineFieldInfo(
   const std::string& fieldName, const std::string& constantValue)
   : formatString(constantValue),
-    description(Json::objectValue) {
+    description(Json::objectValue),
+    constant(true),
+    fieldType(STRING) {
 
   description["name"] = fieldName;
   description["type"] = "str";
@@ -55,7 +63,9 @@ LogLineFieldInfo::LogLineFieldInfo(
 
 LogLineFieldInfo::LogLineFieldInfo(const LogLineFieldInfo& other)
   : formatString(other.formatString),
-    description(other.description) {
+    description(other.description),
+    constant(other.constant),
+    fieldType(other.fieldType) {
 }
 
 LogLineFieldInfo* LogLineFieldInfo::newVariableField(
@@ -106,3 +116,11 @@ const std::string& LogLineFieldInfo::getFormatString() const {
 const Json::Value& LogLineFieldInfo::getDescriptionJson() const {
   return description;
 }
+
+bool LogLineFieldInfo::isConstant() const {
+  return constant;
+}
+
+LogLineFieldInfo::FieldType LogLineFieldInfo::getFieldType() const {
+  return fieldType;
+}
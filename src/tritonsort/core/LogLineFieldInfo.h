@@ -86,9 +86,18 @@ public:
    */
   const Json::Value& getDescriptionJson() const;
 
+  /// \return true if the field has a constant value, in which case its format
+  /// string is that value
+  bool isConstant() const;
+
+  /// \return the field's data type
+  FieldType getFieldType() const;
+
 private:
   std::string formatString;
   Json::Value description;
+  bool constant;
+  FieldType fieldType;
 
 
   LogLineFieldInfo(
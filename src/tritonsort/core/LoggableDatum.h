@@ -4,6 +4,7 @@
 #include <string>
 
 class LogLineDescriptor;
+class StatLogFile;
 
 /**
    The base class from which all datum that are stored in LoggableDataContainer
@@ -16,7 +17,7 @@ public:
 
   /// Write this datum to a file
   /**
-     \param fileDescriptor an open file descriptor to which to write
+     \param file the stat log file to which to write
 
      \param phaseName the name associated with the datum
 
@@ -25,7 +26,7 @@ public:
      \param descriptor the LogLineDescriptor corresponding to this datum
    */
   virtual void write(
-    int fileDescriptor, const std::string& phaseName, uint64_t epoch,
+    StatLogFile& file, const std::string& phaseName, uint64_t epoch,
     const LogLineDescriptor& descriptor) = 0;
 
   /// Generate a log line descriptor based on your parent's log line descriptor
@@ -7,11 +7,11 @@ LoggableStringDatum::LoggableStringDatum(const std::string& _datum)
   : datum(_datum) {
 }
 
-void LoggableStringDatum::write(int fileDescriptor,
+void LoggableStringDatum::write(StatLogFile& file,
                                 const std::string& phaseName,
                                 uint64_t epoch,
                                 const LogLineDescriptor& descriptor) {
-  descriptor.writeLogLineToFile(fileDescriptor, phaseName.c_str(), epoch,
+  descriptor.writeLogLine(&file, phaseName.c_str(), epoch,
                                 datum.c_str());
 }
 
@@ -14,10 +14,10 @@ LoggableTimeDurationDatum::LoggableTimeDurationDatum(const Timer& timer)
 }
 
 void LoggableTimeDurationDatum::write(
-  int fileDescriptor, const std::string& phaseName, uint64_t epoch,
+  StatLogFile& file, const std::string& phaseName, uint64_t epoch,
   const LogLineDescriptor& descriptor) {
 
-  descriptor.writeLogLineToFile(fileDescriptor, phaseName.c_str(), epoch,
+  descriptor.writeLogLine(&file, phaseName.c_str(), epoch,
                                 startTime, stopTime, elapsedTime);
 }
 
@@ -11,9 +11,9 @@ LoggableUInt64Datum::LoggableUInt64Datum(uint64_t _datum) : datum(_datum) {
 }
 
 void LoggableUInt64Datum::write(
-  int fileDescriptor, const std::string& phaseName, uint64_t epoch,
+  StatLogFile& file, const std::string& phaseName, uint64_t epoch,
   const LogLineDescriptor& descriptor) {
-  descriptor.writeLogLineToFile(fileDescriptor, phaseName.c_str(), epoch,
+  descriptor.writeLogLine(&file, phaseName.c_str(), epoch,
                                 datum);
 }
 
@@ -18,7 +18,7 @@ public:
 
   /// Write this datum to a file
   /// \sa LoggableDatum::write
-  void write(int fileDescriptor, const std::string& phaseName, uint64_t epoch,
+  void write(StatLogFile& file, const std::string& phaseName, uint64_t epoch,
              const LogLineDescriptor& descriptor);
 
   /// \sa LoggableDatum::createLogLineDescriptor
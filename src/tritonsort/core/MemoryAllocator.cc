@@ -7,6 +7,8 @@
 #include "core/ResourceMonitor.h"
 #include "core/ScopedLock.h"
 
+uint64_t MemoryAllocator::nextInstanceID = 0;
+
 MemoryAllocator::MemoryAllocator(
   uint64_t _capacity, uint64_t _fragmentationSleepTimeMicros,
   MemoryAllocatorPolicy& _policy, DeadlockResolverInterface& _deadlockResolver)
@@ -31,11 +33,18 @@ MemoryAllocator::MemoryAllocator(
     "deadlock_resolution_size");
 
   ResourceMonitor::registerClient(this, "memory_allocator");
+  uint64_t instanceID = __sync_fetch_and_add(&nextInstanceID, 1);
+  ResourceMonitor::registerCounter(
+    &capacity, "memory_allocator.%llu.capacity", instanceID);
+  ResourceMonitor::registerCounter(
+    &availability, "memory_allocator.%llu.available_bytes", instanceID);
   IntervalStatLogger::registerClient(this);
 }
 
 MemoryAllocator::~MemoryAllocator() {
   ResourceMonitor::unregisterClient(this);
+  ResourceMonitor::unregisterCounter(&capacity);
+  ResourceMonitor::unregisterCounter(&availability);
   IntervalStatLogger::unregisterClient(this);
 
   pthread_mutex_lock(&lock);
@@ -184,6 +193,15 @@ void* MemoryAllocator::allocate(const MemoryAllocationContext& context,
     // Block until the request can be scheduled.
     while (!request.resolvedOnDeadlock &&
            !policy.canScheduleRequest(availability, request)) {
+      if (context.getFailIfMemoryNotAvailableImmediately()) {
+        // The caller would rather do something else than wait.
+        callerInfo->worker.stopMemoryAllocationTimer();
+        policy.removeRequest(request, groupName);
+        outstandingRequests.erase(callerID);
+        wakeNextThread();
+        return NULL;
+      }
+
       request.satisfiable = false;
       pthread_cond_wait(&(callerInfo->conditionVariable), &lock);
     }
@@ -76,7 +76,9 @@ public:
 
   /**
      Allocate a piece of memory dictated by the allocation context. This call
-     will block until the allocation succeeds.
+     will block until the allocation succeeds, unless the context asks to fail
+     if memory isn't available immediately, in which case it returns NULL
+     instead of blocking.
 
      \param context a context declaring the caller ID, allocation size, and
      other information
@@ -199,6 +201,10 @@ private:
   /// Helper function for spawning deadlock checker pthread.
   static void* spawnDeadlockCheckerThread(void* arg);
 
+  // Distinguishes the streamed counters of allocators that exist at the same
+  // time
+  static uint64_t nextInstanceID;
+
   /// Deadlock checker thread main loop.
   void deadlockCheckerThread();
 
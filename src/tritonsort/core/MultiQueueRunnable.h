@@ -63,6 +63,19 @@ protected:
   */
   bool attemptGetNewWork(uint64_t queueID, T*& workUnit);
 
+  /**
+     Block until a particular queue has work, or until a timeout expires. No
+     work is fetched from the queue.
+
+     \param queueID the ID of the queue to wait on
+
+     \param timeoutMicros the maximum amount of time to wait in microseconds
+
+     \return true if the queue has work (or will never have any more), false if
+     the wait timed out
+   */
+  bool waitForWork(uint64_t queueID, uint64_t timeoutMicros);
+
   void startWaitForWorkTimer();
 
   void stopWaitForWorkTimer();
@@ -128,6 +141,11 @@ template <typename T> bool MultiQueueRunnable<T>::attemptGetNewWork(
   return gotNewWork;
 }
 
+template <typename T> bool MultiQueueRunnable<T>::waitForWork(
+  uint64_t queueID, uint64_t timeoutMicros) {
+  return tracker->waitForWork(queueID, timeoutMicros);
+}
+
 template <typename T> void MultiQueueRunnable<T>::startWaitForWorkTimer() {
   // To prevent inaccurate pipeline saturation logging, don't actually log the
   // wait unless we've fetched our first work unit.
@@ -9,6 +9,13 @@
 Params::Params() {
 }
 
+Params::Params(const Params& other) {
+  for (ParamValueMap::const_iterator iter = other.params.begin();
+       iter != other.params.end(); iter++) {
+    params.insert(std::make_pair(iter->first, new ParamValue(*(iter->second))));
+  }
+}
+
 Params::~Params() {
   clear();
 }
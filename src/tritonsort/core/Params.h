@@ -39,6 +39,15 @@ public:
   /// Constructor
   Params();
 
+  /// Copy constructor
+  /**
+     Copies every parameter definition, so that the copy can be read by one
+     thread while the original is modified by another.
+
+     \param other the Params object to copy
+   */
+  Params(const Params& other);
+
   /// Destructor
   virtual ~Params();
 
@@ -145,6 +154,9 @@ public:
   void clear();
 
 private:
+  // Not implemented; copy with the copy constructor instead
+  Params& operator=(const Params& other);
+
   /**
      Defines the various different equivalent representations of a parameter's
      value, and performs casting between these different types as necessary.
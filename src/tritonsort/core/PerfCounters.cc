@@ -0,0 +1,164 @@
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "core/PerfCounters.h"
+#include "core/StatLogger.h"
+#include "core/TritonSortAssert.h"
+
+PerfCounters::PerfCounters() {
+  for (uint64_t i = 0; i < NUM_COUNTERS; i++) {
+    fds[i] = -1;
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (uint64_t i = 0; i < NUM_COUNTERS; i++) {
+    if (fds[i] != -1) {
+      close(fds[i]);
+      fds[i] = -1;
+    }
+  }
+}
+
+bool PerfCounters::open() {
+  ABORT_IF(isOpen(), "Perf counters are already open");
+
+  const uint64_t configs[NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+
+  for (uint64_t i = 0; i < NUM_COUNTERS; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+      PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // The first counter leads the group; the others follow it on and off the
+    // PMU, so only the leader is initially disabled.
+    attr.disabled = (i == 0) ? 1 : 0;
+
+    fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, fds[0], 0);
+
+    if (fds[i] == -1) {
+      // Hardware counters aren't available, e.g. inside a virtual machine or
+      // because perf_event_paranoid forbids them.
+      for (uint64_t j = 0; j < i; j++) {
+        close(fds[j]);
+        fds[j] = -1;
+      }
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool PerfCounters::isOpen() const {
+  return fds[0] != -1;
+}
+
+void PerfCounters::start() {
+  ABORT_IF(ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1,
+           "ioctl(PERF_EVENT_IOC_ENABLE) failed with error %d: %s", errno,
+           strerror(errno));
+}
+
+void PerfCounters::stop() {
+  ABORT_IF(ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP) == -1,
+           "ioctl(PERF_EVENT_IOC_DISABLE) failed with error %d: %s", errno,
+           strerror(errno));
+}
+
+void PerfCounters::read(uint64_t values[NUM_COUNTERS]) const {
+  // With PERF_FORMAT_GROUP, the leader returns the number of counters, the
+  // time enabled, the time running, and then each counter's value.
+  uint64_t groupValues[3 + NUM_COUNTERS];
+
+  ssize_t bytesRead = ::read(fds[0], groupValues, sizeof(groupValues));
+  ABORT_IF(bytesRead != sizeof(groupValues), "read() of perf counters "
+           "failed with error %d: %s", errno, strerror(errno));
+
+  uint64_t timeEnabled = groupValues[1];
+  uint64_t timeRunning = groupValues[2];
+
+  for (uint64_t i = 0; i < NUM_COUNTERS; i++) {
+    values[i] = groupValues[3 + i];
+
+    if (timeRunning > 0 && timeRunning < timeEnabled) {
+      values[i] = static_cast<uint64_t>(
+        static_cast<double>(values[i]) * timeEnabled / timeRunning);
+    }
+  }
+}
+
+const char* PerfCounters::getCounterName(Counter counter) {
+  switch (counter) {
+  case CYCLES:
+    return "cycles";
+  case INSTRUCTIONS:
+    return "instructions";
+  case CACHE_MISSES:
+    return "cache_misses";
+  case BRANCH_MISSES:
+    return "branch_misses";
+  default:
+    ABORT("Unknown perf counter %d", counter);
+    return NULL;
+  }
+}
+
+void PerfCounters::logCounters(
+  StatLogger& logger, uint64_t bytesProcessed) const {
+
+  uint64_t values[NUM_COUNTERS];
+  read(values);
+
+  for (uint64_t i = 0; i < NUM_COUNTERS; i++) {
+    std::string counterName(getCounterName(static_cast<Counter>(i)));
+
+    logger.logDatum(counterName, values[i]);
+
+    if (bytesProcessed > 0) {
+      // Stats are integers, so normalize per megabyte to keep precision.
+      logger.logDatum(
+        counterName + "_per_mb", static_cast<uint64_t>(
+          static_cast<double>(values[i]) * 1000000 / bytesProcessed));
+    }
+  }
+}
+
+void PerfCounters::addToJson(
+  Json::Value& obj, uint64_t bytesProcessed) const {
+
+  uint64_t values[NUM_COUNTERS];
+  read(values);
+
+  for (uint64_t i = 0; i < NUM_COUNTERS; i++) {
+    std::string counterName(getCounterName(static_cast<Counter>(i)));
+
+    obj[counterName] = Json::UInt64(values[i]);
+
+    if (bytesProcessed > 0) {
+      obj[counterName + "_per_byte"] =
+        static_cast<double>(values[i]) / bytesProcessed;
+    }
+  }
+
+  if (values[CYCLES] > 0) {
+    obj["instructions_per_cycle"] =
+      static_cast<double>(values[INSTRUCTIONS]) / values[CYCLES];
+  }
+}
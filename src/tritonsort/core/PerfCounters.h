@@ -0,0 +1,89 @@
+#ifndef THEMIS_PERF_COUNTERS_H
+#define THEMIS_PERF_COUNTERS_H
+
+#include <stdint.h>
+
+#include "third-party/jsoncpp.h"
+
+class StatLogger;
+
+/**
+   PerfCounters counts hardware events (cycles, instructions, cache misses and
+   branch misses) for a single thread using perf_event_open(2). All of the
+   counters are opened as one group, so they are scheduled onto the PMU
+   together and their ratios are meaningful even if the kernel has to
+   multiplex them with other users' counters.
+
+   Only user-space events are counted, so counters can be opened without
+   privileges as long as /proc/sys/kernel/perf_event_paranoid is at most 2.
+
+   Counters are opened for the calling thread, so open() must be called by the
+   thread to be measured. Once opened, they can be read from any thread.
+ */
+class PerfCounters {
+public:
+  /// The events that are counted
+  enum Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    NUM_COUNTERS
+  };
+
+  /// Constructor
+  PerfCounters();
+
+  /// Destructor
+  virtual ~PerfCounters();
+
+  /// Open counters for the calling thread. Counters start out stopped.
+  /**
+     \return true if the counters were opened, or false if this machine or
+     kernel doesn't support them
+   */
+  bool open();
+
+  /// \return true if the counters have been opened successfully
+  bool isOpen() const;
+
+  /// Start counting. Counts accumulate across start() and stop() pairs.
+  void start();
+
+  /// Stop counting
+  void stop();
+
+  /// Read the current value of every counter
+  /**
+     If the kernel had to multiplex the counters, values are scaled up to
+     estimate what they would have been had they been counting the whole time.
+
+     \param[out] values the value of each counter, indexed by Counter
+   */
+  void read(uint64_t values[NUM_COUNTERS]) const;
+
+  /// \return a name for the counter suitable for use in logs
+  static const char* getCounterName(Counter counter);
+
+  /// Log every counter, and every counter per megabyte of data processed
+  /**
+     \param logger the logger to which to log counters
+
+     \param bytesProcessed the number of bytes processed while counting
+   */
+  void logCounters(StatLogger& logger, uint64_t bytesProcessed) const;
+
+  /// Add every counter, and every counter per byte of data processed, to a
+  /// ResourceMonitor JSON object
+  /**
+     \param obj the JSON object
+
+     \param bytesProcessed the number of bytes processed while counting
+   */
+  void addToJson(Json::Value& obj, uint64_t bytesProcessed) const;
+
+private:
+  int fds[NUM_COUNTERS];
+};
+
+#endif // THEMIS_PERF_COUNTERS_H
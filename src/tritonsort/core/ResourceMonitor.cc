@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <arpa/inet.h>
 #include <errno.h>
 #include <sstream>
@@ -10,6 +11,8 @@
 #include "core/Params.h"
 #include "core/ResourceMonitor.h"
 #include "core/ScopedLock.h"
+#include "core/StatusPrinter.h"
+#include "core/Timer.h"
 #include "core/TritonSortAssert.h"
 #include "third-party/jsoncpp.h"
 
@@ -19,26 +22,57 @@ themis::Thread ResourceMonitor::thread(
     "ResourceMonitor", &ResourceMonitor::run);
 bool ResourceMonitor::stop = false;
 bool ResourceMonitor::initialized = false;
+bool ResourceMonitor::streaming = false;
 Socket* ResourceMonitor::serverSocket = NULL;
 uint64_t ResourceMonitor::socketBufferSize = 0;
 
 KeyToClientSetMap ResourceMonitor::keyToClients;
 ClientToKeySetMap ResourceMonitor::clientToKeys;
 
+pthread_mutex_t ResourceMonitor::counterLock;
+NameToCounterMap ResourceMonitor::nameToCounter;
+CounterToNameMap ResourceMonitor::counterToName;
+
+themis::Thread ResourceMonitor::streamThread(
+    "ResourceMonitorStream", &ResourceMonitor::runStream);
+Socket* ResourceMonitor::streamServerSocket = NULL;
+uint64_t ResourceMonitor::streamIntervalMicros = 0;
+SocketList ResourceMonitor::subscribers;
+SocketList ResourceMonitor::newSubscribers;
+CounterValueMap ResourceMonitor::lastStreamedValues;
+
 void ResourceMonitor::init(Params* params) {
-  // Do not initialize if port is not named in config
+  // Do not initialize if neither port is named in config
   // This prevents unnecessary select() overhead if monitoring is not needed
-  if (!params->contains("MONITOR_PORT")) {
+  bool monitorPortGiven = params->contains("MONITOR_PORT");
+  bool streamPortGiven = params->contains("MONITOR_STREAM_PORT");
+
+  if (!monitorPortGiven && !streamPortGiven) {
     return;
   }
 
   pthread_mutex_init(&lock, NULL);
+  pthread_mutex_init(&counterLock, NULL);
   stop = false;
 
-  serverSocket = new Socket();
-  serverSocket->listen(params->get<std::string>("MONITOR_PORT"), 1);
   socketBufferSize = params->get<int32_t>("TCP_RECEIVE_BUFFER_SIZE");
 
+  if (monitorPortGiven) {
+    serverSocket = new Socket();
+    serverSocket->listen(params->get<std::string>("MONITOR_PORT"), 1);
+  }
+
+  if (streamPortGiven) {
+    streamServerSocket = new Socket();
+    streamServerSocket->listen(
+      params->get<std::string>("MONITOR_STREAM_PORT"), 16);
+    streamIntervalMicros = params->get<uint64_t>(
+      "MONITOR_STREAM_INTERVAL_MICROS");
+    ABORT_IF(streamIntervalMicros == 0,
+             "MONITOR_STREAM_INTERVAL_MICROS must be non-zero");
+    streaming = true;
+  }
+
   // Allow registerPool(), spawn(), teardown() calls to succeed
   initialized = true;
 }
@@ -50,14 +84,30 @@ void ResourceMonitor::teardown() {
 
   stop = true;
 
-  thread.stopThread();
-
   if (serverSocket != NULL) {
+    thread.stopThread();
+
     serverSocket->close();
     delete serverSocket;
+    serverSocket = NULL;
+  }
+
+  if (streamServerSocket != NULL) {
+    streamThread.stopThread();
+
+    streamServerSocket->close();
+    delete streamServerSocket;
+    streamServerSocket = NULL;
   }
 
+  streaming = false;
+  nameToCounter.clear();
+  counterToName.clear();
+
+  pthread_mutex_destroy(&counterLock);
   pthread_mutex_destroy(&lock);
+
+  initialized = false;
 }
 
 void ResourceMonitor::registerClient(ResourceMonitorClient* client,
@@ -123,6 +173,59 @@ void ResourceMonitor::unregisterClient(ResourceMonitorClient* client) {
   clientToKeys.erase(clientToKeysIter);
 }
 
+void ResourceMonitor::registerCounter(const uint64_t* counter,
+                                      const char* nameFormat, ...) {
+  if (!streaming) {
+    return;
+  }
+
+  va_list ap;
+
+  va_start(ap, nameFormat);
+  char buffer[1024];
+  int stringSize = vsnprintf(buffer, 1024, nameFormat, ap);
+  va_end(ap);
+
+  std::string counterName(buffer, stringSize);
+
+  ScopedLock scopedLock(&counterLock);
+
+  // Streaming is a diagnostic, so a name collision shouldn't end the job;
+  // the first counter registered under a name keeps it.
+  if (nameToCounter.count(counterName) > 0 ||
+      counterToName.count(counter) > 0) {
+    StatusPrinter::add("A counter named '%s' is already registered with the "
+                       "resource monitor; not streaming it",
+                       counterName.c_str());
+    return;
+  }
+
+  nameToCounter[counterName] = counter;
+  counterToName[counter] = counterName;
+}
+
+void ResourceMonitor::unregisterCounter(const uint64_t* counter) {
+  if (!streaming) {
+    return;
+  }
+
+  ScopedLock scopedLock(&counterLock);
+
+  CounterToNameMap::iterator iter = counterToName.find(counter);
+
+  if (iter == counterToName.end()) {
+    // This counter wasn't registered in the first place, so short-circuit
+    return;
+  }
+
+  nameToCounter.erase(iter->second);
+  counterToName.erase(iter);
+}
+
+bool ResourceMonitor::isStreaming() {
+  return streaming;
+}
+
 void ResourceMonitor::queryAllClients(std::string& outputStr) {
   ScopedLock scopedLock(&lock);
 
@@ -184,10 +287,163 @@ void* ResourceMonitor::run(void* arg) {
   return NULL;
 }
 
+void ResourceMonitor::streamCounters() {
+  Json::FastWriter writer;
+
+  Json::Value delta(Json::objectValue);
+  delta["time"] = Json::UInt64(Timer::posixTimeInMicros());
+  Json::Value& changedCounters = delta["counters"];
+  changedCounters = Json::Value(Json::objectValue);
+  Json::Value& removedCounters = delta["removed"];
+  removedCounters = Json::Value(Json::arrayValue);
+
+  pthread_mutex_lock(&counterLock);
+
+  // Both maps are sorted by name, so walk them together to find counters that
+  // changed, appeared or disappeared.
+  NameToCounterMap::iterator counterIter = nameToCounter.begin();
+  CounterValueMap::iterator lastValueIter = lastStreamedValues.begin();
+
+  while (counterIter != nameToCounter.end() ||
+         lastValueIter != lastStreamedValues.end()) {
+    if (counterIter == nameToCounter.end() ||
+        (lastValueIter != lastStreamedValues.end() &&
+         lastValueIter->first < counterIter->first)) {
+      removedCounters.append(lastValueIter->first);
+      lastStreamedValues.erase(lastValueIter++);
+      continue;
+    }
+
+    const std::string& name = counterIter->first;
+    uint64_t value = *const_cast<const volatile uint64_t*>(
+      counterIter->second);
+
+    if (lastValueIter != lastStreamedValues.end() &&
+        lastValueIter->first == name) {
+      if (lastValueIter->second != value) {
+        lastValueIter->second = value;
+        changedCounters[name] = Json::UInt64(value);
+      }
+      lastValueIter++;
+    } else {
+      lastStreamedValues.insert(
+        lastValueIter, std::make_pair(name, value));
+      changedCounters[name] = Json::UInt64(value);
+    }
+
+    counterIter++;
+  }
+
+  pthread_mutex_unlock(&counterLock);
+
+  std::string deltaLine(writer.write(delta));
+
+  for (SocketList::iterator iter = subscribers.begin();
+       iter != subscribers.end(); ) {
+    if (sendToSubscriber(*iter, deltaLine)) {
+      iter++;
+    } else {
+      (*iter)->close();
+      delete *iter;
+      iter = subscribers.erase(iter);
+    }
+  }
+
+  if (!newSubscribers.empty()) {
+    Json::Value full(Json::objectValue);
+    full["time"] = delta["time"];
+    full["full"] = true;
+    Json::Value& allCounters = full["counters"];
+    allCounters = Json::Value(Json::objectValue);
+    full["removed"] = Json::Value(Json::arrayValue);
+
+    for (CounterValueMap::iterator iter = lastStreamedValues.begin();
+         iter != lastStreamedValues.end(); iter++) {
+      allCounters[iter->first] = Json::UInt64(iter->second);
+    }
+
+    std::string fullLine(writer.write(full));
+
+    for (SocketList::iterator iter = newSubscribers.begin();
+         iter != newSubscribers.end(); iter++) {
+      if (sendToSubscriber(*iter, fullLine)) {
+        subscribers.push_back(*iter);
+      } else {
+        (*iter)->close();
+        delete *iter;
+      }
+    }
+
+    newSubscribers.clear();
+  }
+}
+
+bool ResourceMonitor::sendToSubscriber(
+  Socket* subscriber, const std::string& line) {
+  // Never block; a subscriber whose socket buffer is full has fallen too far
+  // behind to be worth waiting for.
+  ssize_t bytesSent = send(subscriber->getFD(), line.data(), line.size(),
+                           MSG_DONTWAIT | MSG_NOSIGNAL);
+
+  return bytesSent == static_cast<ssize_t>(line.size());
+}
+
+void* ResourceMonitor::runStream(void* arg) {
+  uint64_t nextStreamTime = Timer::posixTimeInMicros();
+
+  while (!stop) {
+    uint64_t currentTime = Timer::posixTimeInMicros();
+
+    if (currentTime < nextStreamTime) {
+      // Accept new subscribers until it's time to stream again.
+      uint64_t timeout = std::max<uint64_t>(
+        nextStreamTime - currentTime, 1000);
+      Socket* subscriber = streamServerSocket->accept(
+        timeout, socketBufferSize);
+
+      if (subscriber != NULL) {
+        newSubscribers.push_back(subscriber);
+      }
+    } else {
+      streamCounters();
+
+      nextStreamTime += streamIntervalMicros;
+      if (nextStreamTime < currentTime) {
+        // Don't try to catch up after falling behind.
+        nextStreamTime = currentTime + streamIntervalMicros;
+      }
+    }
+  }
+
+  for (SocketList::iterator iter = subscribers.begin();
+       iter != subscribers.end(); iter++) {
+    (*iter)->close();
+    delete *iter;
+  }
+  subscribers.clear();
+
+  for (SocketList::iterator iter = newSubscribers.begin();
+       iter != newSubscribers.end(); iter++) {
+    (*iter)->close();
+    delete *iter;
+  }
+  newSubscribers.clear();
+
+  lastStreamedValues.clear();
+
+  return NULL;
+}
+
 void ResourceMonitor::spawn() {
   if (!initialized) {
     return;
   }
 
-  thread.startThread();
+  if (serverSocket != NULL) {
+    thread.startThread();
+  }
+
+  if (streamServerSocket != NULL) {
+    streamThread.startThread();
+  }
 }
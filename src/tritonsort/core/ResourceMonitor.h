@@ -1,6 +1,7 @@
 #ifndef _TRITONSORT_RESOURCEMONITOR_H
 #define _TRITONSORT_RESOURCEMONITOR_H
 
+#include <list>
 #include <map>
 #include <pthread.h>
 #include <set>
@@ -17,6 +18,10 @@ typedef std::set<std::string> KeySet;
 typedef std::set<ResourceMonitorClient*> ClientSet;
 typedef std::map<std::string, ClientSet> KeyToClientSetMap;
 typedef std::map<ResourceMonitorClient*, KeySet> ClientToKeySetMap;
+typedef std::map<std::string, const uint64_t*> NameToCounterMap;
+typedef std::map<const uint64_t*, std::string> CounterToNameMap;
+typedef std::map<std::string, uint64_t> CounterValueMap;
+typedef std::list<Socket*> SocketList;
 
 /**
    The resource monitor provides an external interface to some of the system's
@@ -32,6 +37,22 @@ typedef std::map<ResourceMonitorClient*, KeySet> ClientToKeySetMap;
    pairs, where each value is an array of JSON objects, one per client that
    registered with the particular key.
 
+   Querying every client is too expensive to do many times a second, so the
+   monitor can also stream counters to subscribers. Components register plain
+   uint64_t counters that they already maintain (with registerCounter), and
+   anyone who connects to MONITOR_STREAM_PORT is subscribed until they
+   disconnect. Every MONITOR_STREAM_INTERVAL_MICROS microseconds, the monitor
+   reads every counter without taking any client's locks and sends each
+   subscriber one line of JSON:
+
+   {"time": <micros since epoch>, "counters": {<name>: <value>, ...},
+    "removed": [<name>, ...]}
+
+   A subscriber's first line contains every counter and has "full" set to
+   true. After that, lines only contain the counters whose values changed and
+   the names of counters that were unregistered since the last line.
+   Subscribers that can't keep up are disconnected.
+
    \sa ResourceMonitorClient
  */
 class ResourceMonitor {
@@ -76,6 +97,38 @@ public:
    */
   static void unregisterClient(ResourceMonitorClient* client);
 
+  /// Register a counter to be streamed to subscribers
+  /**
+     The counter is read without synchronization, so it must stay valid until
+     it is unregistered and must be a naturally aligned uint64_t, updated
+     either by a single thread or with atomic operations. If streaming is
+     disabled, this has no effect. If another counter is already registered
+     under the same name, a warning is printed and this counter isn't
+     streamed.
+
+     \param counter a pointer to the counter
+
+     \param nameFormat a printf-style format string giving the name under
+     which the counter is streamed
+
+     \param ... the format arguments for the name format string
+   */
+  static void registerCounter(const uint64_t* counter,
+                              const char* nameFormat, ...);
+
+  /// Stop streaming a counter
+  /**
+     \param counter a pointer to a counter previously passed to
+     ResourceMonitor::registerCounter
+   */
+  static void unregisterCounter(const uint64_t* counter);
+
+  /**
+     \return true if counters registered with registerCounter are streamed,
+     so components can skip maintaining counters that nobody will read
+   */
+  static bool isStreaming();
+
   /**
      Starts the resource monitor
    */
@@ -88,6 +141,7 @@ private:
   static bool stop;
 
   static bool initialized;
+  static bool streaming;
 
   static KeyToClientSetMap keyToClients;
   static ClientToKeySetMap clientToKeys;
@@ -95,7 +149,36 @@ private:
   static Socket* serverSocket;
   static uint64_t socketBufferSize;
 
+  // Protects only the counter registry, so the stream thread never contends
+  // with the locks that guard clients' state
+  static pthread_mutex_t counterLock;
+  static NameToCounterMap nameToCounter;
+  static CounterToNameMap counterToName;
+
+  // The following are only touched by the stream thread.
+  static themis::Thread streamThread;
+  static Socket* streamServerSocket;
+  static uint64_t streamIntervalMicros;
+  static SocketList subscribers;
+  static SocketList newSubscribers;
+  static CounterValueMap lastStreamedValues;
+
   static void* run(void* arg);
+  static void* runStream(void* arg);
+
+  /**
+     Read every counter and send changes to subscribers, and send everything
+     to new subscribers
+   */
+  static void streamCounters();
+
+  /**
+     Send a line to a subscriber without blocking
+
+     \return false if the line couldn't be sent, in which case the subscriber
+     should be dropped
+   */
+  static bool sendToSubscriber(Socket* subscriber, const std::string& line);
 
   /**
      \param[out] outputStr the string to which client output will be written
@@ -0,0 +1,279 @@
+#include "core/MemoryAllocationContext.h"
+#include "core/SizeClassCachingMemoryAllocator.h"
+#include "core/TritonSortAssert.h"
+
+SizeClassCachingMemoryAllocator::SizeClassCachingMemoryAllocator(
+  MemoryAllocatorInterface& _parentAllocator, uint64_t _cacheCapacity,
+  const std::string& stageName, uint64_t id)
+  : parentAllocator(_parentAllocator),
+    cacheCapacity(_cacheCapacity),
+    useCounter(0),
+    cachedBytes(0),
+    logger(stageName, id),
+    numCacheHits(0),
+    numCacheMisses(0),
+    numEvictions(0) {
+  for (uint64_t i = 0; i < NUM_SIZE_CLASS_SLOTS; i++) {
+    slots[i].sizeClass = 0;
+    slots[i].head = NULL;
+    slots[i].lastUsed = 0;
+  }
+}
+
+SizeClassCachingMemoryAllocator::~SizeClassCachingMemoryAllocator() {
+  for (uint64_t i = 0; i < NUM_SIZE_CLASS_SLOTS; i++) {
+    flush(slots[i]);
+  }
+
+  ABORT_IF(cachedBytes != 0, "Expected the cache to be empty after flushing "
+           "it, but it still holds %llu bytes", cachedBytes);
+
+  logger.logDatum("buffer_cache_hits", numCacheHits);
+  logger.logDatum("buffer_cache_misses", numCacheMisses);
+  logger.logDatum("buffer_cache_evictions", numEvictions);
+}
+
+uint64_t SizeClassCachingMemoryAllocator::registerCaller(BaseWorker& caller) {
+  // Misses are allocated from the underlying allocator on the caller's
+  // behalf, so it needs to know about the caller.
+  return parentAllocator.registerCaller(caller);
+}
+
+void* SizeClassCachingMemoryAllocator::allocate(
+  const MemoryAllocationContext& context) {
+  uint64_t dummySize = 0;
+  return allocate(context, dummySize);
+}
+
+void* SizeClassCachingMemoryAllocator::allocate(
+  const MemoryAllocationContext& context, uint64_t& size) {
+
+  const MemoryAllocationContext::MemorySizes& sizes = context.getSizes();
+  if (sizes.size() != 1) {
+    // The underlying allocator gets to pick between sizes, so we can't cache
+    // this region.
+    return allocateFromParent(context, 0, size);
+  }
+
+  size = sizes.front();
+  uint64_t sizeClass = getSizeClass(size);
+
+  Slot* slot = findSlot(sizeClass);
+  if (slot != NULL) {
+    slot->lastUsed = ++useCounter;
+
+    RegionHeader* header = pop(*slot);
+    while (header != NULL && header->sizeClass != sizeClass) {
+      // This region was returned while the slot was being reassigned.
+      evict(header);
+      header = pop(*slot);
+    }
+
+    if (header != NULL) {
+      // Cache hit
+      __sync_fetch_and_sub(&cachedBytes, sizeClass);
+      numCacheHits++;
+      return reinterpret_cast<uint8_t*>(header) + REGION_HEADER_SIZE;
+    }
+  }
+
+  numCacheMisses++;
+
+  // Make sure this region will fit in the cache when it's returned by
+  // flushing regions of other size classes.
+  for (uint64_t i = 0; i < NUM_SIZE_CLASS_SLOTS &&
+         cachedBytes + sizeClass > cacheCapacity; i++) {
+    if (&slots[i] != slot) {
+      flush(slots[i]);
+    }
+  }
+
+  if (slot == NULL) {
+    claimSlot(sizeClass);
+  }
+
+  uint64_t regionSize = 0;
+  return allocateFromParent(context, sizeClass, regionSize);
+}
+
+void SizeClassCachingMemoryAllocator::deallocate(void* memory) {
+  RegionHeader* header = reinterpret_cast<RegionHeader*>(
+    static_cast<uint8_t*>(memory) - REGION_HEADER_SIZE);
+  uint64_t sizeClass = header->sizeClass;
+
+  if (sizeClass == 0) {
+    // This region was passed through to the underlying allocator.
+    parentAllocator.deallocate(header);
+    return;
+  }
+
+  Slot* slot = findSlot(sizeClass);
+
+  // Reserve room for the region in the cache.
+  bool reserved = false;
+  if (slot != NULL) {
+    uint64_t currentBytes = cachedBytes;
+    while (currentBytes + sizeClass <= cacheCapacity) {
+      uint64_t previousBytes = __sync_val_compare_and_swap(
+        &cachedBytes, currentBytes, currentBytes + sizeClass);
+      if (previousBytes == currentBytes) {
+        reserved = true;
+        break;
+      }
+      currentBytes = previousBytes;
+    }
+  }
+
+  if (reserved) {
+    push(*slot, header);
+  } else {
+    // There's no room for this region, or its size class is no longer being
+    // cached.
+    __sync_fetch_and_add(&numEvictions, 1);
+    parentAllocator.deallocate(header);
+  }
+}
+
+uint64_t SizeClassCachingMemoryAllocator::getSizeClass(uint64_t size) {
+  size += REGION_HEADER_SIZE;
+
+  return ((size + SIZE_CLASS_GRANULARITY - 1) / SIZE_CLASS_GRANULARITY) *
+    SIZE_CLASS_GRANULARITY;
+}
+
+SizeClassCachingMemoryAllocator::Slot*
+SizeClassCachingMemoryAllocator::findSlot(uint64_t sizeClass) {
+  for (uint64_t i = 0; i < NUM_SIZE_CLASS_SLOTS; i++) {
+    if (slots[i].sizeClass == sizeClass) {
+      return &slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+SizeClassCachingMemoryAllocator::Slot*
+SizeClassCachingMemoryAllocator::claimSlot(uint64_t sizeClass) {
+  Slot* victim = &slots[0];
+  for (uint64_t i = 0; i < NUM_SIZE_CLASS_SLOTS; i++) {
+    if (slots[i].sizeClass == 0) {
+      victim = &slots[i];
+      break;
+    }
+
+    if (slots[i].lastUsed < victim->lastUsed) {
+      victim = &slots[i];
+    }
+  }
+
+  // Regions of the victim's old size class that are returned after this
+  // point either go back to the underlying allocator or are weeded out when
+  // they're popped.
+  victim->sizeClass = sizeClass;
+  __sync_synchronize();
+  flush(*victim);
+
+  victim->lastUsed = ++useCounter;
+  return victim;
+}
+
+SizeClassCachingMemoryAllocator::RegionHeader*
+SizeClassCachingMemoryAllocator::pop(Slot& slot) {
+  // Only the owning worker pops, so a region can't be popped and pushed back
+  // between reading the head and swapping it out.
+  RegionHeader* header = slot.head;
+  while (header != NULL) {
+    RegionHeader* previousHead =
+      __sync_val_compare_and_swap(&slot.head, header, header->next);
+    if (previousHead == header) {
+      break;
+    }
+    header = previousHead;
+  }
+
+  return header;
+}
+
+void SizeClassCachingMemoryAllocator::push(
+  Slot& slot, RegionHeader* header) {
+  RegionHeader* currentHead = slot.head;
+  while (true) {
+    header->next = currentHead;
+    RegionHeader* previousHead =
+      __sync_val_compare_and_swap(&slot.head, currentHead, header);
+    if (previousHead == currentHead) {
+      break;
+    }
+    currentHead = previousHead;
+  }
+}
+
+void SizeClassCachingMemoryAllocator::flush(Slot& slot) {
+  // Take the whole free list at once; pushers will start a new one.
+  RegionHeader* header = __sync_lock_test_and_set(
+    &slot.head, static_cast<RegionHeader*>(NULL));
+
+  while (header != NULL) {
+    RegionHeader* next = header->next;
+    evict(header);
+    header = next;
+  }
+}
+
+void SizeClassCachingMemoryAllocator::evict(RegionHeader* header) {
+  __sync_fetch_and_sub(&cachedBytes, header->sizeClass);
+  __sync_fetch_and_add(&numEvictions, 1);
+  parentAllocator.deallocate(header);
+}
+
+void* SizeClassCachingMemoryAllocator::allocateFromParent(
+  const MemoryAllocationContext& context, uint64_t sizeClass,
+  uint64_t& size) {
+
+  // Allocate the whole size class so this region can be reused for any
+  // request in the class. Pass-through requests get room for the header on
+  // top of each allowable size.
+  const MemoryAllocationContext::MemorySizes& sizes = context.getSizes();
+  MemoryAllocationContext::MemorySizes::const_iterator iter = sizes.begin();
+
+  MemoryAllocationContext nonBlockingContext(
+    context.getCallerID(),
+    sizeClass != 0 ? sizeClass : *iter + REGION_HEADER_SIZE, true);
+  MemoryAllocationContext blockingContext(
+    context.getCallerID(),
+    sizeClass != 0 ? sizeClass : *iter + REGION_HEADER_SIZE,
+    context.getFailIfMemoryNotAvailableImmediately());
+
+  if (sizeClass == 0) {
+    for (++iter; iter != sizes.end(); iter++) {
+      nonBlockingContext.addSize(*iter + REGION_HEADER_SIZE);
+      blockingContext.addSize(*iter + REGION_HEADER_SIZE);
+    }
+  }
+
+  uint64_t regionSize = 0;
+  void* region = parentAllocator.allocate(nonBlockingContext, regionSize);
+
+  if (region == NULL && !context.getFailIfMemoryNotAvailableImmediately()) {
+    // Don't hold on to cached memory that could let this allocation proceed.
+    for (uint64_t i = 0; i < NUM_SIZE_CLASS_SLOTS; i++) {
+      flush(slots[i]);
+    }
+
+    region = parentAllocator.allocate(blockingContext, regionSize);
+  }
+
+  if (region == NULL) {
+    return NULL;
+  }
+
+  RegionHeader* header = static_cast<RegionHeader*>(region);
+  header->sizeClass = sizeClass;
+  header->next = NULL;
+
+  if (sizeClass == 0) {
+    size = regionSize - REGION_HEADER_SIZE;
+  }
+
+  return static_cast<uint8_t*>(region) + REGION_HEADER_SIZE;
+}
@@ -0,0 +1,171 @@
+#ifndef THEMIS_SIZE_CLASS_CACHING_MEMORY_ALLOCATOR_H
+#define THEMIS_SIZE_CLASS_CACHING_MEMORY_ALLOCATOR_H
+
+#include <stdint.h>
+#include <string>
+
+#include "core/MemoryAllocatorInterface.h"
+#include "core/StatLogger.h"
+
+/**
+   SizeClassCachingMemoryAllocator sits in front of another memory allocator
+   and keeps a small cache of recently freed memory regions for a single
+   worker, grouped by size class. Allocations that can be satisfied from the
+   cache never touch the underlying allocator, which avoids its global lock
+   and bookkeeping for stages that churn through buffers of the same size.
+
+   Every region starts with a small header recording its size class, and
+   requests are rounded up (header included) to a multiple of
+   SIZE_CLASS_GRANULARITY, so a cached region can satisfy any request in the
+   same class. Cached regions remain allocated from the underlying allocator
+   on behalf of the worker that owns the cache, so the underlying allocator's
+   accounting of that worker's memory usage stays exact and its policy
+   continues to see every byte the worker holds.
+
+   Each size class the worker is currently using gets a slot holding a
+   lock-free free list. Regions can be returned by any thread (usually a
+   downstream consumer), but only the owning worker's thread allocates, so
+   free lists have many pushers and a single popper and are therefore safe
+   from ABA. Neither path takes a lock or touches a map.
+
+   A region returned while the cache is full goes back to the underlying
+   allocator. On a miss, the owning worker flushes the free lists of other
+   size classes until the new region would fit, so the cache follows the
+   worker's current allocation sizes. If the underlying allocator can't
+   satisfy a miss immediately, the whole cache is flushed back to it before
+   the worker blocks.
+
+   Requests that offer more than one allowable size are passed straight
+   through to the underlying allocator.
+ */
+class SizeClassCachingMemoryAllocator : public MemoryAllocatorInterface {
+public:
+  /// Allocation sizes are rounded up to a multiple of this many bytes
+  static const uint64_t SIZE_CLASS_GRANULARITY = 4096;
+
+  /// The number of bytes at the start of each region used by the cache
+  /**
+     Kept at 16 bytes so regions keep the alignment of the underlying
+     allocator.
+   */
+  static const uint64_t REGION_HEADER_SIZE = 16;
+
+  /// The number of size classes that can be cached at once
+  static const uint64_t NUM_SIZE_CLASS_SLOTS = 8;
+
+  /// Constructor
+  /**
+     \param parentAllocator the allocator from which regions are allocated
+     on a cache miss, and to which they are returned when they are evicted
+
+     \param cacheCapacity the maximum number of bytes the cache can hold
+
+     \param stageName the name of the stage of the worker using the cache
+
+     \param id the ID of the worker using the cache
+   */
+  SizeClassCachingMemoryAllocator(
+    MemoryAllocatorInterface& parentAllocator, uint64_t cacheCapacity,
+    const std::string& stageName, uint64_t id);
+
+  /// Destructor
+  /**
+     Returns every cached region to the underlying allocator.
+   */
+  virtual ~SizeClassCachingMemoryAllocator();
+
+  /// \sa MemoryAllocatorInterface::registerCaller
+  uint64_t registerCaller(BaseWorker& caller);
+
+  /// \sa MemoryAllocatorInterface::allocate
+  void* allocate(const MemoryAllocationContext& context);
+
+  /// \sa MemoryAllocatorInterface::allocate
+  void* allocate(const MemoryAllocationContext& context, uint64_t& size);
+
+  /// \sa MemoryAllocatorInterface::deallocate
+  void deallocate(void* memory);
+
+  /**
+     \param size an allocation size in bytes
+
+     \return the size class that an allocation of the given size belongs to,
+     which is also the size of the region (header included) that will be
+     allocated for it
+   */
+  static uint64_t getSizeClass(uint64_t size);
+
+private:
+  /// Written into the first REGION_HEADER_SIZE bytes of every region
+  struct RegionHeader {
+    // The region's size class, or 0 if it was passed through
+    uint64_t sizeClass;
+    // The next region in a free list
+    RegionHeader* next;
+  };
+
+  /// A lock-free free list of regions of a single size class
+  struct Slot {
+    // 0 if the slot hasn't been claimed yet
+    volatile uint64_t sizeClass;
+    RegionHeader* volatile head;
+    // Only touched by the owning worker
+    uint64_t lastUsed;
+  };
+
+  /**
+     \return the slot caching the given size class, or NULL if there isn't
+     one
+   */
+  Slot* findSlot(uint64_t sizeClass);
+
+  /**
+     Claim a slot for the given size class, flushing the least recently used
+     slot if all of them are taken. Only called by the owning worker.
+   */
+  Slot* claimSlot(uint64_t sizeClass);
+
+  /**
+     Pop a region from a slot's free list. Only called by the owning worker.
+
+     \return the region's header, or NULL if the free list is empty
+   */
+  RegionHeader* pop(Slot& slot);
+
+  /// Push a region onto a slot's free list; safe from any thread.
+  void push(Slot& slot, RegionHeader* header);
+
+  /**
+     Return every region in a slot's free list to the underlying allocator.
+     Only called by the owning worker.
+   */
+  void flush(Slot& slot);
+
+  /// Return a region that was counted in cachedBytes to the underlying
+  /// allocator.
+  void evict(RegionHeader* header);
+
+  /**
+     Allocate a region from the underlying allocator, flushing the cache
+     first if the allocation would otherwise block.
+   */
+  void* allocateFromParent(
+    const MemoryAllocationContext& context, uint64_t sizeClass,
+    uint64_t& size);
+
+  MemoryAllocatorInterface& parentAllocator;
+  const uint64_t cacheCapacity;
+
+  Slot slots[NUM_SIZE_CLASS_SLOTS];
+  uint64_t useCounter;
+
+  // Updated atomically, since any thread can return a region
+  uint64_t cachedBytes;
+
+  StatLogger logger;
+  uint64_t numCacheHits;
+  uint64_t numCacheMisses;
+  uint64_t numEvictions;
+};
+
+#endif // THEMIS_SIZE_CLASS_CACHING_MEMORY_ALLOCATOR_H
@@ -64,22 +64,20 @@ bool StatCollection::isReadyForWriting() const {
 }
 
 void StatCollection::writeStatsToFile(
-  File& file, LogLineDescriptor& logLineDescriptor,
+  StatLogFile& file, LogLineDescriptor& logLineDescriptor,
   const std::string& phaseName, uint64_t epoch) const {
 
   TRITONSORT_ASSERT(statQueue.size() == timestampQueue.size(), "There needs to be a "
          "timestamp for every statistic logged by a StatCollection");
 
-  int fileDescriptor = file.getFileDescriptor();
-
   std::list<uint64_t>::const_iterator statIter = statQueue.begin();
   std::list<uint64_t>::const_iterator timestampIter = timestampQueue.begin();
 
   const char* phaseNameCStr = phaseName.c_str();
 
   while (statIter != statQueue.end()) {
-    logLineDescriptor.writeLogLineToFile(
-      fileDescriptor, phaseNameCStr, epoch, *timestampIter, *statIter);
+    logLineDescriptor.writeLogLine(
+      &file, phaseNameCStr, epoch, *timestampIter, *statIter);
 
     statIter++;
     timestampIter++;
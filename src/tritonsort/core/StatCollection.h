@@ -46,7 +46,7 @@ public:
   }
 
   void writeStatsToFile(
-    File& file, LogLineDescriptor& logLineDescriptor,
+    StatLogFile& file, LogLineDescriptor& logLineDescriptor,
     const std::string& phaseName, uint64_t epoch) const;
 
   void addLogLineDescriptions(std::set<Json::Value>& descriptionSet) const;
@@ -7,8 +7,8 @@
 #include <stdint.h>
 #include <string>
 
-#include "core/File.h"
 #include "core/LogLineDescriptor.h"
+#include "core/StatLogFile.h"
 #include "core/Timer.h"
 #include "third-party/jsoncpp.h"
 
@@ -42,7 +42,7 @@ public:
      \param epoch the epoch for which stats are currently being written
    */
   virtual void writeStatsToFile(
-    File& file, LogLineDescriptor& logLineDescriptor,
+    StatLogFile& file, LogLineDescriptor& logLineDescriptor,
     const std::string& phaseName, uint64_t epoch) const = 0;
 
 
@@ -63,16 +63,14 @@ void StatHistogram::add(uint64_t stat) {
 }
 
 void StatHistogram::writeStatsToFile(
-  File& file, LogLineDescriptor& logLineDescriptor,
+  StatLogFile& file, LogLineDescriptor& logLineDescriptor,
   const std::string& phaseName, uint64_t epoch) const {
 
   const char* phaseNameCStr = phaseName.c_str();
 
-  int fileDescriptor = file.getFileDescriptor();
-
   for (BinMap::const_iterator iter = bins.begin(); iter != bins.end(); iter++) {
-    logLineDescriptor.writeLogLineToFile(
-      fileDescriptor, phaseNameCStr, epoch, iter->first * binSize,
+    logLineDescriptor.writeLogLine(
+      &file, phaseNameCStr, epoch, iter->first * binSize,
       iter->second);
   }
 }
@@ -0,0 +1,168 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "core/LogLineDescriptor.h"
+#include "core/StatLogFile.h"
+#include "core/TritonSortAssert.h"
+#include "third-party/jsoncpp.h"
+
+const char StatLogFile::BINARY_MAGIC[8] = {
+  'T', 'H', 'M', 'S', 'S', 'T', 'A', 'T' };
+
+uint64_t StatLogFile::nextFileID = 1;
+
+StatLogFile::Format StatLogFile::parseFormat(const std::string& formatName) {
+  if (formatName == "text") {
+    return TEXT;
+  } else if (formatName == "binary") {
+    return BINARY;
+  }
+
+  ABORT("Unknown stat log format '%s'; expected 'text' or 'binary'",
+        formatName.c_str());
+  return TEXT;
+}
+
+StatLogFile::StatLogFile(const std::string& filename, Format _format)
+  : format(_format),
+    fileID(__sync_fetch_and_add(&nextFileID, 1)),
+    file(filename) {
+
+  file.open(File::WRITE, true);
+
+  if (format == BINARY) {
+    writeBuffer.append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    appendUInt32(BINARY_VERSION);
+  }
+}
+
+StatLogFile::~StatLogFile() {
+  if (file.isOpened()) {
+    close();
+  }
+}
+
+void StatLogFile::writeLogLine(
+  const LogLineDescriptor& descriptor, va_list ap) {
+
+  if (format == TEXT) {
+    int status = vdprintf(
+      file.getFileDescriptor(), descriptor.getLogLineFormatString().c_str(),
+      ap);
+
+    ABORT_IF(status < 0, "vdprintf() failed with error %d: %s", errno,
+             strerror(errno));
+    return;
+  }
+
+  uint32_t schemaID = getSchemaID(descriptor);
+
+  const std::vector<LogLineFieldInfo::FieldType>& fieldTypes =
+    descriptor.getVariableFieldTypes();
+
+  // String IDs are assigned while reading the arguments, and a new string's
+  // entry must precede the record that uses it, so gather the record's values
+  // before appending it.
+  uint64_t numFields = fieldTypes.size();
+  recordValues.resize(numFields);
+  // A schema can consist entirely of constant fields
+  uint64_t* values = recordValues.empty() ? NULL : &recordValues[0];
+
+  for (uint64_t i = 0; i < numFields; i++) {
+    switch (fieldTypes[i]) {
+    case LogLineFieldInfo::UNSIGNED_INTEGER:
+      values[i] = va_arg(ap, uint64_t);
+      break;
+    case LogLineFieldInfo::SIGNED_INTEGER:
+      values[i] = static_cast<uint64_t>(va_arg(ap, int64_t));
+      break;
+    case LogLineFieldInfo::STRING:
+      values[i] = getStringID(va_arg(ap, const char*));
+      break;
+    }
+  }
+
+  appendUInt32(schemaID);
+  if (numFields > 0) {
+    writeBuffer.append(
+      reinterpret_cast<const char*>(values), numFields * sizeof(uint64_t));
+  }
+
+  if (writeBuffer.size() >= WRITE_BUFFER_SIZE) {
+    flush();
+  }
+}
+
+void StatLogFile::close() {
+  flush();
+  file.sync();
+  file.close();
+}
+
+uint32_t StatLogFile::getSchemaID(const LogLineDescriptor& descriptor) {
+  if (descriptor.schemaFileID == fileID) {
+    return descriptor.schemaID;
+  }
+
+  // This descriptor hasn't been written to this file before, but an identical
+  // one may have been; LogDataContainers create new descriptors every time
+  // they are drained.
+  Json::FastWriter jsonWriter;
+  std::string schemaString(jsonWriter.write(descriptor.getSchemaJson()));
+
+  StringIDMap::iterator iter = schemaIDs.find(schemaString);
+
+  uint32_t schemaID = 0;
+
+  if (iter != schemaIDs.end()) {
+    schemaID = iter->second;
+  } else {
+    schemaID = schemaIDs.size() + 1;
+    ABORT_IF(schemaID >= STRING_ENTRY, "Too many stat log schemas");
+    schemaIDs.insert(iter, std::make_pair(schemaString, schemaID));
+
+    appendUInt32(SCHEMA_ENTRY);
+    appendUInt32(schemaID);
+    appendUInt32(schemaString.size());
+    writeBuffer.append(schemaString);
+  }
+
+  descriptor.schemaFileID = fileID;
+  descriptor.schemaID = schemaID;
+
+  return schemaID;
+}
+
+uint32_t StatLogFile::getStringID(const char* str) {
+  std::string key(str);
+
+  StringIDMap::iterator iter = stringIDs.find(key);
+
+  if (iter != stringIDs.end()) {
+    return iter->second;
+  }
+
+  uint32_t stringID = stringIDs.size();
+  stringIDs.insert(iter, std::make_pair(key, stringID));
+
+  appendUInt32(STRING_ENTRY);
+  appendUInt32(stringID);
+  appendUInt32(key.size());
+  writeBuffer.append(key);
+
+  return stringID;
+}
+
+void StatLogFile::appendUInt32(uint32_t value) {
+  writeBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void StatLogFile::flush() {
+  if (!writeBuffer.empty()) {
+    file.write(
+      reinterpret_cast<const uint8_t*>(writeBuffer.data()),
+      writeBuffer.size());
+    writeBuffer.clear();
+  }
+}
@@ -0,0 +1,122 @@
+#ifndef THEMIS_STAT_LOG_FILE_H
+#define THEMIS_STAT_LOG_FILE_H
+
+#include <map>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "core/File.h"
+
+class LogLineDescriptor;
+
+/**
+   StatLogFile is the file that StatWriter writes log lines to. It can write
+   either the traditional tab-separated text format or a compact binary
+   format.
+
+   A binary stat log starts with an 8-byte magic string and a 32-bit version
+   number, followed by a stream of entries. Each entry starts with a 32-bit
+   tag:
+
+   - SCHEMA_ENTRY: followed by a 32-bit schema ID, a 32-bit length and that
+     many bytes of JSON from LogLineDescriptor::getSchemaJson(). A log line's
+     schema is written just before its first record.
+   - STRING_ENTRY: followed by a 32-bit string ID, a 32-bit length and that
+     many bytes of string. Each distinct string field value, like a phase name,
+     is written once and referred to by its ID thereafter.
+   - Any other tag is a record for the schema with that ID, and is followed by
+     one 64-bit value per variable field in the schema. String fields are
+     stored as string IDs.
+
+   All integers are stored in host byte order.
+
+   Binary records are fixed-width for a given schema and need no formatting,
+   so they are much cheaper to write and to read back than text log lines.
+   StatLogReader reads both formats and turns binary records back into the
+   log lines that would have been written in the text format.
+ */
+class StatLogFile {
+public:
+  /// The formats in which a stat log can be written
+  enum Format {
+    TEXT,
+    BINARY
+  };
+
+  /// The magic string at the start of every binary stat log
+  static const char BINARY_MAGIC[8];
+
+  /// The version of the binary stat log format
+  static const uint32_t BINARY_VERSION = 1;
+
+  /// Tag for an entry that defines a schema
+  static const uint32_t SCHEMA_ENTRY = 0xFFFFFFFF;
+
+  /// Tag for an entry that defines a string
+  static const uint32_t STRING_ENTRY = 0xFFFFFFFE;
+
+  /// Parse a format name
+  /**
+     \param formatName either "text" or "binary"
+
+     \return the corresponding format
+   */
+  static Format parseFormat(const std::string& formatName);
+
+  /// Constructor
+  /**
+     Creates or truncates the file and opens it for writing.
+
+     \param filename the path to the file
+
+     \param format the format in which to write log lines
+   */
+  StatLogFile(const std::string& filename, Format format);
+
+  /// Destructor
+  /**
+     Closes the file if it hasn't been closed already.
+   */
+  virtual ~StatLogFile();
+
+  /// Write a log line to the file
+  /**
+     \param descriptor the log line's descriptor
+
+     \param ap the log line's variable fields, in order of their declaration
+   */
+  void writeLogLine(const LogLineDescriptor& descriptor, va_list ap);
+
+  /// Flush any buffered records, sync the file to disk and close it
+  void close();
+
+private:
+  typedef std::map<std::string, uint32_t> StringIDMap;
+
+  /// Binary records are buffered until at least this many bytes are pending
+  static const uint64_t WRITE_BUFFER_SIZE = 1048576;
+
+  uint32_t getSchemaID(const LogLineDescriptor& descriptor);
+  uint32_t getStringID(const char* str);
+
+  void appendUInt32(uint32_t value);
+
+  void flush();
+
+  static uint64_t nextFileID;
+
+  const Format format;
+  const uint64_t fileID;
+
+  File file;
+
+  std::string writeBuffer;
+  std::vector<uint64_t> recordValues;
+
+  StringIDMap schemaIDs;
+  StringIDMap stringIDs;
+};
+
+#endif // THEMIS_STAT_LOG_FILE_H
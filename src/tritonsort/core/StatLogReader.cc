@@ -0,0 +1,213 @@
+#define __STDC_FORMAT_MACROS 1
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/StatLogFile.h"
+#include "core/StatLogReader.h"
+#include "core/TritonSortAssert.h"
+#include "core/Utils.h"
+#include "third-party/jsoncpp.h"
+
+StatLogReader::StatLogReader(const std::string& _filename)
+  : filename(_filename),
+    file(NULL),
+    binary(false),
+    lineBuffer(NULL),
+    lineBufferSize(0) {
+
+  file = fopen(filename.c_str(), "r");
+  ABORT_IF(file == NULL, "fopen() of stat log '%s' failed with error %d: %s",
+           filename.c_str(), errno, strerror(errno));
+
+  // Check for the binary format's magic string, and rewind if it isn't there.
+  char magic[sizeof(StatLogFile::BINARY_MAGIC)];
+  if (fread(magic, sizeof(magic), 1, file) == 1 &&
+      memcmp(magic, StatLogFile::BINARY_MAGIC, sizeof(magic)) == 0) {
+    binary = true;
+
+    uint32_t version = readUInt32();
+    ABORT_IF(version != StatLogFile::BINARY_VERSION, "Stat log '%s' has "
+             "binary format version %u, but only version %u is supported",
+             filename.c_str(), version, StatLogFile::BINARY_VERSION);
+  } else {
+    rewind(file);
+  }
+}
+
+StatLogReader::~StatLogReader() {
+  if (file != NULL) {
+    fclose(file);
+    file = NULL;
+  }
+
+  if (lineBuffer != NULL) {
+    free(lineBuffer);
+    lineBuffer = NULL;
+  }
+}
+
+bool StatLogReader::isBinary() const {
+  return binary;
+}
+
+bool StatLogReader::getNextLine(std::string& line) {
+  line.clear();
+
+  if (!binary) {
+    ssize_t lineLength = getline(&lineBuffer, &lineBufferSize, file);
+
+    if (lineLength >= 0) {
+      if (lineLength > 0 && lineBuffer[lineLength - 1] == '\n') {
+        lineLength--;
+      }
+      line.assign(lineBuffer, lineLength);
+    }
+
+    return lineLength >= 0;
+  }
+
+  while (true) {
+    uint32_t tag = 0;
+
+    if (fread(&tag, sizeof(tag), 1, file) != 1) {
+      ABORT_IF(ferror(file), "Reading stat log '%s' failed",
+               filename.c_str());
+      return false;
+    }
+
+    if (tag == StatLogFile::SCHEMA_ENTRY) {
+      readSchemaEntry();
+    } else if (tag == StatLogFile::STRING_ENTRY) {
+      readStringEntry();
+    } else {
+      readRecord(tag, line);
+      return true;
+    }
+  }
+}
+
+void StatLogReader::readSchemaEntry() {
+  uint32_t schemaID = readUInt32();
+  std::string schemaString(readString());
+
+  Json::Value schemaJson;
+  loadJsonString(schemaString.c_str(), schemaString.size(), schemaJson);
+
+  Schema& schema = schemas[schemaID];
+  schema.clear();
+
+  const Json::Value& fields = schemaJson["fields"];
+
+  for (Json::Value::const_iterator iter = fields.begin();
+       iter != fields.end(); iter++) {
+    const Json::Value& fieldJson = *iter;
+
+    Field field;
+    field.constant = fieldJson.isMember("value");
+
+    const std::string& typeName = fieldJson["type"].asString();
+    if (typeName == "uint") {
+      field.type = LogLineFieldInfo::UNSIGNED_INTEGER;
+    } else if (typeName == "int") {
+      field.type = LogLineFieldInfo::SIGNED_INTEGER;
+    } else {
+      field.type = LogLineFieldInfo::STRING;
+    }
+
+    if (field.constant) {
+      field.value = fieldJson["value"].asString();
+    }
+
+    schema.push_back(field);
+  }
+}
+
+void StatLogReader::readStringEntry() {
+  uint32_t stringID = readUInt32();
+  strings[stringID] = readString();
+}
+
+void StatLogReader::readRecord(uint32_t schemaID, std::string& line) {
+  SchemaMap::const_iterator schemaIter = schemas.find(schemaID);
+  ABORT_IF(schemaIter == schemas.end(), "Stat log '%s' has a record for "
+           "undefined schema %u", filename.c_str(), schemaID);
+
+  const Schema& schema = schemaIter->second;
+
+  uint64_t numVariableFields = 0;
+  for (Schema::const_iterator iter = schema.begin(); iter != schema.end();
+       iter++) {
+    if (!iter->constant) {
+      numVariableFields++;
+    }
+  }
+
+  recordValues.resize(numVariableFields);
+  if (numVariableFields > 0) {
+    readBytes(&recordValues[0], numVariableFields * sizeof(uint64_t));
+  }
+
+  std::vector<uint64_t>::const_iterator valueIter = recordValues.begin();
+  char numberBuffer[32];
+
+  for (Schema::const_iterator iter = schema.begin(); iter != schema.end();
+       iter++) {
+    if (iter != schema.begin()) {
+      line.push_back('\t');
+    }
+
+    if (iter->constant) {
+      line.append(iter->value);
+      continue;
+    }
+
+    uint64_t value = *valueIter;
+    valueIter++;
+
+    switch (iter->type) {
+    case LogLineFieldInfo::UNSIGNED_INTEGER:
+      snprintf(numberBuffer, sizeof(numberBuffer), "%" PRIu64, value);
+      line.append(numberBuffer);
+      break;
+    case LogLineFieldInfo::SIGNED_INTEGER:
+      snprintf(numberBuffer, sizeof(numberBuffer), "%" PRId64,
+               static_cast<int64_t>(value));
+      line.append(numberBuffer);
+      break;
+    case LogLineFieldInfo::STRING: {
+      StringMap::const_iterator stringIter = strings.find(value);
+      ABORT_IF(stringIter == strings.end(), "Stat log '%s' refers to "
+               "undefined string %llu", filename.c_str(), value);
+      line.append(stringIter->second);
+      break;
+    }
+    }
+  }
+}
+
+void StatLogReader::readBytes(void* buffer, uint64_t size) {
+  if (size > 0) {
+    ABORT_IF(fread(buffer, size, 1, file) != 1, "Stat log '%s' is truncated",
+             filename.c_str());
+  }
+}
+
+uint32_t StatLogReader::readUInt32() {
+  uint32_t value = 0;
+  readBytes(&value, sizeof(value));
+  return value;
+}
+
+std::string StatLogReader::readString() {
+  uint32_t length = readUInt32();
+
+  std::string str(length, '\0');
+  if (length > 0) {
+    readBytes(&str[0], length);
+  }
+
+  return str;
+}
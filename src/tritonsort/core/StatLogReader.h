@@ -0,0 +1,77 @@
+#ifndef THEMIS_STAT_LOG_READER_H
+#define THEMIS_STAT_LOG_READER_H
+
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "core/LogLineFieldInfo.h"
+
+/**
+   StatLogReader reads a stat log written by StatWriter one log line at a
+   time. Text logs are read line by line. Binary logs (see StatLogFile) are
+   decoded, and each record is turned back into exactly the log line that
+   would have been written in the text format, so tools like loggrep work the
+   same way regardless of which format a log was written in.
+ */
+class StatLogReader {
+public:
+  /// Constructor
+  /**
+     Opens the log and detects its format.
+
+     \param filename the path to the stat log
+   */
+  StatLogReader(const std::string& filename);
+
+  /// Destructor
+  virtual ~StatLogReader();
+
+  /// \return true if the log is in the binary format
+  bool isBinary() const;
+
+  /// Read the next log line
+  /**
+     \param[out] line the log line, without its trailing newline
+
+     \return false if there are no more log lines
+   */
+  bool getNextLine(std::string& line);
+
+private:
+  struct Field {
+    bool constant;
+    LogLineFieldInfo::FieldType type;
+    std::string value;
+  };
+
+  typedef std::vector<Field> Schema;
+  typedef std::map<uint32_t, Schema> SchemaMap;
+  typedef std::map<uint32_t, std::string> StringMap;
+
+  void readSchemaEntry();
+  void readStringEntry();
+  void readRecord(uint32_t schemaID, std::string& line);
+
+  void readBytes(void* buffer, uint64_t size);
+  uint32_t readUInt32();
+  std::string readString();
+
+  const std::string filename;
+
+  FILE* file;
+  bool binary;
+
+  // Reused by getline() for text logs
+  char* lineBuffer;
+  size_t lineBufferSize;
+
+  SchemaMap schemas;
+  StringMap strings;
+
+  std::vector<uint64_t> recordValues;
+};
+
+#endif // THEMIS_STAT_LOG_READER_H
@@ -62,10 +62,12 @@ StatLogger::~StatLogger() {
 
 void StatLogger::init() {
   largestRegisteredStatID = 0;
-  data = new (themis::memcheck) LogDataContainer(logLineDescriptor);
 
   statLoggerID = StatWriter::registerLogger();
 
+  data = new (themis::memcheck) LogDataContainer(
+    logLineDescriptor, statLoggerID);
+
   setNextStatPushTime();
 }
 
@@ -51,13 +51,11 @@ StatSummary* StatSummary::newEmptyCopy() const {
 }
 
 void StatSummary::writeStatsToFile(
-  File& file, LogLineDescriptor& logLineDescriptor,
+  StatLogFile& file, LogLineDescriptor& logLineDescriptor,
   const std::string& phaseName, uint64_t epoch) const {
 
   const char* phaseNameCStr = phaseName.c_str();
 
-  int fileDescriptor = file.getFileDescriptor();
-
   uint64_t mean = std::floor(streaming_mean);
   uint64_t variance;
   // Avoid division by 0.
@@ -69,18 +67,18 @@ void StatSummary::writeStatsToFile(
   else
     variance = sum_of_squares_of_mean_differences / count;
 
-  logLineDescriptor.writeLogLineToFile(
-    fileDescriptor, phaseNameCStr, epoch, "min", min);
-  logLineDescriptor.writeLogLineToFile(
-    fileDescriptor, phaseNameCStr, epoch, "max", max);
-  logLineDescriptor.writeLogLineToFile(
-    fileDescriptor, phaseNameCStr, epoch, "sum", sum);
-  logLineDescriptor.writeLogLineToFile(
-    fileDescriptor, phaseNameCStr, epoch, "count", count);
-  logLineDescriptor.writeLogLineToFile(
-    fileDescriptor, phaseNameCStr, epoch, "mean", mean);
-  logLineDescriptor.writeLogLineToFile(
-    fileDescriptor, phaseNameCStr, epoch, "variance", variance);
+  logLineDescriptor.writeLogLine(
+    &file, phaseNameCStr, epoch, "min", min);
+  logLineDescriptor.writeLogLine(
+    &file, phaseNameCStr, epoch, "max", max);
+  logLineDescriptor.writeLogLine(
+    &file, phaseNameCStr, epoch, "sum", sum);
+  logLineDescriptor.writeLogLine(
+    &file, phaseNameCStr, epoch, "count", count);
+  logLineDescriptor.writeLogLine(
+    &file, phaseNameCStr, epoch, "mean", mean);
+  logLineDescriptor.writeLogLine(
+    &file, phaseNameCStr, epoch, "variance", variance);
 }
 
 bool StatSummary::isReadyForWriting() const {
@@ -6,6 +6,7 @@
 #include "core/MemoryUtils.h"
 #include "core/Params.h"
 #include "core/ScopedLock.h"
+#include "core/StatLogFile.h"
 #include "core/StatWriter.h"
 #include "core/StatusPrinter.h"
 #include "core/TritonSortAssert.h"
@@ -13,6 +14,7 @@
 
 pthread_mutex_t StatWriter::singletonWriterLock = PTHREAD_MUTEX_INITIALIZER;
 StatWriter* StatWriter::singletonWriter = NULL;
+__thread std::string* StatWriter::threadPhaseName = NULL;
 
 StatWriter::StatWriter(Params& _params)
     : themis::Thread("StatWriter"),
@@ -43,8 +45,13 @@ StatWriter::StatWriter(Params& _params)
   std::ostringstream oss;
   oss << logDirName << '/' << hostname << "_stats.log";
 
-  logFile = new File(oss.str());
-  logFile->open(File::WRITE, true);
+  StatLogFile::Format logFormat = StatLogFile::TEXT;
+  if (params.contains("STAT_LOG_FORMAT")) {
+    logFormat = StatLogFile::parseFormat(
+      params.get<std::string>("STAT_LOG_FORMAT"));
+  }
+
+  logFile = new StatLogFile(oss.str(), logFormat);
 
   oss.str("");
   oss << logDirName << '/' << hostname << "_stat_descriptors.log";
@@ -55,7 +62,6 @@ StatWriter::StatWriter(Params& _params)
 
 StatWriter::~StatWriter() {
   if (logFile != NULL) {
-    logFile->sync();
     logFile->close();
     delete logFile;
     logFile = NULL;
@@ -180,6 +186,26 @@ void StatWriter::setCurrentPhaseName(const std::string& phaseName) {
   }
 }
 
+void StatWriter::setThreadPhaseName(const std::string& phaseName) {
+  clearThreadPhaseName();
+  threadPhaseName = new (themis::memcheck) std::string(phaseName);
+}
+
+void StatWriter::clearThreadPhaseName() {
+  if (threadPhaseName != NULL) {
+    delete threadPhaseName;
+    threadPhaseName = NULL;
+  }
+}
+
+std::string StatWriter::getThreadPhaseName() {
+  if (threadPhaseName != NULL) {
+    return *threadPhaseName;
+  } else {
+    return "";
+  }
+}
+
 void StatWriter::setCurrentEpoch(uint64_t epoch) {
   ScopedLock scopedLock(&singletonWriterLock);
 
@@ -201,7 +227,27 @@ uint64_t StatWriter::registerLogger() {
 uint64_t StatWriter::registerStatLogger() {
   ScopedLock lock(&nextStatLoggerIDLock);
 
-  return nextStatLoggerID++;
+  uint64_t loggerID = nextStatLoggerID++;
+
+  if (threadPhaseName != NULL) {
+    loggerPhaseNames[loggerID] = *threadPhaseName;
+  }
+
+  return loggerID;
+}
+
+const std::string& StatWriter::getPhaseNameForLogger(uint64_t loggerID) {
+  ScopedLock lock(&nextStatLoggerIDLock);
+
+  // Entries are never removed, so references to them stay valid after the
+  // lock is released
+  LoggerPhaseNameMap::iterator iter = loggerPhaseNames.find(loggerID);
+
+  if (iter != loggerPhaseNames.end()) {
+    return iter->second;
+  } else {
+    return currentPhaseName;
+  }
 }
 
 void StatWriter::setPhaseName(const std::string& phaseName) {
@@ -350,7 +396,9 @@ void* StatWriter::thread(void* args) {
           LogLineDescriptor* descriptor = iter->second;
 
           container->writeStatsToFile(
-            *logFile, *descriptor, currentPhaseName, currentEpoch);
+            *logFile, *descriptor,
+            getPhaseNameForLogger(container->getParentLoggerID()),
+            currentEpoch);
         }
 
         if (container != NULL) {
@@ -371,7 +419,6 @@ void* StatWriter::thread(void* args) {
            "them was found to be non-empty");
 
   // We're done writing to the log file
-  logFile->sync();
   logFile->close();
   delete logFile;
   logFile = NULL;
@@ -428,11 +475,11 @@ void StatWriter::safeMutexDestroy(pthread_mutex_t& mutex) {
 
 void StatWriter::drainLogDataContainerQueue() {
   LogDataContainer* dataContainer = NULL;
-  int logFileDescriptor = logFile->getFileDescriptor();
 
   while (logDataContainerQueue.pop(dataContainer)) {
     dataContainer->write(
-      logFileDescriptor, currentPhaseName, currentEpoch);
+      *logFile, getPhaseNameForLogger(dataContainer->getParentLoggerID()),
+      currentEpoch);
     dataContainer->addLogLineDescriptions(logLineDescriptionSet);
     delete dataContainer;
   }
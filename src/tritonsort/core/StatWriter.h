@@ -18,12 +18,18 @@
 
 class File;
 class Params;
+class StatLogFile;
 
 /**
    The statistic writer is responsible for periodically gathering statistic
    data from StatLoggers and writing that statistic data to disk. It is also
    responsible for garbage-collecting StatLoggers' statistic containers when
    the StatLoggers destruct.
+
+   Statistics are written in the text format by default. Setting
+   STAT_LOG_FORMAT to "binary" writes them in StatLogFile's binary format
+   instead, which is much cheaper to write and to read back. Either way, the
+   log file is named <hostname>_stats.log and can be read with StatLogReader.
  */
 class StatWriter : private themis::Thread {
 public:
@@ -42,6 +48,24 @@ public:
    */
   static void setCurrentPhaseName(const std::string& phaseName);
 
+  /// Log statistics from the calling thread's StatLoggers under a given phase
+  /**
+     StatLoggers registered by the calling thread after this call log under
+     the given phase name rather than the writer's current phase, so that a
+     pipeline running concurrently with another phase (see
+     OVERLAP_PHASE_THREE) has its statistics attributed to its own phase.
+
+     \param phaseName the phase name for the calling thread's StatLoggers
+   */
+  static void setThreadPhaseName(const std::string& phaseName);
+
+  /// Stop overriding the phase name for the calling thread's StatLoggers
+  static void clearThreadPhaseName();
+
+  /// \return the calling thread's phase name, or the empty string if it
+  /// hasn't set one with setThreadPhaseName
+  static std::string getThreadPhaseName();
+
   /// Set the epoch number associated with logged data
   /**
      \sa StatWriter::setEpoch
@@ -148,6 +172,10 @@ private:
 
   void drainLogDataContainerQueue();
 
+  /// \return the phase name under which the given logger's statistics are
+  /// written
+  const std::string& getPhaseNameForLogger(uint64_t loggerID);
+
   /// Add a stat container to this writer
   /**
      This writer is responsible for garbage-collecting the container.
@@ -176,15 +204,23 @@ private:
   void addLogLineDescriptorInternal(
     uint64_t loggerID, uint64_t statID, LogLineDescriptor* logLineDescriptor);
 
+  typedef std::map<uint64_t, std::string> LoggerPhaseNameMap;
+
   static pthread_mutex_t singletonWriterLock;
   static StatWriter* singletonWriter;
 
+  static __thread std::string* threadPhaseName;
+
   // StatLoggers are assigned unique IDs starting from 1. The ID 0 is assigned
   // to all loggers that attempt to register with a nonexistent singleton
   // StatWriter
   pthread_mutex_t nextStatLoggerIDLock;
   uint64_t nextStatLoggerID;
 
+  // Phase names for loggers registered by threads that set their own phase
+  // name. Guarded by nextStatLoggerIDLock.
+  LoggerPhaseNameMap loggerPhaseNames;
+
   ThreadSafeQueue<StatContainerInterface*> statContainerQueue;
   ThreadSafeQueue<LogDataContainer*> logDataContainerQueue;
 
@@ -207,7 +243,7 @@ private:
   bool stopWriter;
   bool writerRunning;
 
-  File* logFile;
+  StatLogFile* logFile;
   File* descriptorsFile;
 
   std::set<Json::Value> logLineDescriptionSet;
@@ -1,7 +1,11 @@
+#include <errno.h>
+
 #include "core/ScopedLock.h"
 #include "core/ThreadSafeWorkQueue.h"
+#include "core/Timer.h"
 
-ThreadSafeWorkQueue::ThreadSafeWorkQueue() {
+ThreadSafeWorkQueue::ThreadSafeWorkQueue()
+  : numWaitingForWork(0) {
   pthread_mutex_init(&lock, NULL);
   pthread_cond_init(&waitingForPush, NULL);
 }
@@ -14,9 +18,11 @@ ThreadSafeWorkQueue::~ThreadSafeWorkQueue() {
 void ThreadSafeWorkQueue::push(Resource* resource) {
   pthread_mutex_lock(&lock);
   queue.push(resource);
-  if (resource == NULL) {
+  if (resource == NULL || numWaitingForWork > 0) {
     // If multiple threads were waiting on this queue when the NULL gets pushed,
-    // we should wake them all because no more work units are coming.
+    // we should wake them all because no more work units are coming. Threads
+    // in waitForWork() don't consume the work unit they're woken for, so if
+    // any are waiting, wake everyone to avoid stranding a blockingPop().
     pthread_cond_broadcast(&waitingForPush);
   } else {
     // However if this is a regular work unit then just wake a single thread so
@@ -59,6 +65,37 @@ Resource* ThreadSafeWorkQueue::blockingPop() {
   return resource;
 }
 
+bool ThreadSafeWorkQueue::waitForWork(uint64_t timeoutMicros) {
+  pthread_mutex_lock(&lock);
+
+  if (queue.empty() && !queue.willNotReceiveMoreWork()) {
+    numWaitingForWork++;
+
+    if (timeoutMicros == 0) {
+      while (!queue.willNotReceiveMoreWork() && queue.empty()) {
+        pthread_cond_wait(&waitingForPush, &lock);
+      }
+    } else {
+      struct timespec deadline;
+      Timer::deadlineAfterMicros(timeoutMicros, deadline);
+
+      while (!queue.willNotReceiveMoreWork() && queue.empty()) {
+        if (pthread_cond_timedwait(&waitingForPush, &lock, &deadline) ==
+            ETIMEDOUT) {
+          break;
+        }
+      }
+    }
+
+    numWaitingForWork--;
+  }
+
+  bool workAvailable = !queue.empty() || queue.willNotReceiveMoreWork();
+  pthread_mutex_unlock(&lock);
+
+  return workAvailable;
+}
+
 uint64_t ThreadSafeWorkQueue::size() {
   pthread_mutex_lock(&lock);
   uint64_t queueSize = queue.size();
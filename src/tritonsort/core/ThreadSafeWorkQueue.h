@@ -14,6 +14,10 @@ public:
   /// the existence of more work.
   bool pop(Resource*& destResource, bool &noMoreWork);
   Resource* blockingPop();
+  /// Block until the queue is non-empty or will not receive more work, or
+  /// until timeoutMicros microseconds have passed. A timeout of 0 waits
+  /// indefinitely. Returns true if work (or end-of-work) is available.
+  bool waitForWork(uint64_t timeoutMicros);
   uint64_t size();
   uint64_t totalWorkSizeInBytes();
   bool empty();
@@ -23,6 +27,7 @@ public:
 private:
   pthread_mutex_t lock;
   pthread_cond_t waitingForPush;
+  uint64_t numWaitingForWork;
 
   WorkQueue queue;
 };
@@ -82,6 +82,22 @@ public:
     return (((uint64_t) time.tv_sec) * 1000000) + time.tv_usec;
   }
 
+  /// Get an absolute deadline for timed waits such as pthread_cond_timedwait
+  /**
+     \param timeoutMicros the number of microseconds from now until the
+     deadline
+
+     \param[out] deadline the deadline as an absolute time since the UNIX
+     epoch
+   */
+  static inline void deadlineAfterMicros(
+    uint64_t timeoutMicros, struct timespec& deadline) {
+    uint64_t deadlineMicros = posixTimeInMicros() + timeoutMicros;
+
+    deadline.tv_sec = deadlineMicros / 1000000;
+    deadline.tv_nsec = (deadlineMicros % 1000000) * 1000;
+  }
+
 protected:
   /// Start timestamp (microsecond since UNIX epoch)
   uint64_t startTime;
@@ -59,15 +59,13 @@ bool TimerStatCollection::isReadyForWriting() const {
 }
 
 void TimerStatCollection::writeStatsToFile(
-  File& file, LogLineDescriptor& logLineDescriptor,
+  StatLogFile& file, LogLineDescriptor& logLineDescriptor,
   const std::string& phaseName, uint64_t epoch) const {
 
   TRITONSORT_ASSERT(startTimes.size() == stopTimes.size() &&
          stopTimes.size() == elapsedTimes.size(),
          "Stop, start and elapsed time lists should be the same length");
 
-  int fileDescriptor = file.getFileDescriptor();
-
   std::list<uint64_t>::const_iterator startIter = startTimes.begin();
   std::list<uint64_t>::const_iterator stopIter = stopTimes.begin();
   std::list<uint64_t>::const_iterator elapsedIter = elapsedTimes.begin();
@@ -75,8 +73,8 @@ void TimerStatCollection::writeStatsToFile(
   const char* phaseNameCStr = phaseName.c_str();
 
   while (startIter != startTimes.end()) {
-    logLineDescriptor.writeLogLineToFile(
-      fileDescriptor, phaseNameCStr, epoch, *startIter, *stopIter,
+    logLineDescriptor.writeLogLine(
+      &file, phaseNameCStr, epoch, *startIter, *stopIter,
       *elapsedIter);
 
     startIter++;
@@ -33,7 +33,7 @@ public:
   void add(const Timer& timer);
 
   void writeStatsToFile(
-    File& file, LogLineDescriptor& logLineDescriptor,
+    StatLogFile& file, LogLineDescriptor& logLineDescriptor,
     const std::string& phaseName, uint64_t epoch) const;
 
   void addLogLineDescriptions(std::set<Json::Value>& descriptionSet) const;
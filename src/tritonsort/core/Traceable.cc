@@ -0,0 +1,12 @@
+#include "core/BufferTracer.h"
+#include "core/Traceable.h"
+
+Traceable::Traceable()
+  : traceID(BufferTracer::newTraceID()) {
+}
+
+Traceable::~Traceable() {
+  if (traceID != 0) {
+    BufferTracer::trace(traceID, BufferTracer::DESTROY);
+  }
+}
@@ -0,0 +1,33 @@
+#ifndef THEMIS_TRACEABLE_H
+#define THEMIS_TRACEABLE_H
+
+#include <stdint.h>
+
+/**
+   A Traceable work unit carries a trace ID that BufferTracer uses to follow it
+   through the pipeline. Trace IDs are only assigned when tracing is enabled;
+   otherwise the trace ID is 0 and the work unit is never traced.
+
+   \sa BufferTracer
+ */
+class Traceable {
+public:
+  /// Constructor
+  Traceable();
+
+  /// Destructor
+  /**
+     Records that the work unit was destroyed.
+   */
+  virtual ~Traceable();
+
+  /// \return the work unit's trace ID, or 0 if it isn't being traced
+  uint64_t getTraceID() const {
+    return traceID;
+  }
+
+private:
+  const uint64_t traceID;
+};
+
+#endif // THEMIS_TRACEABLE_H
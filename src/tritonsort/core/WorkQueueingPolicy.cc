@@ -56,6 +56,12 @@ void WorkQueueingPolicy::batchDequeue(
   sourceWorkQueue.moveWorkToQueue(destinationQueue);
 }
 
+bool WorkQueueingPolicy::waitForWork(
+  uint64_t requestedQueueID, uint64_t timeoutMicros) {
+  uint64_t queueID = getDequeueID(requestedQueueID);
+  return workQueues[queueID].waitForWork(timeoutMicros);
+}
+
 void WorkQueueingPolicy::teardown() {
   // Push NULL to all work queues so that workers know to shut down
   workQueues.beginThreadSafeIterate();
@@ -47,6 +47,9 @@ public:
   /// \sa WorkQueueingPolicyInterface::batchDequeue
   void batchDequeue(uint64_t queueID, WorkQueue& destinationQueue);
 
+  /// \sa WorkQueueingPolicyInterface::waitForWork
+  bool waitForWork(uint64_t queueID, uint64_t timeoutMicros);
+
   /// \sa WorkQueueingPolicyInterface::teardown
   void teardown();
 
@@ -53,6 +53,22 @@ public:
    */
   virtual void batchDequeue(uint64_t queueID, WorkQueue& destinationQueue) = 0;
 
+  /**
+     Block until a particular queue has work to dequeue or will never receive
+     more work, without dequeueing anything. Workers that poll for work with
+     nonBlockingDequeue() or batchDequeue() use this to sleep until work
+     arrives instead of sleeping for a fixed interval.
+
+     \param queueID the queue to wait on.
+
+     \param timeoutMicros the maximum amount of time to wait in microseconds,
+     or 0 to wait until work arrives
+
+     \return true if the queue has work or will never receive more work, false
+     if the wait timed out
+   */
+  virtual bool waitForWork(uint64_t queueID, uint64_t timeoutMicros) = 0;
+
   /**
      Instruct the policy to teardown, which means no more work units will be
      received.
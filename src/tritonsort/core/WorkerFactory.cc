@@ -5,6 +5,7 @@
 #include "core/MemoryAllocatorInterface.h"
 #include "core/NamedObjectCollection.h"
 #include "core/Params.h"
+#include "core/SizeClassCachingMemoryAllocator.h"
 #include "core/TritonSortAssert.h"
 #include "core/WorkerFactory.h"
 
@@ -112,6 +113,18 @@ BaseWorker* WorkerFactory::constructNewWorker(
     allocator = new CachingMemoryAllocator(bufferSize, numBuffers);
     // Make sure we save this allocator so we can destroy it later.
     customAllocators.push_back(allocator);
+  } else if (params.contains(
+               "BUFFER_CACHE_SIZE." + phaseName + "." + stageName) &&
+             params.get<uint64_t>(
+               "BUFFER_CACHE_SIZE." + phaseName + "." + stageName) > 0) {
+    // Give this worker its own cache of recently freed buffers in front of
+    // the shared allocator.
+    uint64_t cacheSize = params.get<uint64_t>(
+      "BUFFER_CACHE_SIZE." + phaseName + "." + stageName);
+
+    allocator = new SizeClassCachingMemoryAllocator(
+      memoryAllocator, cacheSize, stageName, id);
+    customAllocators.push_back(allocator);
   }
 
   BaseWorker* worker = factoryMethod(
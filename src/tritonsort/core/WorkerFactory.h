@@ -32,6 +32,12 @@ class Params;
    subdivision of stage memory between NUMA domains since first-touch should
    ensure that a worker W only allocates and accesses memory on its own NUMA
    node.
+
+   Workers that allocate buffers of varying sizes can instead be given a
+   SizeClassCachingMemoryAllocator in front of the shared allocator by setting
+   BUFFER_CACHE_SIZE.phase.stage to the number of bytes each worker in the
+   stage may cache. A cache size of 0 leaves the worker on the shared
+   allocator.
  */
 class WorkerFactory {
 public:
@@ -1,6 +1,8 @@
 #include <limits.h>
+#include <sstream>
 
 #include "core/BaseWorker.h"
+#include "core/BufferTracer.h"
 #include "core/MemoryUtils.h"
 #include "core/ScopedLock.h"
 #include "core/Timer.h"
@@ -19,9 +21,16 @@ WorkerTracker::WorkerTracker(
     teardownComplete(false),
     workerFactory(NULL),
     prevTrackers(0),
-    completedPrevTrackers(0) {
+    completedPrevTrackers(0),
+    queuedWorkUnits(0),
+    queuedBytes(0) {
 
   ResourceMonitor::registerClient(this, stageName.c_str());
+  ResourceMonitor::registerCounter(
+    &queuedWorkUnits, "%s.%s.queued_work_units", phaseName.c_str(),
+    stageName.c_str());
+  ResourceMonitor::registerCounter(
+    &queuedBytes, "%s.%s.queued_bytes", phaseName.c_str(), stageName.c_str());
 
   numWorkers = params.get<uint64_t>(
     "NUM_WORKERS." + phaseName + "." + stageName);
@@ -30,6 +39,11 @@ WorkerTracker::WorkerTracker(
 
   pthread_mutex_init(&waitForWorkersLock, NULL);
 
+  traceStageID = BufferTracer::registerStage(phaseName + "." + stageName);
+
+  perfCountersEnabled = params.contains("PERF_COUNTERS") &&
+    params.get<bool>("PERF_COUNTERS");
+
   if (workQueueingPolicyFactory == NULL) {
     // No factory provided. Create a default factory and then create the policy.
     WorkQueueingPolicyFactory factory;
@@ -44,6 +58,8 @@ WorkerTracker::WorkerTracker(
 
 WorkerTracker::~WorkerTracker() {
   ResourceMonitor::unregisterClient(this);
+  ResourceMonitor::unregisterCounter(&queuedWorkUnits);
+  ResourceMonitor::unregisterCounter(&queuedBytes);
 
   if (workQueueingPolicy != NULL) {
     delete workQueueingPolicy;
@@ -133,6 +149,16 @@ void WorkerTracker::addWorkUnit(Resource* workUnit) {
       workQueueingPolicy->teardown();
     }
   } else {
+    if (BufferTracer::isEnabled()) {
+      // Trace before enqueueing, since a worker may consume and destroy the
+      // work unit as soon as it is in the queue.
+      BufferTracer::trace(workUnit, BufferTracer::ENQUEUE, traceStageID);
+    }
+
+    // Count the work unit before enqueueing it for the same reason.
+    __sync_fetch_and_add(&queuedWorkUnits, 1);
+    __sync_fetch_and_add(&queuedBytes, workUnit->getCurrentSize());
+
     workQueueingPolicy->enqueue(workUnit);
   }
 }
@@ -222,6 +248,16 @@ void WorkerTracker::createWorkers() {
     }
 
     worker->setTracker(this);
+    worker->setTraceStageID(traceStageID);
+
+    std::ostringstream counterPrefix;
+    counterPrefix << phaseName << '.' << stageName << '.' << i;
+    worker->setMonitorCounterPrefix(counterPrefix.str());
+
+    if (perfCountersEnabled) {
+      worker->enablePerfCounters();
+    }
+
     workers.push(worker);
   }
 }
@@ -294,15 +330,44 @@ const std::string& WorkerTracker::getStageName() const {
 }
 
 void WorkerTracker::getNewWork(uint64_t queueID, WorkQueue& destWorkUnitQueue) {
+  uint64_t initialWorkUnits = destWorkUnitQueue.size();
+  uint64_t initialBytes = destWorkUnitQueue.totalWorkSizeInBytes();
+
   workQueueingPolicy->batchDequeue(queueID, destWorkUnitQueue);
+
+  __sync_fetch_and_sub(
+    &queuedWorkUnits, destWorkUnitQueue.size() - initialWorkUnits);
+  __sync_fetch_and_sub(
+    &queuedBytes, destWorkUnitQueue.totalWorkSizeInBytes() - initialBytes);
 }
 
 Resource* WorkerTracker::getNewWork(uint64_t queueID) {
-  return workQueueingPolicy->dequeue(queueID);
+  Resource* workUnit = workQueueingPolicy->dequeue(queueID);
+
+  if (workUnit != NULL) {
+    logDequeued(workUnit);
+  }
+
+  return workUnit;
 }
 
 bool WorkerTracker::attemptGetNewWork(uint64_t queueID, Resource*& workUnit) {
-  return workQueueingPolicy->nonBlockingDequeue(queueID, workUnit);
+  bool gotWork = workQueueingPolicy->nonBlockingDequeue(queueID, workUnit);
+
+  if (gotWork && workUnit != NULL) {
+    logDequeued(workUnit);
+  }
+
+  return gotWork;
+}
+
+void WorkerTracker::logDequeued(Resource* workUnit) {
+  __sync_fetch_and_sub(&queuedWorkUnits, 1);
+  __sync_fetch_and_sub(&queuedBytes, workUnit->getCurrentSize());
+}
+
+bool WorkerTracker::waitForWork(uint64_t queueID, uint64_t timeoutMicros) {
+  return workQueueingPolicy->waitForWork(queueID, timeoutMicros);
 }
 
 void WorkerTracker::spawnWorkers() {
@@ -210,6 +210,9 @@ public:
   /// \sa WorkerTrackerInterface::attemptGetNewWork
   virtual bool attemptGetNewWork(uint64_t queueID, Resource*& workUnit);
 
+  /// \sa WorkerTrackerInterface::waitForWork
+  virtual bool waitForWork(uint64_t queueID, uint64_t timeoutMicros);
+
 private:
   /**
      Spawn all worker threads managed by this tracker.
@@ -219,6 +222,9 @@ private:
   uint64_t addDownstreamTrackerReturningID(
     WorkerTrackerInterface* downstreamTracker);
 
+  /// Remove a dequeued work unit from the queued work counts
+  void logDequeued(Resource* workUnit);
+
   Timer stageRuntimeTimer;
 
   StatLogger logger;
@@ -252,6 +258,12 @@ private:
 
   WorkQueueingPolicyInterface* workQueueingPolicy;
 
+  // The stage ID used when recording buffer trace events
+  uint64_t traceStageID;
+
+  // If true, workers count hardware events while they run
+  bool perfCountersEnabled;
+
   uint64_t numWorkers;
 
   WorkerFactory* workerFactory;
@@ -262,6 +274,12 @@ private:
 
   uint64_t prevTrackers;
   uint64_t completedPrevTrackers;
+
+  // The number and total size of work units waiting in this tracker's queues,
+  // streamed by the ResourceMonitor. Updated atomically, since many workers
+  // enqueue and dequeue concurrently.
+  uint64_t queuedWorkUnits;
+  uint64_t queuedBytes;
 };
 
 #endif //_TRITONSORT_WORKER_TRACKER_H
@@ -144,6 +144,18 @@ public:
      \return true if the queue had work, and false if the queue was empty
    */
   virtual bool attemptGetNewWork(uint64_t queueID, Resource*& workUnit) = 0;
+
+  /// Block until a work queue has work or will never receive more work
+  /**
+     \param queueID the unique ID associated with the queue
+
+     \param timeoutMicros the maximum amount of time to wait in microseconds,
+     or 0 to wait indefinitely
+
+     \return true if the queue has work or will never receive more work, and
+     false if the wait timed out
+   */
+  virtual bool waitForWork(uint64_t queueID, uint64_t timeoutMicros) = 0;
 };
 
 #endif // TRITONSORT_WORKER_TRACKER_INTERFACE_H
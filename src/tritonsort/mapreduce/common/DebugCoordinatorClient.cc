@@ -1,19 +1,52 @@
+#include <list>
+#include <sstream>
+
 #include "common/MainUtils.h"
 #include "core/Glob.h"
 #include "core/Params.h"
+#include "core/Utils.h"
 #include "mapreduce/common/DebugCoordinatorClient.h"
 #include "mapreduce/common/JobInfo.h"
 #include "mapreduce/common/ReadRequest.h"
 
+static uint64_t getDebugJobID(const Params& params) {
+  std::list<uint64_t> jobIDList;
+  parseCommaDelimitedList< uint64_t, std::list<uint64_t> >(
+    jobIDList, params.get<std::string>("JOB_IDS"));
+
+  ABORT_IF(jobIDList.size() != 1, "Debug mode runs exactly one job, but "
+           "JOB_IDS lists %llu", jobIDList.size());
+
+  return jobIDList.front();
+}
+
+static std::string getDebugOutputDirectory(uint64_t jobID) {
+  std::ostringstream oss;
+  oss << "local:///job_" << jobID;
+  return oss.str();
+}
+
 DebugCoordinatorClient::DebugCoordinatorClient(
   const Params& params, const std::string& phaseName, uint64_t _diskID)
   : numPartitions(params.get<uint64_t>("NUM_PARTITIONS")),
     diskID(_diskID),
-    outputDirectory("local:///job_0") {
-  // Pull our disk out of the input disk list.
+    jobID(getDebugJobID(params)),
+    numPeers(params.get<uint64_t>("NUM_PEERS")),
+    mapFunction(params.get<std::string>("DEBUG_MAP_FUNCTION")),
+    reduceFunction(params.get<std::string>("DEBUG_REDUCE_FUNCTION")),
+    partitionFunction(params.get<std::string>("DEBUG_PARTITION_FUNCTION")),
+    outputDirectory(getDebugOutputDirectory(jobID)) {
+  // Pull our disk out of the input disk list. Clients created for purposes
+  // other than reading input (fetching job info, for example) have no input
+  // disks.
   StringList disks;
   std::string inputDiskListParam = "INPUT_DISK_LIST." + phaseName;
-  getDiskList(disks, inputDiskListParam, &params);
+  if (params.contains(inputDiskListParam) ||
+      params.contains(inputDiskListParam + "_FILE")) {
+    getDiskList(disks, inputDiskListParam, &params);
+  }
+
+  nextFile = files.begin();
   uint64_t diskCount = 0;
   for (StringList::iterator iter = disks.begin(); iter != disks.end();
        iter++, diskCount++) {
@@ -36,7 +69,7 @@ ReadRequest* DebugCoordinatorClient::getNextReadRequest() {
   }
 
   ReadRequest* readRequest = new ReadRequest(*nextFile, diskID);
-  readRequest->jobIDs.insert(0);
+  readRequest->jobIDs.insert(jobID);
   nextFile++;
 
   return readRequest;
@@ -46,7 +79,8 @@ JobInfo* DebugCoordinatorClient::getJobInfo(uint64_t jobID) {
   // There's only one job in debug mode, and its properties are specified in
   // params so load them.
   JobInfo* jobInfo = new JobInfo(
-    jobID, "", "", "", "", "", "", 0, numPartitions);
+    jobID, "", "", "", mapFunction, reduceFunction, partitionFunction, 0,
+    numPartitions);
   return jobInfo;
 }
 
@@ -77,8 +111,10 @@ void DebugCoordinatorClient::setNumPartitions(
 }
 
 void DebugCoordinatorClient::waitOnBarrier(const std::string& barrierName) {
-  // Barriers not supported in debug mode.
-  ABORT("Barrier");
+  // A single node has nobody to wait for; barriers between several nodes
+  // aren't supported in debug mode.
+  ABORT_IF(numPeers > 1, "Barrier '%s' across %llu nodes isn't supported in "
+           "debug mode", barrierName.c_str(), numPeers);
 }
 
 void DebugCoordinatorClient::uploadSampleStatistics(
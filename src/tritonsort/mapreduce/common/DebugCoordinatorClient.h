@@ -12,9 +12,14 @@ class Params;
    information from the global params object:
 
    INPUT_DISK_LIST: list of input disks to read input files from. Files should
-   be named *input_*
+   be in a job_<job ID> directory and end in .partition
+
+   JOB_IDS: the ID of the one job being run
 
    NUM_PARTITIONS: the number of partitions, or files, for the job
+
+   DEBUG_MAP_FUNCTION, DEBUG_REDUCE_FUNCTION, DEBUG_PARTITION_FUNCTION: the
+   names of the job's map, reduce and partition functions
  */
 class DebugCoordinatorClient : public CoordinatorClientInterface {
 public:
@@ -68,7 +73,7 @@ public:
   /// Not implemented
   void setNumPartitions(uint64_t jobID, uint64_t numPartitions);
 
-  /// Not implemented
+  /// Returns immediately on a single node, aborts on more than one
   void waitOnBarrier(const std::string& barrierName);
 
   /// Not implemented
@@ -86,6 +91,12 @@ public:
 private:
   const uint64_t numPartitions;
   const uint64_t diskID;
+  const uint64_t jobID;
+  const uint64_t numPeers;
+
+  const std::string mapFunction;
+  const std::string reduceFunction;
+  const std::string partitionFunction;
 
   StringList files;
   StringList::iterator nextFile;
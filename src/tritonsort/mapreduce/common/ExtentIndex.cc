@@ -0,0 +1,130 @@
+#include "core/File.h"
+#include "core/TritonSortAssert.h"
+#include "mapreduce/common/ExtentIndex.h"
+
+static const std::string INDEX_SUFFIX(".index");
+static const std::string LARGE_INDEX_SUFFIX(".large.index");
+
+static bool endsWith(const std::string& str, const std::string& suffix) {
+  return str.size() > suffix.size() &&
+    str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string ExtentIndex::getIndexFilename(const std::string& logFilename) {
+  return logFilename + INDEX_SUFFIX;
+}
+
+std::string ExtentIndex::getLargeIndexFilename(
+  const std::string& logFilename) {
+  return logFilename + LARGE_INDEX_SUFFIX;
+}
+
+std::string ExtentIndex::getLogFilename(const std::string& indexFilename) {
+  // Check for the longer suffix first, since it ends in the shorter one.
+  const std::string& suffix = endsWith(indexFilename, LARGE_INDEX_SUFFIX) ?
+    LARGE_INDEX_SUFFIX : INDEX_SUFFIX;
+
+  ABORT_IF(!endsWith(indexFilename, suffix),
+           "Extent index filename '%s' doesn't end in '%s'",
+           indexFilename.c_str(), suffix.c_str());
+
+  return indexFilename.substr(0, indexFilename.size() - suffix.size());
+}
+
+uint64_t ExtentIndex::getTotalLength(const ExtentVector& extents) {
+  uint64_t totalLength = 0;
+
+  for (ExtentVector::const_iterator iter = extents.begin();
+       iter != extents.end(); iter++) {
+    totalLength += iter->length;
+  }
+
+  return totalLength;
+}
+
+void ExtentIndex::addExtent(
+  uint64_t partitionID, uint64_t offset, uint64_t length) {
+
+  if (length == 0) {
+    return;
+  }
+
+  ExtentVector& extents = partitions[partitionID];
+
+  if (!extents.empty() &&
+      extents.back().offset + extents.back().length == offset) {
+    // This extent continues the partition's last extent.
+    extents.back().length += length;
+  } else {
+    Extent extent;
+    extent.offset = offset;
+    extent.length = length;
+    extents.push_back(extent);
+  }
+}
+
+const ExtentIndex::PartitionExtentMap& ExtentIndex::getPartitions() const {
+  return partitions;
+}
+
+uint64_t ExtentIndex::getPartitionSize(uint64_t partitionID) const {
+  PartitionExtentMap::const_iterator iter = partitions.find(partitionID);
+
+  if (iter == partitions.end()) {
+    return 0;
+  }
+
+  return getTotalLength(iter->second);
+}
+
+void ExtentIndex::write(const std::string& filename) const {
+  std::vector<uint64_t> records;
+
+  for (PartitionExtentMap::const_iterator partitionIter = partitions.begin();
+       partitionIter != partitions.end(); partitionIter++) {
+    const ExtentVector& extents = partitionIter->second;
+
+    for (ExtentVector::const_iterator iter = extents.begin();
+         iter != extents.end(); iter++) {
+      records.push_back(partitionIter->first);
+      records.push_back(iter->offset);
+      records.push_back(iter->length);
+    }
+  }
+
+  File indexFile(filename);
+  indexFile.open(File::WRITE, true);
+
+  if (!records.empty()) {
+    indexFile.write(
+      reinterpret_cast<const uint8_t*>(&records[0]),
+      records.size() * sizeof(uint64_t));
+  }
+
+  indexFile.sync();
+  indexFile.close();
+}
+
+void ExtentIndex::read(const std::string& filename) {
+  File indexFile(filename);
+  indexFile.open(File::READ);
+
+  uint64_t fileSize = indexFile.getCurrentSize();
+  uint64_t recordSize = 3 * sizeof(uint64_t);
+
+  ABORT_IF(fileSize % recordSize != 0, "Extent index '%s' is %llu bytes, "
+           "which isn't a multiple of the %llu-byte record size",
+           filename.c_str(), fileSize, recordSize);
+
+  std::vector<uint64_t> records(fileSize / sizeof(uint64_t));
+
+  if (!records.empty()) {
+    indexFile.read(reinterpret_cast<uint8_t*>(&records[0]), fileSize);
+  }
+
+  indexFile.close();
+
+  for (uint64_t i = 0; i < records.size(); i += 3) {
+    addExtent(records[i], records[i + 1], records[i + 2]);
+  }
+}
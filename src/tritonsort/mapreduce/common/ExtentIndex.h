@@ -0,0 +1,105 @@
+#ifndef MAPRED_EXTENT_INDEX_H
+#define MAPRED_EXTENT_INDEX_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+   An ExtentIndex records where each partition's data lives within an extent
+   log, a single large file on a disk to which the writer appends buffers for
+   many partitions in the order they arrive. Each buffer appended to the log
+   becomes an extent of its partition, and a partition can be read back by
+   reading its extents in order.
+
+   Extents that directly follow the previous extent of the same partition in
+   the log are merged, so a partition written in one long run has a single
+   extent no matter how many buffers it was written in.
+
+   The index is stored in its own file as a sequence of (partition ID, offset,
+   length) records, each made of three native-endian 64-bit integers. The
+   extents of partitions larger than LARGE_PARTITION_THRESHOLD are stored in a
+   separate large partition index instead, so that phase two can skip them and
+   phase three can split them.
+ */
+class ExtentIndex {
+public:
+  /// A contiguous range of a partition's data in the log
+  struct Extent {
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  typedef std::vector<Extent> ExtentVector;
+  typedef std::map<uint64_t, ExtentVector> PartitionExtentMap;
+
+  /**
+     \param logFilename the filename of an extent log
+
+     \return the filename of the log's index
+   */
+  static std::string getIndexFilename(const std::string& logFilename);
+
+  /**
+     \param logFilename the filename of an extent log
+
+     \return the filename of the log's large partition index
+   */
+  static std::string getLargeIndexFilename(const std::string& logFilename);
+
+  /**
+     \param indexFilename the filename of an extent log's index or large
+     partition index
+
+     \return the filename of the log that the index describes
+   */
+  static std::string getLogFilename(const std::string& indexFilename);
+
+  /**
+     \param extents a list of extents
+
+     \return the total length of the extents in bytes
+   */
+  static uint64_t getTotalLength(const ExtentVector& extents);
+
+  /**
+     Record that some of a partition's data was written to the log.
+
+     \param partitionID the partition to which the data belongs
+
+     \param offset the offset in the log at which the data was written
+
+     \param length the length of the data in bytes
+   */
+  void addExtent(uint64_t partitionID, uint64_t offset, uint64_t length);
+
+  /// \return every partition in the index along with its extents
+  const PartitionExtentMap& getPartitions() const;
+
+  /**
+     \param partitionID the partition to query
+
+     \return the total number of bytes recorded for the partition
+   */
+  uint64_t getPartitionSize(uint64_t partitionID) const;
+
+  /**
+     Write the index to a file, replacing the file if it exists.
+
+     \param filename the file to which to write the index
+   */
+  void write(const std::string& filename) const;
+
+  /**
+     Add the extents stored in a file written by write() to the index.
+
+     \param filename the file from which to read the index
+   */
+  void read(const std::string& filename);
+
+private:
+  PartitionExtentMap partitions;
+};
+
+#endif // MAPRED_EXTENT_INDEX_H
@@ -0,0 +1,17 @@
+#include <limits>
+
+#include "mapreduce/common/ExtentReadRequest.h"
+
+ExtentReadRequest::ExtentReadRequest(
+  const std::string& logFilename, uint64_t diskID, uint64_t jobID,
+  uint64_t _partitionID, const ExtentIndex::ExtentVector& _extents)
+  : ReadRequest(
+      std::set<uint64_t>(), FILE, "INVALID",
+      std::numeric_limits<uint32_t>::max(), logFilename,
+      _extents.empty() ? 0 : _extents.front().offset,
+      ExtentIndex::getTotalLength(_extents), diskID),
+    partitionID(_partitionID),
+    extents(_extents) {
+
+  jobIDs.insert(jobID);
+}
@@ -0,0 +1,37 @@
+#ifndef MAPRED_EXTENT_READ_REQUEST_H
+#define MAPRED_EXTENT_READ_REQUEST_H
+
+#include "mapreduce/common/ExtentIndex.h"
+#include "mapreduce/common/ReadRequest.h"
+
+/**
+   A request to read one partition out of an extent log. The partition is made
+   up of the given extents of the log, in order, and its length is their total
+   length. Its offset is the offset of the first extent, so a request for a
+   single extent is an ordinary byte range that any reader can read.
+
+   \sa ExtentIndex
+ */
+class ExtentReadRequest : public ReadRequest {
+public:
+  /// Constructor
+  /**
+     \param logFilename the path to the extent log on the local filesystem
+
+     \param diskID the ID of the disk to read from
+
+     \param jobID the job that should consume the partition
+
+     \param partitionID the partition to read
+
+     \param extents the partition's extents in the log
+   */
+  ExtentReadRequest(
+    const std::string& logFilename, uint64_t diskID, uint64_t jobID,
+    uint64_t partitionID, const ExtentIndex::ExtentVector& extents);
+
+  const uint64_t partitionID;
+  const ExtentIndex::ExtentVector extents;
+};
+
+#endif // MAPRED_EXTENT_READ_REQUEST_H
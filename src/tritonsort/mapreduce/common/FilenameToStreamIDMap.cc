@@ -40,13 +40,7 @@ void FilenameToStreamIDMap::addFilenameWithSize(
   const std::string& filename, const std::set<uint64_t>& jobIDs,
   uint64_t size, uint64_t offset) {
 
-  std::ostringstream oss;
-  oss << filename;
-  if (offset > 0) {
-    // Read requests from different offsets are technically different streams.
-    oss << ".offset_" << offset;
-  }
-  std::string fullFilename = oss.str();
+  std::string fullFilename = getStreamName(filename, offset);
 
   ScopedLock scopedLock(&lock);
 
@@ -63,10 +57,31 @@ void FilenameToStreamIDMap::addFilenameWithSize(
     streamInfo->addJobID(*iter);
   }
 
+  FilenameToPartitionIDMap::iterator partitionIter =
+    partitionIDs.find(fullFilename);
+
+  if (partitionIter != partitionIDs.end()) {
+    streamInfo->setPartitionID(partitionIter->second);
+  }
+
   fileToStreamMap[fullFilename] = streamInfo;
   streamIDToStreamInfoMap[streamID] = streamInfo;
 }
 
+void FilenameToStreamIDMap::setPartitionID(
+  const std::string& filename, uint64_t offset, uint64_t partitionID) {
+
+  std::string fullFilename = getStreamName(filename, offset);
+
+  ScopedLock scopedLock(&lock);
+
+  ABORT_IF(fileToStreamMap.find(fullFilename) != fileToStreamMap.end(),
+           "Can't set the partition ID of stream '%s' after it's been added",
+           fullFilename.c_str());
+
+  partitionIDs[fullFilename] = partitionID;
+}
+
 const StreamInfo& FilenameToStreamIDMap::getStreamInfo(uint64_t streamID) {
   ScopedLock scopedLock(&lock);
 
@@ -82,13 +97,7 @@ const StreamInfo& FilenameToStreamIDMap::getStreamInfo(uint64_t streamID) {
 const StreamInfo& FilenameToStreamIDMap::getStreamInfo(
   const std::string& filename, uint64_t offset) {
 
-  std::ostringstream oss;
-  oss << filename;
-  if (offset > 0) {
-    // Read requests from different offsets are technically different streams.
-    oss << ".offset_" << offset;
-  }
-  std::string fullFilename = oss.str();
+  std::string fullFilename = getStreamName(filename, offset);
 
   ScopedLock scopedLock(&lock);
 
@@ -100,3 +109,16 @@ const StreamInfo& FilenameToStreamIDMap::getStreamInfo(
 
   return *(iter->second);
 }
+
+std::string FilenameToStreamIDMap::getStreamName(
+  const std::string& filename, uint64_t offset) {
+
+  std::ostringstream oss;
+  oss << filename;
+  if (offset > 0) {
+    // Read requests from different offsets are technically different streams.
+    oss << ".offset_" << offset;
+  }
+
+  return oss.str();
+}
@@ -66,6 +66,24 @@ public:
     const std::string& filename, const std::set<uint64_t>& jobIDs,
     uint64_t size, uint64_t offset=0);
 
+  /// Record the partition to which a stream that hasn't been added yet
+  /// belongs
+  /**
+     Streams read from partition files get their partition ID from the
+     filename. Streams read from other files, such as byte ranges of an extent
+     log, need to be told their partition ID before a reader adds them.
+
+     Thread-safe.
+
+     \param filename the filename of the stream
+
+     \param offset the offset into the file at which the stream starts
+
+     \param partitionID the partition to which the stream's data belongs
+   */
+  void setPartitionID(
+    const std::string& filename, uint64_t offset, uint64_t partitionID);
+
   /// Get information about a stream
   /**
      \param streamID the stream ID of the stream
@@ -89,11 +107,16 @@ public:
 private:
   typedef std::map<std::string, StreamInfo*> FilenameToStreamMap;
   typedef std::map<uint64_t, StreamInfo*> StreamIDToStreamInfoMap;
+  typedef std::map<std::string, uint64_t> FilenameToPartitionIDMap;
+
+  static std::string getStreamName(
+    const std::string& filename, uint64_t offset);
 
   pthread_mutex_t lock;
   uint64_t lastStreamID;
   FilenameToStreamMap fileToStreamMap;
   StreamIDToStreamInfoMap streamIDToStreamInfoMap;
+  FilenameToPartitionIDMap partitionIDs;
 };
 
 #endif // MAPRED_FILENAME_TO_STREAM_ID_MAP_H
@@ -5,14 +5,16 @@
 StreamInfo::StreamInfo(uint64_t _streamID, const std::string& _filename)
   : streamID(_streamID),
     filename(_filename),
-    size(std::numeric_limits<uint64_t>::max()) {
+    size(std::numeric_limits<uint64_t>::max()),
+    partitionID(std::numeric_limits<uint64_t>::max()) {
 }
 
 StreamInfo::StreamInfo(
   uint64_t _streamID, const std::string& _filename, uint64_t _size)
   : streamID(_streamID),
     filename(_filename),
-    size(_size) {
+    size(_size),
+    partitionID(std::numeric_limits<uint64_t>::max()) {
 }
 
 void StreamInfo::addJobID(uint64_t jobID) {
@@ -34,3 +36,11 @@ const std::string& StreamInfo::getFilename() const {
 uint64_t StreamInfo::getSize() const {
   return size;
 }
+
+void StreamInfo::setPartitionID(uint64_t _partitionID) {
+  partitionID = _partitionID;
+}
+
+uint64_t StreamInfo::getPartitionID() const {
+  return partitionID;
+}
@@ -51,11 +51,25 @@ public:
   /// \return the size of the stream if set, or uint64_t max otherwise
   uint64_t getSize() const;
 
+  /// Associate a partition ID with this stream
+  /**
+     Streams read from partition files get their partition ID from the
+     filename; this is for streams whose filenames don't carry one.
+
+     \param partitionID the partition to which this stream's data belongs
+   */
+  void setPartitionID(uint64_t partitionID);
+
+  /// \return the partition ID set with setPartitionID, or uint64_t max if
+  /// there isn't one
+  uint64_t getPartitionID() const;
+
 private:
   const uint64_t streamID;
   std::set<uint64_t> jobIDs;
   const std::string filename;
   const uint64_t size;
+  uint64_t partitionID;
 };
 
 
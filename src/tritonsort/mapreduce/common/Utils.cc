@@ -2,6 +2,7 @@
 #include <cmath>
 
 #include "common/AlignmentUtils.h"
+#include "core/StatusPrinter.h"
 #include "core/Params.h"
 #include "core/WorkerTracker.h"
 #include "mapreduce/common/CoordinatorClientFactory.h"
@@ -85,3 +86,21 @@ uint64_t setNumPartitions(
 
   return numPartitions;
 }
+
+uint64_t setNumPartitionsFromSampleStatistics(
+  uint64_t jobID, uint64_t numNodes,
+  CoordinatorClientInterface& coordinatorClient, const Params& params) {
+  uint64_t totalInputBytes;
+  uint64_t totalIntermediateBytes;
+  // Block until we have sample statistics from all nodes.
+  coordinatorClient.getSampleStatisticsSums(
+    jobID, numNodes, totalInputBytes, totalIntermediateBytes);
+
+  double intermediateToInputRatio = totalIntermediateBytes /
+    ((double) totalInputBytes);
+  StatusPrinter::add("Total # input bytes: %llu", totalInputBytes);
+  StatusPrinter::add("Estimated intermediate:input data size ratio: %.2f:1",
+                     intermediateToInputRatio);
+
+  return setNumPartitions(jobID, intermediateToInputRatio, params);
+}
@@ -3,6 +3,7 @@
 
 #include <string>
 
+class CoordinatorClientInterface;
 class Params;
 class WorkerTracker;
 
@@ -35,4 +36,24 @@ void loadReadRequests(
 uint64_t setNumPartitions(
   uint64_t jobID, double intermediateToInputRatio, const Params& params);
 
+/**
+   Block until sample statistics from every node are available, then use them
+   to set the number of partitions for a job. This should only be called on the
+   coordinator node; other nodes should ask the coordinator client for the
+   number of partitions instead.
+
+   \param jobID the ID of the job
+
+   \param numNodes the number of nodes in the cluster
+
+   \param coordinatorClient a coordinator client to fetch statistics from
+
+   \param params the global params object
+
+   \return the number of partitions
+ */
+uint64_t setNumPartitionsFromSampleStatistics(
+  uint64_t jobID, uint64_t numNodes,
+  CoordinatorClientInterface& coordinatorClient, const Params& params);
+
 #endif // MAPRED_UTILS_H
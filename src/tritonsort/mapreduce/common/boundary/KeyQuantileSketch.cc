@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/Comparison.h"
+#include "core/TritonSortAssert.h"
+#include "mapreduce/common/KVPairWriterInterface.h"
+#include "mapreduce/common/KeyValuePair.h"
+#include "mapreduce/common/boundary/KeyQuantileSketch.h"
+#include "mapreduce/common/buffers/KVPairBuffer.h"
+
+KeyQuantileSketch::KeyQuantileSketch(uint64_t _capacity)
+  : capacity(_capacity),
+    totalWeight(0),
+    numRetainedKeys(0),
+    totalCapacity(0) {
+  ABORT_IF(capacity < MIN_COMPACTOR_CAPACITY, "Quantile sketch capacity must "
+           "be at least %llu, but got %llu", MIN_COMPACTOR_CAPACITY, capacity);
+
+  compactors.resize(1);
+  totalCapacity = compactorCapacity(0);
+}
+
+bool KeyQuantileSketch::keyLessThan(
+  const WeightedKey& key1, const WeightedKey& key2) {
+  return compare(
+    reinterpret_cast<const uint8_t*>(key1.key.data()), key1.key.size(),
+    reinterpret_cast<const uint8_t*>(key2.key.data()), key2.key.size()) < 0;
+}
+
+bool KeyQuantileSketch::keyPointerLessThan(
+  const WeightedKey* key1, const WeightedKey* key2) {
+  return keyLessThan(*key1, *key2);
+}
+
+void KeyQuantileSketch::insert(
+  const uint8_t* key, uint32_t keyLength, uint64_t weight) {
+  if (weight == 0) {
+    // Keys with no weight have no effect on quantiles.
+    return;
+  }
+
+  insert(key, keyLength, weight, 0);
+  totalWeight += weight;
+
+  countKey(std::string(reinterpret_cast<const char*>(key), keyLength), weight);
+
+  compress();
+}
+
+void KeyQuantileSketch::insert(
+  const uint8_t* key, uint32_t keyLength, uint64_t weight, uint64_t level) {
+  if (level >= compactors.size()) {
+    compactors.resize(level + 1);
+
+    // Capacities depend on the number of compactors, so recompute them.
+    totalCapacity = 0;
+    for (uint64_t i = 0; i < compactors.size(); i++) {
+      totalCapacity += compactorCapacity(i);
+    }
+  }
+
+  Compactor& compactor = compactors[level];
+  compactor.resize(compactor.size() + 1);
+
+  WeightedKey& weightedKey = compactor.back();
+  weightedKey.key.assign(reinterpret_cast<const char*>(key), keyLength);
+  weightedKey.weight = weight;
+
+  numRetainedKeys++;
+}
+
+void KeyQuantileSketch::merge(const KeyQuantileSketch& other) {
+  for (uint64_t level = 0; level < other.compactors.size(); level++) {
+    const Compactor& compactor = other.compactors[level];
+
+    for (Compactor::const_iterator iter = compactor.begin();
+         iter != compactor.end(); iter++) {
+      insert(
+        reinterpret_cast<const uint8_t*>(iter->key.data()), iter->key.size(),
+        iter->weight, level);
+    }
+  }
+
+  totalWeight += other.totalWeight;
+
+  for (FrequentKeyMap::const_iterator iter = other.frequentKeys.begin();
+       iter != other.frequentKeys.end(); iter++) {
+    countKey(iter->first, iter->second);
+  }
+
+  compress();
+}
+
+void KeyQuantileSketch::serialize(KVPairWriterInterface& writer) const {
+  for (uint64_t level = 0; level < compactors.size(); level++) {
+    const Compactor& compactor = compactors[level];
+
+    for (Compactor::const_iterator iter = compactor.begin();
+         iter != compactor.end(); iter++) {
+      uint64_t value[2];
+      value[0] = iter->weight;
+      value[1] = level;
+
+      KeyValuePair kvPair;
+      kvPair.setKey(
+        reinterpret_cast<const uint8_t*>(iter->key.data()), iter->key.size());
+      kvPair.setValue(reinterpret_cast<const uint8_t*>(value), sizeof(value));
+      writer.write(kvPair);
+    }
+  }
+
+  for (FrequentKeyMap::const_iterator iter = frequentKeys.begin();
+       iter != frequentKeys.end(); iter++) {
+    uint64_t value[2];
+    value[0] = iter->second;
+    value[1] = FREQUENT_KEY_LEVEL;
+
+    KeyValuePair kvPair;
+    kvPair.setKey(
+      reinterpret_cast<const uint8_t*>(iter->first.data()), iter->first.size());
+    kvPair.setValue(reinterpret_cast<const uint8_t*>(value), sizeof(value));
+    writer.write(kvPair);
+  }
+}
+
+void KeyQuantileSketch::deserialize(KVPairBuffer& buffer) {
+  KeyValuePair kvPair;
+  while (buffer.getNextKVPair(kvPair)) {
+    uint64_t value[2];
+    ABORT_IF(kvPair.getValueLength() != sizeof(value), "Expected serialized "
+             "sketch tuples to have %llu-byte values, but got a %llu-byte "
+             "value", sizeof(value), kvPair.getValueLength());
+    memcpy(value, kvPair.getValue(), sizeof(value));
+
+    if (value[1] == FREQUENT_KEY_LEVEL) {
+      countKey(
+        std::string(
+          reinterpret_cast<const char*>(kvPair.getKey()),
+          kvPair.getKeyLength()), value[0]);
+    } else {
+      insert(kvPair.getKey(), kvPair.getKeyLength(), value[0], value[1]);
+      totalWeight += value[0];
+    }
+  }
+
+  compress();
+}
+
+uint64_t KeyQuantileSketch::writeBoundaries(
+  uint64_t numPartitions, KVPairWriterInterface& writer,
+  std::vector<uint64_t>& partitionWeights) const {
+  ABORT_IF(numRetainedKeys == 0, "Can't pick partition boundaries from an "
+           "empty quantile sketch");
+
+  // Sort every retained key, regardless of level, to form the sketch's
+  // approximation of the weighted key distribution.
+  WeightedKeyPointerVector sortedKeys;
+  sortedKeys.reserve(numRetainedKeys);
+  for (CompactorVector::const_iterator compactorIter = compactors.begin();
+       compactorIter != compactors.end(); compactorIter++) {
+    for (Compactor::const_iterator iter = compactorIter->begin();
+         iter != compactorIter->end(); iter++) {
+      sortedKeys.push_back(&(*iter));
+    }
+  }
+
+  // Counted keys that compaction dropped can still be heavy hitters, so make
+  // sure each of them is visited. They don't add any weight of their own.
+  Compactor countedKeys(frequentKeys.size());
+  Compactor::iterator countedKeyIter = countedKeys.begin();
+  for (FrequentKeyMap::const_iterator iter = frequentKeys.begin();
+       iter != frequentKeys.end(); iter++, countedKeyIter++) {
+    countedKeyIter->key = iter->first;
+    countedKeyIter->weight = 0;
+    sortedKeys.push_back(&(*countedKeyIter));
+  }
+
+  std::sort(sortedKeys.begin(), sortedKeys.end(),
+            &KeyQuantileSketch::keyPointerLessThan);
+
+  partitionWeights.assign(numPartitions, 0);
+
+  uint64_t partition = 0;
+  uint64_t unassignedWeight = totalWeight;
+  uint64_t numHeavyKeys = 0;
+
+  // Once the sketch's coarse weights have used up most of the weight, the
+  // remaining share can get arbitrarily small, so a heavy hitter must also
+  // hold at least an even share of the total weight.
+  uint64_t minimumHeavyWeight = std::max<uint64_t>(
+    totalWeight / numPartitions, 1);
+  std::string lastBoundary = sortedKeys.front()->key;
+  writeBoundary(lastBoundary, writer);
+
+  WeightedKeyPointerVector::iterator iter = sortedKeys.begin();
+  while (iter != sortedKeys.end()) {
+    // Combine every retained copy of this key. Their weight includes the
+    // weight of neighboring keys that were compacted away, so only the key's
+    // counter decides whether it's a heavy hitter.
+    const std::string& key = (*iter)->key;
+    uint64_t keyWeight = 0;
+    while (iter != sortedKeys.end() && (*iter)->key == key) {
+      keyWeight += (*iter)->weight;
+      iter++;
+    }
+
+    FrequentKeyMap::const_iterator counter = frequentKeys.find(key);
+    uint64_t countedWeight =
+      (counter == frequentKeys.end()) ? 0 : counter->second;
+
+    uint64_t& currentWeight = partitionWeights[partition];
+    if (partition + 1 < numPartitions && currentWeight > 0) {
+      uint64_t targetWeight = unassignedWeight / (numPartitions - partition);
+      if (currentWeight >= targetWeight ||
+          countedWeight >= std::max(targetWeight, minimumHeavyWeight)) {
+        // Start a new partition at this key.
+        unassignedWeight -= currentWeight;
+        partition++;
+        lastBoundary = key;
+        writeBoundary(lastBoundary, writer);
+      }
+    }
+
+    partitionWeights[partition] += keyWeight;
+
+    if (partition + 1 < numPartitions && iter != sortedKeys.end()) {
+      uint64_t targetWeight = unassignedWeight / (numPartitions - partition);
+      if (countedWeight >= std::max(targetWeight, minimumHeavyWeight)) {
+        // This is a heavy-hitter key, so end its partition immediately after
+        // it.
+        unassignedWeight -= partitionWeights[partition];
+        partition++;
+        lastBoundary = key;
+        lastBoundary.push_back('\0');
+        writeBoundary(lastBoundary, writer);
+        numHeavyKeys++;
+      }
+    }
+  }
+
+  // Pad out the boundary list if we ran out of keys.
+  for (partition++; partition < numPartitions; partition++) {
+    writeBoundary(lastBoundary, writer);
+  }
+
+  return numHeavyKeys;
+}
+
+void KeyQuantileSketch::writeBoundary(
+  const std::string& key, KVPairWriterInterface& writer) {
+  KeyValuePair kvPair;
+  kvPair.setKey(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+  kvPair.setValue(NULL, 0);
+  writer.write(kvPair);
+}
+
+uint64_t KeyQuantileSketch::getTotalWeight() const {
+  return totalWeight;
+}
+
+uint64_t KeyQuantileSketch::getNumRetainedKeys() const {
+  return numRetainedKeys;
+}
+
+uint64_t KeyQuantileSketch::getKeyWeight(
+  const uint8_t* key, uint32_t keyLength) const {
+  FrequentKeyMap::const_iterator iter = frequentKeys.find(
+    std::string(reinterpret_cast<const char*>(key), keyLength));
+
+  return (iter == frequentKeys.end()) ? 0 : iter->second;
+}
+
+uint64_t KeyQuantileSketch::compactorCapacity(uint64_t level) const {
+  uint64_t depth = compactors.size() - level - 1;
+  uint64_t levelCapacity = std::ceil(capacity * std::pow(2.0 / 3.0, depth));
+  if (levelCapacity < MIN_COMPACTOR_CAPACITY) {
+    levelCapacity = MIN_COMPACTOR_CAPACITY;
+  }
+
+  return levelCapacity;
+}
+
+void KeyQuantileSketch::compress() {
+  while (numRetainedKeys > totalCapacity) {
+    // Compact the lowest compactor that has reached its capacity. One must
+    // exist, since the sketch as a whole is over capacity.
+    uint64_t level = 0;
+    while (compactors[level].size() < compactorCapacity(level)) {
+      level++;
+    }
+
+    compact(level);
+  }
+}
+
+void KeyQuantileSketch::compact(uint64_t level) {
+  if (level + 1 == compactors.size()) {
+    compactors.resize(level + 2);
+
+    totalCapacity = 0;
+    for (uint64_t i = 0; i < compactors.size(); i++) {
+      totalCapacity += compactorCapacity(i);
+    }
+  }
+
+  Compactor& compactor = compactors[level];
+  Compactor& nextCompactor = compactors[level + 1];
+
+  std::sort(compactor.begin(), compactor.end(),
+            &KeyQuantileSketch::keyLessThan);
+
+  // If the compactor holds an odd number of keys, the largest stays behind.
+  uint64_t numPairedKeys = compactor.size() - (compactor.size() % 2);
+
+  for (uint64_t i = 0; i < numPairedKeys; i += 2) {
+    WeightedKey& first = compactor[i];
+    WeightedKey& second = compactor[i + 1];
+    uint64_t pairWeight = first.weight + second.weight;
+
+    // Keep one key of the pair with probability proportional to its weight,
+    // so that the expected weight below any key is unchanged.
+    uint64_t random = ((static_cast<uint64_t>(lrand48()) << 31) | lrand48()) %
+      pairWeight;
+
+    nextCompactor.resize(nextCompactor.size() + 1);
+    WeightedKey& promotedKey = nextCompactor.back();
+    promotedKey.key.swap(random < first.weight ? first.key : second.key);
+    promotedKey.weight = pairWeight;
+  }
+
+  compactor.erase(compactor.begin(), compactor.begin() + numPairedKeys);
+
+  numRetainedKeys -= numPairedKeys / 2;
+}
+
+void KeyQuantileSketch::countKey(const std::string& key, uint64_t weight) {
+  frequentKeys[key] += weight;
+
+  // Let the counters grow to twice the capacity before pruning them, so that
+  // each pruning pass frees room for many more keys.
+  if (frequentKeys.size() > 2 * capacity) {
+    pruneFrequentKeys();
+  }
+}
+
+void KeyQuantileSketch::pruneFrequentKeys() {
+  std::vector<uint64_t> counts;
+  counts.reserve(frequentKeys.size());
+  for (FrequentKeyMap::const_iterator iter = frequentKeys.begin();
+       iter != frequentKeys.end(); iter++) {
+    counts.push_back(iter->second);
+  }
+
+  std::nth_element(
+    counts.begin(), counts.begin() + capacity, counts.end(),
+    std::greater<uint64_t>());
+  uint64_t decrement = counts[capacity];
+
+  FrequentKeyMap::iterator iter = frequentKeys.begin();
+  while (iter != frequentKeys.end()) {
+    if (iter->second <= decrement) {
+      frequentKeys.erase(iter++);
+    } else {
+      iter->second -= decrement;
+      iter++;
+    }
+  }
+}
@@ -0,0 +1,196 @@
+#ifndef MAPRED_KEY_QUANTILE_SKETCH_H
+#define MAPRED_KEY_QUANTILE_SKETCH_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class KVPairBuffer;
+class KVPairWriterInterface;
+
+/**
+   KeyQuantileSketch is a mergeable, weighted quantile sketch over byte-string
+   keys, modeled on the KLL sketch of Karnin, Lang and Liberty. It is used in
+   phase zero to summarize the keys of the sampled map output, weighted by the
+   size of the tuples they came from, so that partition boundaries can be read
+   off of a small sketch rather than a fully sorted sample.
+
+   Retained keys are kept in a stack of compactors. When the sketch grows past
+   its capacity, the lowest compactor that is full is sorted and compacted:
+   adjacent keys are paired up, and one key from each pair is promoted to the
+   next compactor carrying the weight of both. The key to keep is chosen at
+   random in proportion to weight, so the expected weight below any key is
+   preserved and the total weight of the sketch is preserved exactly.
+
+   After compaction, a retained key's weight stands for its neighbors as well
+   as itself, so the quantile sketch can't tell a hot key from a dense range
+   of keys. Alongside the compactors, the sketch keeps a weighted Misra-Gries
+   summary of up to 2 * capacity key counters, which underestimates each key's
+   weight by at most the total weight divided by capacity. Heavy-hitter keys
+   are picked from these counters. The summary merges by adding counters and
+   pruning back down, so it survives merging as the compactors do.
+
+   Sketches serialize to tuples whose key is the retained key and whose value
+   is the key's weight and compactor level, so sketches from many nodes can be
+   sent through the usual buffer pipeline and merged on a single node. Key
+   counters are serialized the same way with a reserved level.
+ */
+class KeyQuantileSketch {
+public:
+  /// Constructor
+  /**
+     \param capacity the capacity of the top compactor and of the key counter
+     summary. Larger values retain more keys and produce more accurate
+     quantiles and heavy-hitter weights. Total memory use is roughly
+     5 * capacity keys.
+   */
+  KeyQuantileSketch(uint64_t capacity);
+
+  /**
+     Add a key to the sketch.
+
+     \param key the key to add
+
+     \param keyLength the length of the key in bytes
+
+     \param weight the weight of the key, typically the size of its tuple
+   */
+  void insert(const uint8_t* key, uint32_t keyLength, uint64_t weight);
+
+  /**
+     Merge another sketch into this one. The other sketch is not modified.
+
+     \param other the sketch to merge
+   */
+  void merge(const KeyQuantileSketch& other);
+
+  /**
+     Write every retained key in the sketch as a tuple. Each tuple's key is the
+     retained key, and its value is the key's weight followed by its compactor
+     level, both as 64-bit integers. Key counters follow, with a level of
+     FREQUENT_KEY_LEVEL.
+
+     \param writer the writer to which tuples will be written
+   */
+  void serialize(KVPairWriterInterface& writer) const;
+
+  /**
+     Merge every tuple in a buffer of tuples produced by serialize() into this
+     sketch.
+
+     \param buffer a buffer of serialized sketch tuples
+   */
+  void deserialize(KVPairBuffer& buffer);
+
+  /**
+     Write partition boundary keys read off of the sketch. Exactly numPartitions
+     keys are written in sorted order, each with an empty value, matching the
+     boundary list format expected by KeyPartitioner. The first key is the
+     smallest key in the sketch.
+
+     Boundaries are chosen greedily so that each partition receives roughly an
+     equal share of the weight that has not yet been assigned. A heavy-hitter
+     key, whose counted weight alone is at least a partition's share and at
+     least an even share of the total weight, is given a dedicated partition: it starts a new partition, and the next partition
+     starts at the smallest possible key greater than it (the key followed by
+     a zero byte). This keeps a single hot key from being lumped together with
+     a partition's worth of other keys. If the sketch runs out of keys before
+     every boundary is picked, the last boundary is repeated, producing empty
+     partitions.
+
+     \param numPartitions the number of partitions
+
+     \param writer the writer to which boundary keys will be written
+
+     \param[out] partitionWeights the predicted weight of each partition
+
+     \return the number of heavy-hitter keys that were given a dedicated
+     partition
+   */
+  uint64_t writeBoundaries(
+    uint64_t numPartitions, KVPairWriterInterface& writer,
+    std::vector<uint64_t>& partitionWeights) const;
+
+  /// \return the total weight of all keys inserted into the sketch
+  uint64_t getTotalWeight() const;
+
+  /// \return the number of keys currently retained by the sketch
+  uint64_t getNumRetainedKeys() const;
+
+  /**
+     \param key a key
+
+     \param keyLength the length of the key in bytes
+
+     \return the key's weight according to the key counters, which is at most
+     its true weight and at least its true weight minus the total weight
+     divided by the sketch's capacity
+   */
+  uint64_t getKeyWeight(const uint8_t* key, uint32_t keyLength) const;
+
+  /// The compactor level that marks a serialized key counter
+  static const uint64_t FREQUENT_KEY_LEVEL = 0xFFFFFFFFFFFFFFFFULL;
+
+private:
+  struct WeightedKey {
+    std::string key;
+    uint64_t weight;
+  };
+
+  typedef std::vector<WeightedKey> Compactor;
+  typedef std::vector<Compactor> CompactorVector;
+  typedef std::vector<const WeightedKey*> WeightedKeyPointerVector;
+  typedef std::map<std::string, uint64_t> FrequentKeyMap;
+
+  /// The smallest capacity any compactor can have
+  static const uint64_t MIN_COMPACTOR_CAPACITY = 2;
+
+  /// Orders weighted keys by key, matching the order used when sorting tuples
+  static bool keyLessThan(const WeightedKey& key1, const WeightedKey& key2);
+
+  /// Orders pointers to weighted keys by key
+  static bool keyPointerLessThan(
+    const WeightedKey* key1, const WeightedKey* key2);
+
+  /// Add a key with a given weight to a particular compactor
+  void insert(
+    const uint8_t* key, uint32_t keyLength, uint64_t weight, uint64_t level);
+
+  /**
+     \param level a compactor level
+
+     \return the capacity of the compactor at the given level, which shrinks
+     geometrically with distance from the top compactor
+   */
+  uint64_t compactorCapacity(uint64_t level) const;
+
+  /// Write a single boundary key with an empty value
+  static void writeBoundary(
+    const std::string& key, KVPairWriterInterface& writer);
+
+  /// Compact compactors until the sketch is within its capacity
+  void compress();
+
+  /// Compact a single compactor into the compactor above it
+  void compact(uint64_t level);
+
+  /// Add weight to a key's counter, pruning the counters if there are too
+  /// many of them
+  void countKey(const std::string& key, uint64_t weight);
+
+  /// Subtract the (capacity + 1)-th largest count from every counter and drop
+  /// the counters that reach zero, leaving at most capacity counters
+  void pruneFrequentKeys();
+
+  const uint64_t capacity;
+
+  CompactorVector compactors;
+  FrequentKeyMap frequentKeys;
+
+  uint64_t totalWeight;
+  uint64_t numRetainedKeys;
+  uint64_t totalCapacity;
+};
+
+#endif // MAPRED_KEY_QUANTILE_SKETCH_H
@@ -99,7 +99,7 @@ public:
   /**
      Reset the iterator position to the beginning of the buffer.
    */
-  void resetIterator();
+  virtual void resetIterator();
 
   /**
      Set the iterator to a given position. Used by the Reducer.
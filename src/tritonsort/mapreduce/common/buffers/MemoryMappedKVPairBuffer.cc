@@ -0,0 +1,54 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "MemoryMappedKVPairBuffer.h"
+#include "core/File.h"
+#include "core/MemoryAllocatorInterface.h"
+#include "core/TritonSortAssert.h"
+
+MemoryMappedKVPairBuffer::MemoryMappedKVPairBuffer(
+  File& file, bool populate, MemoryAllocatorInterface& _memoryAllocator,
+  void* _reservation)
+  : KVPairBuffer(
+    mapFile(file, file.getCurrentSize(), populate), file.getCurrentSize()),
+    mapping(const_cast<uint8_t*>(getRawBuffer())),
+    mappingSize(getCapacity()),
+    memoryAllocator(_memoryAllocator),
+    reservation(_reservation) {
+  // The mapping already holds the file's contents.
+  setCurrentSize(mappingSize);
+}
+
+MemoryMappedKVPairBuffer::~MemoryMappedKVPairBuffer() {
+  int status = munmap(mapping, mappingSize);
+  ABORT_IF(status != 0, "munmap() of %p failed with errno %d: %s", mapping,
+           errno, strerror(errno));
+
+  memoryAllocator.deallocate(reservation);
+}
+
+uint8_t* MemoryMappedKVPairBuffer::mapFile(
+  File& file, uint64_t size, bool populate) {
+
+  ABORT_IF(size == 0, "Can't memory-map empty file %s",
+           file.getFilename().c_str());
+
+  int flags = MAP_PRIVATE;
+  if (populate) {
+    flags |= MAP_POPULATE;
+  }
+
+  void* memory = mmap(
+    NULL, size, PROT_READ | PROT_WRITE, flags, file.getFileDescriptor(), 0);
+  ABORT_IF(memory == MAP_FAILED, "mmap() of %s failed with errno %d: %s",
+           file.getFilename().c_str(), errno, strerror(errno));
+
+  if (!populate) {
+    // Start reading the file in the background. This is only advice, so
+    // failure isn't fatal.
+    madvise(memory, size, MADV_WILLNEED);
+  }
+
+  return static_cast<uint8_t*>(memory);
+}
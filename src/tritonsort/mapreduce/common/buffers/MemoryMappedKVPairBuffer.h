@@ -0,0 +1,72 @@
+#ifndef MAPRED_MEMORY_MAPPED_KV_PAIR_BUFFER_H
+#define MAPRED_MEMORY_MAPPED_KV_PAIR_BUFFER_H
+
+#include "KVPairBuffer.h"
+
+class File;
+class MemoryAllocatorInterface;
+
+/**
+   A KVPairBuffer whose memory is a private mapping of an entire file of
+   key/value pairs, rather than memory from an allocator. The buffer starts
+   out full, holding the file's contents, and the mapping is removed when the
+   buffer is deleted.
+
+   Because the mapping is private, the buffer's contents can be modified (by
+   an in-place sort, for example) without changing the file; modified pages
+   are copied on write.
+
+   The mapped pages don't come from an allocator, so the creator reserves a
+   region the size of the file from one beforehand and hands it to the buffer.
+   The reservation is never touched; it only stands in for the mapping in the
+   allocator's accounting, and is released when the mapping is removed.
+ */
+class MemoryMappedKVPairBuffer : public KVPairBuffer {
+public:
+  /// Constructor
+  /**
+     \param file an open file to map; the file can be closed once the buffer
+     has been constructed
+
+     \param populate if true, read the whole file into memory before
+     returning; otherwise, ask the kernel to start reading it in the
+     background and fault in any pages it hasn't read on first access
+
+     \param memoryAllocator the allocator from which the reservation was
+     allocated
+
+     \param reservation a region at least as large as the file, allocated
+     from memoryAllocator, which the buffer deallocates when it is deleted
+   */
+  MemoryMappedKVPairBuffer(
+    File& file, bool populate, MemoryAllocatorInterface& memoryAllocator,
+    void* reservation);
+
+  /// Destructor
+  /**
+     Unmaps the file and releases the reservation.
+   */
+  virtual ~MemoryMappedKVPairBuffer();
+
+private:
+  /**
+     mmap() a file's contents.
+
+     \param file the file to map
+
+     \param size the size of the file
+
+     \param populate \sa MemoryMappedKVPairBuffer()
+
+     \return the start of the mapping
+   */
+  static uint8_t* mapFile(File& file, uint64_t size, bool populate);
+
+  uint8_t* const mapping;
+  const uint64_t mappingSize;
+
+  MemoryAllocatorInterface& memoryAllocator;
+  void* const reservation;
+};
+
+#endif // MAPRED_MEMORY_MAPPED_KV_PAIR_BUFFER_H
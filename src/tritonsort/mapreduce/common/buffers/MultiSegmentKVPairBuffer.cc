@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <limits>
+
+#include "MultiSegmentKVPairBuffer.h"
+#include "core/TritonSortAssert.h"
+
+MultiSegmentKVPairBuffer::MultiSegmentKVPairBuffer()
+  : KVPairBuffer(static_cast<uint8_t*>(NULL), 0),
+    totalSize(0),
+    currentSegment(0) {
+}
+
+MultiSegmentKVPairBuffer::~MultiSegmentKVPairBuffer() {
+  for (SegmentVector::iterator iter = segments.begin();
+       iter != segments.end(); iter++) {
+    delete *iter;
+  }
+
+  segments.clear();
+}
+
+void MultiSegmentKVPairBuffer::addSegment(KVPairBuffer* segment) {
+  ABORT_IF(segment == NULL, "Can't add a NULL segment");
+
+  segments.push_back(segment);
+  totalSize += segment->getCurrentSize();
+  addJobIDSet(segment->getJobIDs());
+  cached = false;
+}
+
+uint64_t MultiSegmentKVPairBuffer::getNumSegments() const {
+  return segments.size();
+}
+
+KVPairBuffer* MultiSegmentKVPairBuffer::getSegment(uint64_t segmentID) {
+  ABORT_IF(segmentID >= segments.size(), "Segment %llu out of range; there are "
+           "only %llu segments", segmentID, segments.size());
+  return segments[segmentID];
+}
+
+uint64_t MultiSegmentKVPairBuffer::getCurrentSize() const {
+  return totalSize;
+}
+
+bool MultiSegmentKVPairBuffer::getNextKVPair(KeyValuePair& kvPair) {
+  while (currentSegment < segments.size()) {
+    if (segments[currentSegment]->getNextKVPair(kvPair)) {
+      return true;
+    }
+
+    currentSegment++;
+  }
+
+  return false;
+}
+
+void MultiSegmentKVPairBuffer::resetIterator() {
+  KVPairBuffer::resetIterator();
+  currentSegment = 0;
+
+  for (SegmentVector::iterator iter = segments.begin();
+       iter != segments.end(); iter++) {
+    (*iter)->resetIterator();
+  }
+}
+
+void MultiSegmentKVPairBuffer::addKVPair(KeyValuePair& kvPair) {
+  ABORT("Can't append to a MultiSegmentKVPairBuffer");
+}
+
+void MultiSegmentKVPairBuffer::append(const uint8_t* data, uint64_t length) {
+  ABORT("Can't append to a MultiSegmentKVPairBuffer");
+}
+
+void MultiSegmentKVPairBuffer::commitAppend(
+  const uint8_t* ptr, uint64_t actualAppendLength) {
+  ABORT("Can't append to a MultiSegmentKVPairBuffer");
+}
+
+void MultiSegmentKVPairBuffer::calculateTupleMetadata() {
+  numTuples = 0;
+  minKeyLength = std::numeric_limits<uint32_t>::max();
+  maxKeyLength = 0;
+
+  for (SegmentVector::iterator iter = segments.begin();
+       iter != segments.end(); iter++) {
+    KVPairBuffer* segment = *iter;
+
+    if (segment->getNumTuples() > 0) {
+      numTuples += segment->getNumTuples();
+      minKeyLength = std::min(minKeyLength, segment->getMinKeyLength());
+      maxKeyLength = std::max(maxKeyLength, segment->getMaxKeyLength());
+    }
+  }
+
+  cached = true;
+}
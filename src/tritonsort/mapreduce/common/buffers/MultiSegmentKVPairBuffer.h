@@ -0,0 +1,97 @@
+#ifndef MAPRED_MULTI_SEGMENT_KV_PAIR_BUFFER_H
+#define MAPRED_MULTI_SEGMENT_KV_PAIR_BUFFER_H
+
+#include <vector>
+
+#include "KVPairBuffer.h"
+
+/**
+   A KVPairBuffer that doesn't have any memory of its own, but instead presents
+   a list of other KVPairBuffers (its segments) as though they were one buffer.
+   This lets a worker combine many buffers into one work unit by passing
+   pointers around rather than copying tuples into a larger buffer.
+
+   The buffer supports the iteration and tuple metadata API of KVPairBuffer
+   (getNextKVPair(), resetIterator(), getNumTuples(), getMinKeyLength(),
+   getMaxKeyLength()) as well as getCurrentSize(), which returns the combined
+   size of every segment. Since its tuples aren't contiguous in memory, it
+   can't be appended to and getRawBuffer() doesn't refer to its tuples, so it
+   can only be given to workers that read their input a tuple at a time (like
+   the mapper) rather than workers that operate on raw memory (like the
+   sorter).
+
+   The buffer takes ownership of its segments and deletes them when it is
+   deleted.
+ */
+class MultiSegmentKVPairBuffer : public KVPairBuffer {
+public:
+  /// Constructor
+  MultiSegmentKVPairBuffer();
+
+  /// Destructor
+  /**
+     Deletes every segment in the buffer.
+   */
+  virtual ~MultiSegmentKVPairBuffer();
+
+  /**
+     Add a buffer to the end of this buffer's list of segments. Its job IDs are
+     added to this buffer's job IDs.
+
+     \param segment the buffer to add, which this buffer now owns
+   */
+  void addSegment(KVPairBuffer* segment);
+
+  /// \return the number of segments in the buffer
+  uint64_t getNumSegments() const;
+
+  /**
+     \param segmentID the index of the segment to get
+
+     \return the segment at the given index
+   */
+  KVPairBuffer* getSegment(uint64_t segmentID);
+
+  /**
+     \return the combined size of every segment in bytes
+   */
+  uint64_t getCurrentSize() const;
+
+  /**
+     Iterate over each segment's tuples in turn.
+
+     \sa KVPairBuffer::getNextKVPair
+   */
+  bool getNextKVPair(KeyValuePair& kvPair);
+
+  /**
+     Reset the iterator position to the beginning of the first segment.
+   */
+  void resetIterator();
+
+  /// \warning Not supported; aborts
+  void addKVPair(KeyValuePair& kvPair);
+
+  /// \warning Not supported; aborts
+  void append(const uint8_t* data, uint64_t length);
+
+  /// \warning Not supported; aborts
+  void commitAppend(const uint8_t* ptr, uint64_t actualAppendLength);
+
+protected:
+  /**
+     Combines the tuple metadata of every segment.
+   */
+  void calculateTupleMetadata();
+
+private:
+  typedef std::vector<KVPairBuffer*> SegmentVector;
+
+  SegmentVector segments;
+  uint64_t totalSize;
+
+  // The segment that the iterator is currently in
+  uint64_t currentSegment;
+};
+
+#endif // MAPRED_MULTI_SEGMENT_KV_PAIR_BUFFER_H
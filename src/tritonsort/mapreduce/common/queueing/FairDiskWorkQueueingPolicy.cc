@@ -1,4 +1,7 @@
+#include <errno.h>
+
 #include "core/ScopedLock.h"
+#include "core/Timer.h"
 #include "core/TritonSortAssert.h"
 #include "mapreduce/common/queueing/FairDiskWorkQueueingPolicy.h"
 #include "mapreduce/common/queueing/PhysicalDiskWorkQueueingPolicy.h"
@@ -9,6 +12,7 @@ FairDiskWorkQueueingPolicy::FairDiskWorkQueueingPolicy(
     partitionMap(params, phaseName),
     nextQueueID(0),
     numWorkUnits(0),
+    numWaitingForWork(0),
     done(false) {
   workQueues.resize(numDisks);
 
@@ -46,8 +50,14 @@ void FairDiskWorkQueueingPolicy::enqueue(Resource* workUnit) {
   workQueues[queueID].push(workUnit);
   numWorkUnits++;
 
-  // If there are threads blocked on dequeue, signal one of them.
-  pthread_cond_signal(&waitingForEnqueue);
+  if (numWaitingForWork > 0) {
+    // Threads blocked in waitForWork() don't consume the work unit they're
+    // woken for, so wake everyone to avoid stranding a blocked dequeue().
+    pthread_cond_broadcast(&waitingForEnqueue);
+  } else {
+    // If there are threads blocked on dequeue, signal one of them.
+    pthread_cond_signal(&waitingForEnqueue);
+  }
 }
 
 Resource* FairDiskWorkQueueingPolicy::dequeue(uint64_t requestedQueueID) {
@@ -103,6 +113,37 @@ void FairDiskWorkQueueingPolicy::batchDequeue(
   }
 }
 
+bool FairDiskWorkQueueingPolicy::waitForWork(
+  uint64_t requestedQueueID, uint64_t timeoutMicros) {
+  ScopedLock scopedLock(&lock);
+
+  // Work is handed out round-robin regardless of the requested queue, so any
+  // work unit will do.
+  if (numWorkUnits == 0 && !done) {
+    numWaitingForWork++;
+
+    if (timeoutMicros == 0) {
+      while (numWorkUnits == 0 && !done) {
+        pthread_cond_wait(&waitingForEnqueue, &lock);
+      }
+    } else {
+      struct timespec deadline;
+      Timer::deadlineAfterMicros(timeoutMicros, deadline);
+
+      while (numWorkUnits == 0 && !done) {
+        if (pthread_cond_timedwait(&waitingForEnqueue, &lock, &deadline) ==
+            ETIMEDOUT) {
+          break;
+        }
+      }
+    }
+
+    numWaitingForWork--;
+  }
+
+  return numWorkUnits > 0 || done;
+}
+
 void FairDiskWorkQueueingPolicy::teardown() {
   ScopedLock scopedLock(&lock);
   done = true;
@@ -51,6 +51,9 @@ public:
   /// \sa WorkQueueingPolicyInterface::batchDequeue
   void batchDequeue(uint64_t queueID, WorkQueue& destinationQueue);
 
+  /// \sa WorkQueueingPolicyInterface::waitForWork
+  bool waitForWork(uint64_t queueID, uint64_t timeoutMicros);
+
   /// \sa WorkQueueingPolicyInterface::teardown
   void teardown();
 
@@ -69,6 +72,7 @@ private:
 
   uint64_t nextQueueID;
   uint64_t numWorkUnits;
+  uint64_t numWaitingForWork;
 
   bool done;
 
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <string.h>
+
+#include "core/Comparison.h"
+#include "core/Timer.h"
+#include "core/TritonSortAssert.h"
+#include "mapreduce/common/KeyValuePair.h"
+#include "mapreduce/common/buffers/KVPairBuffer.h"
+#include "mapreduce/common/sorting/InPlaceSortStrategy.h"
+
+InPlaceSortStrategy::InPlaceSortStrategy(bool useSecondaryKeys)
+  : secondaryKeyLength(useSecondaryKeys ? sizeof(uint64_t) : 0),
+    scratchBuffer(NULL),
+    tupleSize(0),
+    bucketTables(NULL),
+    scratchTuple(NULL),
+    logger("InPlaceSort") {
+
+  sortTimeStatID = logger.registerStat("sort_time");
+}
+
+void InPlaceSortStrategy::sort(
+  KVPairBuffer* inputBuffer, KVPairBuffer* outputBuffer) {
+
+  ABORT_IF(inputBuffer == NULL, "Must set non-NULL input buffer.");
+  ABORT_IF(scratchBuffer == NULL, "Scratch buffer wasn't set prior to sorting");
+
+  uint64_t numTuples = inputBuffer->getNumTuples();
+
+  if (numTuples > 1) {
+    TRITONSORT_ASSERT(canSort(inputBuffer), "In-place sort requires all tuples "
+                      "in the buffer to be the same size");
+
+    Timer sortTimer;
+    sortTimer.start();
+
+    uint8_t* tuples = const_cast<uint8_t*>(inputBuffer->getRawBuffer());
+    tupleSize = KeyValuePair::tupleSize(tuples);
+
+    // Bucket tables go first so that they're aligned, followed by space for a
+    // single tuple to use when swapping.
+    uint64_t numBucketTables = getNumBucketTables(inputBuffer);
+    bucketTables = reinterpret_cast<uint64_t*>(scratchBuffer);
+    scratchTuple = scratchBuffer +
+      (numBucketTables * NUM_BUCKETS * sizeof(uint64_t));
+
+    sortRange(tuples, numTuples, 0);
+
+    sortTimer.stop();
+    logger.add(sortTimeStatID, sortTimer.getElapsed());
+  }
+
+  // Reset scratch buffer so that we don't ever re-use a stale one by accident
+  scratchBuffer = NULL;
+  bucketTables = NULL;
+  scratchTuple = NULL;
+}
+
+uint64_t InPlaceSortStrategy::getRequiredScratchBufferSize(
+  KVPairBuffer* buffer) const {
+
+  if (buffer->getNumTuples() == 0) {
+    return 0;
+  }
+
+  uint64_t numBucketTables = getNumBucketTables(buffer);
+
+  return (numBucketTables * NUM_BUCKETS * sizeof(uint64_t)) +
+    KeyValuePair::tupleSize(const_cast<uint8_t*>(buffer->getRawBuffer()));
+}
+
+void InPlaceSortStrategy::setScratchBuffer(uint8_t* scratchBuffer) {
+  this->scratchBuffer = scratchBuffer;
+}
+
+SortAlgorithm InPlaceSortStrategy::getSortAlgorithmID() const {
+  return IN_PLACE_SORT;
+}
+
+bool InPlaceSortStrategy::sortsInPlace() const {
+  return true;
+}
+
+bool InPlaceSortStrategy::canSort(KVPairBuffer* buffer) const {
+  uint64_t numTuples = buffer->getNumTuples();
+
+  if (numTuples == 0) {
+    return true;
+  }
+
+  uint8_t* tuple = const_cast<uint8_t*>(buffer->getRawBuffer());
+  uint64_t firstTupleSize = KeyValuePair::tupleSize(tuple);
+
+  // Checking the buffer's size first rejects most buffers with mixed tuple
+  // sizes without a scan.
+  if (firstTupleSize * numTuples != buffer->getCurrentSize()) {
+    return false;
+  }
+
+  uint8_t* end = tuple + buffer->getCurrentSize();
+  for (; tuple < end; tuple += firstTupleSize) {
+    if (KeyValuePair::tupleSize(tuple) != firstTupleSize) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+uint64_t InPlaceSortStrategy::getNumBucketTables(KVPairBuffer* buffer) const {
+  // Ranges are bucketed at depths up to the length of the longest sort key,
+  // and each depth also uses the next depth's table while permuting.
+  return buffer->getMaxKeyLength() + secondaryKeyLength + 2;
+}
+
+void InPlaceSortStrategy::sortRange(
+  uint8_t* tuples, uint64_t numTuples, uint64_t depth) {
+
+  if (numTuples <= INSERTION_SORT_THRESHOLD) {
+    insertionSort(tuples, numTuples);
+    return;
+  }
+
+  // Count the tuples in each bucket. The counts are then turned into the
+  // offset just past the end of each bucket, and nextTuple holds the offset
+  // of the next tuple in each bucket that hasn't been placed yet. nextTuple is
+  // only needed until this range is permuted, so every depth shares the table
+  // just past this depth's.
+  uint64_t* bucketEnds = bucketTables + (depth * NUM_BUCKETS);
+  uint64_t* nextTuple = bucketEnds + NUM_BUCKETS;
+
+  memset(bucketEnds, 0, NUM_BUCKETS * sizeof(uint64_t));
+
+  uint8_t* tuple = tuples;
+  for (uint64_t i = 0; i < numTuples; i++, tuple += tupleSize) {
+    bucketEnds[bucket(tuple, depth)]++;
+  }
+
+  uint64_t offset = 0;
+  for (uint64_t i = 0; i < NUM_BUCKETS; i++) {
+    nextTuple[i] = offset;
+    offset += bucketEnds[i];
+    bucketEnds[i] = offset;
+  }
+
+  // Swap each tuple into its bucket. Every swap places at least one tuple, so
+  // this takes at most one swap per tuple.
+  for (uint64_t i = 0; i < NUM_BUCKETS; i++) {
+    while (nextTuple[i] < bucketEnds[i]) {
+      tuple = tuples + (nextTuple[i] * tupleSize);
+      uint64_t tupleBucket = bucket(tuple, depth);
+
+      if (tupleBucket == i) {
+        nextTuple[i]++;
+      } else {
+        swapTuples(tuple, tuples + (nextTuple[tupleBucket] * tupleSize));
+        nextTuple[tupleBucket]++;
+      }
+    }
+  }
+
+  // Keys in the first bucket ended before this depth, so they're all equal.
+  // Every other bucket is sorted on the next byte.
+  uint64_t bucketStart = bucketEnds[0];
+  for (uint64_t i = 1; i < NUM_BUCKETS; i++) {
+    uint64_t bucketSize = bucketEnds[i] - bucketStart;
+
+    if (bucketSize > 1) {
+      sortRange(tuples + (bucketStart * tupleSize), bucketSize, depth + 1);
+    }
+
+    bucketStart = bucketEnds[i];
+  }
+}
+
+void InPlaceSortStrategy::insertionSort(uint8_t* tuples, uint64_t numTuples) {
+  uint8_t* end = tuples + (numTuples * tupleSize);
+
+  for (uint8_t* tuple = tuples + tupleSize; tuple < end; tuple += tupleSize) {
+    uint8_t* insertPosition = tuple;
+    uint8_t* previousTuple = tuple - tupleSize;
+
+    if (compare(
+          KeyValuePair::key(previousTuple), sortKeyLength(previousTuple),
+          KeyValuePair::key(tuple), sortKeyLength(tuple)) <= 0) {
+      continue;
+    }
+
+    memcpy(scratchTuple, tuple, tupleSize);
+    uint8_t* key = KeyValuePair::key(scratchTuple);
+    uint64_t keyLength = sortKeyLength(scratchTuple);
+
+    // Shift larger tuples up one slot until the scratch tuple's position is
+    // found
+    do {
+      memcpy(insertPosition, previousTuple, tupleSize);
+      insertPosition = previousTuple;
+      previousTuple -= tupleSize;
+    } while (insertPosition > tuples &&
+             compare(
+               KeyValuePair::key(previousTuple), sortKeyLength(previousTuple),
+               key, keyLength) > 0);
+
+    memcpy(insertPosition, scratchTuple, tupleSize);
+  }
+}
+
+inline uint64_t InPlaceSortStrategy::sortKeyLength(uint8_t* tuple) const {
+  // Don't let the secondary key run past the end of the tuple's value
+  return KeyValuePair::keyLength(tuple) +
+    std::min<uint64_t>(secondaryKeyLength, KeyValuePair::valueLength(tuple));
+}
+
+inline uint64_t InPlaceSortStrategy::bucket(
+  uint8_t* tuple, uint64_t depth) const {
+
+  if (depth >= sortKeyLength(tuple)) {
+    return 0;
+  }
+
+  return KeyValuePair::key(tuple)[depth] + 1;
+}
+
+inline void InPlaceSortStrategy::swapTuples(uint8_t* tuple1, uint8_t* tuple2) {
+  memcpy(scratchTuple, tuple1, tupleSize);
+  memcpy(tuple1, tuple2, tupleSize);
+  memcpy(tuple2, scratchTuple, tupleSize);
+}
@@ -0,0 +1,117 @@
+#ifndef TRITONSORT_MAPREDUCE_IN_PLACE_SORT_STRATEGY_H
+#define TRITONSORT_MAPREDUCE_IN_PLACE_SORT_STRATEGY_H
+
+#include "core/StatLogger.h"
+#include "mapreduce/common/sorting/SortStrategyInterface.h"
+
+/**
+   A sort strategy implementation that sorts a buffer's tuples where they are,
+   using an in-place MSD radix sort (American flag sort). Unlike the other
+   strategies, it doesn't need an output buffer, so a Sorter that uses it only
+   needs memory for the input buffer and a small scratch buffer rather than
+   more than twice the size of the input buffer.
+
+   Each pass counts the tuples that fall into each of 257 buckets based on one
+   byte of their keys (the first bucket holding keys that are shorter than the
+   current depth), and then swaps tuples into their buckets one at a time.
+   Buckets are sorted recursively on the next key byte, and small buckets are
+   finished with an insertion sort.
+
+   Swapping tuples in place requires every tuple in the buffer to be the same
+   size, so this strategy can only sort buffers whose tuples have uniform key
+   and value lengths. The scratch buffer holds one tuple and a bucket table for
+   each byte of the longest key, so its size is independent of the number of
+   tuples in the buffer.
+
+   Like the other strategies, secondary keys are handled by treating the first
+   8 bytes of each value as part of its key.
+ */
+class InPlaceSortStrategy : public SortStrategyInterface {
+public:
+  /// Constructor
+  /**
+     \param useSecondaryKeys if true, break ties between keys with the first 8
+     bytes of their values
+   */
+  InPlaceSortStrategy(bool useSecondaryKeys);
+
+  /**
+     Sort inputBuffer's tuples in place.
+
+     \sa SortStrategyInterface::sort
+   */
+  void sort(KVPairBuffer* inputBuffer, KVPairBuffer* outputBuffer);
+
+  /**
+     In-place sort needs space for one tuple and a table of bucket boundaries
+     for each byte of the longest key.
+
+     \sa SortStrategyInterface::getRequiredScratchBufferSize
+   */
+  uint64_t getRequiredScratchBufferSize(KVPairBuffer* buffer) const;
+
+  /// \sa SortStrategyInterface::setScratchBuffer
+  void setScratchBuffer(uint8_t* scratchBuffer);
+
+  /// \sa SortStrategyInterface::getSortAlgorithmID
+  SortAlgorithm getSortAlgorithmID() const;
+
+  /// \sa SortStrategyInterface::sortsInPlace
+  bool sortsInPlace() const;
+
+  /**
+     In-place sort can only sort buffers whose tuples are all the same size.
+
+     \sa SortStrategyInterface::canSort
+   */
+  bool canSort(KVPairBuffer* buffer) const;
+
+private:
+  // One bucket for each byte value, plus one for keys that have ended
+  static const uint64_t NUM_BUCKETS = 257;
+
+  // Buckets with at most this many tuples are insertion sorted
+  static const uint64_t INSERTION_SORT_THRESHOLD = 32;
+
+  /// \return the number of bucket tables needed to sort a buffer
+  uint64_t getNumBucketTables(KVPairBuffer* buffer) const;
+
+  /**
+     Sort a contiguous range of tuples whose keys are known to be equal up to
+     the given depth.
+
+     \param tuples the first tuple in the range
+
+     \param numTuples the number of tuples in the range
+
+     \param depth the key byte on which to bucket tuples
+   */
+  void sortRange(uint8_t* tuples, uint64_t numTuples, uint64_t depth);
+
+  /// Insertion sort a contiguous range of tuples
+  void insertionSort(uint8_t* tuples, uint64_t numTuples);
+
+  /// \return the number of bytes of a tuple's key and secondary key to sort on
+  inline uint64_t sortKeyLength(uint8_t* tuple) const;
+
+  /// \return the bucket into which a tuple falls at the given depth
+  inline uint64_t bucket(uint8_t* tuple, uint64_t depth) const;
+
+  /// Swap the contents of two tuples using the scratch tuple
+  inline void swapTuples(uint8_t* tuple1, uint8_t* tuple2);
+
+  const uint64_t secondaryKeyLength;
+
+  uint8_t* scratchBuffer;
+
+  // Valid only during a call to sort()
+  uint64_t tupleSize;
+  uint64_t* bucketTables;
+  uint8_t* scratchTuple;
+
+  // Logging
+  StatLogger logger;
+  uint64_t sortTimeStatID;
+};
+
+#endif // TRITONSORT_MAPREDUCE_IN_PLACE_SORT_STRATEGY_H
@@ -115,3 +115,11 @@ void QuickSortStrategy::setScratchBuffer(uint8_t* scratchBuffer) {
 SortAlgorithm QuickSortStrategy::getSortAlgorithmID() const {
   return QUICK_SORT;
 }
+
+bool QuickSortStrategy::sortsInPlace() const {
+  return false;
+}
+
+bool QuickSortStrategy::canSort(KVPairBuffer* buffer) const {
+  return true;
+}
@@ -38,6 +38,12 @@ public:
 
   /// \sa SortStrategyInterface::getSortAlgorithmID
   SortAlgorithm getSortAlgorithmID() const;
+
+  /// \sa SortStrategyInterface::sortsInPlace
+  bool sortsInPlace() const;
+
+  /// \sa SortStrategyInterface::canSort
+  bool canSort(KVPairBuffer* buffer) const;
 private:
   typedef int (*KeyComparisonFunction)(const void*, const void*);
 
@@ -23,3 +23,11 @@ void RadixSortStrategy::setScratchBuffer(uint8_t* scratchBuffer) {
 SortAlgorithm RadixSortStrategy::getSortAlgorithmID() const {
   return RADIX_SORT_MAPREDUCE;
 }
+
+bool RadixSortStrategy::sortsInPlace() const {
+  return false;
+}
+
+bool RadixSortStrategy::canSort(KVPairBuffer* buffer) const {
+  return true;
+}
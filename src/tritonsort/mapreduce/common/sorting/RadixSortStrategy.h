@@ -15,7 +15,9 @@
    variance in key size can dramatically reduce performance because the runtime
    and scratch buffer overhead are roughly linear in the maximum key size.
    Having even one key that is significantly larger than the others can greatly
-   reduce throughput.
+   reduce throughput. Buffers with variable-length keys also pay for one or two
+   extra passes over a key length suffix that keeps shorter keys ahead of
+   longer keys they prefix.
 
    RadixSortStrategy is a wrapper around a RadixSort object that performs the
    actual sort. We should remove this wrapper class and make RadixSort a sort
@@ -46,6 +48,12 @@ public:
 
   /// \sa SortStrategyInterface::getSortAlgorithmID
   SortAlgorithm getSortAlgorithmID() const;
+
+  /// \sa SortStrategyInterface::sortsInPlace
+  bool sortsInPlace() const;
+
+  /// \sa SortStrategyInterface::canSort
+  bool canSort(KVPairBuffer* buffer) const;
 private:
   RadixSort radixSort;
 };
@@ -1,4 +1,5 @@
 #include "core/Params.h"
+#include "mapreduce/common/sorting/InPlaceSortStrategy.h"
 #include "mapreduce/common/sorting/QuickSortStrategy.h"
 #include "mapreduce/common/sorting/RadixSortStrategy.h"
 #include "mapreduce/common/sorting/SortStrategyFactory.h"
@@ -20,6 +21,9 @@ SortStrategyInterface* SortStrategyFactory::newSortStrategy(
   case RADIX_SORT_MAPREDUCE:
     strat = new RadixSortStrategy(useSecondaryKeys);
     break;
+  case IN_PLACE_SORT:
+    strat = new InPlaceSortStrategy(useSecondaryKeys);
+    break;
   default:
     ABORT("Don't know how to handle specified sort algorithm");
     break;
@@ -39,12 +43,18 @@ void SortStrategyFactory::populateOrderedSortStrategyList(
     strategyList.push_back(radixSort);
   }
 
+  if (anyStrategy || strategy == "IN_PLACE_SORT") {
+    SortStrategyInterface* inPlaceSort = new InPlaceSortStrategy(
+      useSecondaryKeys);
+    strategyList.push_back(inPlaceSort);
+  }
+
   if (anyStrategy || strategy == "QUICK_SORT") {
     SortStrategyInterface* quickSort = new QuickSortStrategy(useSecondaryKeys);
     strategyList.push_back(quickSort);
   }
 
   ABORT_IF(strategyList.size() == 0,
-           "Unknown sort strategy %s. Specify RADIX_SORT, QUICK_SORT, or ANY",
-           strategy.c_str());
+           "Unknown sort strategy %s. Specify RADIX_SORT, IN_PLACE_SORT, "
+           "QUICK_SORT, or ANY", strategy.c_str());
 }
@@ -21,7 +21,8 @@ public:
 
      \param inputBuffer the input buffer to be sorted
 
-     \param outputBuffer the output buffer where sorted tuples should be copied
+     \param outputBuffer the output buffer where sorted tuples should be
+     copied, or NULL if the strategy sorts in place
    */
   virtual void sort(KVPairBuffer* inputBuffer, KVPairBuffer* outputBuffer) = 0;
 
@@ -49,6 +50,19 @@ public:
 
   /// Return the SortAlgorithm corresponding to this strategy.
   virtual SortAlgorithm getSortAlgorithmID() const = 0;
+
+  /**
+     \return true if this strategy leaves the sorted tuples in the input
+     buffer rather than copying them into an output buffer
+   */
+  virtual bool sortsInPlace() const = 0;
+
+  /**
+     \param buffer the buffer that is to be sorted
+
+     \return true if this strategy is able to sort the buffer
+   */
+  virtual bool canSort(KVPairBuffer* buffer) const = 0;
 };
 
 #endif // TRITONSORT_MAPREDUCE_SORT_STRATEGY_INTERFACE_H
@@ -2,6 +2,7 @@
 
 Bucket::Bucket() :
   maxKeySize(0),
+  keyLengthBytes(0),
   entrySize(0),
   readPointer(NULL),
   writePointer(NULL),
@@ -9,10 +10,12 @@ Bucket::Bucket() :
   offsetSize(UINT64_T) {}
 
 void Bucket::reset(uint8_t* newBufferPosition, uint64_t newCapacity,
-                   uint32_t newMaxKeySize, OffsetSize offsetSize) {
+                   uint32_t newMaxKeySize, uint32_t newKeyLengthBytes,
+                   OffsetSize offsetSize) {
   readPointer = newBufferPosition;
   writePointer = newBufferPosition;
   maxKeySize = newMaxKeySize;
+  keyLengthBytes = newKeyLengthBytes;
   // An entry is a key and an offset tag
   entrySize = maxKeySize + offsetBytes[offsetSize];
   endPointer = newBufferPosition + (entrySize * newCapacity);
@@ -12,6 +12,11 @@
    an offset tag locating the key in the original buffer. Keys shorter than the
    maximum key size are padded with 0s to ensure the 'fixed size' property.
 
+   If keys vary in length, the padded key is followed by the key's length in
+   big-endian order, so that a key sorts before any longer key that it is a
+   prefix of, even if the longer key's extra bytes are 0s. This matches the
+   ordering of compare().
+
    RadixSort uses 2 sets of buckets, with 256 buckets in each set.
    Each bucket holds keys with the same byte in the key at a specified offset.
  */
@@ -28,12 +33,17 @@ public:
 
      \param newCapacity the number of key-entries that this bucket will hold.
 
-     \param newMaxKeySize the maximum size of keys added to the bucket
+     \param newMaxKeySize the maximum size of keys added to the bucket,
+     including the key length suffix
+
+     \param newKeyLengthBytes the size of the key length suffix, or 0 if keys
+     are not suffixed with their lengths
 
      \param offsetSize the size of the offset tag associated with key-entries.
    */
   void reset(uint8_t* newBufferPosition, uint64_t newCapacity,
-             uint32_t newMaxKeySize, OffsetSize offsetSize);
+             uint32_t newMaxKeySize, uint32_t newKeyLengthBytes,
+             OffsetSize offsetSize);
 
   // Keep the following implementations in the header for inlining purposes:
 
@@ -67,17 +77,24 @@ public:
                                    uint64_t offset) {
     TRITONSORT_ASSERT(writePointer + entrySize <= endPointer,
            "Cannot write to full bucket");
-    TRITONSORT_ASSERT(keyLength <= maxKeySize, "Cannot write entry with key size %llu "
-           "larger than max key size %llu", keyLength, maxKeySize);
+    TRITONSORT_ASSERT(keyLength + keyLengthBytes <= maxKeySize, "Cannot write "
+           "entry with key size %llu larger than max key size %llu",
+           keyLength, maxKeySize - keyLengthBytes);
 
     // Write the key
     writePointer = reinterpret_cast<uint8_t*>(
       mempcpy(writePointer, keyPointer, keyLength));;
     // 0-pad up to the maximum key size
-    uint32_t paddingSize = maxKeySize - keyLength;
+    uint32_t paddingSize = maxKeySize - keyLengthBytes - keyLength;
     memset(writePointer, 0, paddingSize);
     writePointer += paddingSize;
 
+    // Write the key's length, most significant byte first
+    for (uint32_t i = keyLengthBytes; i > 0; i--) {
+      *writePointer = static_cast<uint8_t>(keyLength >> (8 * (i - 1)));
+      ++writePointer;
+    }
+
     // Write the tuple's offset
     if (offsetSize == UINT16_T) {
       // Write a shortened uint16_t offset
@@ -113,6 +130,7 @@ public:
 
 private:
   uint32_t maxKeySize;
+  uint32_t keyLengthBytes;
   uint64_t entrySize;
   uint8_t* readPointer;
   uint8_t* writePointer;
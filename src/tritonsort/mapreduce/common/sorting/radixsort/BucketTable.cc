@@ -2,6 +2,7 @@
 
 BucketTable::BucketTable(Histogram& _histogram) :
   maxKeySize(0),
+  keyLengthBytes(0),
   offsetSize(UINT64_T),
   numEntries(0),
   entrySize(0),
@@ -14,7 +15,8 @@ void BucketTable::resetBuckets() {
   for (uint64_t i = 0; i < NUM_BUCKETS; ++i) {
     // Reset and resize the bucket
     uint64_t numEntries = histogram.get(i);
-    buckets[i].reset(buffer + offset, numEntries, maxKeySize, offsetSize);
+    buckets[i].reset(
+      buffer + offset, numEntries, maxKeySize, keyLengthBytes, offsetSize);
     // Compute the offset for the next bucket
     offset += numEntries * entrySize;
   }
@@ -46,6 +46,17 @@ public:
     entrySize = maxKeySize + offsetBytes[offsetSize];
   }
 
+  /**
+     Sets the number of bytes of key length that follow each padded key. Keys
+     are only suffixed with their lengths if they vary in length.
+
+     \param keyLengthBytes the size of the key length suffix, which is
+     included in the maximum key size
+   */
+  inline void setKeyLengthBytes(uint32_t keyLengthBytes) {
+    this->keyLengthBytes = keyLengthBytes;
+  }
+
   /**
      Sets the size of the offset tag for a key-entry. Offsets are defined in
      Constants.h to be UINT16_T, UINT32_T, or UINT64_T
@@ -110,13 +121,38 @@ public:
     // Don't update the historgram since this is the last iteration
   }
 
+  /**
+     Returns a byte of a key as it will appear in its key-entry, which is either
+     a byte of the key, a padding 0, or a byte of the key's length suffix.
+
+     \param keyPointer the memory location of the key in the input buffer
+
+     \param keyLength the length of the key
+
+     \param position the position in the key-entry of the byte to return
+
+     \return the byte of the key-entry at the given position
+   */
+  inline uint8_t getKeyEntryByte(
+    uint8_t* keyPointer, uint32_t keyLength, uint32_t position) const {
+    uint32_t paddedKeySize = maxKeySize - keyLengthBytes;
+
+    if (position < paddedKeySize) {
+      return position < keyLength ? keyPointer[position] : 0;
+    }
+
+    // The length suffix is big-endian
+    return static_cast<uint8_t>(
+      keyLength >> (8 * (maxKeySize - 1 - position)));
+  }
+
   /**
      Adds an entry to the BucketTable sourced from the input buffer. Since
      the 0-padded key-entry has not yet been created, this method handles short
-     keys correctly by binning them in the 0-byte bucket. This method also
-     updates the histogram for the next iteration. Call this method during the
-     the first iteration of bucketing, where keys are sourced from a
-     KVPairBuffer.
+     keys correctly by binning them in the 0-byte bucket, and handles the key
+     length suffix if there is one. This method also updates the histogram for
+     the next iteration. Call this method during the the first iteration of
+     bucketing, where keys are sourced from a KVPairBuffer.
 
      \param keyPointer the memory location of the key in the input buffer
 
@@ -127,13 +163,22 @@ public:
    */
   inline void addEntryFromBuffer(uint8_t* keyPointer, uint32_t keyLength,
                                  uint64_t offset) {
-    // 0-pad bytes beyond key
-    uint8_t byte = keyOffset < keyLength ? getCurrentByte(keyPointer) : 0;
+    uint8_t byte = 0;
+    uint8_t nextByte = 0;
+
+    if (keyLengthBytes == 0) {
+      // 0-pad bytes beyond key
+      byte = keyOffset < keyLength ? getCurrentByte(keyPointer) : 0;
+      nextByte = keyOffset - 1 < keyLength ? getNextByte(keyPointer) : 0;
+    } else {
+      byte = getKeyEntryByte(keyPointer, keyLength, keyOffset);
+      if (keyOffset > 0) {
+        nextByte = getKeyEntryByte(keyPointer, keyLength, keyOffset - 1);
+      }
+    }
+
     // Add to the appropriate bucket
     buckets[byte].writeEntryFromBuffer(keyPointer, keyLength, offset);
-    // 0-pad bytes beyond key
-    uint8_t nextByte = keyOffset - 1 < keyLength ?
-      getNextByte(keyPointer) : 0;
     // Update the histogram for the next iteration
     histogram.increment(nextByte);
   }
@@ -195,6 +240,7 @@ private:
   Bucket buckets[NUM_BUCKETS];
 
   uint32_t maxKeySize;
+  uint32_t keyLengthBytes;
   OffsetSize offsetSize;
   uint64_t numEntries;
   uint64_t entrySize;
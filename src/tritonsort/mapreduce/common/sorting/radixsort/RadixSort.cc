@@ -10,6 +10,7 @@ RadixSort::RadixSort(bool _useSecondaryKeys)
     inputBuffer(NULL),
     outputBuffer(NULL),
     maxKeySize(0),
+    keyLengthBytes(0),
     offsetSize(UINT64_T),
     inputBuckets(0),
 #ifdef TRITONSORT_CXX_11
@@ -72,8 +73,10 @@ void RadixSort::setup() {
   bucketTables[0].setNumEntries(numTuples);
   bucketTables[1].setNumEntries(numTuples);
 
-  // Set the maximum key size
-  maxKeySize = inputBuffer->getMaxKeyLength();
+  // Set the maximum key size, which includes the key length suffix if keys
+  // vary in length
+  keyLengthBytes = getKeyLengthBytes(inputBuffer);
+  maxKeySize = inputBuffer->getMaxKeyLength() + keyLengthBytes;
 
   if (useSecondaryKeys) {
     maxKeySize += sizeof(uint64_t);
@@ -81,6 +84,8 @@ void RadixSort::setup() {
 
   bucketTables[0].setMaxKeySize(maxKeySize);
   bucketTables[1].setMaxKeySize(maxKeySize);
+  bucketTables[0].setKeyLengthBytes(keyLengthBytes);
+  bucketTables[1].setKeyLengthBytes(keyLengthBytes);
 
   // Set the offset size
   offsetSize = getOffsetSize(inputBuffer);
@@ -241,6 +246,7 @@ void RadixSort::deriveInitialHistogram() {
   uint8_t lastByte = 0;
   uint8_t* buffer = const_cast<uint8_t*>(inputBuffer->getRawBuffer());
   uint8_t* end = buffer + inputBuffer->getCurrentSize();
+  BucketTable& outputBuckets = getOutputBuckets();
 
   while (buffer < end) {
     // Increment the histogram
@@ -250,7 +256,11 @@ void RadixSort::deriveInitialHistogram() {
       keyLength += sizeof(uint64_t);
     }
 
-    if (maxKeySize > 0 && keyLength == maxKeySize) {
+    if (keyLengthBytes > 0) {
+      // The last byte of the key-entry is the low byte of the key's length
+      lastByte = outputBuckets.getKeyEntryByte(
+        KeyValuePair::key(buffer), keyLength, maxKeySize - 1);
+    } else if (maxKeySize > 0 && keyLength == maxKeySize) {
       lastByte = KeyValuePair::key(buffer)[maxKeySize - 1];
     } else {
       lastByte = 0;
@@ -14,9 +14,11 @@ class KVPairBuffer;
    algorithm is as follows:
 
    1. Read the input buffer into buckets based on the last byte in the key,
-        padding keys with 0s until they reach the maximum key length. Add
-        an offset tag to each key that tracks its initial position in the input
-        buffer. A key together with an offset tag is called a **key-entry**
+        padding keys with 0s until they reach the maximum key length. If keys
+        vary in length, follow each padded key with its length so that shorter
+        keys sort before longer keys that they prefix. Add an offset tag to
+        each key that tracks its initial position in the input buffer. A key
+        together with an offset tag is called a **key-entry**
    2. Re-bucket the keys by the preceding byte in the key, preserving the order
         of keys with equal bytes.
    3. Repeat step 2 until all bytes of the key have been used to re-bucket keys.
@@ -63,6 +65,7 @@ private:
   KVPairBuffer* inputBuffer;
   KVPairBuffer* outputBuffer;
   uint32_t maxKeySize;
+  uint32_t keyLengthBytes;
   OffsetSize offsetSize;
   Histogram histogram;
   int inputBuckets;
@@ -165,6 +168,35 @@ private:
     }
   }
 
+  /**
+     Compute the number of bytes of key length to append to each padded key.
+     Keys only need to be suffixed with their lengths if they vary in length,
+     and the suffix only needs to be wide enough for the longest key.
+
+     \param buffer the buffer for which to compute the suffix size
+
+     \return the number of key length bytes in each key-entry for buffer
+   */
+  inline uint32_t getKeyLengthBytes(KVPairBuffer* buffer) const {
+    if (buffer->getMinKeyLength() == buffer->getMaxKeyLength()) {
+      return 0;
+    }
+
+    uint64_t maxKeyLength = buffer->getMaxKeyLength();
+
+    if (useSecondaryKeys) {
+      maxKeyLength += sizeof(uint64_t);
+    }
+
+    if (maxKeyLength <= std::numeric_limits<uint8_t>::max()) {
+      return sizeof(uint8_t);
+    } else if (maxKeyLength <= std::numeric_limits<uint16_t>::max()) {
+      return sizeof(uint16_t);
+    } else {
+      return sizeof(uint32_t);
+    }
+  }
+
   inline uint64_t getScratchBufferEntrySize(KVPairBuffer* buffer) const {
     uint64_t keyLength = buffer->getMaxKeyLength();
 
@@ -172,7 +204,8 @@ private:
       keyLength += sizeof(uint64_t);
     }
 
-    return keyLength + offsetBytes[getOffsetSize(buffer)];
+    return keyLength + getKeyLengthBytes(buffer) +
+      offsetBytes[getOffsetSize(buffer)];
   }
 };
 
@@ -15,6 +15,7 @@ const char* malloc_conf = "lg_chunk:20,lg_tcache_gc_sweep:30"
 #include "common/SimpleMemoryAllocator.h"
 #include "common/WriteTokenPool.h"
 #include "core/AbortingDeadlockResolver.h"
+#include "core/BufferTracer.h"
 #include "core/CPUAffinitySetter.h"
 #include "core/DefaultAllocatorPolicy.h"
 #include "core/File.h"
@@ -1192,6 +1193,8 @@ int main(int argc, char** argv) {
   StatWriter::init(params);
   StatWriter::spawn();
 
+  BufferTracer::init(params);
+
   ResourceMonitor::init(&params);
   ResourceMonitor::spawn();
 
@@ -1292,6 +1295,8 @@ int main(int argc, char** argv) {
   // Delete logger so that it deregisters
   delete mainLogger;
 
+  BufferTracer::teardown();
+
   StatWriter::teardown();
 
   StatusPrinter::teardown();
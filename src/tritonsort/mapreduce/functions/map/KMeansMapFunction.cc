@@ -1,18 +1,26 @@
+#include <algorithm>
 #include <iterator>
+#include <limits>
 
 #include "KMeansMapFunction.h"
 
 KMeansMapFunction::KMeansMapFunction(uint64_t _dimension, uint64_t _k,
                                      std::string _kCentersURL)
-  : dimension(_dimension), k(_k), kCentersURL(_kCentersURL) {
+  : dimension(_dimension), k(_k), kCentersURL(_kCentersURL),
+    numCenterBlocks(0), centerCoordinates(NULL), centerIDs(NULL) {
 }
 
 void KMeansMapFunction::init(const Params& params) {
-  kCenters = new uint64_t*[k];
-  for(uint64_t i = 0; i < k; i++){
-    // additional one slot to store hashed center id
-    kCenters[i] = new uint64_t[dimension + 1];
-  }
+  numCenterBlocks = (k + CENTER_BLOCK_SIZE - 1) / CENTER_BLOCK_SIZE;
+
+  // Padding centers in the last block are zero-filled and are never selected,
+  // since only the first k centers are considered when picking the nearest.
+  uint64_t numCoordinates = numCenterBlocks * CENTER_BLOCK_SIZE * dimension;
+  centerCoordinates = new uint64_t[numCoordinates];
+  memset(centerCoordinates, 0, numCoordinates * sizeof(uint64_t));
+
+  centerIDs = new uint64_t[k];
+  memset(centerIDs, 0, k * sizeof(uint64_t));
 
   std::ifstream ifs(kCentersURL.c_str());
   ABORT_IF(!ifs.good(), "Cannot open %s\n", kCentersURL.c_str());
@@ -27,45 +35,120 @@ void KMeansMapFunction::init(const Params& params) {
         std::back_inserter<std::vector<std::string> > (tokens));
 
     TRITONSORT_ASSERT(dimension == tokens.size() - 2, "Mismatch in k-centers param file");
-    kCenters[lineno][0] = atol(tokens.at(1).c_str());
+    centerIDs[lineno] = atol(tokens.at(1).c_str());
+
+    uint64_t* block = centerCoordinates +
+      (lineno / CENTER_BLOCK_SIZE) * CENTER_BLOCK_SIZE * dimension;
+    uint64_t lane = lineno % CENTER_BLOCK_SIZE;
     for(uint64_t i = 0; i < dimension; i++){
-      kCenters[lineno][i + 1] = atol(tokens.at(i + 2).c_str());
+      block[i * CENTER_BLOCK_SIZE + lane] = atol(tokens.at(i + 2).c_str());
     }
     lineno++;
   }
 }
 
 void KMeansMapFunction::teardown(KVPairWriterInterface& writer) {
-  for(uint64_t i = 0; i < k; i++){
-    delete[] kCenters[i];
+  delete[] centerCoordinates;
+  centerCoordinates = NULL;
+
+  delete[] centerIDs;
+  centerIDs = NULL;
+}
+
+bool KMeansMapFunction::blockDistances(
+  const uint64_t* block, const uint64_t* point, uint64_t currentMinimum,
+  uint64_t* distances) const {
+
+  for (uint64_t lane = 0; lane < CENTER_BLOCK_SIZE; lane++) {
+    distances[lane] = 0;
+  }
+
+  for (uint64_t j = 0; j < dimension; j++) {
+    const uint64_t coordinate = point[j];
+    const uint64_t* centers = block + j * CENTER_BLOCK_SIZE;
+
+    // Unsigned arithmetic wraps identically to squaring the signed
+    // difference, and keeps this loop free of branches so it vectorizes.
+    for (uint64_t lane = 0; lane < CENTER_BLOCK_SIZE; lane++) {
+      uint64_t difference = centers[lane] - coordinate;
+      distances[lane] += difference * difference;
+    }
+
+    if ((j + 1) % ABANDON_CHECK_INTERVAL == 0) {
+      // Partial distances only grow, so once every center in the block is at
+      // least as far as the current minimum none of them can replace it.
+      uint64_t blockMinimum = distances[0];
+      for (uint64_t lane = 1; lane < CENTER_BLOCK_SIZE; lane++) {
+        blockMinimum = std::min(blockMinimum, distances[lane]);
+      }
+
+      if (blockMinimum >= currentMinimum) {
+        return false;
+      }
+    }
   }
-  delete[] kCenters;
+
+  return true;
 }
 
 void KMeansMapFunction::map(KeyValuePair& kvPair,
                             KVPairWriterInterface& writer) {
-  uint64_t *coordVector = (uint64_t *)kvPair.getValue();
-  uint64_t minSquaredDistance = 0;
-  uint64_t minCenterID = 0;
-  // find nearest center
-  for(uint64_t i = 0; i < k; i++){
-    uint64_t squaredDistance = 0;
-    for(uint64_t j = 0; j < dimension; j++){
-      int64_t dist = kCenters[i][j + 1] - coordVector[j];
-      squaredDistance += dist * dist;
+  mapBatch(&kvPair, 1, writer);
+}
+
+void KMeansMapFunction::mapBatch(
+  KeyValuePair* kvPairs, uint64_t numKVPairs, KVPairWriterInterface& writer) {
+
+  if (minSquaredDistances.size() < numKVPairs) {
+    minSquaredDistances.resize(numKVPairs);
+    minCenterIndices.resize(numKVPairs);
+  }
+
+  for (uint64_t p = 0; p < numKVPairs; p++) {
+    minSquaredDistances[p] = std::numeric_limits<uint64_t>::max();
+    minCenterIndices[p] = 0;
+  }
+
+  uint64_t distances[CENTER_BLOCK_SIZE];
+
+  // find nearest center, visiting centers in increasing order so that ties
+  // are broken in favor of the earliest center
+  for (uint64_t b = 0; b < numCenterBlocks; b++) {
+    const uint64_t* block = centerCoordinates +
+      b * CENTER_BLOCK_SIZE * dimension;
+    uint64_t firstCenter = b * CENTER_BLOCK_SIZE;
+    uint64_t blockCenters = k - firstCenter;
+    if (blockCenters > CENTER_BLOCK_SIZE) {
+      blockCenters = CENTER_BLOCK_SIZE;
     }
-    if(i == 0 || squaredDistance < minSquaredDistance){
-      minSquaredDistance = squaredDistance;
-      minCenterID = kCenters[i][0];
+
+    for (uint64_t p = 0; p < numKVPairs; p++) {
+      const uint64_t* coordVector =
+        reinterpret_cast<const uint64_t*>(kvPairs[p].getValue());
+
+      if (!blockDistances(
+            block, coordVector, minSquaredDistances[p], distances)) {
+        continue;
+      }
+
+      for (uint64_t lane = 0; lane < blockCenters; lane++) {
+        if (distances[lane] < minSquaredDistances[p]) {
+          minSquaredDistances[p] = distances[lane];
+          minCenterIndices[p] = firstCenter + lane;
+        }
+      }
     }
   }
 
   // emit nearest center
-  KeyValuePair outputKVPair;
-  outputKVPair.setKey(reinterpret_cast<const uint8_t *>(&minCenterID),
-      sizeof(uint64_t));
-  outputKVPair.setValue(reinterpret_cast<const uint8_t *>(kvPair.getValue()),
-      kvPair.getValueLength());
+  for (uint64_t p = 0; p < numKVPairs; p++) {
+    uint64_t minCenterID = centerIDs[minCenterIndices[p]];
+
+    KeyValuePair outputKVPair;
+    outputKVPair.setKey(reinterpret_cast<const uint8_t *>(&minCenterID),
+                        sizeof(uint64_t));
+    outputKVPair.setValue(kvPairs[p].getValue(), kvPairs[p].getValueLength());
 
-  writer.write(outputKVPair);
+    writer.write(outputKVPair);
+  }
 }
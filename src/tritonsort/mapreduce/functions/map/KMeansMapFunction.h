@@ -1,23 +1,69 @@
 #ifndef MAPRED_K_MEANS_MAP_FUNCTION_H
 #define MAPRED_K_MEANS_MAP_FUNCTION_H
 
+#include <vector>
+
 #include "mapreduce/functions/map/MapFunction.h"
 
+/**
+   KMeansMapFunction assigns each point to its nearest center and emits the
+   point keyed by that center's ID.
+
+   Centers are stored in a single contiguous allocation, grouped into blocks of
+   CENTER_BLOCK_SIZE centers. Within a block, coordinates are laid out
+   dimension-major, so the coordinate j of every center in the block is
+   contiguous and the distance computation for all centers in the block
+   vectorizes. Points are mapped in batches so that each block of centers is
+   streamed through the cache once per batch rather than once per point, and a
+   block is abandoned as soon as none of its partial distances can beat the
+   point's current nearest center.
+ */
 class KMeansMapFunction : public MapFunction {
 public:
   KMeansMapFunction(uint64_t _dimension, uint64_t _k, std::string _kCentersURL);
 
   void map(KeyValuePair& kvPair, KVPairWriterInterface& writer);
+  void mapBatch(
+    KeyValuePair* kvPairs, uint64_t numKVPairs, KVPairWriterInterface& writer);
   void init(const Params& params);
   void teardown(KVPairWriterInterface& writer);
 
 private:
+  /// The number of centers whose distances are computed together
+  static const uint64_t CENTER_BLOCK_SIZE = 8;
+
+  /// The number of dimensions between early-abandon checks
+  static const uint64_t ABANDON_CHECK_INTERVAL = 16;
+
+  /**
+     Compute the squared distances from a point to every center in a block.
+
+     \param block the block's coordinates in dimension-major order
+
+     \param point the point's coordinates
+
+     \param currentMinimum the smallest squared distance found so far for this
+     point
+
+     \param[out] distances the squared distance to each center in the block
+
+     \return false if the computation was abandoned because no center in the
+     block can be closer than currentMinimum, true otherwise
+   */
+  bool blockDistances(
+    const uint64_t* block, const uint64_t* point, uint64_t currentMinimum,
+    uint64_t* distances) const;
+
   const uint64_t dimension;
   const uint64_t k;
   const std::string kCentersURL;
 
-  uint64_t **kCenters;
+  uint64_t numCenterBlocks;
+  uint64_t* centerCoordinates;
+  uint64_t* centerIDs;
 
+  std::vector<uint64_t> minSquaredDistances;
+  std::vector<uint64_t> minCenterIndices;
 };
 
 #endif // MAPRED_K_MEANS_MAP_FUNCTION_H
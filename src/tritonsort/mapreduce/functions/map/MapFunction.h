@@ -41,6 +41,32 @@ public:
    */
   virtual void map(KeyValuePair& kvPair, KVPairWriterInterface& writer) = 0;
 
+  /**
+     Execute the map function on a batch of consecutive key/value pairs from
+     the same input buffer. Map functions whose per-tuple work can be shared
+     across tuples (for example by streaming a large lookup table through the
+     cache once per batch instead of once per tuple) should override this
+     method.
+
+     By default, this function calls map() on each tuple in order.
+
+     \param kvPairs an array of key/value pairs on which to perform the map
+     function
+
+     \param numKVPairs the number of key/value pairs in kvPairs
+
+     \param writer the map function emits tuples by calling
+     KVPairWriterInterface::write or KVPairWriterInterface::setupWrite /
+     KVPairWriterInterface::commitWrite on this object
+   */
+  virtual void mapBatch(
+    KeyValuePair* kvPairs, uint64_t numKVPairs,
+    KVPairWriterInterface& writer) {
+    for (uint64_t i = 0; i < numKVPairs; i++) {
+      map(kvPairs[i], writer);
+    }
+  }
+
   /**
      Perform any cleanup on the map function that needs to occur after the map
      function has finished processing all tuples but before it is destructed.
@@ -13,10 +13,12 @@ const char* malloc_conf = "lg_chunk:20,lg_tcache_gc_sweep:30";
 #include "../common/MainUtils.h"
 #include "common/BufferListContainerFactory.h"
 #include "common/ByteStreamBufferFactory.h"
+#include "common/DiskIOScheduler.h"
 #include "common/PartitionFile.h"
 #include "common/SimpleMemoryAllocator.h"
 #include "common/WriteTokenPool.h"
 #include "core/AbortingDeadlockResolver.h"
+#include "core/BufferTracer.h"
 #include "core/CPUAffinitySetter.h"
 #include "core/DefaultAllocatorPolicy.h"
 #include "core/File.h"
@@ -29,6 +31,7 @@ const char* malloc_conf = "lg_chunk:20,lg_tcache_gc_sweep:30";
 #include "core/RedisConnection.h"
 #include "core/ResourceMonitor.h"
 #include "core/StatWriter.h"
+#include "core/Thread.h"
 #include "core/ThreadSafeVector.h"
 #include "core/Timer.h"
 #include "core/TrackerSet.h"
@@ -38,10 +41,13 @@ const char* malloc_conf = "lg_chunk:20,lg_tcache_gc_sweep:30";
 #include "mapreduce/common/ChunkMap.h"
 #include "mapreduce/common/CoordinatorClientFactory.h"
 #include "mapreduce/common/CoordinatorClientInterface.h"
+#include "mapreduce/common/ExtentIndex.h"
+#include "mapreduce/common/ExtentReadRequest.h"
 #include "mapreduce/common/FilenameToStreamIDMap.h"
 #include "mapreduce/common/JobInfo.h"
 #include "mapreduce/common/ListableKVPairBufferFactory.h"
 #include "mapreduce/common/PartitionFunctionInterface.h"
+#include "mapreduce/common/ReadRequest.h"
 #include "mapreduce/common/SampleMetadataKVPairBufferFactory.h"
 #include "mapreduce/common/Utils.h"
 #include "mapreduce/common/boundary/KeyPartitionerInterface.h"
@@ -559,6 +565,10 @@ void executePhaseOne(
   StatusPrinter::flush();
 }
 
+bool largerReadRequest(ReadRequest* request, ReadRequest* otherRequest) {
+  return request->length > otherRequest->length;
+}
+
 void executePhaseTwo(
   Params* params, IPList& peers, const StringList& intermediateDiskList,
   const StringList& outputDiskList) {
@@ -568,6 +578,16 @@ void executePhaseTwo(
   StatLogger phaseTwoStatLogger(phaseName);
   StatWriter::setCurrentPhaseName(phaseName);
 
+  bool logStructured = params->get<bool>("LOG_STRUCTURED_INTERMEDIATES");
+  if (logStructured) {
+    // Partitions are scattered across phase one's extent logs, so read them
+    // with a reader that understands extent indices.
+    ABORT_IF(params->contains("FORMAT_READER.phase_two"),
+             "Can't read log-structured intermediate files with a format "
+             "reader");
+    params->add<std::string>("WORKER_IMPLS.phase_two.reader", "ExtentReader");
+  }
+
   CoordinatorClientInterface* barrierCoordinatorClient =
     CoordinatorClientFactory::newCoordinatorClient(*params, phaseName, "", 0);
 
@@ -706,6 +726,9 @@ void executePhaseTwo(
     &workerFactory, "mapreduce", "kv_pair_buf_receiver");
 
   // Add intermediate files to the appropriate reader for each job
+  bool largestPartitionFirst = params->get<bool>("LARGEST_PARTITION_FIRST");
+  std::vector<ReadRequest*> partitionRequests;
+
   std::list<uint64_t> jobIDList;
   parseCommaDelimitedList< uint64_t, std::list<uint64_t> >(
     jobIDList, params->get<std::string>("JOB_IDS"));
@@ -724,32 +747,82 @@ void executePhaseTwo(
     uint64_t diskID = 0;
     for (StringList::const_iterator diskIter = intermediateDiskList.begin();
          diskIter != intermediateDiskList.end(); diskIter++) {
-      Glob intermediateGlob(
-        *diskIter + outputDirectory.path() + "/*.partition");
-
-      const StringList& intermediateFiles = intermediateGlob.getFiles();
-      StringVector fileVector;
-      for (StringList::const_iterator fileIter = intermediateFiles.begin();
-           fileIter != intermediateFiles.end(); fileIter++) {
-        fileVector.push_back(*fileIter);
+      std::vector<ReadRequest*> diskRequests;
+
+      if (logStructured) {
+        // Read each partition out of the disk's extent logs.
+        Glob indexGlob(
+          *diskIter + outputDirectory.path() + "/*.extents.index");
+
+        const StringList& indexFiles = indexGlob.getFiles();
+        for (StringList::const_iterator fileIter = indexFiles.begin();
+             fileIter != indexFiles.end(); fileIter++) {
+          ExtentIndex index;
+          index.read(*fileIter);
+
+          std::string logFilename(ExtentIndex::getLogFilename(*fileIter));
+
+          const ExtentIndex::PartitionExtentMap& partitions =
+            index.getPartitions();
+          for (ExtentIndex::PartitionExtentMap::const_iterator partitionIter =
+                 partitions.begin(); partitionIter != partitions.end();
+               partitionIter++) {
+            diskRequests.push_back(
+              new ExtentReadRequest(
+                logFilename, diskID, *jobIter, partitionIter->first,
+                partitionIter->second));
+          }
+        }
+      } else {
+        Glob intermediateGlob(
+          *diskIter + outputDirectory.path() + "/*.partition");
+
+        const StringList& intermediateFiles = intermediateGlob.getFiles();
+        for (StringList::const_iterator fileIter = intermediateFiles.begin();
+             fileIter != intermediateFiles.end(); fileIter++) {
+
+          PartitionFile file(*fileIter);
+          ReadRequest* request = new ReadRequest(*fileIter, diskID);
+          request->jobIDs.insert(file.getJobID());
+          diskRequests.push_back(request);
+        }
       }
-      std::random_shuffle(fileVector.begin(), fileVector.end() );
 
-      for (StringVector::iterator fileIter = fileVector.begin();
-           fileIter != fileVector.end(); fileIter++) {
-
-        PartitionFile file(*fileIter);
-        ReadRequest* request = new ReadRequest(*fileIter, diskID);
-        request->jobIDs.insert(file.getJobID());
-        readerTracker.addWorkUnit(request);
+      if (!largestPartitionFirst) {
+        std::random_shuffle(diskRequests.begin(), diskRequests.end());
       }
 
+      partitionRequests.insert(
+        partitionRequests.end(), diskRequests.begin(), diskRequests.end());
+
       diskID++;
     }
   }
 
   delete coordinatorClient;
 
+  if (largestPartitionFirst) {
+    // Sort partitions from every disk together, largest first. Each disk's
+    // reader then reads its partitions largest first, and the sorters and
+    // reducers, which take partitions from every disk, always start on the
+    // largest partition available, so the last partitions to finish are small
+    // ones.
+    std::stable_sort(
+      partitionRequests.begin(), partitionRequests.end(), &largerReadRequest);
+
+    if (params->get<bool>("ASYNCHRONOUS_READ_SCHEDULING")) {
+      StatusPrinter::add(
+        "Asynchronous read scheduling reads each disk's partitions in filename "
+        "order, so LARGEST_PARTITION_FIRST doesn't order partitions within a "
+        "disk");
+    }
+  }
+
+  for (std::vector<ReadRequest*>::iterator iter = partitionRequests.begin();
+       iter != partitionRequests.end(); iter++) {
+    readerTracker.addWorkUnit(*iter);
+  }
+
   FilenameToStreamIDMap intermediateFilenameToStreamIDMap;
   if (useConverter) {
     workerFactory.addDependency("reader", "filename_to_stream_id_map",
@@ -788,32 +861,16 @@ void executePhaseTwo(
   StatusPrinter::flush();
 }
 
-void executePhaseThree(
-  Params* params, IPList& peers, const StringList& intermediateDiskList,
-  const StringList& outputDiskList) {
-  // Phase Three is responsible for performing an external merge sort on the
-  // partitions that were too large to process in phase two. It operates in two
-  // subphases.
-  //  splitsort: Split and Sort
-  //    Split the large partition into manageable chunks, sort each chunk, and
-  //    write sorted chunk files back to intermediate disks.
-  //  mergereduce: Merge and Reduce
-  //    Stream sorted chunks from disk into an in-memory merger that constructs
-  //    a streaming representation of the sorted partition.  This sorted
-  //    partition is directed, one buffer at a time, to a reducer that is
-  //    configured to expect multiple buffers per partition (since we can't fit
-  //    the entire partition in memory). Finally, the reduced partition is
-  //    written back to output disks.
-
+void executeSplitSort(
+  Params* params, const StringList& intermediateDiskList, ChunkMap& chunkMap) {
+  // Split and Sort: split each large partition into manageable chunks, sort
+  // each chunk, and write sorted chunk files back to intermediate disks. Since
+  // this may run concurrently with phase two, the caller sets
+  // NUM_OUTPUT_DISKS.phase_three to the number of intermediate disks
+  // beforehand rather than modifying params here.
   std::string phaseName = "phase_three";
 
-  StatLogger phaseThreeStatLogger(phaseName);
-  StatWriter::setCurrentPhaseName(phaseName);
-
-  // The first part of phase three reads from intermediate disks and writes back
-  // to intermediate disks, so configure the chunk map accordingly.
-  uint64_t numSplitSortDisks = intermediateDiskList.size();
-  ChunkMap chunkMap(numSplitSortDisks);
+  StatLogger splitSortStatLogger(phaseName);
 
   SimpleMemoryAllocator* memoryAllocator = new SimpleMemoryAllocator();
 
@@ -825,18 +882,11 @@ void executePhaseThree(
   parseCommaDelimitedList< uint64_t, std::list<uint64_t> >(
     jobIDList, params->get<std::string>("JOB_IDS"));
 
-  // Large partition files and smaller chunk files reside in the intermediate
-  // file directory, which is phase one's output directory.
-  // in the phase one output directory, so get that.
+  // Large partition files reside in the intermediate file directory, which is
+  // phase one's output directory, so get that.
   CoordinatorClientInterface* coordinatorClient =
     CoordinatorClientFactory::newCoordinatorClient(*params, "phase_one", "", 0);
 
-  // ===============//
-  // Split and Sort //
-  // ============== //
-  params->add<uint64_t>(
-    "NUM_OUTPUT_DISKS.phase_three", numSplitSortDisks);
-
   MapReduceWorkQueueingPolicyFactory splitSortQueueingPolicyFactory;
   splitSortQueueingPolicyFactory.setChunkMap(&chunkMap);
 
@@ -906,6 +956,21 @@ void executePhaseThree(
   splitSortWorkerFactory.addDependency(
     "chunk_map", &chunkMap);
 
+  DiskIOScheduler* ioScheduler = NULL;
+  if (params->get<bool>("DISK_IO_SCHEDULING")) {
+    ioScheduler = new DiskIOScheduler(
+      params->get<uint64_t>("DISK_IO_BURST_LENGTH"),
+      params->get<double>("DISK_IO_READ_SHARE"));
+    splitSortWorkerFactory.addDependency("io_scheduler", ioScheduler);
+  }
+
+  // Gather every large partition so they can be split and sorted largest
+  // first, which keeps one big partition that started late from holding up
+  // the end of the subphase.
+  std::vector<ReadRequest*> largePartitionRequests;
+
+  bool logStructured = params->get<bool>("LOG_STRUCTURED_INTERMEDIATES");
+
   for (std::list<uint64_t>::iterator jobIter = jobIDList.begin();
          jobIter != jobIDList.end(); jobIter++) {
     const themis::URL& outputDirectory =
@@ -917,30 +982,88 @@ void executePhaseThree(
     uint64_t diskID = 0;
     for (StringList::const_iterator diskIter = intermediateDiskList.begin();
          diskIter != intermediateDiskList.end(); diskIter++) {
-      Glob intermediateGlob(
-        *diskIter + outputDirectory.path() + "/*.partition.large");
-
-      const StringList& intermediateFiles = intermediateGlob.getFiles();
+      if (logStructured) {
+        // Large partitions are recorded in the extent logs' large partition
+        // indices.
+        Glob indexGlob(
+          *diskIter + outputDirectory.path() + "/*.extents.large.index");
+
+        const StringList& indexFiles = indexGlob.getFiles();
+        for (StringList::const_iterator fileIter = indexFiles.begin();
+             fileIter != indexFiles.end(); fileIter++) {
+          ExtentIndex index;
+          index.read(*fileIter);
+
+          std::string logFilename(ExtentIndex::getLogFilename(*fileIter));
+
+          const ExtentIndex::PartitionExtentMap& partitions =
+            index.getPartitions();
+          for (ExtentIndex::PartitionExtentMap::const_iterator partitionIter =
+                 partitions.begin(); partitionIter != partitions.end();
+               partitionIter++) {
+            largePartitionRequests.push_back(
+              new ExtentReadRequest(
+                logFilename, diskID, *jobIter, partitionIter->first,
+                partitionIter->second));
+          }
+        }
+      } else {
+        Glob intermediateGlob(
+          *diskIter + outputDirectory.path() + "/*.partition.large");
 
-      for (StringList::const_iterator fileIter = intermediateFiles.begin();
-           fileIter != intermediateFiles.end(); fileIter++) {
+        const StringList& intermediateFiles = intermediateGlob.getFiles();
 
-        PartitionFile file(*fileIter);
-        ReadRequest* request = new ReadRequest(*fileIter, diskID);
-        request->jobIDs.insert(file.getJobID());
+        for (StringList::const_iterator fileIter = intermediateFiles.begin();
+             fileIter != intermediateFiles.end(); fileIter++) {
 
-        splitSortReaderTracker.addWorkUnit(request);
+          PartitionFile file(*fileIter);
+          ReadRequest* request = new ReadRequest(*fileIter, diskID);
+          request->jobIDs.insert(file.getJobID());
 
+          largePartitionRequests.push_back(request);
+        }
       }
 
       diskID++;
     }
   }
 
-  splitSortTrackers.createWorkers();
+  delete coordinatorClient;
 
-  Timer phaseThreeTimer;
-  phaseThreeTimer.start();
+  std::stable_sort(
+    largePartitionRequests.begin(), largePartitionRequests.end(),
+    &largerReadRequest);
+
+  for (std::vector<ReadRequest*>::iterator iter =
+         largePartitionRequests.begin();
+       iter != largePartitionRequests.end(); iter++) {
+    ExtentReadRequest* extentRequest = dynamic_cast<ExtentReadRequest*>(*iter);
+
+    if (extentRequest == NULL) {
+      splitSortReaderTracker.addWorkUnit(*iter);
+      continue;
+    }
+
+    // Each extent is a whole number of records, so read each one as its own
+    // stream. Their filenames don't say which partition they belong to, so
+    // tell the converter.
+    const ExtentIndex::ExtentVector& extents = extentRequest->extents;
+    for (ExtentIndex::ExtentVector::const_iterator extentIter =
+           extents.begin(); extentIter != extents.end(); extentIter++) {
+      largePartitionFilenameToStreamIDMap.setPartitionID(
+        extentRequest->path, extentIter->offset, extentRequest->partitionID);
+
+      splitSortReaderTracker.addWorkUnit(
+        new ExtentReadRequest(
+          extentRequest->path, extentRequest->diskID,
+          *(extentRequest->jobIDs.begin()), extentRequest->partitionID,
+          ExtentIndex::ExtentVector(1, *extentIter)));
+    }
+
+    delete extentRequest;
+  }
+
+  splitSortTrackers.createWorkers();
 
   Timer splitSortTimer;
   splitSortTimer.start();
@@ -951,10 +1074,203 @@ void executePhaseThree(
   splitSortTrackers.waitForWorkersToFinish();
 
   splitSortTimer.stop();
-  phaseThreeStatLogger.logDatum("splitsort_runtime", splitSortTimer);
+  splitSortStatLogger.logDatum("splitsort_runtime", splitSortTimer);
 
   splitSortTrackers.destroyWorkers();
 
+  if (ioScheduler != NULL) {
+    delete ioScheduler;
+  }
+
+  delete memoryAllocator;
+}
+
+/**
+   Arguments to executeSplitSort, wrapped in a struct so that it can be run in
+   its own thread.
+ */
+struct SplitSortArgs {
+  // Phase two adds parameters while splitsort is running, so splitsort reads
+  // its own copy
+  Params params;
+  const StringList& intermediateDiskList;
+  ChunkMap& chunkMap;
+
+  SplitSortArgs(
+    const Params& _params, const StringList& _intermediateDiskList,
+    ChunkMap& _chunkMap)
+    : params(_params),
+      intermediateDiskList(_intermediateDiskList),
+      chunkMap(_chunkMap) {}
+};
+
+void* executeSplitSortThreaded(void* args) {
+  SplitSortArgs* splitSortArgs = static_cast<SplitSortArgs*>(args);
+
+  // Phase two owns the StatWriter's current phase, so splitsort's statistics
+  // are attributed to phase three explicitly.
+  StatWriter::setThreadPhaseName("phase_three");
+
+  executeSplitSort(
+    &(splitSortArgs->params), splitSortArgs->intermediateDiskList,
+    splitSortArgs->chunkMap);
+
+  StatWriter::clearThreadPhaseName();
+
+  return NULL;
+}
+
+/**
+   \return true if phase one left any large partitions for splitsort on the
+   given intermediate disks
+ */
+bool largePartitionsExist(
+  Params& params, const StringList& intermediateDiskList) {
+  std::list<uint64_t> jobIDList;
+  parseCommaDelimitedList< uint64_t, std::list<uint64_t> >(
+    jobIDList, params.get<std::string>("JOB_IDS"));
+
+  CoordinatorClientInterface* coordinatorClient =
+    CoordinatorClientFactory::newCoordinatorClient(params, "phase_one", "", 0);
+
+  bool logStructured = params.get<bool>("LOG_STRUCTURED_INTERMEDIATES");
+  bool found = false;
+
+  for (std::list<uint64_t>::iterator jobIter = jobIDList.begin();
+       !found && jobIter != jobIDList.end(); jobIter++) {
+    const themis::URL& outputDirectory =
+      coordinatorClient->getOutputDirectory(*jobIter);
+
+    for (StringList::const_iterator diskIter = intermediateDiskList.begin();
+         !found && diskIter != intermediateDiskList.end(); diskIter++) {
+      if (logStructured) {
+        Glob indexGlob(
+          *diskIter + outputDirectory.path() + "/*.extents.large.index");
+
+        const StringList& indexFiles = indexGlob.getFiles();
+        for (StringList::const_iterator fileIter = indexFiles.begin();
+             !found && fileIter != indexFiles.end(); fileIter++) {
+          ExtentIndex index;
+          index.read(*fileIter);
+          found = !index.getPartitions().empty();
+        }
+      } else {
+        Glob intermediateGlob(
+          *diskIter + outputDirectory.path() + "/*.partition.large");
+        found = !intermediateGlob.getFiles().empty();
+      }
+    }
+  }
+
+  delete coordinatorClient;
+
+  return found;
+}
+
+/**
+   When splitsort overlaps with phase two, both pipelines have to fit in the
+   memory that phase two would have had to itself. Scale phase two's and
+   splitsort's memory quotas down by the same factor so that, together, they
+   add up to phase two's original quotas.
+ */
+void shareMemoryQuotasWithSplitSort(Params& params) {
+  const char* phaseTwoQuotas[] = {
+    "MEMORY_QUOTAS.phase_two.reader",
+    "MEMORY_QUOTAS.phase_two.reader_converter",
+    "MEMORY_QUOTAS.phase_two.sorter",
+    "MEMORY_QUOTAS.phase_two.reducer",
+    "MEMORY_QUOTAS.phase_two.reducer_replica"
+  };
+  const char* splitSortQuotas[] = {
+    "MEMORY_QUOTAS.phase_three.splitsort_reader",
+    "MEMORY_QUOTAS.phase_three.splitsort_reader_converter",
+    "MEMORY_QUOTAS.phase_three.sorter"
+  };
+
+  uint64_t numPhaseTwoQuotas = sizeof(phaseTwoQuotas) / sizeof(const char*);
+  uint64_t numSplitSortQuotas = sizeof(splitSortQuotas) / sizeof(const char*);
+
+  uint64_t phaseTwoTotal = 0;
+  for (uint64_t i = 0; i < numPhaseTwoQuotas; i++) {
+    phaseTwoTotal += params.get<uint64_t>(phaseTwoQuotas[i]);
+  }
+
+  uint64_t splitSortTotal = 0;
+  for (uint64_t i = 0; i < numSplitSortQuotas; i++) {
+    splitSortTotal += params.get<uint64_t>(splitSortQuotas[i]);
+  }
+
+  if (phaseTwoTotal + splitSortTotal == 0) {
+    return;
+  }
+
+  double scale = phaseTwoTotal / static_cast<double>(
+    phaseTwoTotal + splitSortTotal);
+
+  for (uint64_t i = 0; i < numPhaseTwoQuotas; i++) {
+    params.add<uint64_t>(
+      phaseTwoQuotas[i], params.get<uint64_t>(phaseTwoQuotas[i]) * scale);
+  }
+
+  for (uint64_t i = 0; i < numSplitSortQuotas; i++) {
+    params.add<uint64_t>(
+      splitSortQuotas[i], params.get<uint64_t>(splitSortQuotas[i]) * scale);
+  }
+}
+
+void executePhaseThree(
+  Params* params, IPList& peers, const StringList& intermediateDiskList,
+  const StringList& outputDiskList, ChunkMap& chunkMap,
+  bool splitSortComplete) {
+  // Phase Three is responsible for performing an external merge sort on the
+  // partitions that were too large to process in phase two. It operates in two
+  // subphases.
+  //  splitsort: Split and Sort
+  //    Split the large partition into manageable chunks, sort each chunk, and
+  //    write sorted chunk files back to intermediate disks.
+  //  mergereduce: Merge and Reduce
+  //    Stream sorted chunks from disk into an in-memory merger that constructs
+  //    a streaming representation of the sorted partition.  This sorted
+  //    partition is directed, one buffer at a time, to a reducer that is
+  //    configured to expect multiple buffers per partition (since we can't fit
+  //    the entire partition in memory). Finally, the reduced partition is
+  //    written back to output disks.
+  //
+  // If OVERLAP_PHASE_THREE is set, splitsort has already been run alongside
+  // phase two, so only mergereduce is left to do.
+
+  std::string phaseName = "phase_three";
+
+  StatLogger phaseThreeStatLogger(phaseName);
+  StatWriter::setCurrentPhaseName(phaseName);
+
+  Timer phaseThreeTimer;
+  phaseThreeTimer.start();
+
+  if (!splitSortComplete) {
+    // The first part of phase three reads from intermediate disks and writes
+    // back to intermediate disks.
+    params->add<uint64_t>(
+      "NUM_OUTPUT_DISKS.phase_three", intermediateDiskList.size());
+
+    executeSplitSort(params, intermediateDiskList, chunkMap);
+  }
+
+  SimpleMemoryAllocator* memoryAllocator = new SimpleMemoryAllocator();
+
+  MapReduceWorkerImpls mapReduceWorkerImpls;
+  CPUAffinitySetter cpuAffinitySetter(*params, phaseName);
+
+  // Parse job IDs.
+  std::list<uint64_t> jobIDList;
+  parseCommaDelimitedList< uint64_t, std::list<uint64_t> >(
+    jobIDList, params->get<std::string>("JOB_IDS"));
+
+  // Chunk files reside in the intermediate file directory, which is phase
+  // one's output directory, so get that.
+  CoordinatorClientInterface* coordinatorClient =
+    CoordinatorClientFactory::newCoordinatorClient(*params, "phase_one", "", 0);
+
   // =================//
   // Merge and Reduce //
   // ================ //
@@ -1145,6 +1461,14 @@ void executePhaseThree(
 
   mergeReduceWorkerFactory.addDependency("read_token_pool", &tokenPool);
 
+  DiskIOScheduler* ioScheduler = NULL;
+  if (params->get<bool>("DISK_IO_SCHEDULING")) {
+    ioScheduler = new DiskIOScheduler(
+      params->get<uint64_t>("DISK_IO_BURST_LENGTH"),
+      params->get<double>("DISK_IO_READ_SHARE"));
+    mergeReduceWorkerFactory.addDependency("io_scheduler", ioScheduler);
+  }
+
   for (std::list<uint64_t>::iterator jobIter = jobIDList.begin();
          jobIter != jobIDList.end(); jobIter++) {
     const themis::URL& outputDirectory =
@@ -1204,6 +1528,10 @@ void executePhaseThree(
 
   delete coordinatorClient;
 
+  if (ioScheduler != NULL) {
+    delete ioScheduler;
+  }
+
   delete memoryAllocator;
 
   StatusPrinter::add("Phase 3 complete");
@@ -1377,6 +1705,17 @@ void deriveAdditionalParams(
     params.add<uint64_t>("ALIGNMENT.phase_two.writer", alignmentMultiple);
   }
 
+  if (params.get<bool>("LOG_STRUCTURED_INTERMEDIATES")) {
+    // With log-structured intermediates, splitsort reads large partitions as
+    // byte ranges of phase one's extent logs. Those ranges start wherever the
+    // writer's buffers landed, so they can't be read with direct I/O, and the
+    // logs are shared with other partitions, so they can't be deleted.
+    params.add<bool>("DIRECT_IO.phase_three.splitsort_reader", false);
+    ABORT_IF(params.get<bool>("DELETE_AFTER_READ.phase_three"),
+             "Can't delete log-structured intermediate files after reading "
+             "them in phase three");
+  }
+
   if (params.get<bool>("DIRECT_IO.phase_three.splitsort_reader")) {
     // Phase three splitsort reader should align buffers.
     params.add<uint64_t>(
@@ -1461,6 +1800,8 @@ int main(int argc, char** argv) {
   StatWriter::init(params);
   StatWriter::spawn();
 
+  BufferTracer::init(params);
+
   ResourceMonitor::init(&params);
   ResourceMonitor::spawn();
 
@@ -1555,18 +1896,55 @@ int main(int argc, char** argv) {
     delete keyPartitioner;
   }
 
+  // Phase three's splitsort subphase can run alongside phase two, since the
+  // large partitions it operates on are all known once phase one completes.
+  // Overlapping takes memory away from phase two for all of phase two, so
+  // only do it if there's something for splitsort to do.
+  bool overlapPhaseThree = !params.get<bool>("SKIP_PHASE_TWO") &&
+    !params.get<bool>("SKIP_PHASE_THREE") &&
+    params.get<bool>("OVERLAP_PHASE_THREE") &&
+    largePartitionsExist(params, intermediateDiskList);
+
+  ChunkMap chunkMap(intermediateDiskList.size());
+  SplitSortArgs* splitSortArgs = NULL;
+  themis::Thread* splitSortThread = NULL;
+
   if (!params.get<bool>("SKIP_PHASE_TWO")) {
     // Phase two also uses SimpleMemoryAllocator, so limit the memory usage to
     // prevent the OOM killer from killing us.
     limitMemorySize(params);
 
+    if (overlapPhaseThree) {
+      params.add<uint64_t>(
+        "NUM_OUTPUT_DISKS.phase_three", intermediateDiskList.size());
+      shareMemoryQuotasWithSplitSort(params);
+
+      splitSortArgs = new SplitSortArgs(params, intermediateDiskList, chunkMap);
+
+      splitSortThread = new themis::Thread(
+        "SplitSort", &executeSplitSortThreaded);
+      splitSortThread->startThread(splitSortArgs);
+    }
+
     executePhaseTwo(&params, peers, intermediateDiskList, outputDiskList);
   }
 
   if (!params.get<bool>("SKIP_PHASE_THREE")) {
+    if (splitSortThread != NULL) {
+      // Wait for splitsort to finish before merging its chunks.
+      splitSortThread->stopThread();
+      delete splitSortThread;
+      splitSortThread = NULL;
+
+      delete splitSortArgs;
+      splitSortArgs = NULL;
+    }
+
     limitMemorySize(params);
 
-    executePhaseThree(&params, peers, intermediateDiskList, outputDiskList);
+    executePhaseThree(
+      &params, peers, intermediateDiskList, outputDiskList, chunkMap,
+      overlapPhaseThree);
   }
 
   dumpParams(params);
@@ -1582,6 +1960,8 @@ int main(int argc, char** argv) {
   // Delete logger so that it deregisters
   delete mainLogger;
 
+  BufferTracer::teardown();
+
   StatWriter::teardown();
 
   StatusPrinter::teardown();
@@ -15,6 +15,7 @@ const char* malloc_conf = "lg_chunk:20,lg_tcache_gc_sweep:30";
 #include "common/SimpleMemoryAllocator.h"
 #include "common/WriteTokenPool.h"
 #include "core/AbortingDeadlockResolver.h"
+#include "core/BufferTracer.h"
 #include "core/CPUAffinitySetter.h"
 #include "core/DefaultAllocatorPolicy.h"
 #include "core/File.h"
@@ -330,6 +331,8 @@ int main(int argc, char** argv) {
   StatWriter::init(params);
   StatWriter::spawn();
 
+  BufferTracer::init(params);
+
   ResourceMonitor::init(&params);
   ResourceMonitor::spawn();
 
@@ -416,6 +419,8 @@ int main(int argc, char** argv) {
   // Delete logger so that it deregisters
   delete mainLogger;
 
+  BufferTracer::teardown();
+
   StatWriter::teardown();
 
   StatusPrinter::teardown();
@@ -1,6 +1,6 @@
+#include <algorithm>
 #include <boost/bind.hpp>
 
-#include "core/MemoryUtils.h"
 #include "mapreduce/workers/boundarydecider/BoundaryDecider.h"
 
 BoundaryDecider::BoundaryDecider(
@@ -13,10 +13,15 @@ BoundaryDecider::BoundaryDecider(
     bufferFactory(*this, memoryAllocator, defaultBufferSize, alignmentSize),
     writer(
       boost::bind(&BoundaryDecider::broadcastOutputChunk, this, _1),
-      boost::bind(&BoundaryDecider::getOutputChunk, this, _1)),
-    sortStrategy(false) {
+      boost::bind(&BoundaryDecider::getOutputChunk, this, _1)) {
   buffers.resize(numNodes);
   kvPairs.resize(numNodes);
+  medianCandidates.resize(numNodes);
+}
+
+bool BoundaryDecider::keyLessThan(
+  const KeyValuePair* tuple1, const KeyValuePair* tuple2) {
+  return KeyValuePair::compareByKey(*tuple1, *tuple2) < 0;
 }
 
 void BoundaryDecider::run() {
@@ -40,43 +45,18 @@ void BoundaryDecider::run() {
 
   bool done = false;
   while (!done) {
-    // Sort the partition boundary keys and take the median key.
-    uint64_t totalBytes = 0;
-    for (TupleVector::iterator iter = kvPairs.begin(); iter != kvPairs.end();
-         iter++) {
-      totalBytes += iter->getWriteSize();
+    // Select the median key among the partition boundary keys.
+    for (uint64_t i = 0; i < numNodes; i++) {
+      medianCandidates[i] = &(kvPairs[i]);
     }
 
-    KVPairBuffer* buffer = bufferFactory.newInstance(totalBytes);
-    for (TupleVector::iterator iter = kvPairs.begin(); iter != kvPairs.end();
-         iter++) {
-      buffer->addKVPair(*iter);
-    }
-
-    uint64_t scratchBufferSize =
-      sortStrategy.getRequiredScratchBufferSize(buffer);
-    uint8_t* scratchBuffer = new (themis::memcheck) uint8_t[scratchBufferSize];
-
-    KVPairBuffer* sortedBuffer = bufferFactory.newInstance(totalBytes);
-
-    sortStrategy.setScratchBuffer(scratchBuffer);
-    sortStrategy.sort(buffer, sortedBuffer);
-    sortedBuffer->resetIterator();
-
-    delete buffer;
-    delete[] scratchBuffer;
-
-    // Pick off the median key.
-    KeyValuePair kvPair;
     uint64_t medianIndex = (numNodes - 1) / 2;
-    for (uint64_t i = 0; i < medianIndex + 1; i++) {
-      sortedBuffer->getNextKVPair(kvPair);
-    }
+    std::nth_element(
+      medianCandidates.begin(), medianCandidates.begin() + medianIndex,
+      medianCandidates.end(), &BoundaryDecider::keyLessThan);
 
     // Copy this median key to the partition boundary buffer.
-    writer.write(kvPair);
-
-    delete sortedBuffer;
+    writer.write(*(medianCandidates[medianIndex]));
 
     // Now fetch new tuples from each buffer, and new buffers if we run out of
     // tuples.
@@ -9,7 +9,6 @@
 #include "mapreduce/common/KeyValuePair.h"
 #include "mapreduce/common/SimpleKVPairWriter.h"
 #include "mapreduce/common/buffers/KVPairBuffer.h"
-#include "mapreduce/common/sorting/QuickSortStrategy.h"
 
 /**
    BoundaryDecider is responsible for deciding upon the job-wide partition
@@ -41,14 +40,26 @@ public:
     uint64_t alignmentSize, uint64_t numNodes);
 
   /**
-     Take in boundary buffers from all nodes and, for each partition, sort the
-     keys and pick the median key as the official boundary key.
+     Take in boundary buffers from all nodes and, for each partition, select
+     the median key as the official boundary key.
+
+     Medians are selected in place with std::nth_element over pointers to the
+     current tuple from each node, so no memory is allocated per partition.
    */
   void run();
 
 private:
   typedef std::vector<KVPairBuffer*> BufferVector;
   typedef std::vector<KeyValuePair> TupleVector;
+  typedef std::vector<KeyValuePair*> TuplePointerVector;
+
+  /// Orders tuples by key, matching the order used when sorting tuples
+  /**
+     \return true if the key of the first tuple is smaller than the key of the
+     second tuple
+   */
+  static bool keyLessThan(
+    const KeyValuePair* tuple1, const KeyValuePair* tuple2);
 
   /// Used internally to get an output chunk buffer
   /**
@@ -73,8 +84,7 @@ private:
 
   BufferVector buffers;
   TupleVector kvPairs;
-
-  QuickSortStrategy sortStrategy;
+  TuplePointerVector medianCandidates;
 };
 
 #endif // MAPRED_BOUNDARY_DECIDER_H
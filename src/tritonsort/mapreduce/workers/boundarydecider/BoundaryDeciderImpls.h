@@ -2,12 +2,14 @@
 #define MAPRED_BOUNDARY_DECIDER_IMPLS_H
 
 #include "BoundaryDecider.h"
+#include "SketchBoundaryDecider.h"
 #include "core/ImplementationList.h"
 
 class BoundaryDeciderImpls : public ImplementationList {
 public:
   BoundaryDeciderImpls() : ImplementationList() {
     ADD_IMPLEMENTATION(BoundaryDecider, "BoundaryDecider");
+    ADD_IMPLEMENTATION(SketchBoundaryDecider, "SketchBoundaryDecider");
   }
 };
 
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include "core/Params.h"
+#include "core/StatusPrinter.h"
+#include "mapreduce/common/CoordinatorClientFactory.h"
+#include "mapreduce/common/CoordinatorClientInterface.h"
+#include "mapreduce/common/Utils.h"
+#include "mapreduce/workers/boundarydecider/SketchBoundaryDecider.h"
+
+SketchBoundaryDecider::SketchBoundaryDecider(
+  uint64_t id, const std::string& stageName, const std::string& _phaseName,
+  MemoryAllocatorInterface& memoryAllocator, uint64_t defaultBufferSize,
+  uint64_t alignmentSize, const Params& _params, uint64_t _numNodes,
+  uint64_t sketchCapacity)
+  : MultiQueueRunnable(id, stageName),
+    phaseName(_phaseName),
+    params(_params),
+    numNodes(_numNodes),
+    logger(stageName, id),
+    jobID(0),
+    bufferFactory(*this, memoryAllocator, defaultBufferSize, alignmentSize),
+    writer(
+      boost::bind(&SketchBoundaryDecider::broadcastOutputChunk, this, _1),
+      boost::bind(&SketchBoundaryDecider::getOutputChunk, this, _1)),
+    sketch(sketchCapacity) {
+  predictedPartitionSizeStatID = logger.registerSummaryStat(
+    "predicted_partition_size");
+}
+
+void SketchBoundaryDecider::run() {
+  // Merge every sketch buffer from every peer.
+  uint64_t buffersMerged = 0;
+  for (uint64_t peerID = 0; peerID < numNodes; peerID++) {
+    KVPairBuffer* buffer = getNewWork(peerID);
+    while (buffer != NULL) {
+      if (buffersMerged == 0) {
+        // Get the job ID from the first buffer.
+        uint64_t numJobIDs = buffer->getJobIDs().size();
+        ABORT_IF(numJobIDs != 1, "Expected one job ID but got %llu",
+                 numJobIDs);
+        jobID = *(buffer->getJobIDs().begin());
+      }
+
+      sketch.deserialize(*buffer);
+      buffersMerged++;
+
+      delete buffer;
+      buffer = getNewWork(peerID);
+    }
+  }
+
+  if (buffersMerged == 0) {
+    // Sketches are only sent to the coordinator, so there is nothing to do.
+    return;
+  }
+
+  CoordinatorClientInterface* coordinatorClient =
+    CoordinatorClientFactory::newCoordinatorClient(
+      params, phaseName, getName(), getID());
+
+  uint64_t numPartitions = setNumPartitionsFromSampleStatistics(
+    jobID, numNodes, *coordinatorClient, params);
+
+  delete coordinatorClient;
+
+  std::vector<uint64_t> partitionWeights;
+  uint64_t numHeavyKeys = sketch.writeBoundaries(
+    numPartitions, writer, partitionWeights);
+
+  // Log predicted partition sizes, in sampled bytes, so they can be compared
+  // with the actual partition sizes logged by the writers.
+  uint64_t largestPartitionWeight = 0;
+  for (std::vector<uint64_t>::iterator iter = partitionWeights.begin();
+       iter != partitionWeights.end(); iter++) {
+    logger.add(predictedPartitionSizeStatID, *iter);
+    largestPartitionWeight = std::max(largestPartitionWeight, *iter);
+  }
+
+  logger.logDatum("sample_bytes", sketch.getTotalWeight());
+  logger.logDatum("heavy_keys", numHeavyKeys);
+
+  StatusPrinter::add(
+    "Isolated %llu heavy key(s); largest predicted partition holds %.2f%% of "
+    "the data", numHeavyKeys,
+    100.0 * largestPartitionWeight / sketch.getTotalWeight());
+
+  // Flush any remaining buffers from the writer.
+  writer.flushBuffers();
+}
+
+KVPairBuffer* SketchBoundaryDecider::getOutputChunk(uint64_t tupleSize) {
+  KVPairBuffer* buffer = NULL;
+
+  if (tupleSize > bufferFactory.getDefaultSize()) {
+    buffer = bufferFactory.newInstance(tupleSize);
+  } else {
+    buffer = bufferFactory.newInstance();
+  }
+
+  return buffer;
+}
+
+void SketchBoundaryDecider::broadcastOutputChunk(KVPairBuffer* outputChunk) {
+  // Send a copy of this chunk to each node.
+  for (uint64_t i = 0; i < numNodes; i++) {
+    KVPairBuffer* buffer = NULL;
+    if (i != numNodes - 1) {
+      // Create a copy of the chunk.
+      buffer = bufferFactory.newInstance(outputChunk->getCurrentSize());
+      buffer->append(
+        outputChunk->getRawBuffer(), outputChunk->getCurrentSize());
+    } else {
+      // Use the original chunk for the last peer.
+      buffer = outputChunk;
+    }
+
+    buffer->setNode(i);
+    buffer->addJobID(jobID);
+    emitWorkUnit(buffer);
+  }
+}
+
+BaseWorker* SketchBoundaryDecider::newInstance(
+  const std::string& phaseName, const std::string& stageName,
+  uint64_t id, Params& params, MemoryAllocatorInterface& memoryAllocator,
+  NamedObjectCollection& dependencies) {
+
+  uint64_t defaultBufferSize = params.get<uint64_t>(
+    "DEFAULT_BUFFER_SIZE." + phaseName + "." + stageName);
+
+  uint64_t alignmentSize = params.getv<uint64_t>(
+    "ALIGNMENT.%s.%s", phaseName.c_str(), stageName.c_str());
+
+  uint64_t numNodes = params.get<uint64_t>("NUM_PEERS");
+
+  uint64_t sketchCapacity = params.get<uint64_t>("PHASE_ZERO_SKETCH_CAPACITY");
+
+  SketchBoundaryDecider* decider = new SketchBoundaryDecider(
+    id, stageName, phaseName, memoryAllocator, defaultBufferSize,
+    alignmentSize, params, numNodes, sketchCapacity);
+
+  return decider;
+}
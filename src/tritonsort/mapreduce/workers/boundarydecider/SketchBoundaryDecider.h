@@ -0,0 +1,94 @@
+#ifndef MAPRED_SKETCH_BOUNDARY_DECIDER_H
+#define MAPRED_SKETCH_BOUNDARY_DECIDER_H
+
+#include "core/MultiQueueRunnable.h"
+#include "core/StatLogger.h"
+#include "mapreduce/common/KVPairBufferFactory.h"
+#include "mapreduce/common/SimpleKVPairWriter.h"
+#include "mapreduce/common/boundary/KeyQuantileSketch.h"
+#include "mapreduce/common/buffers/KVPairBuffer.h"
+
+class Params;
+
+/**
+   SketchBoundaryDecider is the decider counterpart of SketchBoundaryScanner.
+   On the coordinator node, it merges the serialized quantile sketches sent by
+   every node, decides the number of partitions from the job's sample
+   statistics, and reads the job-wide boundary list directly off of the merged
+   sketch, giving heavy-hitter keys dedicated partitions. The boundary list is
+   then broadcast to every node, exactly as BoundaryDecider does.
+
+   The predicted size of each partition is logged as the
+   predicted_partition_size statistic, in sampled bytes, for comparison with
+   the partition_size statistic logged by the writers.
+
+   Since sketches are only sent to the coordinator, SketchBoundaryDecider does
+   nothing on other nodes.
+ */
+class SketchBoundaryDecider : public MultiQueueRunnable<KVPairBuffer> {
+WORKER_IMPL
+
+public:
+  /// Constructor
+  /**
+     \param id the id of the worker
+
+     \param name the name of the worker
+
+     \param phaseName the name of the phase
+
+     \param memoryAllocator a memory allocator used for new buffers
+
+     \param defaultBufferSize the default size of output buffers
+
+     \param alignmentSize the memory alignment of output buffers
+
+     \param params the global params object
+
+     \param numNodes the number of nodes in the cluster
+
+     \param sketchCapacity the capacity of the merged quantile sketch
+   */
+  SketchBoundaryDecider(
+    uint64_t id, const std::string& stageName, const std::string& phaseName,
+    MemoryAllocatorInterface& memoryAllocator, uint64_t defaultBufferSize,
+    uint64_t alignmentSize, const Params& params, uint64_t numNodes,
+    uint64_t sketchCapacity);
+
+  /**
+     Merge sketches from all nodes, then pick and broadcast the official
+     boundary keys.
+   */
+  void run();
+
+private:
+  /// Used internally to get an output chunk buffer
+  /**
+     \param tupleSize the size of a tuple to be written
+
+     \return a new chunk buffer
+   */
+  KVPairBuffer* getOutputChunk(uint64_t tupleSize);
+
+  /// Used internally to broadcast chunk buffers to all nodes.
+  /**
+     \param outputChunk the chunk to broadcast
+   */
+  void broadcastOutputChunk(KVPairBuffer* outputChunk);
+
+  const std::string phaseName;
+  const Params& params;
+  const uint64_t numNodes;
+
+  StatLogger logger;
+  uint64_t predictedPartitionSizeStatID;
+
+  uint64_t jobID;
+
+  KVPairBufferFactory bufferFactory;
+  SimpleKVPairWriter writer;
+
+  KeyQuantileSketch sketch;
+};
+
+#endif // MAPRED_SKETCH_BOUNDARY_DECIDER_H
@@ -49,19 +49,8 @@ void BoundaryScanner::run(KVPairBuffer* buffer) {
 
     // Compute the number of partitions.
     if (isCoordinatorNode) {
-      uint64_t totalInputBytes;
-      uint64_t totalIntermediateBytes;
-      // Block until we have sample statistics from all nodes.
-      coordinatorClient->getSampleStatisticsSums(
-        jobID, numNodes, totalInputBytes, totalIntermediateBytes);
-
-      double intermediateToInputRatio = totalIntermediateBytes /
-        ((double) totalInputBytes);
-      StatusPrinter::add("Total # input bytes: %llu", totalInputBytes);
-      StatusPrinter::add("Estimated intermediate:input data size ratio: %.2f:1",
-                         intermediateToInputRatio);
-
-      numPartitions = setNumPartitions(jobID, intermediateToInputRatio, params);
+      numPartitions = setNumPartitionsFromSampleStatistics(
+        jobID, numNodes, *coordinatorClient, params);
     } else {
       // If we're not the coordinator, let the coordinator figure it out for us.
       numPartitions = coordinatorClient->getNumPartitions(jobID);
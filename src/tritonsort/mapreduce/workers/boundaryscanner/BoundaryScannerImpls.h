@@ -2,12 +2,14 @@
 #define MAPRED_BOUNDARY_SCANNER_IMPLS_H
 
 #include "BoundaryScanner.h"
+#include "SketchBoundaryScanner.h"
 #include "core/ImplementationList.h"
 
 class BoundaryScannerImpls : public ImplementationList {
 public:
   BoundaryScannerImpls() : ImplementationList() {
     ADD_IMPLEMENTATION(BoundaryScanner, "BoundaryScanner");
+    ADD_IMPLEMENTATION(SketchBoundaryScanner, "SketchBoundaryScanner");
   }
 };
 
@@ -0,0 +1,94 @@
+#include <boost/bind.hpp>
+
+#include "mapreduce/workers/boundaryscanner/SketchBoundaryScanner.h"
+
+SketchBoundaryScanner::SketchBoundaryScanner(
+  uint64_t id, const std::string& name,
+  MemoryAllocatorInterface& memoryAllocator, uint64_t defaultBufferSize,
+  uint64_t alignmentSize, uint64_t sketchCapacity,
+  uint64_t _coordinatorNodeID)
+  : SingleUnitRunnable<KVPairBuffer>(id, name),
+    coordinatorNodeID(_coordinatorNodeID),
+    logger(name, id),
+    jobID(0),
+    gotJobID(false),
+    bufferFactory(*this, memoryAllocator, defaultBufferSize, alignmentSize),
+    writer(
+      boost::bind(&SketchBoundaryScanner::emitWorkUnit, this, _1),
+      boost::bind(&SketchBoundaryScanner::getOutputChunk, this, _1)),
+    sketch(sketchCapacity) {
+}
+
+void SketchBoundaryScanner::run(KVPairBuffer* buffer) {
+  if (!gotJobID) {
+    // Get the job ID from the first buffer.
+    uint64_t numJobIDs = buffer->getJobIDs().size();
+    ABORT_IF(numJobIDs != 1, "Expected one job ID but got %llu", numJobIDs);
+    jobID = *(buffer->getJobIDs().begin());
+    gotJobID = true;
+  }
+
+  KeyValuePair kvPair;
+  while (buffer->getNextKVPair(kvPair)) {
+    // The value is the number of bytes the actual map output tuple took up.
+    uint64_t tupleSize = 0;
+    ABORT_IF(kvPair.getValueLength() != sizeof(tupleSize), "Expected "
+             "%llu-byte tuple size values, but got a %llu-byte value",
+             sizeof(tupleSize), kvPair.getValueLength());
+    memcpy(&tupleSize, kvPair.getValue(), sizeof(tupleSize));
+
+    sketch.insert(kvPair.getKey(), kvPair.getKeyLength(), tupleSize);
+  }
+
+  delete buffer;
+}
+
+void SketchBoundaryScanner::teardown() {
+  if (!gotJobID) {
+    // This node sampled nothing, so it has nothing to contribute.
+    return;
+  }
+
+  logger.logDatum("sketch_keys", sketch.getNumRetainedKeys());
+
+  sketch.serialize(writer);
+  writer.flushBuffers();
+}
+
+KVPairBuffer* SketchBoundaryScanner::getOutputChunk(uint64_t tupleSize) {
+  KVPairBuffer* buffer = NULL;
+
+  if (tupleSize > bufferFactory.getDefaultSize()) {
+    buffer = bufferFactory.newInstance(tupleSize);
+  } else {
+    buffer = bufferFactory.newInstance();
+  }
+
+  buffer->setNode(coordinatorNodeID);
+
+  buffer->addJobID(jobID);
+
+  return buffer;
+}
+
+BaseWorker* SketchBoundaryScanner::newInstance(
+  const std::string& phaseName, const std::string& stageName,
+  uint64_t id, Params& params, MemoryAllocatorInterface& memoryAllocator,
+  NamedObjectCollection& dependencies) {
+
+  uint64_t defaultBufferSize = params.get<uint64_t>(
+    "DEFAULT_BUFFER_SIZE." + phaseName + "." + stageName);
+
+  uint64_t alignmentSize = params.getv<uint64_t>(
+    "ALIGNMENT.%s.%s", phaseName.c_str(), stageName.c_str());
+
+  uint64_t sketchCapacity = params.get<uint64_t>("PHASE_ZERO_SKETCH_CAPACITY");
+
+  uint64_t coordinatorNodeID = params.get<uint64_t>("MERGE_NODE_ID");
+
+  SketchBoundaryScanner* scanner = new SketchBoundaryScanner(
+    id, stageName, memoryAllocator, defaultBufferSize, alignmentSize,
+    sketchCapacity, coordinatorNodeID);
+
+  return scanner;
+}
@@ -0,0 +1,81 @@
+#ifndef MAPRED_SKETCH_BOUNDARY_SCANNER_H
+#define MAPRED_SKETCH_BOUNDARY_SCANNER_H
+
+#include "core/SingleUnitRunnable.h"
+#include "core/StatLogger.h"
+#include "mapreduce/common/KVPairBufferFactory.h"
+#include "mapreduce/common/SimpleKVPairWriter.h"
+#include "mapreduce/common/boundary/KeyQuantileSketch.h"
+#include "mapreduce/common/buffers/KVPairBuffer.h"
+
+/**
+   SketchBoundaryScanner is an alternative to BoundaryScanner that summarizes
+   this node's sampled keys in a KeyQuantileSketch instead of scanning a fully
+   sorted sample. Its input buffers do not need to be sorted, so phase zero can
+   use a NopSorter in front of it.
+
+   Each input tuple's key is inserted into the sketch, weighted by the tuple
+   size stored in its value. When all input has been consumed, the sketch is
+   serialized into buffers tagged with the coordinator's node ID so that a
+   SketchBoundaryDecider on the coordinator can merge every node's sketch and
+   pick boundaries from the result.
+ */
+class SketchBoundaryScanner : public SingleUnitRunnable<KVPairBuffer> {
+WORKER_IMPL
+
+public:
+  /// Constructor
+  /**
+     \param id the id of the worker
+
+     \param name the name of the worker
+
+     \param memoryAllocator a memory allocator used for new buffers
+
+     \param defaultBufferSize the default size of output buffers
+
+     \param alignmentSize the memory alignment of output buffers
+
+     \param sketchCapacity the capacity of the quantile sketch
+
+     \param coordinatorNodeID the ID of the coordinator node
+   */
+  SketchBoundaryScanner(
+    uint64_t id, const std::string& name,
+    MemoryAllocatorInterface& memoryAllocator, uint64_t defaultBufferSize,
+    uint64_t alignmentSize, uint64_t sketchCapacity,
+    uint64_t coordinatorNodeID);
+
+  /**
+     Insert every tuple in a buffer into the sketch.
+
+     \param buffer a buffer of key/tuple size pairs
+   */
+  void run(KVPairBuffer* buffer);
+
+  /// Serialize the sketch and send it to the coordinator
+  void teardown();
+
+private:
+  /// Used internally to get output chunks for the serialized sketch
+  /**
+     \param tupleSize the size of the tuple that is about to be written
+
+     \return a new buffer to write to
+   */
+  KVPairBuffer* getOutputChunk(uint64_t tupleSize);
+
+  const uint64_t coordinatorNodeID;
+
+  StatLogger logger;
+
+  uint64_t jobID;
+  bool gotJobID;
+
+  KVPairBufferFactory bufferFactory;
+  SimpleKVPairWriter writer;
+
+  KeyQuantileSketch sketch;
+};
+
+#endif // MAPRED_SKETCH_BOUNDARY_SCANNER_H
@@ -2,11 +2,16 @@
 #define MAPRED_BUFFER_COMBINER_H
 
 #include "core/SingleUnitRunnable.h"
-#include "mapreduce/common/KVPairBufferFactory.h"
 #include "mapreduce/common/buffers/KVPairBuffer.h"
 
+class MultiSegmentKVPairBuffer;
+
 /**
    Combiner buffers into a single buffer.
+
+   Rather than copying every buffer into one large buffer, the combiner adds
+   each buffer it receives as a segment of a MultiSegmentKVPairBuffer, so
+   combining doesn't need any more memory than the buffers it combines.
  */
 class BufferCombiner : public SingleUnitRunnable<KVPairBuffer> {
 WORKER_IMPL
@@ -17,15 +22,11 @@ public:
      \param id the worker's worker ID within its parent stage
 
      \param name the worker's stage name
-
-     \param memoryAllocator the memory allocator to use for constructing buffers
-
-     \param alignmentSize if non-zero, buffers will be aligned to be a multiple
-     of this size
    */
-  BufferCombiner(
-    uint64_t id, const std::string& name,
-    MemoryAllocatorInterface& memoryAllocator, uint64_t alignmentSize);
+  BufferCombiner(uint64_t id, const std::string& name);
+
+  /// Destructor
+  virtual ~BufferCombiner();
 
   /**
      Collect a buffer, which will be combined with all
@@ -36,14 +37,11 @@ public:
   void run(KVPairBuffer* buffer);
 
   /**
-     Combine all buffer and then emit.
+     Emit the combined buffer.
    */
   void teardown();
 private:
-  uint64_t coalescedBufferSize;
-  std::queue<KVPairBuffer*> buffers;
-
-  KVPairBufferFactory bufferFactory;
+  MultiSegmentKVPairBuffer* combinedBuffer;
 };
 
 #endif // MAPRED_BUFFER_COMBINER_H
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <limits>
 
 #include "common/buffers/ByteStreamBuffer.h"
 #include "mapreduce/common/StreamInfo.h"
@@ -75,6 +76,10 @@ void ByteStreamConverter::emitBuffer(
   if (isPartitionFile) {
     buffer.setLogicalDiskID(partitionID);
     buffer.setChunkID(chunkID);
+  } else if (streamInfo.getPartitionID() !=
+             std::numeric_limits<uint64_t>::max()) {
+    // This stream is part of a partition in a file that holds many of them.
+    buffer.setLogicalDiskID(streamInfo.getPartitionID());
   }
 
   emitWorkUnit(&buffer);
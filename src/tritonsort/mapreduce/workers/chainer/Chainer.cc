@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "common/WriteTokenPool.h"
 #include "core/MemoryUtils.h"
 #include "mapreduce/common/buffers/ListableKVPairBuffer.h"
@@ -7,7 +9,8 @@ Chainer::Chainer(
   uint64_t id, const std::string& name, uint64_t _nodeID,
   uint64_t _physicalDisksPerChainer, uint64_t maxBytesInBufferTable,
   uint64_t _workUnitEmissionLowerBound, uint64_t _workUnitEmissionUpperBound,
-  uint64_t _numCoalescers, uint64_t _numNodes, uint64_t _numDisks,
+  bool _adaptiveEmission, uint64_t _numCoalescers, uint64_t _numNodes,
+  uint64_t _numDisks,
   WriteTokenPool& _writeTokenPool, const Params& params,
   const std::string& phaseName)
   : BatchRunnable(id, name, maxBytesInBufferTable),
@@ -15,6 +18,7 @@ Chainer::Chainer(
     physicalDisksPerChainer(_physicalDisksPerChainer),
     workUnitEmissionLowerBound(_workUnitEmissionLowerBound),
     workUnitEmissionUpperBound(_workUnitEmissionUpperBound),
+    adaptiveEmission(_adaptiveEmission),
     numCoalescers(_numCoalescers),
     numNodes(_numNodes),
     numDisks(_numDisks),
@@ -33,6 +37,14 @@ Chainer::Chainer(
 
   runTimestampStatID = logger.registerStat("run_timestamp");
   emitWorkTimestampStatID = logger.registerStat("emit_work_timestamp");
+
+  if (adaptiveEmission) {
+    writeLatencies.resize(physicalDisksPerChainer, 0.0);
+    emissionLowerBounds.resize(
+      physicalDisksPerChainer, workUnitEmissionLowerBound);
+    emissionLowerBoundStatID = logger.registerSummaryStat(
+      "emission_lower_bound");
+  }
 }
 
 Chainer::~Chainer() {
@@ -125,11 +137,13 @@ void Chainer::run(WorkQueue& workQueue) {
 
     this->getNewWork();
 
-    // If you don't get new work, wait 1ms for work to come in.
+    // If you don't get new work, wait up to 1ms for work to come in. Waking
+    // as soon as work arrives keeps chaining latency low, while the timeout
+    // makes sure we retry write tokens for full lists periodically.
     if (workQueue.empty()) {
       emptyWorkQueueWaits++;
       this->startWaitForWorkTimer();
-      usleep(1000);
+      this->waitForWork(1000);
       this->stopWaitForWorkTimer();
     } else {
       while (!workQueue.empty()) {
@@ -244,8 +258,14 @@ void Chainer::writeFullLists(
   while (true) {
     physicalDisksWithFullLists.clear();
 
-    bufferTable->getPhysicalDisksWithListsAboveMinimumSize(
-      workUnitEmissionLowerBound, physicalDisksWithFullLists);
+    if (adaptiveEmission) {
+      updateEmissionLowerBounds();
+      bufferTable->getPhysicalDisksWithListsAboveMinimumSize(
+        emissionLowerBounds, physicalDisksWithFullLists);
+    } else {
+      bufferTable->getPhysicalDisksWithListsAboveMinimumSize(
+        workUnitEmissionLowerBound, physicalDisksWithFullLists);
+    }
 
     if (physicalDisksWithFullLists.size() == 0) {
       break;
@@ -262,6 +282,13 @@ void Chainer::writeFullLists(
       BufferList<ListableKVPairBuffer>* list =
         bufferTable->getLargestListForDisk(diskID);
       TRITONSORT_ASSERT(list != NULL);
+
+      if (adaptiveEmission) {
+        logger.add(
+          emissionLowerBoundStatID,
+          emissionLowerBounds[diskID - (id * physicalDisksPerChainer)]);
+      }
+
       writeListToBuffer(bufferTable, list, lblContainer);
       emitWorkUnit(lblContainer);
     } else {
@@ -270,6 +297,42 @@ void Chainer::writeFullLists(
   }
 }
 
+void Chainer::updateEmissionLowerBounds() {
+  uint64_t baseDiskID = id * physicalDisksPerChainer;
+
+  // Writes to the fastest disk that has completed any writes set the scale
+  // against which every other disk is measured.
+  double fastestLatency = 0.0;
+
+  for (uint64_t i = 0; i < physicalDisksPerChainer; i++) {
+    double latency = writeTokenPool.getWriteLatency(baseDiskID + i);
+    writeLatencies[i] = latency;
+
+    if (latency > 0.0 && (fastestLatency == 0.0 || latency < fastestLatency)) {
+      fastestLatency = latency;
+    }
+  }
+
+  for (uint64_t i = 0; i < physicalDisksPerChainer; i++) {
+    uint64_t lowerBound = workUnitEmissionLowerBound;
+
+    // A disk with nothing outstanding is starved, so give it whatever we have
+    // as soon as its list reaches the default lower bound.
+    if (writeLatencies[i] > 0.0 &&
+        writeTokenPool.getNumOutstandingTokens(baseDiskID + i) > 0) {
+      double scaledLowerBound = workUnitEmissionLowerBound *
+        (writeLatencies[i] / fastestLatency);
+
+      lowerBound = std::max(
+        workUnitEmissionLowerBound,
+        std::min(workUnitEmissionUpperBound,
+                 static_cast<uint64_t>(scaledLowerBound)));
+    }
+
+    emissionLowerBounds[i] = lowerBound;
+  }
+}
+
 BaseWorker* Chainer::newInstance(
   const std::string& phaseName, const std::string& stageName,
   uint64_t id, Params& params, MemoryAllocatorInterface& memoryAllocator,
@@ -282,6 +345,7 @@ BaseWorker* Chainer::newInstance(
     "CHAINER_WORK_UNIT_EMISSION_LOWER_BOUND");
   uint64_t workUnitEmissionUpperBound = params.get<uint64_t>(
     "CHAINER_WORK_UNIT_EMISSION_UPPER_BOUND");
+  bool adaptiveEmission = params.get<bool>("ADAPTIVE_CHAINER_EMISSION");
   uint64_t maxBytesInBufferTable = params.get<uint64_t>(
     "MAX_CHAINER_BUFFER_TABLE_SIZE");
   uint64_t numNodes = params.get<uint64_t>("NUM_PEERS");
@@ -300,7 +364,8 @@ BaseWorker* Chainer::newInstance(
   Chainer* chainer = new Chainer(
     id, stageName, nodeID, physicalDisksPerChainer,
     maxBytesInBufferTable, workUnitEmissionLowerBound,
-    workUnitEmissionUpperBound, numCoalescers, numNodes, numDisks,
+    workUnitEmissionUpperBound, adaptiveEmission, numCoalescers, numNodes,
+    numDisks,
     *writeTokenPool, params, phaseName);
 
   return chainer;
@@ -2,6 +2,7 @@
 #define TRITONSORT_CHAINER_H
 
 #include <pthread.h>
+#include <vector>
 
 #include "mapreduce/common/PartitionMap.h"
 #include "common/BufferListContainer.h"
@@ -15,6 +16,16 @@ class WriteTokenPool;
    The chainer is responsible for chaining together logical disk buffers into a
    chain per logical disk, and passing chains to the next stage when they're
    long enough.
+
+   By default, a chain is long enough once it holds
+   CHAINER_WORK_UNIT_EMISSION_LOWER_BOUND bytes. If ADAPTIVE_CHAINER_EMISSION
+   is set, the chainer instead sets a lower bound for each disk based on
+   feedback from the write token pool. Disks whose writes take longer per byte
+   than the fastest of the chainer's disks have their lower bound scaled up in
+   proportion (up to CHAINER_WORK_UNIT_EMISSION_UPPER_BOUND), so that slow
+   disks receive fewer, larger writes while fast disks keep receiving small
+   ones. A disk with no writes outstanding always uses the default lower bound
+   so that it isn't left idle waiting for a long chain.
  */
 class Chainer : public BatchRunnable {
   WORKER_IMPL
@@ -45,6 +56,9 @@ public:
      \param workUnitEmissionUpperBound the largest amount of data, in bytes,
      contained in a logical disk buffer chain emitted to the next stage
 
+     \param adaptiveEmission if true, scale each disk's emission lower bound
+     according to its write latency
+
      \param numCoalescers the number of downstream coalescers to which the
      chainer is routing chains. All chains for a given logical disk must be
      routed to the same coalescer so that buffer alignment is done correctly
@@ -64,7 +78,8 @@ public:
     uint64_t id, const std::string& name, uint64_t nodeID,
     uint64_t physicalDisksPerChainer, uint64_t maxBytesInBufferTable,
     uint64_t workUnitEmissionLowerBound, uint64_t workUnitEmissionUpperBound,
-    uint64_t numCoalescers, uint64_t numNodes, uint64_t numDisks,
+    bool adaptiveEmission, uint64_t numCoalescers, uint64_t numNodes,
+    uint64_t numDisks,
     WriteTokenPool& writeTokenPool, const Params& params,
     const std::string& phaseName);
 
@@ -97,7 +112,8 @@ public:
   /**
      Until we run out of work, continuously do the following:
      - Get as many logical disk buffers as possible from the work queue
-        - If the work queue is empty, wait 1ms and try again
+        - If the work queue is empty, wait up to 1ms for work to arrive and
+          try again
         - Otherwise, append all received logical disk buffers to the appropriate
           list
      - Append any lists that are full enough (see Chainer::writeFullLists)
@@ -120,10 +136,15 @@ private:
   void writeFullLists(
     uint64_t jobID, BufferTable<ListableKVPairBuffer>* bufferTable);
 
+  /// Set each disk's emission lower bound from the write token pool's
+  /// feedback about its write latency and queue depth
+  void updateEmissionLowerBounds();
+
   const uint64_t nodeID;
   const uint64_t physicalDisksPerChainer;
   const uint64_t workUnitEmissionLowerBound;
   const uint64_t workUnitEmissionUpperBound;
+  const bool adaptiveEmission;
   const uint64_t numCoalescers;
 
   const uint64_t numNodes;
@@ -137,6 +158,11 @@ private:
 
   std::set<uint64_t> physicalDisksWithFullLists;
 
+  // Used only with adaptive emission; indexed by disk relative to the first
+  // disk assigned to this chainer
+  std::vector<double> writeLatencies;
+  std::vector<uint64_t> emissionLowerBounds;
+
   uint64_t failedGetAttempts;
   uint64_t iterationStartRateLimitingCounter;
   uint64_t workUnitEmittedRateLimitingCounter;
@@ -146,6 +172,7 @@ private:
 
   uint64_t runTimestampStatID;
   uint64_t emitWorkTimestampStatID;
+  uint64_t emissionLowerBoundStatID;
 
   StatLogger logger;
 };
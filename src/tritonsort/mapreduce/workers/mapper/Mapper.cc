@@ -164,15 +164,27 @@ void Mapper::map(KVPairBuffer* buffer, uint64_t bufferJobID) {
   bytesIn += buffer->getCurrentSize();
 
   buffer->resetIterator();
-  KeyValuePair kvPair;
 
-  while (buffer->getNextKVPair(kvPair)) {
+  // Tuples are deserialized in place, so batched tuples remain valid until
+  // this buffer is deleted.
+  uint64_t batchSize = 0;
+
+  while (buffer->getNextKVPair(batch[batchSize])) {
     if (tuplesIn % inputTupleSampleRate == 0) {
-      mapInputLoggingStrategy.logTuple(logger, kvPair);
+      mapInputLoggingStrategy.logTuple(logger, batch[batchSize]);
     }
 
-    mapFunction->map(kvPair, *writer);
     tuplesIn++;
+    batchSize++;
+
+    if (batchSize == MAP_BATCH_SIZE) {
+      mapFunction->mapBatch(batch, batchSize, *writer);
+      batchSize = 0;
+    }
+  }
+
+  if (batchSize > 0) {
+    mapFunction->mapBatch(batch, batchSize, *writer);
   }
 }
 
@@ -4,6 +4,7 @@
 #include "core/SingleUnitRunnable.h"
 #include "core/constants.h"
 #include "mapreduce/common/KVPairBufferFactory.h"
+#include "mapreduce/common/KeyValuePair.h"
 #include "mapreduce/common/TupleSizeHistogramLoggingStrategy.h"
 
 class CoordinatorClientInterface;
@@ -99,6 +100,9 @@ public:
 
   void logWriteStats(uint64_t numBytesWritten, uint64_t numTuplesWritten);
 private:
+  /// The maximum number of tuples handed to MapFunction::mapBatch at once
+  static const uint64_t MAP_BATCH_SIZE = 64;
+
   const uint64_t inputTupleSampleRate;
   const uint64_t myNodeID;
   const uint64_t minBufferSize;
@@ -127,6 +131,8 @@ private:
   uint64_t bytesOut;
 
   CoordinatorClientInterface& coordinatorClient;
+
+  KeyValuePair batch[MAP_BATCH_SIZE];
 };
 
 #endif //MAPRED_MAPPER_H
@@ -3,16 +3,19 @@
 #include "common/PartitionFile.h"
 #include "common/WriteToken.h"
 #include "core/MemoryUtils.h"
+#include "core/Timer.h"
 #include "mapreduce/common/FilenameToStreamIDMap.h"
 #include "mapreduce/common/StreamInfo.h"
 #include "mapreduce/workers/reader/AsynchronousReader.h"
 
 AsynchronousReader::AsynchronousReader(
   const std::string& phaseName, const std::string& stageName, uint64_t id,
-  uint64_t _asynchronousIODepth, uint64_t defaultBufferSize,
+  uint64_t _asynchronousIODepth, uint64_t _defaultBufferSize,
   uint64_t alignmentSize, FilenameToStreamIDMap* _filenameToStreamIDMap,
   MemoryAllocatorInterface& memoryAllocator, bool _deleteAfterRead,
-  bool _useByteStreamBuffers, WriteTokenPool* _tokenPool, ChunkMap* chunkMap)
+  bool _useByteStreamBuffers, WriteTokenPool* _tokenPool, ChunkMap* chunkMap,
+  bool _scheduleReads, double _readLatencyThreshold,
+  DiskIOScheduler* _ioScheduler)
   : MultiQueueRunnable(id, stageName),
     asynchronousIODepth(_asynchronousIODepth),
     logger(stageName, id),
@@ -23,12 +26,16 @@ AsynchronousReader::AsynchronousReader(
     deleteAfterRead(_deleteAfterRead),
     useByteStreamBuffers(_useByteStreamBuffers),
     setStreamSize(phaseName == "phase_two"),
+    scheduleReads(_scheduleReads && _tokenPool == NULL),
+    readLatencyThreshold(_readLatencyThreshold),
+    defaultBufferSize(_defaultBufferSize),
     alignedBytesRead(0),
     filenameToStreamIDMap(_filenameToStreamIDMap),
     byteStreamBufferFactory(
-      *this, memoryAllocator, defaultBufferSize, alignmentSize),
+      *this, memoryAllocator, _defaultBufferSize, alignmentSize),
     kvPairBufferFactory(*this, memoryAllocator, 0, alignmentSize),
-    tokenPool(_tokenPool) {
+    tokenPool(_tokenPool),
+    ioScheduler(_ioScheduler) {
   ABORT_IF(useByteStreamBuffers && filenameToStreamIDMap == NULL,
            "Filename-to-stream-ID map cannot be NULL");
 
@@ -48,6 +55,23 @@ AsynchronousReader::AsynchronousReader(
       currentOffset += numChunks;
     }
   }
+
+  if (scheduleReads) {
+    readLatencyStatID = logger.registerSummaryStat("read_latency");
+    readDepthLimitStatID = logger.registerSummaryStat("read_depth_limit");
+  }
+
+  if (ioScheduler != NULL) {
+    ioSchedulerWaitStatID = logger.registerSummaryStat("io_scheduler_wait");
+  }
+}
+
+AsynchronousReader::~AsynchronousReader() {
+  for (AIMDControllerMap::iterator iter = depthControllers.begin();
+       iter != depthControllers.end(); iter++) {
+    delete iter->second;
+  }
+  depthControllers.clear();
 }
 
 void AsynchronousReader::run() {
@@ -64,6 +88,10 @@ void AsynchronousReader::run() {
 
         // Finish reading all existing requests so we don't have an artificially
         // long teardown time.
+        if (scheduleReads) {
+          startPendingReads();
+        }
+
         while (!waitingForToken.empty() || numReadsInProgress() > 0) {
           if (!waitingForToken.empty()) {
             checkForReadTokens();
@@ -72,6 +100,10 @@ void AsynchronousReader::run() {
             waitForReadCompletionAndEmitBuffers();
           }
         }
+      } else if (scheduleReads) {
+        // Start the request when its disk has room for it.
+        schedulePendingRead(readRequest);
+        startPendingReads();
       } else {
         // Wait until we have a free I/O slot, and then service a new request.
         while (numReadsInProgress() >= asynchronousIODepth) {
@@ -93,13 +125,19 @@ void AsynchronousReader::run() {
       processTimer.start();
       while (processTimer.getRunningTime() < 10000) {
         if (numReadsInProgress() == 0 && waitingForToken.empty()) {
-          // There's no work, and no buffers to read, so sleep.
+          // There's no work, and no buffers to read, so sleep until a new
+          // read request shows up.
           uint64_t elapsed = processTimer.getRunningTime();
           if (elapsed < 10000) {
             // Sleep a little extra to make sure we don't have to do this twice.
             startWaitForWorkTimer();
-            usleep(10100 - elapsed);
+            bool workArrived = waitForWork(getID(), 10100 - elapsed);
             stopWaitForWorkTimer();
+
+            if (workArrived) {
+              // Go back to the tracker right away.
+              break;
+            }
           }
         } else {
           if (!waitingForToken.empty()) {
@@ -119,6 +157,8 @@ void AsynchronousReader::run() {
 void AsynchronousReader::teardown() {
   TRITONSORT_ASSERT(numReadsInProgress() == 0,
          "Should have finished all writes before tearing down.");
+  TRITONSORT_ASSERT(!hasPendingReads(),
+         "Should have started all scheduled reads before tearing down.");
   logger.logDatum("direct_io_bytes_read", alignedBytesRead);
 }
 
@@ -139,17 +179,7 @@ bool AsynchronousReader::processNewReadRequest(
     // Update data structures.
     bytesRead[readRequest] = 0;
     if (useByteStreamBuffers) {
-      TRITONSORT_ASSERT(readRequest->jobIDs.size() > 0, "Expected read request to have "
-             "at least one job ID");
-
-      if (setStreamSize) {
-        filenameToStreamIDMap->addFilenameWithSize(
-          file->getFilename(), readRequest->jobIDs, readRequest->length,
-          readRequest->offset);
-      } else {
-        filenameToStreamIDMap->addFilename(
-          file->getFilename(), readRequest->jobIDs, readRequest->offset);
-      }
+      registerStream(readRequest);
     }
 
     uint64_t tokenID = 0;
@@ -178,20 +208,43 @@ bool AsynchronousReader::processNewReadRequest(
   }
 }
 
+void AsynchronousReader::registerStream(ReadRequest* readRequest) {
+  TRITONSORT_ASSERT(readRequest->jobIDs.size() > 0, "Expected read request to have "
+         "at least one job ID");
+
+  if (setStreamSize) {
+    filenameToStreamIDMap->addFilenameWithSize(
+      readRequest->path, readRequest->jobIDs, readRequest->length,
+      readRequest->offset);
+  } else {
+    filenameToStreamIDMap->addFilename(
+      readRequest->path, readRequest->jobIDs, readRequest->offset);
+  }
+}
+
+ByteStreamBuffer* AsynchronousReader::newStreamBuffer(
+  ReadRequest* readRequest) {
+  ByteStreamBuffer* buffer = byteStreamBufferFactory.newInstance();
+  buffer->clear();
+
+  const StreamInfo& streamInfo = filenameToStreamIDMap->getStreamInfo(
+    readRequest->path, readRequest->offset);
+
+  buffer->setStreamID(streamInfo.getStreamID());
+
+  return buffer;
+}
+
 BaseBuffer* AsynchronousReader::startNextReadBuffer(
   ReadInfo* readInfo, bool returnEmptyBuffer) {
   // Get a new buffer for this read request.
   BaseBuffer* newBuffer;
-  if (useByteStreamBuffers) {
-    ByteStreamBuffer* buffer = byteStreamBufferFactory.newInstance();
-    buffer->clear();
-
-    const StreamInfo& streamInfo = filenameToStreamIDMap->getStreamInfo(
-      readInfo->request->path, readInfo->request->offset);
-
-    buffer->setStreamID(streamInfo.getStreamID());
-
-    newBuffer = buffer;
+  if (!readInfo->adjacentRequests.empty()) {
+    // Adjacent requests are read into one staging buffer, which is split up
+    // by stream once it's full.
+    newBuffer = byteStreamBufferFactory.newInstance(readInfo->request->length);
+  } else if (useByteStreamBuffers) {
+    newBuffer = newStreamBuffer(readInfo->request);
   } else {
     PartitionFile file(readInfo->request->path);
     const std::string& filename = file.getFilename();
@@ -223,20 +276,50 @@ BaseBuffer* AsynchronousReader::startNextReadBuffer(
     const uint8_t* appendPointer = newBuffer->setupAppend(readSize);
     reads[appendPointer] = readInfo;
 
+    if (ioScheduler != NULL) {
+      // Wait for a read burst on this file's disk.
+      logger.add(
+        ioSchedulerWaitStatID,
+        ioScheduler->waitForTurn(*(readInfo->file), DiskIOScheduler::READ));
+    }
+
     // Instruct the AIO implementation to prepare the buffer for reading
     prepareRead(appendPointer, *(readInfo->file), readSize);
     // Begin the first read into the buffer.
+    if (scheduleReads) {
+      readInfo->issueTime = Timer::posixTimeInMicros();
+    }
     issueNextRead(appendPointer);
   }
 
   return newBuffer;
 }
 
+void AsynchronousReader::readCompleted(
+  const uint8_t* appendPointer, uint64_t readSize) {
+  reads.at(appendPointer)->completedReadSize = readSize;
+  idleBuffers.push(appendPointer);
+}
+
 void AsynchronousReader::serviceIdleBuffers() {
   while (!idleBuffers.empty()) {
     const uint8_t* buffer = idleBuffers.front();
     idleBuffers.pop();
 
+    if (scheduleReads) {
+      // A read into this buffer just completed, so feed its latency to its
+      // disk's controller.
+      ReadInfo* readInfo = reads.at(buffer);
+      uint64_t now = Timer::posixTimeInMicros();
+      uint64_t latency = now - readInfo->issueTime;
+
+      getDepthController(readInfo->request->diskID).recordLatency(
+        latency, readInfo->completedReadSize);
+      logger.add(readLatencyStatID, latency);
+
+      readInfo->issueTime = now;
+    }
+
     // If we still have part of this buffer left to read, issue another
     // asynchronous read.
     if (!issueNextRead(buffer)) {
@@ -266,8 +349,12 @@ void AsynchronousReader::emitFullBuffers() {
 
     // Commit the append and emit the buffer.
     readInfo->buffer->commitAppend(appendPointer, readInfo->size);
-    logger.add(readSizeStatID, readInfo->buffer->getCurrentSize());
-    emitWorkUnit(readInfo->buffer);
+    if (!readInfo->adjacentRequests.empty()) {
+      emitAdjacentRequests(readInfo);
+    } else {
+      logger.add(readSizeStatID, readInfo->buffer->getCurrentSize());
+      emitWorkUnit(readInfo->buffer);
+    }
 
     // We no longer need to link this read info to the completed append pointer,
     // but don't delete the read info quite yet because we can still reuse it.
@@ -285,7 +372,7 @@ void AsynchronousReader::emitFullBuffers() {
         startNextReadBuffer(readInfo);
       }
     } else {
-      if (useByteStreamBuffers) {
+      if (useByteStreamBuffers && readInfo->adjacentRequests.empty()) {
         // We need to send an empty buffer downstream to manually signal that
         // the stream is closed.
         /// \TODO(MC): We really should be doing something better than using
@@ -296,6 +383,10 @@ void AsynchronousReader::emitFullBuffers() {
 
       // We've finished the read request, so go ahead and actually free the
       // ReadInfo and File objects
+      if (scheduleReads) {
+        requestsInProgress[readInfo->request->diskID]--;
+      }
+
       bytesRead.erase(readInfo->request);
       alignedBytesRead += readInfo->file->getAlignedBytesRead();
       readInfo->file->close();
@@ -305,6 +396,12 @@ void AsynchronousReader::emitFullBuffers() {
       }
 
       delete readInfo->file;
+
+      if (!readInfo->adjacentRequests.empty()) {
+        // This request was made up by readAdjacentRequests().
+        delete readInfo->request;
+      }
+
       delete readInfo;
     }
   }
@@ -317,6 +414,11 @@ void AsynchronousReader::waitForReadCompletionAndEmitBuffers() {
   serviceIdleBuffers();
   // Finally emit any completely full buffers.
   emitFullBuffers();
+
+  if (scheduleReads) {
+    // Finished requests may have made room for pending ones.
+    startPendingReads();
+  }
 }
 
 void AsynchronousReader::checkForReadTokens() {
@@ -342,3 +444,177 @@ void AsynchronousReader::checkForReadTokens() {
     }
   }
 }
+
+void AsynchronousReader::schedulePendingRead(ReadRequest* readRequest) {
+  pendingReads[readRequest->diskID].insert(
+    std::make_pair(
+      ReadPosition(readRequest->path, readRequest->offset), readRequest));
+}
+
+void AsynchronousReader::startPendingReads() {
+  for (PendingReadsForDiskMap::iterator diskIter = pendingReads.begin();
+       diskIter != pendingReads.end(); diskIter++) {
+    uint64_t diskID = diskIter->first;
+    PendingReadMap& diskPendingReads = diskIter->second;
+    AIMDController& controller = getDepthController(diskID);
+    uint64_t& diskRequestsInProgress = requestsInProgress[diskID];
+
+    while (!diskPendingReads.empty() &&
+           diskRequestsInProgress < controller.getLimit() &&
+           numReadsInProgress() < asynchronousIODepth) {
+      // Continue from where the last request on this disk started, wrapping
+      // around to the first position on the disk if we're past the end.
+      PendingReadMap::iterator nextRead = diskPendingReads.begin();
+
+      ReadPositionMap::iterator lastPosition = lastReadPositions.find(diskID);
+      if (lastPosition != lastReadPositions.end()) {
+        nextRead = diskPendingReads.lower_bound(lastPosition->second);
+
+        if (nextRead == diskPendingReads.end()) {
+          nextRead = diskPendingReads.begin();
+        }
+      }
+
+      lastReadPositions[diskID] = nextRead->first;
+      ReadRequest* readRequest = nextRead->second;
+
+      if (canReadWithAdjacentRequests(readRequest)) {
+        // Gather the pending requests that start where the previous one ends,
+        // as long as they fit in one buffer together. Keeping the combined
+        // read no larger than a regular one keeps its latency comparable for
+        // the disk's controller.
+        ReadRequestVector adjacentRequests(1, readRequest);
+        uint64_t adjacentLength = readRequest->length;
+        PendingReadMap::iterator adjacentRead = nextRead;
+        adjacentRead++;
+
+        while (adjacentRead != diskPendingReads.end() &&
+               adjacentRead->first.first == readRequest->path &&
+               adjacentRead->first.second == adjacentRequests.back()->offset +
+               adjacentRequests.back()->length &&
+               canReadWithAdjacentRequests(adjacentRead->second) &&
+               adjacentLength + adjacentRead->second->length <=
+               defaultBufferSize) {
+          adjacentLength += adjacentRead->second->length;
+          adjacentRequests.push_back(adjacentRead->second);
+          adjacentRead++;
+        }
+
+        if (adjacentRequests.size() > 1) {
+          diskPendingReads.erase(nextRead, adjacentRead);
+
+          diskRequestsInProgress++;
+          logger.add(readDepthLimitStatID, controller.getLimit());
+
+          readAdjacentRequests(adjacentRequests);
+          continue;
+        }
+      }
+
+      diskPendingReads.erase(nextRead);
+
+      ReadInfo* readInfo;
+      if (processNewReadRequest(readRequest, readInfo)) {
+        diskRequestsInProgress++;
+        logger.add(readDepthLimitStatID, controller.getLimit());
+
+        // Start reading from the beginning of this read request.
+        startNextReadBuffer(readInfo);
+      }
+    }
+  }
+}
+
+bool AsynchronousReader::canReadWithAdjacentRequests(
+  ReadRequest* readRequest) const {
+  // Whole-file and deleted-after-read inputs are never laid out next to other
+  // requests in the same file.
+  return useByteStreamBuffers && !deleteAfterRead && readRequest->length > 0 &&
+    readRequest->length <= defaultBufferSize;
+}
+
+void AsynchronousReader::readAdjacentRequests(
+  const ReadRequestVector& readRequests) {
+  ReadRequest* firstRequest = readRequests.front();
+  ReadRequest* lastRequest = readRequests.back();
+
+  // Read the requests as a single request spanning all of them.
+  ReadRequest* spanningRequest = new (themis::memcheck) ReadRequest(
+    firstRequest->jobIDs, firstRequest->protocol, firstRequest->host,
+    firstRequest->port, firstRequest->path, firstRequest->offset,
+    lastRequest->offset + lastRequest->length - firstRequest->offset,
+    firstRequest->diskID);
+
+  File* file = new (themis::memcheck) File(spanningRequest->path);
+
+  for (ReadRequestVector::const_iterator iter = readRequests.begin();
+       iter != readRequests.end(); iter++) {
+    std::ostringstream oss;
+    oss << file->getFilename() << ",offset=" << (*iter)->offset
+        << ",length=" << (*iter)->length;
+
+    logger.logDatum("input_filename", oss.str());
+
+    registerStream(*iter);
+  }
+
+  // Prepare the file for reading.
+  openFile(*file);
+  file->seek(spanningRequest->offset, File::FROM_BEGINNING);
+
+  bytesRead[spanningRequest] = 0;
+
+  ReadInfo* readInfo = new (themis::memcheck) ReadInfo(
+    NULL, file, spanningRequest, 0, 0);
+  readInfo->adjacentRequests = readRequests;
+
+  startNextReadBuffer(readInfo);
+}
+
+void AsynchronousReader::emitAdjacentRequests(ReadInfo* readInfo) {
+  const uint8_t* data = readInfo->buffer->getRawBuffer();
+  uint64_t startOffset = readInfo->request->offset;
+
+  for (ReadRequestVector::const_iterator iter =
+         readInfo->adjacentRequests.begin();
+       iter != readInfo->adjacentRequests.end(); iter++) {
+    ReadRequest* readRequest = *iter;
+
+    ByteStreamBuffer* buffer = newStreamBuffer(readRequest);
+    buffer->append(data + (readRequest->offset - startOffset),
+                   readRequest->length);
+
+    logger.add(readSizeStatID, buffer->getCurrentSize());
+    emitWorkUnit(buffer);
+
+    // Close the stream with an empty buffer.
+    emitWorkUnit(newStreamBuffer(readRequest));
+  }
+
+  delete readInfo->buffer;
+  readInfo->buffer = NULL;
+}
+
+bool AsynchronousReader::hasPendingReads() const {
+  for (PendingReadsForDiskMap::const_iterator iter = pendingReads.begin();
+       iter != pendingReads.end(); iter++) {
+    if (!iter->second.empty()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+AIMDController& AsynchronousReader::getDepthController(uint64_t diskID) {
+  AIMDControllerMap::iterator iter = depthControllers.find(diskID);
+
+  if (iter == depthControllers.end()) {
+    iter = depthControllers.insert(
+      std::make_pair(
+        diskID, new (themis::memcheck) AIMDController(
+          1, asynchronousIODepth, readLatencyThreshold))).first;
+  }
+
+  return *(iter->second);
+}
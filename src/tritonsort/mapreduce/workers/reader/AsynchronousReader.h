@@ -2,14 +2,18 @@
 #define MAPRED_ASYNCHRONOUS_READER_H
 
 #include <map>
+#include <vector>
 
+#include "common/AIMDController.h"
 #include "common/ByteStreamBufferFactory.h"
+#include "common/DiskIOScheduler.h"
 #include "common/WriteTokenPool.h"
 #include "core/MultiQueueRunnable.h"
 #include "mapreduce/common/ChunkMap.h"
 #include "mapreduce/common/KVPairBufferFactory.h"
 #include "mapreduce/common/ReadRequest.h"
 
+class ByteStreamBuffer;
 class File;
 class FilenameToStreamIDMap;
 
@@ -25,6 +29,35 @@ class FilenameToStreamIDMap;
    process its existing files while checking in with the tracker at 10ms
    intervals. If the reader has no files to read and there are no buffers in
    the queue, it sleeps, while again checking in at 10ms intervals.
+
+   By default, the reader starts reading each request as soon as it arrives,
+   so reads for every request it's working on are interleaved on their disks.
+   If read scheduling is enabled, the reader instead collects requests for
+   each disk as they arrive and works on only a few of them per disk at a
+   time. Each disk's requests are started in elevator order by filename and
+   offset, continuing from the position of the last request started on that
+   disk, so that consecutive requests on a disk are read in the order they're
+   laid out. The number of requests in progress on each disk is set by an
+   AIMDController from the latency of the disk's reads, so a disk that
+   handles concurrent reads well is kept busy while one that slows down under
+   concurrent reads reads fewer requests at once. Read scheduling is never
+   used with a token pool, since token-paced readers need every request to
+   be in progress at once. Elevator order replaces whatever order the
+   requests arrived in, so with read scheduling each disk's partitions are no
+   longer read largest first under LARGEST_PARTITION_FIRST.
+
+   With read scheduling, requests for byte streams that fit in a single
+   buffer and start where the previous pending request in the same file ends
+   are read together, up to a buffer's worth at a time. The whole range is
+   read asynchronously into a single staging buffer, just like any other
+   request, and counts as one request in progress on its disk. When the read
+   completes, each stream's bytes are copied into a buffer of its own and
+   emitted.
+
+   If the phase provides a DiskIOScheduler as the "io_scheduler" dependency,
+   the reader waits for a read burst on a file's disk before starting each
+   buffer's reads, so that its reads don't interleave with writes to the same
+   disk.
  */
 class AsynchronousReader : public MultiQueueRunnable<ReadRequest> {
 
@@ -56,16 +89,28 @@ public:
      \param tokenPool a token pool for mergereduce phase three
 
      \param chunkMap a chunk map for mergereduce phase three
+
+     \param scheduleReads if true, schedule requests per disk rather than
+     starting them as they arrive
+
+     \param readLatencyThreshold with read scheduling, how many times a disk's
+     baseline read latency a read's latency must be before the disk's
+     concurrency is reduced
+
+     \param ioScheduler if not NULL, a scheduler shared with the phase's other
+     readers and writers that each buffer's reads must wait for
    */
   AsynchronousReader(
     const std::string& phaseName, const std::string& stageName, uint64_t id,
     uint64_t asynchronousIODepth, uint64_t defaultBufferSize,
     uint64_t alignmentSize, FilenameToStreamIDMap* filenameToStreamIDMap,
     MemoryAllocatorInterface& memoryAllocator, bool deleteAfterRead,
-    bool useByteStreamBuffers, WriteTokenPool* tokenPool, ChunkMap* chunkMap);
+    bool useByteStreamBuffers, WriteTokenPool* tokenPool, ChunkMap* chunkMap,
+    bool scheduleReads, double readLatencyThreshold,
+    DiskIOScheduler* ioScheduler);
 
   /// Destructor
-  virtual ~AsynchronousReader() {}
+  virtual ~AsynchronousReader();
 
   /// Issue reads asynchronously up to the given IO depth.
   void run();
@@ -82,6 +127,13 @@ protected:
     uint64_t size;
     WriteToken* token;
     uint64_t tokenID;
+    // The time at which the most recent read for this request was issued
+    uint64_t issueTime;
+    // The size of the most recently completed read for this request
+    uint64_t completedReadSize;
+    // If not empty, request covers these requests, which are laid out one
+    // after another in the same file and are split apart once read
+    std::vector<ReadRequest*> adjacentRequests;
     ReadInfo(
       BaseBuffer* _buffer, File* _file, ReadRequest* _request, uint64_t _size,
       uint64_t _tokenID)
@@ -90,7 +142,9 @@ protected:
         request(_request),
         size(_size),
         token(NULL),
-        tokenID(_tokenID) {}
+        tokenID(_tokenID),
+        issueTime(0),
+        completedReadSize(0) {}
   };
 
   typedef std::map<const uint8_t*, ReadInfo*> ReadMap;
@@ -111,6 +165,15 @@ protected:
    */
   virtual void waitForReadsToComplete(uint64_t numReads) = 0;
 
+  /**
+     Mark a buffer idle after one of its reads completes.
+
+     \param appendPointer the append pointer of the buffer whose read completed
+
+     \param readSize the number of bytes the read transferred
+   */
+  void readCompleted(const uint8_t* appendPointer, uint64_t readSize);
+
   /// Issue new reads for any buffers that are idle but still not complete.
   void serviceIdleBuffers();
 
@@ -127,6 +190,14 @@ protected:
 private:
   typedef std::map<ReadRequest*, uint64_t> BytesReadMap;
 
+  // A position on a disk, in terms of a file and an offset within it
+  typedef std::pair<std::string, uint64_t> ReadPosition;
+  typedef std::multimap<ReadPosition, ReadRequest*> PendingReadMap;
+  typedef std::map<uint64_t, PendingReadMap> PendingReadsForDiskMap;
+  typedef std::map<uint64_t, ReadPosition> ReadPositionMap;
+  typedef std::map<uint64_t, AIMDController*> AIMDControllerMap;
+  typedef std::vector<ReadRequest*> ReadRequestVector;
+
   /// Prepare a buffer for asynchronous reading.
   /**
      \param appendPointer the raw location to read into
@@ -159,6 +230,19 @@ private:
    */
   bool processNewReadRequest(ReadRequest* readRequest, ReadInfo*& readInfo);
 
+  /// Register a request's stream with the filename-to-stream-ID map
+  /**
+     \param readRequest the request whose stream is starting
+   */
+  void registerStream(ReadRequest* readRequest);
+
+  /**
+     \param readRequest a request whose stream has been registered
+
+     \return an empty byte stream buffer for the request's stream
+   */
+  ByteStreamBuffer* newStreamBuffer(ReadRequest* readRequest);
+
   /// Check out a new buffer and start reading.
   /**
      \param readInfo a data structure describing the read
@@ -179,6 +263,50 @@ private:
   /// Try any paused reads by checking the token pool for available read tokens.
   void checkForReadTokens();
 
+  /// Add a read request to its disk's pending requests, to be started by
+  /// startPendingReads()
+  /**
+     \param readRequest the request to schedule
+   */
+  void schedulePendingRead(ReadRequest* readRequest);
+
+  /// Start pending requests on each disk until the disk has as many requests
+  /// in progress as its controller allows, or the reader's IO depth is
+  /// reached
+  void startPendingReads();
+
+  /**
+     \param readRequest a pending request
+
+     \return true if the request can be read together with adjacent requests
+   */
+  bool canReadWithAdjacentRequests(ReadRequest* readRequest) const;
+
+  /// Start a single read covering requests that are laid out one after
+  /// another in the same file
+  /**
+     \param readRequests the requests to read, in offset order
+   */
+  void readAdjacentRequests(const ReadRequestVector& readRequests);
+
+  /// Split a completed read of adjacent requests into one buffer per stream,
+  /// emit each stream, and free the staging buffer
+  /**
+     \param readInfo the read's data structure
+   */
+  void emitAdjacentRequests(ReadInfo* readInfo);
+
+  /// \return true if any scheduled requests haven't been started yet
+  bool hasPendingReads() const;
+
+  /**
+     \param diskID a disk ID
+
+     \return the controller for the number of requests in progress on the
+     disk
+   */
+  AIMDController& getDepthController(uint64_t diskID);
+
   StatLogger logger;
 
   const uint64_t readSizeStatID;
@@ -186,6 +314,9 @@ private:
   const bool deleteAfterRead;
   const bool useByteStreamBuffers;
   const bool setStreamSize;
+  const bool scheduleReads;
+  const double readLatencyThreshold;
+  const uint64_t defaultBufferSize;
 
   uint64_t alignedBytesRead;
 
@@ -199,11 +330,23 @@ private:
   /// Buffers that are full and can be emitted.
   std::queue<const uint8_t*> fullBuffers;
 
+  // Used for read scheduling.
+  PendingReadsForDiskMap pendingReads;
+  ReadPositionMap lastReadPositions;
+  std::map<uint64_t, uint64_t> requestsInProgress;
+  AIMDControllerMap depthControllers;
+  uint64_t readLatencyStatID;
+  uint64_t readDepthLimitStatID;
+
   // Used for phase three.
   WriteTokenPool* tokenPool;
   std::map<uint64_t, uint64_t> offsetMap;
   std::map<uint64_t, ReadInfo*> waitingForToken;
   std::set<uint64_t> tokenIDSet;
+
+  // Used for sharing disks with writers.
+  DiskIOScheduler* ioScheduler;
+  uint64_t ioSchedulerWaitStatID;
 };
 
 #endif // MAPRED_ASYNCHRONOUS_READER_H
@@ -0,0 +1,92 @@
+#include "core/File.h"
+#include "mapreduce/common/ExtentReadRequest.h"
+#include "mapreduce/workers/reader/ExtentReader.h"
+
+ExtentReader::ExtentReader(
+  uint64_t id, const std::string& name, uint64_t _maxReadSize,
+  MemoryAllocatorInterface& memoryAllocator)
+  : SingleUnitRunnable<ReadRequest>(id, name),
+    maxReadSize(_maxReadSize),
+    logger(name, id),
+    bufferFactory(*this, memoryAllocator, 0, 0) {
+
+  readTimeStatID = logger.registerHistogramStat("read_time", 100);
+  readSizeStatID = logger.registerHistogramStat("read_size", 100);
+  extentsPerPartitionStatID = logger.registerSummaryStat(
+    "extents_per_partition");
+}
+
+void ExtentReader::run(ReadRequest* readRequest) {
+  ExtentReadRequest* extentRequest =
+    dynamic_cast<ExtentReadRequest*>(readRequest);
+  ABORT_IF(extentRequest == NULL, "ExtentReader can only read partitions "
+           "from extent logs");
+
+  uint64_t partitionSize = extentRequest->length;
+
+  // Don't process empty partitions
+  if (partitionSize > 0) {
+    File file(extentRequest->path);
+    file.open(File::READ);
+
+    // Get a buffer to hold the whole partition.
+    KVPairBuffer* buffer = bufferFactory.newInstance(partitionSize);
+    buffer->setSourceName(extentRequest->path);
+    buffer->setLogicalDiskID(extentRequest->partitionID);
+    buffer->addJobIDSet(extentRequest->jobIDs);
+
+    // Read each extent into the buffer in turn.
+    const uint8_t* appendPtr = buffer->setupAppend(partitionSize);
+    uint8_t* extentPtr = const_cast<uint8_t*>(appendPtr);
+
+    const ExtentIndex::ExtentVector& extents = extentRequest->extents;
+
+    readTimer.start();
+    for (ExtentIndex::ExtentVector::const_iterator iter = extents.begin();
+         iter != extents.end(); iter++) {
+      file.seek(iter->offset, File::FROM_BEGINNING);
+      file.read(extentPtr, iter->length, maxReadSize);
+      extentPtr += iter->length;
+    }
+    readTimer.stop();
+
+    buffer->commitAppend(appendPtr, partitionSize);
+
+    emitWorkUnit(buffer);
+
+    logger.add(readTimeStatID, readTimer);
+    logger.add(readSizeStatID, partitionSize);
+    logger.add(extentsPerPartitionStatID, extents.size());
+
+    file.close();
+  }
+
+  delete readRequest;
+}
+
+BaseWorker* ExtentReader::newInstance(
+  const std::string& phaseName, const std::string& stageName,
+  uint64_t id, Params& params, MemoryAllocatorInterface& memoryAllocator,
+  NamedObjectCollection& dependencies) {
+
+  // Read size is unlimited, unless specified.
+  uint64_t maxReadSize = std::numeric_limits<uint64_t>::max();
+  if (params.contains("MAX_READ_SIZE." + phaseName)) {
+    maxReadSize = params.get<uint64_t>("MAX_READ_SIZE." + phaseName);
+  }
+
+  // Extent logs hold many partitions, so they can't be deleted as each
+  // partition is read.
+  ABORT_IF(params.get<bool>("DELETE_AFTER_READ." + phaseName),
+           "ExtentReader doesn't support DELETE_AFTER_READ");
+
+  // Sanity check
+  ABORT_IF(params.contains("FORMAT_READER." + phaseName),
+           "Should be reading into byte stream buffers in phase %s",
+           phaseName.c_str());
+
+  ExtentReader* reader = new ExtentReader(
+    id, stageName, maxReadSize, memoryAllocator);
+
+  return reader;
+}
@@ -0,0 +1,59 @@
+#ifndef THEMIS_EXTENT_READER_H
+#define THEMIS_EXTENT_READER_H
+
+#include <stdint.h>
+
+#include "core/SingleUnitRunnable.h"
+#include "core/StatLogger.h"
+#include "mapreduce/common/KVPairBufferFactory.h"
+
+class ReadRequest;
+
+/**
+   An ExtentReader reads a partition out of an extent log into a single
+   KVPairBuffer, reading each of the partition's extents in turn. It accepts
+   only ExtentReadRequests.
+
+   Extents start wherever the writer's buffers happened to land in the log,
+   so they aren't generally aligned and the reader doesn't use direct I/O.
+
+   \sa ExtentIndex
+ */
+class ExtentReader : public SingleUnitRunnable<ReadRequest> {
+WORKER_IMPL
+
+public:
+  /// Constructor
+  /**
+     \param id the unique ID of this worker within its parent stage
+
+     \param name the name of the worker's parent stage
+
+     \param maxReadSize the maximum size of a read() syscall
+
+     \param memoryAllocator a memory allocator that the worker will use to
+     allocate memory for buffers
+   */
+  ExtentReader(uint64_t id, const std::string& name, uint64_t maxReadSize,
+               MemoryAllocatorInterface& memoryAllocator);
+
+  /// Read the requested partition into a single KVPairBuffer
+  /**
+     \param readRequest an ExtentReadRequest for the partition to read
+   */
+  void run(ReadRequest* readRequest);
+
+private:
+  const uint64_t maxReadSize;
+
+  uint64_t readTimeStatID;
+  uint64_t readSizeStatID;
+  uint64_t extentsPerPartitionStatID;
+
+  Timer readTimer;
+  StatLogger logger;
+
+  KVPairBufferFactory bufferFactory;
+};
+
+#endif // THEMIS_EXTENT_READER_H
@@ -11,7 +11,11 @@ LibAIOReader::LibAIOReader(
   : AsynchronousReader(
       phaseName, stageName, id, asynchronousIODepth, defaultBufferSize,
       _alignmentSize, filenameToStreamIDMap, memoryAllocator, deleteAfterRead,
-      useByteStreamBuffers, tokenPool, chunkMap),
+      useByteStreamBuffers, tokenPool, chunkMap,
+      params.get<bool>("ASYNCHRONOUS_READ_SCHEDULING"),
+      params.get<double>("ASYNCHRONOUS_READ_LATENCY_THRESHOLD"),
+      dependencies.contains<DiskIOScheduler>("io_scheduler") ?
+      dependencies.get<DiskIOScheduler>("io_scheduler") : NULL),
     alignmentSize(_alignmentSize),
     directIO(_directIO),
     maxReadSize(_maxReadSize),
@@ -119,7 +123,7 @@ void LibAIOReader::waitForReadsToComplete(uint64_t numReads) {
     outstandingReadBuffers.erase(iter);
     delete controlBlock;
 
-    idleBuffers.push(buffer);
+    readCompleted(buffer, readSize);
   }
 }
 
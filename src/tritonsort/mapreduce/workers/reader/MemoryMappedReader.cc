@@ -0,0 +1,83 @@
+#include "common/PartitionFile.h"
+#include "core/MemoryAllocationContext.h"
+#include "core/MemoryAllocatorInterface.h"
+#include "mapreduce/common/ReadRequest.h"
+#include "mapreduce/common/buffers/MemoryMappedKVPairBuffer.h"
+#include "mapreduce/workers/reader/MemoryMappedReader.h"
+
+MemoryMappedReader::MemoryMappedReader(
+  uint64_t id, const std::string& name,
+  MemoryAllocatorInterface& _memoryAllocator, bool _populate,
+  bool _deleteAfterRead)
+  : SingleUnitRunnable<ReadRequest>(id, name),
+    memoryAllocator(_memoryAllocator),
+    callerID(_memoryAllocator.registerCaller(*this)),
+    populate(_populate),
+    deleteAfterRead(_deleteAfterRead),
+    logger(name, id) {
+
+  readTimeStatID = logger.registerHistogramStat("read_time", 100);
+  readSizeStatID = logger.registerHistogramStat("read_size", 100);
+}
+
+void MemoryMappedReader::run(ReadRequest* readRequest) {
+  PartitionFile file(readRequest->path);
+  const std::string& filename = file.getFilename();
+
+  uint64_t fileSize = file.getCurrentSize();
+
+  // Don't process zero-length files
+  if (fileSize > 0) {
+    logger.logDatum("input_filename", filename);
+
+    // With MMAP_POPULATE the whole file is read into memory as soon as it's
+    // mapped, so make sure the allocator has room for it first.
+    MemoryAllocationContext context(callerID, fileSize);
+    void* reservation = memoryAllocator.allocate(context);
+
+    file.open(File::READ);
+
+    readTimer.start();
+    KVPairBuffer* buffer = new MemoryMappedKVPairBuffer(
+      file, populate, memoryAllocator, reservation);
+    readTimer.stop();
+
+    buffer->setSourceName(filename);
+    buffer->setLogicalDiskID(file.getPartitionID());
+    buffer->addJobID(file.getJobID());
+
+    // The mapping stays valid after the file is closed or unlinked.
+    file.close();
+
+    if (deleteAfterRead) {
+      file.unlink();
+    }
+
+    emitWorkUnit(buffer);
+
+    logger.add(readTimeStatID, readTimer);
+    logger.add(readSizeStatID, fileSize);
+  }
+
+  delete readRequest;
+}
+
+BaseWorker* MemoryMappedReader::newInstance(
+  const std::string& phaseName, const std::string& stageName,
+  uint64_t id, Params& params, MemoryAllocatorInterface& memoryAllocator,
+  NamedObjectCollection& dependencies) {
+
+  bool populate = params.get<bool>("MMAP_POPULATE");
+
+  bool deleteAfterRead = params.get<bool>("DELETE_AFTER_READ." + phaseName);
+
+  // Sanity check
+  ABORT_IF(params.contains("FORMAT_READER." + phaseName),
+           "Should be reading into byte stream buffers in phase %s",
+           phaseName.c_str());
+
+  MemoryMappedReader* reader = new MemoryMappedReader(
+    id, stageName, memoryAllocator, populate, deleteAfterRead);
+
+  return reader;
+}
@@ -0,0 +1,71 @@
+#ifndef THEMIS_MEMORY_MAPPED_READER_H
+#define THEMIS_MEMORY_MAPPED_READER_H
+
+#include <stdint.h>
+
+#include "core/SingleUnitRunnable.h"
+#include "core/StatLogger.h"
+#include "mapreduce/common/buffers/KVPairBuffer.h"
+
+class MemoryAllocatorInterface;
+class ReadRequest;
+
+/**
+   A MemoryMappedReader maps each file it is asked to read into memory and
+   emits a single MemoryMappedKVPairBuffer over the mapping, rather than
+   allocating a buffer and reading the file into it like WholeFileReader. This
+   saves an allocation and a copy out of the page cache for each file, at the
+   cost of holding the file in the page cache until its buffer is deleted.
+
+   Before mapping a file, the reader reserves the file's size from its memory
+   allocator, blocking until the allocator can grant it just like a reader
+   allocating a buffer would. The reservation is held until the buffer is
+   deleted and the file is unmapped.
+ */
+class MemoryMappedReader : public SingleUnitRunnable<ReadRequest> {
+WORKER_IMPL
+
+public:
+  /// Constructor
+  /**
+     \param id the unique ID of this worker within its parent stage
+
+     \param name the name of the worker's parent stage
+
+     \param memoryAllocator the allocator from which the memory for each
+     mapping is reserved
+
+     \param populate if true, read each file into memory when it's mapped;
+     otherwise, only start reading it in the background and let the next stage
+     fault in the rest
+
+     \param deleteAfterRead whether or not the reader should delete the file
+     after mapping it
+   */
+  MemoryMappedReader(
+    uint64_t id, const std::string& name,
+    MemoryAllocatorInterface& memoryAllocator, bool populate,
+    bool deleteAfterRead);
+
+  /// Map the given file into a single KVPairBuffer
+  /**
+     \param readRequest a data structure with information about the current
+     file
+   */
+  void run(ReadRequest* readRequest);
+
+private:
+  MemoryAllocatorInterface& memoryAllocator;
+  const uint64_t callerID;
+
+  const bool populate;
+  const bool deleteAfterRead;
+
+  uint64_t readTimeStatID;
+  uint64_t readSizeStatID;
+
+  Timer readTimer;
+  StatLogger logger;
+};
+
+#endif // THEMIS_MEMORY_MAPPED_READER_H
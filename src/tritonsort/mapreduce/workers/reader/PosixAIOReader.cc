@@ -13,7 +13,11 @@ PosixAIOReader::PosixAIOReader(
   : AsynchronousReader(
       phaseName, stageName, id, asynchronousIODepth, defaultBufferSize,
       _alignmentSize, filenameToStreamIDMap, memoryAllocator, deleteAfterRead,
-      useByteStreamBuffers, tokenPool, chunkMap),
+      useByteStreamBuffers, tokenPool, chunkMap,
+      params.get<bool>("ASYNCHRONOUS_READ_SCHEDULING"),
+      params.get<double>("ASYNCHRONOUS_READ_LATENCY_THRESHOLD"),
+      dependencies.contains<DiskIOScheduler>("io_scheduler") ?
+      dependencies.get<DiskIOScheduler>("io_scheduler") : NULL),
     alignmentSize(_alignmentSize),
     directIO(_directIO),
     maxReadSize(_maxReadSize),
@@ -93,13 +97,14 @@ void PosixAIOReader::waitForReadsToComplete(uint64_t numReads) {
   // Posix AIO interface does not let us block until N reads complete so keep
   // looping until we've done numReads
   while (completedReads < numReads) {
-    // Wait for some reads to complete.
-    int status = aio_suspend(aiocbList, numReadsInProgress(), NULL);
+    // Wait for some reads to complete. Completed reads leave NULL holes
+    // anywhere in the list, which aio_suspend() ignores, so pass all of it.
+    int status = aio_suspend(aiocbList, asynchronousIODepth, NULL);
     ABORT_IF(status != 0,
              "aio_suspend() failed %d: %s", errno, strerror(errno));
 
-    for (BufferMap::iterator iter = outstandingReadBuffers.begin();
-         iter != outstandingReadBuffers.end(); iter++) {
+    BufferMap::iterator iter = outstandingReadBuffers.begin();
+    while (iter != outstandingReadBuffers.end()) {
       struct aiocb* controlBlock = iter->first;
       const uint8_t* buffer = iter->second;
 
@@ -113,7 +118,7 @@ void PosixAIOReader::waitForReadsToComplete(uint64_t numReads) {
                  "aio_read() should have read %llu bytes but read %llu",
                  readSize, readStatus);
         // Remember this buffer so we can issue its next read later.
-        idleBuffers.push(buffer);
+        readCompleted(buffer, readSize);
         completedReads++;
 
         // Remove the request from the list of outstanding reads.
@@ -129,15 +134,13 @@ void PosixAIOReader::waitForReadsToComplete(uint64_t numReads) {
 
         delete controlBlock;
 
-        // Remove this controlBlock from the read map, but make sure to set the
-        // iterator just before it so incrementing the iterator at the end of
-        // the loop will land on the next member of the map.
-        BufferMap::iterator previousIterator = iter;
-        previousIterator--;
-        outstandingReadBuffers.erase(iter);
-        iter = previousIterator;
+        // Remove this controlBlock from the read map, advancing the iterator to
+        // the next member of the map before the erase invalidates it.
+        outstandingReadBuffers.erase(iter++);
       } else if (status != EINPROGRESS) {
         ABORT("aio_error() failed with status %llu");
+      } else {
+        iter++;
       }
     }
   }
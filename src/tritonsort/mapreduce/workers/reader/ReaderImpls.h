@@ -4,7 +4,9 @@
 #include "common/workers/sink/Sink.h"
 #include "core/ImplementationList.h"
 #include "mapreduce/workers/reader/ByteStreamReader.h"
+#include "mapreduce/workers/reader/ExtentReader.h"
 #include "mapreduce/workers/reader/LibAIOReader.h"
+#include "mapreduce/workers/reader/MemoryMappedReader.h"
 #include "mapreduce/workers/reader/MultiProtocolReader.h"
 #include "mapreduce/workers/reader/PosixAIOReader.h"
 #include "mapreduce/workers/reader/WholeFileReader.h"
@@ -13,7 +15,9 @@ class ReaderImpls : public ImplementationList {
 public:
   ReaderImpls() : ImplementationList() {
     ADD_IMPLEMENTATION(ByteStreamReader, "ByteStreamReader");
+    ADD_IMPLEMENTATION(ExtentReader, "ExtentReader");
     ADD_IMPLEMENTATION(LibAIOReader, "LibAIOReader");
+    ADD_IMPLEMENTATION(MemoryMappedReader, "MemoryMappedReader");
     ADD_IMPLEMENTATION(MultiProtocolReader, "MultiProtocolReader");
     ADD_IMPLEMENTATION(PosixAIOReader, "PosixAIOReader");
     ADD_IMPLEMENTATION(Sink, "SinkReader");
@@ -104,6 +104,11 @@ uint64_t PhaseZeroSampleMetadataAwareSorter::getOutputBufferSize(
   return inputBuffer.getCurrentSize() + PhaseZeroSampleMetadata::tupleSize();
 }
 
+bool PhaseZeroSampleMetadataAwareSorter::canSortInPlace(
+  KVPairBuffer& inputBuffer) {
+  return false;
+}
+
 BaseWorker* PhaseZeroSampleMetadataAwareSorter::newInstance(
   const std::string& phaseName, const std::string& stageName,
   uint64_t id, Params& params, MemoryAllocatorInterface& memoryAllocator,
@@ -92,6 +92,14 @@ private:
    */
   virtual uint64_t getOutputBufferSize(KVPairBuffer& inputBuffer);
 
+  /**
+     Sample metadata is moved into a new output buffer before sorting, so
+     in-place sort strategies can't be used.
+
+     \return false
+   */
+  virtual bool canSortInPlace(KVPairBuffer& inputBuffer);
+
   const uint64_t minBufferSize;
   // The node ID of the coordinator, to which the downstream sender stage will
   // be routing sorted output buffers
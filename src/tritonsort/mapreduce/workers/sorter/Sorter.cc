@@ -39,6 +39,8 @@ Sorter::Sorter(
   bytesInStatID = logger.registerStat("bytes_in");
   bytesOutStatID = logger.registerStat("bytes_out");
   sortAlgorithmUsedStatID = logger.registerHistogramStat("algorithm_used", 1);
+  sortAlgorithmRejectedStatID = logger.registerHistogramStat(
+    "algorithm_rejected", 1);
 }
 
 KVPairBuffer* Sorter::newOutputBuffer(uint8_t* memory, uint64_t size) {
@@ -49,34 +51,113 @@ KVPairBuffer* Sorter::newOutputBuffer(uint8_t* memory, uint64_t size) {
 void Sorter::run(KVPairBuffer* inputBuffer) {
   uint64_t tuplesIn = inputBuffer->getNumTuples();
   uint64_t bytesIn = inputBuffer->getCurrentSize();
-  uint64_t logicalDiskID = inputBuffer->getLogicalDiskID();
-  uint64_t outputBufferSize = getOutputBufferSize(*inputBuffer);
 
-  uint64_t requiredMemorySize = 0;
+  uint64_t requiredScratchBufferSize = 0;
   SortStrategyInterface* selectedStrategy = NULL;
   for (SortStrategyInterfaceList::iterator iter = sortStrategies.begin();
        iter != sortStrategies.end(); iter++) {
     SortStrategyInterface* currentStrategy = *iter;
-    uint64_t requiredScratchBufferSize =
+
+    // Record every strategy that gets passed over, so that the logs show how
+    // often buffers fall back to slower strategies and which strategies they
+    // fall back from.
+    if (!currentStrategy->canSort(inputBuffer) ||
+        (currentStrategy->sortsInPlace() && !canSortInPlace(*inputBuffer))) {
+      logger.add(
+        sortAlgorithmRejectedStatID, currentStrategy->getSortAlgorithmID());
+      continue;
+    }
+
+    requiredScratchBufferSize =
       currentStrategy->getRequiredScratchBufferSize(inputBuffer);
 
-    // Only use Radix Sort if all keys are the same length and the scratch size
-    // does not exceed the user specified maximum.
+    // Only use Radix Sort if the scratch size does not exceed the user
+    // specified maximum.
     if (currentStrategy->getSortAlgorithmID() == RADIX_SORT_MAPREDUCE &&
-        (inputBuffer->getMinKeyLength() != inputBuffer->getMaxKeyLength() ||
-         requiredScratchBufferSize > maxRadixSortScratchSize)) {
+        requiredScratchBufferSize > maxRadixSortScratchSize) {
+      logger.add(
+        sortAlgorithmRejectedStatID, currentStrategy->getSortAlgorithmID());
       continue;
     }
 
     // Use the first strategy in the list with an acceptable size.
-    requiredMemorySize = requiredScratchBufferSize + outputBufferSize;
     selectedStrategy = *iter;
     break;
   }
 
-  ABORT_IF(requiredMemorySize == 0,
+  ABORT_IF(selectedStrategy == NULL,
            "Could not find an acceptable sort strategy.");
 
+  logger.add(sortAlgorithmUsedStatID, selectedStrategy->getSortAlgorithmID());
+
+  KVPairBuffer* outputBuffer = NULL;
+  if (selectedStrategy->sortsInPlace()) {
+    outputBuffer = sortInPlace(
+      inputBuffer, *selectedStrategy, requiredScratchBufferSize);
+  } else {
+    outputBuffer = sortIntoOutputBuffer(
+      inputBuffer, *selectedStrategy, requiredScratchBufferSize);
+  }
+
+  // Get num tuples and num pairs
+  uint64_t tuplesOut = outputBuffer->getNumTuples();
+  uint64_t bytesOut = outputBuffer->getCurrentSize();
+
+  // Sorter should produce the same number of output tuples/bytes
+  TRITONSORT_ASSERT(bytesOut == bytesIn, "Sorter output buffer size is not equal to input "
+         "buffer size (%llu bytes != %llu bytes)", bytesOut, bytesIn);
+  TRITONSORT_ASSERT(tuplesOut == tuplesIn, "Sorter output buffer tuple count is not equal "
+         "input buffer tuple count (%llu tuples != %llu tuples)", tuplesOut,
+         tuplesIn);
+
+  // Send output buffer downstream
+  emitOutputBuffer(outputBuffer);
+
+  // Record statistics
+  logger.add(sortTimeStatID, sortTimer.getElapsed());
+  logger.add(numTuplesStatID, tuplesIn);
+  numTuplesIn += tuplesIn;
+  numTuplesOut += tuplesOut;
+  totalBytesIn += bytesIn;
+  totalBytesOut += bytesOut;
+}
+
+KVPairBuffer* Sorter::sortInPlace(
+  KVPairBuffer* inputBuffer, SortStrategyInterface& strategy,
+  uint64_t scratchBufferSize) {
+
+  // The sorted tuples stay in the input buffer, so only the strategy's
+  // scratch space needs to be allocated, and it can be freed right away.
+  uint8_t* scratchMemory = NULL;
+  if (scratchBufferSize > 0) {
+    MemoryAllocationContext scratchContext(
+      scratchMemoryCallerID, scratchBufferSize);
+    scratchMemory = static_cast<uint8_t*>(
+      memoryAllocator.allocate(scratchContext));
+  }
+
+  strategy.setScratchBuffer(scratchMemory);
+
+  // Sort the buffer
+  sortTimer.start();
+  strategy.sort(inputBuffer, NULL);
+  sortTimer.stop();
+
+  if (scratchMemory != NULL) {
+    memoryAllocator.deallocate(scratchMemory);
+  }
+
+  return inputBuffer;
+}
+
+KVPairBuffer* Sorter::sortIntoOutputBuffer(
+  KVPairBuffer* inputBuffer, SortStrategyInterface& strategy,
+  uint64_t scratchBufferSize) {
+
+  uint64_t logicalDiskID = inputBuffer->getLogicalDiskID();
+  uint64_t outputBufferSize = getOutputBufferSize(*inputBuffer);
+  uint64_t requiredMemorySize = scratchBufferSize + outputBufferSize;
+
   MemoryAllocationContext scratchContext(
     scratchMemoryCallerID, requiredMemorySize + alignmentSize);
 
@@ -107,12 +188,11 @@ void Sorter::run(KVPairBuffer* inputBuffer) {
   // will know how to handle it
   outputBuffer->addJobIDSet(inputBuffer->getJobIDs());
 
-  selectedStrategy->setScratchBuffer(scratchMemory);
-  logger.add(sortAlgorithmUsedStatID, selectedStrategy->getSortAlgorithmID());
+  strategy.setScratchBuffer(scratchMemory);
 
   // Sort the buffer
   sortTimer.start();
-  selectedStrategy->sort(inputBuffer, outputBuffer);
+  strategy.sort(inputBuffer, outputBuffer);
   sortTimer.stop();
 
   // Don't need to deallocate scratch memory at this point; output buffer will
@@ -120,27 +200,7 @@ void Sorter::run(KVPairBuffer* inputBuffer) {
 
   delete inputBuffer;
 
-  // Get num tuples and num pairs
-  uint64_t tuplesOut = outputBuffer->getNumTuples();
-  uint64_t bytesOut = outputBuffer->getCurrentSize();
-
-  // Sorter should produce the same number of output tuples/bytes
-  TRITONSORT_ASSERT(bytesOut == bytesIn, "Sorter output buffer size is not equal to input "
-         "buffer size (%llu bytes != %llu bytes)", bytesOut, bytesIn);
-  TRITONSORT_ASSERT(tuplesOut == tuplesIn, "Sorter output buffer tuple count is not equal "
-         "input buffer tuple count (%llu tuples != %llu tuples)", tuplesOut,
-         tuplesIn);
-
-  // Send output buffer downstream
-  emitOutputBuffer(outputBuffer);
-
-  // Record statistics
-  logger.add(sortTimeStatID, sortTimer.getElapsed());
-  logger.add(numTuplesStatID, tuplesIn);
-  numTuplesIn += tuplesIn;
-  numTuplesOut += tuplesOut;
-  totalBytesIn += bytesIn;
-  totalBytesOut += bytesOut;
+  return outputBuffer;
 }
 
 void Sorter::teardown() {
@@ -170,6 +230,10 @@ uint64_t Sorter::getOutputBufferSize(KVPairBuffer& inputBuffer) {
   return inputBuffer.getCurrentSize();
 }
 
+bool Sorter::canSortInPlace(KVPairBuffer& inputBuffer) {
+  return true;
+}
+
 BaseWorker* Sorter::newInstance(
   const std::string& phaseName, const std::string& stageName,
   uint64_t id, Params& params, MemoryAllocatorInterface& memoryAllocator,
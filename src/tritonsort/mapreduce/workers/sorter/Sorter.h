@@ -9,7 +9,9 @@ class RawBuffer;
 
 /**
    The Sorter worker is responsible copying the sorted permutation of an
-   input buffer's data into an output buffer.
+   input buffer's data into an output buffer. If the selected sort strategy
+   sorts in place, the input buffer is sorted and emitted instead, and no
+   output buffer is allocated.
  */
 class Sorter : public SingleUnitRunnable<KVPairBuffer> {
 WORKER_IMPL
@@ -58,6 +60,39 @@ protected:
 private:
   typedef std::vector<SortStrategyInterface*> SortStrategyInterfaceList;
 
+  /**
+     Sort a buffer with a strategy that leaves the sorted tuples in the
+     buffer. Only the strategy's scratch space is allocated.
+
+     \param inputBuffer the buffer whose contents are to be sorted
+
+     \param strategy the in-place strategy to sort with
+
+     \param scratchBufferSize the amount of scratch space the strategy needs
+
+     \return the sorted buffer, which is inputBuffer
+   */
+  KVPairBuffer* sortInPlace(
+    KVPairBuffer* inputBuffer, SortStrategyInterface& strategy,
+    uint64_t scratchBufferSize);
+
+  /**
+     Sort a buffer by copying its sorted permutation into a new output buffer,
+     which shares an allocation with the strategy's scratch space. The input
+     buffer is deleted.
+
+     \param inputBuffer the buffer whose contents are to be sorted
+
+     \param strategy the strategy to sort with
+
+     \param scratchBufferSize the amount of scratch space the strategy needs
+
+     \return the output buffer holding the sorted tuples
+   */
+  KVPairBuffer* sortIntoOutputBuffer(
+    KVPairBuffer* inputBuffer, SortStrategyInterface& strategy,
+    uint64_t scratchBufferSize);
+
   /**
      Perform any cleanup or manipulation on the output buffer so that it is
      prepared to accept the sorted permutation of the input buffer.
@@ -99,6 +134,17 @@ private:
    */
   virtual uint64_t getOutputBufferSize(KVPairBuffer& inputBuffer);
 
+  /**
+     Decide whether in-place sort strategies may be used for an input buffer.
+     Sorters that need to emit a different kind of buffer than they receive
+     should return false.
+
+     \param inputBuffer the buffer that is to be sorted
+
+     \return true if the input buffer can be sorted and emitted as-is
+   */
+  virtual bool canSortInPlace(KVPairBuffer& inputBuffer);
+
   uint64_t scratchMemoryCallerID;
 
   // A list of sortStrategies populated by
@@ -115,6 +161,7 @@ private:
   uint64_t bytesInStatID;
   uint64_t bytesOutStatID;
   uint64_t sortAlgorithmUsedStatID;
+  uint64_t sortAlgorithmRejectedStatID;
 
   uint64_t numWorkUnitsSorted, numTuplesIn, numTuplesOut,
     totalBytesIn, totalBytesOut;
@@ -56,13 +56,19 @@ void AsynchronousWriter::run() {
       processTimer.start();
       while (processTimer.getRunningTime() < 1000) {
         if (numWritesInProgress() == 0) {
-          // There's no work, and no buffers to write, so sleep.
+          // There's no work, and no buffers to write, so sleep until a new
+          // buffer shows up.
           uint64_t elapsed = processTimer.getRunningTime();
           if (elapsed < 1000) {
             // Sleep a little extra to make sure we don't have to do this twice.
             startWaitForWorkTimer();
-            usleep(1100 - elapsed);
+            bool workArrived = waitForWork(getID(), 1100 - elapsed);
             stopWaitForWorkTimer();
+
+            if (workArrived) {
+              // Go back to the tracker right away.
+              break;
+            }
           }
         } else {
           // Wait until some write completes.
@@ -2,6 +2,7 @@
 #include <sstream>
 #include <iomanip>
 
+#include "common/DiskIOScheduler.h"
 #include "common/MainUtils.h"
 #include "common/WriteTokenPool.h"
 #include "core/File.h"
@@ -94,16 +95,25 @@ BaseWriter* BaseWriter::newBaseWriter(
     largePartitionThreshold = params.get<uint64_t>("LARGE_PARTITION_THRESHOLD");
   }
 
+  // Only phase one's intermediate files can be read back from extent logs.
+  bool logStructured = phaseName == "phase_one" &&
+    params.get<bool>("LOG_STRUCTURED_INTERMEDIATES");
+
   ChunkMap* chunkMap = NULL;
   if (dependencies.contains<ChunkMap>("chunk_map")) {
     chunkMap = dependencies.get<ChunkMap>("chunk_map");
   }
 
+  DiskIOScheduler* ioScheduler = NULL;
+  if (dependencies.contains<DiskIOScheduler>("io_scheduler")) {
+    ioScheduler = dependencies.get<DiskIOScheduler>("io_scheduler");
+  }
+
   BaseWriter* writer = new BaseWriter(
     id, nodeIPAddress, writeTokenPool, fileMode, directIO, logicalDiskSizeHint,
     outputDisks, *coordinatorClient, bytesBeforeSimulatedFailure, logger,
     params, numDisks, phaseName, largePartitionThreshold, chunkMap,
-    peerID);
+    peerID, logStructured, ioScheduler);
 
   return writer;
 }
@@ -115,7 +125,8 @@ BaseWriter::BaseWriter(
   CoordinatorClientInterface& _coordinatorClient,
   uint64_t _bytesBeforeSimulatedFailure, StatLogger& _logger,
   const Params& params, uint64_t _numDisks, const std::string& phaseName,
-  uint64_t _largePartitionThreshold, ChunkMap* _chunkMap, uint64_t _nodeID)
+  uint64_t _largePartitionThreshold, ChunkMap* _chunkMap, uint64_t _nodeID,
+  bool _logStructured, DiskIOScheduler* _ioScheduler)
   : id(_id),
     nodeIPAddress(_nodeIPAddress),
     fileMode(_fileMode),
@@ -126,13 +137,21 @@ BaseWriter::BaseWriter(
     numDisks(_numDisks),
     largePartitionThreshold(_largePartitionThreshold),
     nodeID(_nodeID),
+    logStructured(_logStructured),
     coordinatorClient(_coordinatorClient),
     partitionMap(params, phaseName),
     writeTokenPool(_writeTokenPool),
     chunkMap(_chunkMap),
+    ioScheduler(_ioScheduler),
     logger(_logger),
-    totalBytesWritten(0) {
+    totalBytesWritten(0),
+    ioSchedulerWaitStatID(0) {
   writeSizeStatID = logger.registerHistogramStat("write_size", 100);
+  partitionSizeStatID = logger.registerSummaryStat("partition_size");
+
+  if (ioScheduler != NULL) {
+    ioSchedulerWaitStatID = logger.registerSummaryStat("io_scheduler_wait");
+  }
 }
 
 BaseWriter::~BaseWriter() {
@@ -140,6 +159,36 @@ BaseWriter::~BaseWriter() {
 }
 
 File* BaseWriter::getFile(KVPairBuffer* writeBuffer) {
+  ExtentLog* extentLog = NULL;
+  return getFile(writeBuffer, extentLog);
+}
+
+File* BaseWriter::startWrite(KVPairBuffer* writeBuffer) {
+  ExtentLog* extentLog = NULL;
+  File* file = getFile(writeBuffer, extentLog);
+
+  if (extentLog != NULL) {
+    // Buffers are written to the log in the order in which they're started,
+    // so this buffer goes right after the last one.
+    uint64_t length = writeBuffer->getCurrentSize();
+    extentLog->index.addExtent(
+      writeBuffer->getLogicalDiskID(), extentLog->nextOffset, length);
+    extentLog->nextOffset += length;
+  }
+
+  if (ioScheduler != NULL && file != NULL) {
+    // Wait for a write burst on this buffer's disk.
+    logger.add(
+      ioSchedulerWaitStatID,
+      ioScheduler->waitForTurn(*file, DiskIOScheduler::WRITE));
+  }
+
+  return file;
+}
+
+File* BaseWriter::getFile(KVPairBuffer* writeBuffer, ExtentLog*& extentLog) {
+  extentLog = NULL;
+
   // Get the job ID for this write.
   const std::set<uint64_t>& jobIDs = writeBuffer->getJobIDs();
   TRITONSORT_ASSERT(jobIDs.size() == 1, "Expected buffer being passed to writer to "
@@ -197,6 +246,16 @@ File* BaseWriter::getFile(KVPairBuffer* writeBuffer) {
     }
 
     return chunkFile;
+  } else if (logStructured && !replica) {
+    ExtentLog*& log = extentLogs[jobID][diskID];
+
+    if (log == NULL) {
+      log = newExtentLog(diskID, jobID, outputDiskIter->second);
+      logger.logDatum("example_output_filename", log->file->getFilename());
+    }
+
+    extentLog = log;
+    return log->file;
   } else {
     FileMap& filesForJob = files[jobID];
     File*& file = filesForJob[partitionID];
@@ -242,7 +301,7 @@ void BaseWriter::logBufferWritten(KVPairBuffer* writeBuffer) {
   if (token != NULL) {
     ABORT_IF(writeTokenPool == NULL, "You must have provided a write token "
              "pool, but this writer hasn't been given a write token pool");
-    writeTokenPool->putToken(token);
+    writeTokenPool->putToken(token, writeBuffer->getCurrentSize());
   }
 }
 
@@ -263,9 +322,13 @@ void BaseWriter::teardown() {
 
         file->close();
 
+        // Log actual partition sizes so they can be compared against the
+        // sizes predicted in phase zero.
+        uint64_t fileSize = file->getCurrentSize();
+        logger.add(partitionSizeStatID, fileSize);
+
         // Rename large partition files.
         if (largePartitionThreshold > 0) {
-          uint64_t fileSize = file->getCurrentSize();
           if (fileSize > largePartitionThreshold) {
             file->rename(file->getFilename() + ".large");
           }
@@ -307,6 +370,62 @@ void BaseWriter::teardown() {
 
   chunkFiles.clear();
 
+  // Close all extent logs and write their indices.
+  for (ExtentLogsForJobMap::iterator jobIter = extentLogs.begin();
+       jobIter != extentLogs.end(); jobIter++) {
+    ExtentLogMap& logsForJob = jobIter->second;
+
+    for (ExtentLogMap::iterator logIter = logsForJob.begin();
+         logIter != logsForJob.end(); logIter++) {
+      ExtentLog*& log = logIter->second;
+
+      alignedBytesWritten += log->file->getAlignedBytesWritten();
+
+      log->file->close();
+
+      // Large partitions can't be renamed like partition files can, so
+      // record them in their own index for phase three instead.
+      ExtentIndex index;
+      ExtentIndex largePartitionIndex;
+
+      const ExtentIndex::PartitionExtentMap& partitions =
+        log->index.getPartitions();
+      for (ExtentIndex::PartitionExtentMap::const_iterator partitionIter =
+             partitions.begin(); partitionIter != partitions.end();
+           partitionIter++) {
+        const ExtentIndex::ExtentVector& extents = partitionIter->second;
+
+        uint64_t partitionSize = ExtentIndex::getTotalLength(extents);
+        logger.add(partitionSizeStatID, partitionSize);
+
+        ExtentIndex& partitionIndex =
+          (largePartitionThreshold > 0 &&
+           partitionSize > largePartitionThreshold) ?
+          largePartitionIndex : index;
+
+        for (ExtentIndex::ExtentVector::const_iterator extentIter =
+               extents.begin(); extentIter != extents.end(); extentIter++) {
+          partitionIndex.addExtent(
+            partitionIter->first, extentIter->offset, extentIter->length);
+        }
+      }
+
+      const std::string& logFilename = log->file->getFilename();
+      index.write(ExtentIndex::getIndexFilename(logFilename));
+
+      if (!largePartitionIndex.getPartitions().empty()) {
+        largePartitionIndex.write(
+          ExtentIndex::getLargeIndexFilename(logFilename));
+      }
+
+      delete log->file;
+      delete log;
+      log = NULL;
+    }
+  }
+
+  extentLogs.clear();
+
   logger.logDatum("total_bytes_written", totalBytesWritten);
   logger.logDatum("direct_io_bytes_written", alignedBytesWritten);
 }
@@ -315,6 +434,40 @@ File* BaseWriter::newFile(
   uint64_t logicalDiskUID, uint64_t jobID, const std::string& outputDisk,
   uint64_t chunkID, bool replica) {
 
+  std::ostringstream oss;
+  oss << getOutputDirectory(jobID, outputDisk, replica);
+
+  oss << "/" << std::setfill('0') << std::setw(8) << logicalDiskUID
+      << ".partition";
+  if (chunkID < std::numeric_limits<uint64_t>::max()) {
+    // This is a large chunk buffer.
+    oss << ".chunk_" << std::setfill('0') << std::setw(8) << chunkID;
+  }
+
+  return openFile(oss.str(), logicalDiskSizeHint);
+}
+
+BaseWriter::ExtentLog* BaseWriter::newExtentLog(
+  uint64_t diskID, uint64_t jobID, const std::string& outputDisk) {
+
+  std::ostringstream oss;
+  oss << getOutputDirectory(jobID, outputDisk, false) << "/"
+      << std::setfill('0') << std::setw(8) << diskID << ".extents";
+
+  // The log holds every partition on the disk, so preallocate enough room for
+  // all of them up front.
+  ExtentLog* log = new (themis::memcheck) ExtentLog;
+  log->file = openFile(
+    oss.str(),
+    logicalDiskSizeHint * partitionMap.getNumPartitionsPerOutputDisk(jobID));
+  log->nextOffset = 0;
+
+  return log;
+}
+
+std::string BaseWriter::getOutputDirectory(
+  uint64_t jobID, const std::string& outputDisk, bool replica) {
+
   const themis::URL& outputDirectory = coordinatorClient.getOutputDirectory(jobID);
 
   std::ostringstream oss;
@@ -331,15 +484,14 @@ File* BaseWriter::newFile(
              "Could not create directory %s", oss.str().c_str());
   }
 
-  oss << "/" << std::setfill('0') << std::setw(8) << logicalDiskUID
-      << ".partition";
-  if (chunkID < std::numeric_limits<uint64_t>::max()) {
-    // This is a large chunk buffer.
-    oss << ".chunk_" << std::setfill('0') << std::setw(8) << chunkID;
-  }
+  return oss.str();
+}
+
+File* BaseWriter::openFile(
+  const std::string& filename, uint64_t preallocationSize) {
 
   // Create the file and open it for writing
-  File* logicalDiskFile = new (themis::memcheck) File(oss.str());
+  File* logicalDiskFile = new (themis::memcheck) File(filename);
   TRITONSORT_ASSERT(fileMode == File::WRITE || fileMode == File::WRITE_POSIXAIO ||
          fileMode == File::WRITE_LIBAIO, "Unsupported write mode, must be "
          "WRITE, WRITE_POSIXAIO, or WRITE_LIBAIO");
@@ -351,8 +503,8 @@ File* BaseWriter::newFile(
   }
 
   // Pre-allocate the file if we are given a hint as to how big it will be.
-  if (logicalDiskSizeHint > 0) {
-    logicalDiskFile->preallocate(logicalDiskSizeHint);
+  if (preallocationSize > 0) {
+    logicalDiskFile->preallocate(preallocationSize);
   }
 
   return logicalDiskFile;
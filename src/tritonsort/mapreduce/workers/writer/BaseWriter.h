@@ -6,10 +6,12 @@
 #include <string>
 
 #include "core/File.h"
+#include "mapreduce/common/ExtentIndex.h"
 #include "mapreduce/common/PartitionMap.h"
 
 class ChunkMap;
 class CoordinatorClientInterface;
+class DiskIOScheduler;
 class KVPairBuffer;
 class NamedObjectCollection;
 class Params;
@@ -26,11 +28,24 @@ typedef std::map<uint64_t, std::string> OutputDiskMap;
 
    The typical usage pattern for a BaseWriter is:
 
-   File* file = getFile(buffer);
+   File* file = startWrite(buffer);
    // perform some write operation on file...
 
    // After write completes...
    logBufferWritten(buffer);
+
+   By default, each partition is written to its own file. If the writer is
+   log-structured, every buffer for a regular partition on a given disk is
+   instead appended to a single extent log for that disk and job, and an
+   ExtentIndex recording where each partition's buffers landed is written next
+   to the log at teardown. This turns many small interleaved writes to
+   thousands of partition files into one sequential stream per disk. Replica
+   partitions and phase three chunks are always written to their own files.
+
+   If the phase provides a DiskIOScheduler as the "io_scheduler" dependency,
+   startWrite() waits for a write burst on the buffer's disk before returning,
+   so that every writer, synchronous or asynchronous, keeps its writes from
+   interleaving with reads from the same disk.
  */
 class BaseWriter {
 public:
@@ -100,6 +115,12 @@ public:
      \param chunkMap the global chunk map
 
      \param nodeID the ID of this node in the cluster
+
+     \param logStructured if true, append partitions to a per-disk extent log
+     rather than writing them to their own files
+
+     \param ioScheduler if not NULL, a scheduler shared with the phase's other
+     readers and writers that each buffer's writes must wait for
    */
   BaseWriter(
     uint64_t id,  const std::string& nodeIPAddress,
@@ -109,7 +130,8 @@ public:
     uint64_t bytesBeforeSimulatedFailure, StatLogger& logger,
     const Params& params, uint64_t numDisks,
     const std::string& phaseName, uint64_t largePartitionThreshold,
-    ChunkMap* chunkMap, uint64_t nodeID);
+    ChunkMap* chunkMap, uint64_t nodeID, bool logStructured,
+    DiskIOScheduler* ioScheduler);
 
   /// Destructor
   virtual ~BaseWriter();
@@ -124,6 +146,20 @@ public:
    */
   File* getFile(KVPairBuffer* writeBuffer);
 
+  /**
+     Retrieve the file that a given buffer should be written to, and reserve
+     the buffer's place in the file if it's an extent log. Must be called
+     exactly once for each buffer before it is written, and buffers bound for
+     the same file must be written in the order in which they're started;
+     getFile() can be used to retrieve the file again afterward. With an IO
+     scheduler, blocks until the file's disk is in a write burst.
+
+     \param writeBuffer the buffer to write
+
+     \return the file to write to
+   */
+  File* startWrite(KVPairBuffer* writeBuffer);
+
   /**
      Logs that a buffer has been written and performs failure simulation if
      specified. Automatically returns write tokens to the pool, but does NOT
@@ -148,6 +184,29 @@ private:
 
   typedef std::map<uint64_t, bool> BooleanMap;
 
+  /// An extent log, along with the index of extents that have been written to
+  /// it so far
+  struct ExtentLog {
+    File* file;
+    uint64_t nextOffset;
+    ExtentIndex index;
+  };
+
+  typedef std::map<uint64_t, ExtentLog*> ExtentLogMap;
+  typedef std::map<uint64_t, ExtentLogMap> ExtentLogsForJobMap;
+
+  /**
+     Retrieve the file that a given buffer should be written to.
+
+     \param writeBuffer the buffer to write
+
+     \param[out] extentLog set to the extent log to which the buffer should be
+     appended, or NULL if it should be written to its own file
+
+     \return the file to write to
+   */
+  File* getFile(KVPairBuffer* writeBuffer, ExtentLog*& extentLog);
+
   /**
      Helper function that opens a new file.
 
@@ -167,6 +226,47 @@ private:
     uint64_t logicalDiskUID, uint64_t jobID, const std::string& outputDisk,
     uint64_t chunkID, bool replica);
 
+  /**
+     Helper function that opens a new extent log.
+
+     \param diskID the node-local ID of the disk that the log is on
+
+     \param jobID the job that this log belongs to
+
+     \param outputDisk the disk path where the log should be stored
+
+     \return a new extent log to append to
+   */
+  ExtentLog* newExtentLog(
+    uint64_t diskID, uint64_t jobID, const std::string& outputDisk);
+
+  /**
+     Get the directory to which a job's files should be written on a disk,
+     creating it if it doesn't exist.
+
+     \param jobID the job whose files are being written
+
+     \param outputDisk the disk path where the files should be stored
+
+     \param replica if true, get the directory for replica files
+
+     \return the path to the directory
+   */
+  std::string getOutputDirectory(
+    uint64_t jobID, const std::string& outputDisk, bool replica);
+
+  /**
+     Open a file for writing in the writer's file mode.
+
+     \param filename the path to the file
+
+     \param preallocationSize the number of bytes to preallocate for the file,
+     or 0 if the file shouldn't be preallocated
+
+     \return the opened file
+   */
+  File* openFile(const std::string& filename, uint64_t preallocationSize);
+
   const uint64_t id;
   const std::string nodeIPAddress;
   const File::AccessMode fileMode;
@@ -177,6 +277,7 @@ private:
   const uint64_t numDisks;
   const uint64_t largePartitionThreshold;
   const uint64_t nodeID;
+  const bool logStructured;
 
   BooleanMap blackHoleWrites;
 
@@ -188,12 +289,17 @@ private:
 
   FilesForJobMap files;
   ChunkFilesForJobMap chunkFiles;
+  ExtentLogsForJobMap extentLogs;
 
   ChunkMap* chunkMap;
 
+  DiskIOScheduler* ioScheduler;
+
   StatLogger& logger;
   uint64_t writeSizeStatID;
+  uint64_t partitionSizeStatID;
   uint64_t totalBytesWritten;
+  uint64_t ioSchedulerWaitStatID;
 };
 
 #endif // MAPRED_BASE_WRITER_H
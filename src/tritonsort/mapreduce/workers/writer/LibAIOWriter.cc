@@ -24,7 +24,7 @@ LibAIOWriter::~LibAIOWriter() {
 }
 
 void LibAIOWriter::prepareWrite(KVPairBuffer* buffer) {
-  File* file = writer.getFile(buffer);
+  File* file = writer.startWrite(buffer);
   file->prepareLibAIOWrite(
     const_cast<uint8_t*>(buffer->getRawBuffer()), buffer->getCurrentSize(),
     maxWriteSize);
@@ -26,7 +26,7 @@ PosixAIOWriter::~PosixAIOWriter() {
 }
 
 void PosixAIOWriter::prepareWrite(KVPairBuffer* buffer) {
-  File* file = writer.getFile(buffer);
+  File* file = writer.startWrite(buffer);
   file->preparePosixAIOWrite(
     const_cast<uint8_t*>(buffer->getRawBuffer()), buffer->getCurrentSize(),
     maxWriteSize);
@@ -93,15 +93,16 @@ void PosixAIOWriter::waitForWritesToComplete(uint64_t numWrites) {
   // Posix AIO interface does not let us block until N writes complete so keep
   // looping until we've done numWrites
   while (completedWrites < numWrites) {
-    // Wait for some writes to complete.
-    int status = aio_suspend(aiocbList, numWritesInProgress(), NULL);
+    // Wait for some writes to complete. Completed writes leave NULL holes
+    // anywhere in the list, which aio_suspend() ignores, so pass all of it.
+    int status = aio_suspend(aiocbList, asynchronousIODepth, NULL);
     ABORT_IF(status != 0,
              "aio_suspend() failed %d: %s", errno, strerror(errno));
 
     // Iterate through the list of outstanding writes and remove any that have
     // completed.
-    for (WriteMap::iterator iter = outstandingWriteBuffers.begin();
-         iter != outstandingWriteBuffers.end(); iter++) {
+    WriteMap::iterator iter = outstandingWriteBuffers.begin();
+    while (iter != outstandingWriteBuffers.end()) {
       struct aiocb* controlBlock = iter->first;
       KVPairBuffer* buffer = iter->second;
 
@@ -131,15 +132,13 @@ void PosixAIOWriter::waitForWritesToComplete(uint64_t numWrites) {
 
         delete controlBlock;
 
-        // Remove this controlBlock from the write map, but make sure to set the
-        // iterator just before it so incrementing the iterator at the end of the
-        // loop will land on the next member of the map.
-        WriteMap::iterator previousIterator = iter;
-        previousIterator--;
-        outstandingWriteBuffers.erase(iter);
-        iter = previousIterator;
+        // Remove this controlBlock from the write map, advancing the iterator
+        // to the next member of the map before the erase invalidates it.
+        outstandingWriteBuffers.erase(iter++);
       } else if (status != EINPROGRESS) {
         ABORT("aio_error() failed with status %d", status);
+      } else {
+        iter++;
       }
     }
   }
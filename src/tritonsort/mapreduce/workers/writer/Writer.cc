@@ -22,7 +22,7 @@ Writer::~Writer() {
 
 void Writer::run(KVPairBuffer* buffer) {
   // Issue a blocking write.
-  File* file = writer.getFile(buffer);
+  File* file = writer.startWrite(buffer);
 
   writeTimer.start();
   file->write(
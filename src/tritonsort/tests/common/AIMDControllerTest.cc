@@ -0,0 +1,77 @@
+#include "common/AIMDController.h"
+#include "tests/common/AIMDControllerTest.h"
+
+static const uint64_t READ_SIZE = 1048576;
+
+TEST_F(AIMDControllerTest, testDecreaseAndIncrease) {
+  AIMDController controller(1, 8, 2.0);
+  EXPECT_EQ(8u, controller.getLimit());
+
+  // Establish a baseline of 100us.
+  for (uint64_t i = 0; i < 8; i++) {
+    controller.recordLatency(100, READ_SIZE);
+  }
+  EXPECT_EQ(8u, controller.getLimit());
+
+  // A congested read halves the limit.
+  controller.recordLatency(1000, READ_SIZE);
+  EXPECT_EQ(4u, controller.getLimit());
+
+  // Reads issued before the decrease are still draining, so the next few
+  // congested reads don't decrease the limit again.
+  for (uint64_t i = 0; i < 3; i++) {
+    controller.recordLatency(1000, READ_SIZE);
+    EXPECT_EQ(4u, controller.getLimit());
+  }
+
+  controller.recordLatency(1000, READ_SIZE);
+  EXPECT_EQ(2u, controller.getLimit());
+
+  // Repeated congestion never takes the limit below the minimum.
+  for (uint64_t i = 0; i < 16; i++) {
+    controller.recordLatency(1000, READ_SIZE);
+  }
+  EXPECT_EQ(1u, controller.getLimit());
+
+  // Each limit's worth of uncongested reads increases the limit by one.
+  controller.recordLatency(100, READ_SIZE);
+  EXPECT_EQ(2u, controller.getLimit());
+  controller.recordLatency(100, READ_SIZE);
+  EXPECT_EQ(2u, controller.getLimit());
+  controller.recordLatency(100, READ_SIZE);
+  EXPECT_EQ(3u, controller.getLimit());
+
+  // The limit never exceeds the maximum.
+  for (uint64_t i = 0; i < 100; i++) {
+    controller.recordLatency(100, READ_SIZE);
+  }
+  EXPECT_EQ(8u, controller.getLimit());
+}
+
+TEST_F(AIMDControllerTest, testMixedReadSizes) {
+  AIMDController controller(1, 8, 2.0);
+
+  // Short reads before any full-size read set a baseline that the first
+  // full-size read replaces.
+  controller.recordLatency(50, 4096);
+  for (uint64_t i = 0; i < 8; i++) {
+    controller.recordLatency(1000, READ_SIZE);
+  }
+  EXPECT_EQ(8u, controller.getLimit());
+
+  // Short reads are much faster than full-size ones, but they don't lower the
+  // baseline.
+  for (uint64_t i = 0; i < 16; i++) {
+    controller.recordLatency(50, 4096);
+  }
+
+  // Full-size reads at the baseline latency are still uncongested.
+  for (uint64_t i = 0; i < 8; i++) {
+    controller.recordLatency(1000, READ_SIZE);
+    EXPECT_EQ(8u, controller.getLimit());
+  }
+
+  // Full-size reads well over the baseline latency are still congested.
+  controller.recordLatency(10000, READ_SIZE);
+  EXPECT_EQ(4u, controller.getLimit());
+}
@@ -0,0 +1,9 @@
+#ifndef THEMIS_AIMD_CONTROLLER_TEST_H
+#define THEMIS_AIMD_CONTROLLER_TEST_H
+
+#include "third-party/googletest.h"
+
+class AIMDControllerTest : public ::testing::Test {
+};
+
+#endif // THEMIS_AIMD_CONTROLLER_TEST_H
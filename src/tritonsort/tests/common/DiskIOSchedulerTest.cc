@@ -0,0 +1,35 @@
+#include "common/DiskIOScheduler.h"
+#include "tests/common/DiskIOSchedulerTest.h"
+
+TEST_F(DiskIOSchedulerTest, testUncontendedDevice) {
+  // Cycles are 1000us long, and the first 250us of each is a read burst.
+  DiskIOScheduler scheduler(1000, 0.25);
+
+  // With only reads on a device, reads never wait, even outside read bursts.
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::READ, 10500));
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::READ, 10900));
+
+  // Writes to another device don't contend with those reads.
+  EXPECT_EQ(0u, scheduler.getDelay(2, DiskIOScheduler::WRITE, 11100));
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::READ, 11200));
+}
+
+TEST_F(DiskIOSchedulerTest, testAlternatingBursts) {
+  DiskIOScheduler scheduler(1000, 0.25);
+
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::READ, 10100));
+
+  // Once the device is being read, a write has to wait for the write burst.
+  EXPECT_EQ(150u, scheduler.getDelay(1, DiskIOScheduler::WRITE, 10100));
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::WRITE, 10250));
+
+  // Reads during the write burst wait for the next read burst.
+  EXPECT_EQ(500u, scheduler.getDelay(1, DiskIOScheduler::READ, 10500));
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::READ, 11000));
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::READ, 11249));
+  EXPECT_EQ(1u, scheduler.getDelay(1, DiskIOScheduler::WRITE, 11249));
+
+  // Once reads stop for a whole cycle, writes no longer wait for their burst.
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::WRITE, 12300));
+  EXPECT_EQ(0u, scheduler.getDelay(1, DiskIOScheduler::WRITE, 13100));
+}
@@ -0,0 +1,9 @@
+#ifndef THEMIS_DISK_IO_SCHEDULER_TEST_H
+#define THEMIS_DISK_IO_SCHEDULER_TEST_H
+
+#include "third-party/googletest.h"
+
+class DiskIOSchedulerTest : public ::testing::Test {
+};
+
+#endif // THEMIS_DISK_IO_SCHEDULER_TEST_H
@@ -1,9 +1,23 @@
+#include <pthread.h>
 #include <queue>
+#include <unistd.h>
 
 #include "common/WriteToken.h"
 #include "common/WriteTokenPool.h"
 #include "tests/common/WriteTokenPoolTest.h"
 
+struct DelayedPutArgs {
+  WriteTokenPool* pool;
+  WriteToken* token;
+};
+
+static void* delayedPutThread(void* arg) {
+  DelayedPutArgs* args = static_cast<DelayedPutArgs*>(arg);
+  usleep(10000);
+  args->pool->putToken(args->token);
+  return NULL;
+}
+
 TEST_F(WriteTokenPoolTest, testAttemptGetToExhaustion) {
   uint64_t tokensPerDisk = 8;
   uint64_t numDisks = 8;
@@ -18,9 +32,9 @@ TEST_F(WriteTokenPoolTest, testAttemptGetToExhaustion) {
 
   std::queue<WriteToken*> tokenQueue;
 
-  for (uint64_t diskID = 0; diskID < numDisks; diskID++) {
-    for (uint64_t tokenNumber = 0; tokenNumber < tokensPerDisk;
-         tokenNumber++) {
+  // Tokens should be spread evenly across disks in round-robin order.
+  for (uint64_t tokenNumber = 0; tokenNumber < tokensPerDisk; tokenNumber++) {
+    for (uint64_t diskID = 0; diskID < numDisks; diskID++) {
       WriteToken* token = pool.attemptGetToken(diskIDSet);
 
       EXPECT_TRUE(token != NULL);
@@ -37,3 +51,107 @@ TEST_F(WriteTokenPoolTest, testAttemptGetToExhaustion) {
     tokenQueue.pop();
   }
 }
+
+TEST_F(WriteTokenPoolTest, testLeastLoadedDiskFirst) {
+  uint64_t tokensPerDisk = 4;
+  uint64_t numDisks = 3;
+
+  WriteTokenPool pool(tokensPerDisk, numDisks);
+
+  std::set<uint64_t> diskIDSet;
+  diskIDSet.insert(0);
+  diskIDSet.insert(1);
+  diskIDSet.insert(2);
+
+  // Load disk 1 with three outstanding tokens and disk 2 with one.
+  std::set<uint64_t> diskOneSet;
+  diskOneSet.insert(1);
+  std::set<uint64_t> diskTwoSet;
+  diskTwoSet.insert(2);
+
+  std::queue<WriteToken*> tokenQueue;
+  for (uint64_t i = 0; i < 3; i++) {
+    tokenQueue.push(pool.attemptGetToken(diskOneSet));
+  }
+  tokenQueue.push(pool.attemptGetToken(diskTwoSet));
+
+  // Disk 0 has no outstanding tokens, so it's picked until it's as loaded as
+  // disk 2.
+  WriteToken* token = pool.attemptGetToken(diskIDSet);
+  ASSERT_TRUE(token != NULL);
+  EXPECT_EQ(0u, token->getDiskID());
+  tokenQueue.push(token);
+
+  // Disks 0 and 2 are now tied. Disk 2 follows disk 0 in round-robin order.
+  token = pool.attemptGetToken(diskIDSet);
+  ASSERT_TRUE(token != NULL);
+  EXPECT_EQ(2u, token->getDiskID());
+  tokenQueue.push(token);
+
+  token = pool.attemptGetToken(diskIDSet);
+  ASSERT_TRUE(token != NULL);
+  EXPECT_EQ(0u, token->getDiskID());
+  tokenQueue.push(token);
+
+  while (!tokenQueue.empty()) {
+    pool.putToken(tokenQueue.front());
+    tokenQueue.pop();
+  }
+}
+
+TEST_F(WriteTokenPoolTest, testGetTokenBlocksUntilPut) {
+  WriteTokenPool pool(1, 2);
+
+  std::set<uint64_t> diskIDSet;
+  diskIDSet.insert(1);
+
+  WriteToken* token = pool.getToken(diskIDSet);
+  ASSERT_TRUE(token != NULL);
+  EXPECT_EQ(1u, token->getDiskID());
+
+  DelayedPutArgs args;
+  args.pool = &pool;
+  args.token = token;
+
+  pthread_t putThreadID;
+  EXPECT_EQ(0, pthread_create(&putThreadID, NULL, &delayedPutThread, &args));
+
+  // Disk 1's only token is outstanding, so this blocks until the other
+  // thread returns it.
+  WriteToken* secondToken = pool.getToken(diskIDSet);
+  EXPECT_EQ(token, secondToken);
+
+  EXPECT_EQ(0, pthread_join(putThreadID, NULL));
+
+  pool.putToken(secondToken);
+}
+
+TEST_F(WriteTokenPoolTest, testWriteFeedback) {
+  WriteTokenPool pool(2, 2);
+
+  std::set<uint64_t> diskOneSet;
+  diskOneSet.insert(1);
+
+  EXPECT_EQ(0u, pool.getNumOutstandingTokens(0));
+  EXPECT_EQ(0u, pool.getNumOutstandingTokens(1));
+  EXPECT_EQ(0.0, pool.getWriteLatency(1));
+
+  WriteToken* firstToken = pool.attemptGetToken(diskOneSet);
+  WriteToken* secondToken = pool.attemptGetToken(diskOneSet);
+  ASSERT_TRUE(firstToken != NULL);
+  ASSERT_TRUE(secondToken != NULL);
+  EXPECT_EQ(2u, pool.getNumOutstandingTokens(1));
+
+  usleep(10000);
+
+  // Returning a token without a write size doesn't count as a write.
+  pool.putToken(firstToken);
+  EXPECT_EQ(1u, pool.getNumOutstandingTokens(1));
+  EXPECT_EQ(0.0, pool.getWriteLatency(1));
+
+  // The second token was held for at least 10ms while writing 1000 bytes.
+  pool.putToken(secondToken, 1000);
+  EXPECT_EQ(0u, pool.getNumOutstandingTokens(1));
+  EXPECT_LE(10.0, pool.getWriteLatency(1));
+  EXPECT_EQ(0.0, pool.getWriteLatency(0));
+}
@@ -0,0 +1,68 @@
+#include <boost/filesystem.hpp>
+
+#include "mapreduce/common/ExtentIndex.h"
+#include "tests/mapreduce/common/ExtentIndexTest.h"
+
+extern const char* TEST_WRITE_ROOT;
+
+TEST_F(ExtentIndexTest, testContiguousExtentsMerge) {
+  ExtentIndex index;
+
+  // Partition 3's first two buffers are adjacent in the log, but its third
+  // follows a buffer for partition 7.
+  index.addExtent(3, 0, 100);
+  index.addExtent(3, 100, 50);
+  index.addExtent(7, 150, 20);
+  index.addExtent(3, 170, 30);
+  index.addExtent(7, 200, 0);
+
+  const ExtentIndex::PartitionExtentMap& partitions = index.getPartitions();
+  ASSERT_EQ(2u, partitions.size());
+
+  const ExtentIndex::ExtentVector& extents = partitions.find(3)->second;
+  ASSERT_EQ(2u, extents.size());
+  EXPECT_EQ(0u, extents[0].offset);
+  EXPECT_EQ(150u, extents[0].length);
+  EXPECT_EQ(170u, extents[1].offset);
+  EXPECT_EQ(30u, extents[1].length);
+
+  EXPECT_EQ(1u, partitions.find(7)->second.size());
+
+  EXPECT_EQ(180u, index.getPartitionSize(3));
+  EXPECT_EQ(20u, index.getPartitionSize(7));
+  EXPECT_EQ(0u, index.getPartitionSize(5));
+}
+
+TEST_F(ExtentIndexTest, testWriteAndRead) {
+  std::string logFilename(
+    (boost::filesystem::path(TEST_WRITE_ROOT) / "00000000.extents").string());
+  std::string indexFilename(ExtentIndex::getIndexFilename(logFilename));
+
+  EXPECT_EQ(logFilename, ExtentIndex::getLogFilename(indexFilename));
+  EXPECT_EQ(logFilename, ExtentIndex::getLogFilename(
+              ExtentIndex::getLargeIndexFilename(logFilename)));
+
+  ExtentIndex index;
+  index.addExtent(1, 0, 10);
+  index.addExtent(2, 10, 20);
+  index.addExtent(1, 30, 40);
+  index.write(indexFilename);
+
+  ExtentIndex readIndex;
+  readIndex.read(indexFilename);
+
+  const ExtentIndex::PartitionExtentMap& partitions = readIndex.getPartitions();
+  ASSERT_EQ(2u, partitions.size());
+
+  const ExtentIndex::ExtentVector& extents = partitions.find(1)->second;
+  ASSERT_EQ(2u, extents.size());
+  EXPECT_EQ(0u, extents[0].offset);
+  EXPECT_EQ(10u, extents[0].length);
+  EXPECT_EQ(30u, extents[1].offset);
+  EXPECT_EQ(40u, extents[1].length);
+
+  EXPECT_EQ(50u, readIndex.getPartitionSize(1));
+  EXPECT_EQ(20u, readIndex.getPartitionSize(2));
+
+  boost::filesystem::remove(indexFilename);
+}
@@ -0,0 +1,9 @@
+#ifndef MAPRED_EXTENT_INDEX_TEST_H
+#define MAPRED_EXTENT_INDEX_TEST_H
+
+#include "third-party/googletest.h"
+
+class ExtentIndexTest : public ::testing::Test {
+};
+
+#endif // MAPRED_EXTENT_INDEX_TEST_H
@@ -1,3 +1,5 @@
+#include <limits>
+
 #include "FilenameToStreamIDMapTest.h"
 #include "core/TritonSortAssert.h"
 #include "mapreduce/common/FilenameToStreamIDMap.h"
@@ -41,6 +43,28 @@ TEST_F(FilenameToStreamIDMapTest, testNormalAccess) {
   checkStreamInfo(map.getStreamInfo("smoo"), "smoo", 3, secondJobSet);
 }
 
+TEST_F(FilenameToStreamIDMapTest, testPartitionIDs) {
+  FilenameToStreamIDMap map;
+  std::set<uint64_t> jobIDs;
+  jobIDs.insert(1);
+
+  map.setPartitionID("log.extents", 0, 3);
+  map.setPartitionID("log.extents", 4096, 7);
+
+  map.addFilename("log.extents", jobIDs, 0);
+  map.addFilename("log.extents", jobIDs, 4096);
+  map.addFilename("log.extents", jobIDs, 8192);
+
+  EXPECT_EQ(3u, map.getStreamInfo("log.extents", 0).getPartitionID());
+  EXPECT_EQ(7u, map.getStreamInfo("log.extents", 4096).getPartitionID());
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
+            map.getStreamInfo("log.extents", 8192).getPartitionID());
+
+  // Streams that have already been added can't be given a partition
+  ASSERT_THROW(
+    map.setPartitionID("log.extents", 8192, 9), AssertionFailedException);
+}
+
 TEST_F(FilenameToStreamIDMapTest, testInvalidFilenameThrowsException) {
   FilenameToStreamIDMap map;
 
@@ -0,0 +1,276 @@
+#include <boost/bind.hpp>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/SimpleMemoryAllocator.h"
+#include "core/ByteOrder.h"
+#include "mapreduce/common/SimpleKVPairWriter.h"
+#include "mapreduce/common/boundary/KeyQuantileSketch.h"
+#include "tests/mapreduce/common/KVPairWriterParentWorker.h"
+#include "tests/mapreduce/common/KeyQuantileSketchTest.h"
+
+void KeyQuantileSketchTest::insertKeys(
+  KeyQuantileSketch& sketch, uint64_t firstKey, uint64_t numKeys,
+  uint64_t weight) {
+  for (uint64_t i = 0; i < numKeys; i++) {
+    // Visit the keys out of order, since the sketch shouldn't depend on its
+    // input being sorted.
+    uint64_t key = hostToBigEndian64(firstKey + ((i * 7919) % numKeys));
+    sketch.insert(reinterpret_cast<uint8_t*>(&key), sizeof(key), weight);
+  }
+}
+
+uint64_t KeyQuantileSketchTest::decodeKey(
+  const uint8_t* key, uint32_t keyLength) {
+  uint64_t encodedKey;
+  EXPECT_EQ(sizeof(encodedKey), keyLength);
+  memcpy(&encodedKey, key, sizeof(encodedKey));
+  return bigEndianToHost64(encodedKey);
+}
+
+TEST_F(KeyQuantileSketchTest, testSmallSketchIsExact) {
+  // A sketch that never compacts should produce exact boundaries.
+  KeyQuantileSketch sketch(1000);
+  insertKeys(sketch, 0, 100, 1);
+
+  EXPECT_EQ(static_cast<uint64_t>(100), sketch.getNumRetainedKeys());
+  EXPECT_EQ(static_cast<uint64_t>(100), sketch.getTotalWeight());
+
+  SimpleMemoryAllocator memoryAllocator;
+  KVPairWriterParentWorker parent(memoryAllocator, 10000);
+  SimpleKVPairWriter writer(
+    boost::bind(
+      &KVPairWriterParentWorker::emitBufferFromWriter, &parent, _1, 0),
+    boost::bind(&KVPairWriterParentWorker::getBufferForWriter, &parent, _1));
+
+  std::vector<uint64_t> partitionWeights;
+  EXPECT_EQ(static_cast<uint64_t>(0),
+            sketch.writeBoundaries(4, writer, partitionWeights));
+  writer.flushBuffers();
+
+  for (uint64_t i = 0; i < 4; i++) {
+    EXPECT_EQ(static_cast<uint64_t>(25), partitionWeights[i]);
+  }
+
+  const std::list<KVPairBuffer*>& emittedBuffers = parent.getEmittedBuffers();
+  ASSERT_EQ(static_cast<size_t>(1), emittedBuffers.size());
+
+  uint64_t expectedBoundaries[4] = {0, 25, 50, 75};
+  KeyValuePair kvPair;
+  for (uint64_t i = 0; i < 4; i++) {
+    ASSERT_TRUE(emittedBuffers.front()->getNextKVPair(kvPair));
+    EXPECT_EQ(expectedBoundaries[i],
+              decodeKey(kvPair.getKey(), kvPair.getKeyLength()));
+    EXPECT_EQ(static_cast<uint32_t>(0), kvPair.getValueLength());
+  }
+  EXPECT_FALSE(emittedBuffers.front()->getNextKVPair(kvPair));
+
+  parent.returnEmittedBuffersToPool();
+}
+
+TEST_F(KeyQuantileSketchTest, testMergeSerializedSketches) {
+  srand48(42);
+
+  uint64_t numKeys = 100000;
+  uint64_t numPartitions = 10;
+  uint64_t capacity = 200;
+
+  // Split the key space unevenly across three sketches with different
+  // weights, as if they came from three nodes.
+  KeyQuantileSketch sketch1(capacity);
+  KeyQuantileSketch sketch2(capacity);
+  KeyQuantileSketch sketch3(capacity);
+  insertKeys(sketch1, 0, 20000, 3);
+  insertKeys(sketch2, 20000, 50000, 3);
+  insertKeys(sketch3, 70000, 30000, 3);
+
+  // Sketches should retain far fewer keys than they were given.
+  EXPECT_GT(3 * capacity, sketch2.getNumRetainedKeys());
+
+  SimpleMemoryAllocator memoryAllocator;
+  KVPairWriterParentWorker parent(memoryAllocator, 10000);
+  SimpleKVPairWriter writer(
+    boost::bind(
+      &KVPairWriterParentWorker::emitBufferFromWriter, &parent, _1, 0),
+    boost::bind(&KVPairWriterParentWorker::getBufferForWriter, &parent, _1));
+
+  sketch1.serialize(writer);
+  sketch2.serialize(writer);
+  sketch3.serialize(writer);
+  writer.flushBuffers();
+
+  // Merge the serialized sketches into a fresh sketch.
+  KeyQuantileSketch mergedSketch(capacity);
+  const std::list<KVPairBuffer*>& emittedBuffers = parent.getEmittedBuffers();
+  for (std::list<KVPairBuffer*>::const_iterator iter = emittedBuffers.begin();
+       iter != emittedBuffers.end(); iter++) {
+    mergedSketch.deserialize(**iter);
+  }
+  parent.returnEmittedBuffersToPool();
+
+  // Merging must preserve weight exactly.
+  EXPECT_EQ(3 * numKeys, mergedSketch.getTotalWeight());
+  EXPECT_GT(3 * capacity, mergedSketch.getNumRetainedKeys());
+
+  std::vector<uint64_t> partitionWeights;
+  EXPECT_EQ(static_cast<uint64_t>(0), mergedSketch.writeBoundaries(
+              numPartitions, writer, partitionWeights));
+  writer.flushBuffers();
+
+  // Boundaries should be sorted and close to the true quantiles.
+  uint64_t numBoundaries = 0;
+  uint64_t previousBoundary = 0;
+  KeyValuePair kvPair;
+  for (std::list<KVPairBuffer*>::const_iterator iter = emittedBuffers.begin();
+       iter != emittedBuffers.end(); iter++) {
+    while ((*iter)->getNextKVPair(kvPair)) {
+      uint64_t boundary = decodeKey(kvPair.getKey(), kvPair.getKeyLength());
+      uint64_t expectedBoundary = numBoundaries * (numKeys / numPartitions);
+
+      EXPECT_LE(previousBoundary, boundary);
+      EXPECT_GT(static_cast<int64_t>(numKeys / 50),
+                llabs(static_cast<int64_t>(boundary - expectedBoundary)))
+        << "Boundary " << numBoundaries << " is " << boundary
+        << ", expected about " << expectedBoundary;
+
+      previousBoundary = boundary;
+      numBoundaries++;
+    }
+  }
+
+  EXPECT_EQ(numPartitions, numBoundaries);
+
+  parent.returnEmittedBuffersToPool();
+}
+
+TEST_F(KeyQuantileSketchTest, testHeavyKeyGetsDedicatedPartition) {
+  // Keys 0-999 each have weight 1, except for key 500, which has weight 3000
+  // and should get a partition to itself.
+  KeyQuantileSketch sketch(10000);
+  insertKeys(sketch, 0, 500, 1);
+  insertKeys(sketch, 500, 1, 3000);
+  insertKeys(sketch, 501, 499, 1);
+
+  SimpleMemoryAllocator memoryAllocator;
+  KVPairWriterParentWorker parent(memoryAllocator, 10000);
+  SimpleKVPairWriter writer(
+    boost::bind(
+      &KVPairWriterParentWorker::emitBufferFromWriter, &parent, _1, 0),
+    boost::bind(&KVPairWriterParentWorker::getBufferForWriter, &parent, _1));
+
+  std::vector<uint64_t> partitionWeights;
+  EXPECT_EQ(static_cast<uint64_t>(1),
+            sketch.writeBoundaries(4, writer, partitionWeights));
+  writer.flushBuffers();
+
+  // The partition after the heavy key starts at the heavy key followed by a
+  // zero byte, the smallest key greater than the heavy key.
+  uint64_t heavyKey = hostToBigEndian64(500);
+  std::string heavyKeySuccessor(
+    reinterpret_cast<const char*>(&heavyKey), sizeof(heavyKey));
+  heavyKeySuccessor.push_back('\0');
+
+  const std::list<KVPairBuffer*>& emittedBuffers = parent.getEmittedBuffers();
+  ASSERT_EQ(static_cast<size_t>(1), emittedBuffers.size());
+  KVPairBuffer* buffer = emittedBuffers.front();
+
+  KeyValuePair kvPair;
+  ASSERT_TRUE(buffer->getNextKVPair(kvPair));
+  EXPECT_EQ(static_cast<uint64_t>(0),
+            decodeKey(kvPair.getKey(), kvPair.getKeyLength()));
+  ASSERT_TRUE(buffer->getNextKVPair(kvPair));
+  EXPECT_EQ(static_cast<uint64_t>(500),
+            decodeKey(kvPair.getKey(), kvPair.getKeyLength()));
+  ASSERT_TRUE(buffer->getNextKVPair(kvPair));
+  EXPECT_EQ(heavyKeySuccessor, std::string(
+              reinterpret_cast<const char*>(kvPair.getKey()),
+              kvPair.getKeyLength()));
+  ASSERT_TRUE(buffer->getNextKVPair(kvPair));
+  EXPECT_EQ(static_cast<uint64_t>(750),
+            decodeKey(kvPair.getKey(), kvPair.getKeyLength()));
+  EXPECT_FALSE(buffer->getNextKVPair(kvPair));
+
+  EXPECT_EQ(static_cast<uint64_t>(500), partitionWeights[0]);
+  EXPECT_EQ(static_cast<uint64_t>(3000), partitionWeights[1]);
+  EXPECT_EQ(static_cast<uint64_t>(249), partitionWeights[2]);
+  EXPECT_EQ(static_cast<uint64_t>(250), partitionWeights[3]);
+
+  parent.returnEmittedBuffersToPool();
+}
+
+TEST_F(KeyQuantileSketchTest, testDenseKeysAreNotHeavy) {
+  srand48(42);
+
+  // After compaction each retained key stands for hundreds of distinct keys,
+  // which is more than a partition's share, but none of them is a heavy
+  // hitter.
+  KeyQuantileSketch sketch(20);
+  insertKeys(sketch, 0, 10000, 1);
+
+  EXPECT_EQ(static_cast<uint64_t>(0),
+            sketch.getKeyWeight(reinterpret_cast<const uint8_t*>("x"), 1));
+
+  SimpleMemoryAllocator memoryAllocator;
+  KVPairWriterParentWorker parent(memoryAllocator, 10000);
+  SimpleKVPairWriter writer(
+    boost::bind(
+      &KVPairWriterParentWorker::emitBufferFromWriter, &parent, _1, 0),
+    boost::bind(&KVPairWriterParentWorker::getBufferForWriter, &parent, _1));
+
+  std::vector<uint64_t> partitionWeights;
+  EXPECT_EQ(static_cast<uint64_t>(0),
+            sketch.writeBoundaries(100, writer, partitionWeights));
+  writer.flushBuffers();
+
+  parent.returnEmittedBuffersToPool();
+}
+
+TEST_F(KeyQuantileSketchTest, testHeavyKeySurvivesMerge) {
+  srand48(42);
+
+  // Each sketch sees half of a heavy key's weight among many light keys, and
+  // compacts heavily.
+  uint64_t capacity = 50;
+  KeyQuantileSketch sketch1(capacity);
+  KeyQuantileSketch sketch2(capacity);
+  insertKeys(sketch1, 0, 5000, 1);
+  insertKeys(sketch1, 2500, 1, 1500);
+  insertKeys(sketch2, 5000, 5000, 1);
+  insertKeys(sketch2, 2500, 1, 1500);
+
+  SimpleMemoryAllocator memoryAllocator;
+  KVPairWriterParentWorker parent(memoryAllocator, 10000);
+  SimpleKVPairWriter writer(
+    boost::bind(
+      &KVPairWriterParentWorker::emitBufferFromWriter, &parent, _1, 0),
+    boost::bind(&KVPairWriterParentWorker::getBufferForWriter, &parent, _1));
+
+  sketch1.serialize(writer);
+  sketch2.serialize(writer);
+  writer.flushBuffers();
+
+  KeyQuantileSketch mergedSketch(capacity);
+  const std::list<KVPairBuffer*>& emittedBuffers = parent.getEmittedBuffers();
+  for (std::list<KVPairBuffer*>::const_iterator iter = emittedBuffers.begin();
+       iter != emittedBuffers.end(); iter++) {
+    mergedSketch.deserialize(**iter);
+  }
+  parent.returnEmittedBuffersToPool();
+
+  EXPECT_EQ(static_cast<uint64_t>(13000), mergedSketch.getTotalWeight());
+
+  // The heavy key's counter may only be off by the total weight divided by
+  // the capacity.
+  uint64_t heavyKey = hostToBigEndian64(2500);
+  uint64_t heavyKeyWeight = mergedSketch.getKeyWeight(
+    reinterpret_cast<const uint8_t*>(&heavyKey), sizeof(heavyKey));
+  EXPECT_GE(static_cast<uint64_t>(3001), heavyKeyWeight);
+  EXPECT_LE(static_cast<uint64_t>(3001 - 13000 / capacity), heavyKeyWeight);
+
+  std::vector<uint64_t> partitionWeights;
+  EXPECT_EQ(static_cast<uint64_t>(1),
+            mergedSketch.writeBoundaries(10, writer, partitionWeights));
+  writer.flushBuffers();
+
+  parent.returnEmittedBuffersToPool();
+}
@@ -0,0 +1,20 @@
+#ifndef MAPRED_KEY_QUANTILE_SKETCH_TEST_H
+#define MAPRED_KEY_QUANTILE_SKETCH_TEST_H
+
+#include <stdint.h>
+
+#include "third-party/googletest.h"
+
+class KeyQuantileSketch;
+class KVPairBuffer;
+
+class KeyQuantileSketchTest : public ::testing::Test {
+protected:
+  void insertKeys(
+    KeyQuantileSketch& sketch, uint64_t firstKey, uint64_t numKeys,
+    uint64_t weight);
+
+  uint64_t decodeKey(const uint8_t* key, uint32_t keyLength);
+};
+
+#endif // MAPRED_KEY_QUANTILE_SKETCH_TEST_H
@@ -0,0 +1,104 @@
+#include <boost/filesystem.hpp>
+#include <string.h>
+
+#include "core/File.h"
+#include "core/MemoryAllocationContext.h"
+#include "mapreduce/common/KeyValuePair.h"
+#include "mapreduce/common/buffers/MemoryMappedKVPairBuffer.h"
+#include "tests/mapreduce/common/MemoryMappedKVPairBufferTest.h"
+
+extern const char* TEST_WRITE_ROOT;
+
+std::string MemoryMappedKVPairBufferTest::writeTestFile(
+  uint64_t numTuples, uint32_t keyLength, uint32_t valueLength) {
+
+  boost::filesystem::path testFilePath(
+    boost::filesystem::path(TEST_WRITE_ROOT) / "test_mmap.partition");
+
+  uint64_t tupleSize = KeyValuePair::tupleSize(keyLength, valueLength);
+  uint8_t* tuples = new uint8_t[numTuples * tupleSize];
+  uint8_t* key = new uint8_t[keyLength];
+  uint8_t* value = new uint8_t[valueLength];
+
+  for (uint64_t i = 0; i < numTuples; i++) {
+    memset(key, i, keyLength);
+    memset(value, i, valueLength);
+
+    KeyValuePair kvPair;
+    kvPair.setKey(key, keyLength);
+    kvPair.setValue(value, valueLength);
+    kvPair.serialize(tuples + (i * tupleSize));
+  }
+
+  File file(testFilePath.string());
+  file.open(File::WRITE, true);
+  file.write(tuples, numTuples * tupleSize);
+  file.close();
+
+  delete[] tuples;
+  delete[] key;
+  delete[] value;
+
+  return testFilePath.string();
+}
+
+TEST_F(MemoryMappedKVPairBufferTest, testMapFile) {
+  uint64_t numTuples = 100;
+  uint32_t keyLength = 10;
+  uint32_t valueLength = 90;
+
+  std::string filename = writeTestFile(numTuples, keyLength, valueLength);
+
+  for (uint64_t populate = 0; populate < 2; populate++) {
+    File file(filename);
+
+    MemoryAllocationContext context(callerID, file.getCurrentSize());
+    void* reservation = memoryAllocator->allocate(context);
+
+    file.open(File::READ);
+    MemoryMappedKVPairBuffer buffer(
+      file, populate == 1, *memoryAllocator, reservation);
+    file.close();
+
+    EXPECT_EQ(file.getCurrentSize(), buffer.getCurrentSize());
+    EXPECT_EQ(numTuples, buffer.getNumTuples());
+    EXPECT_EQ(keyLength, buffer.getMinKeyLength());
+    EXPECT_EQ(keyLength, buffer.getMaxKeyLength());
+
+    buffer.resetIterator();
+
+    KeyValuePair kvPair;
+    uint64_t tupleIndex = 0;
+
+    while (buffer.getNextKVPair(kvPair)) {
+      ASSERT_EQ(keyLength, kvPair.getKeyLength());
+      ASSERT_EQ(valueLength, kvPair.getValueLength());
+
+      for (uint32_t i = 0; i < keyLength; i++) {
+        ASSERT_EQ(static_cast<uint8_t>(tupleIndex), kvPair.getKey()[i]);
+      }
+
+      for (uint32_t i = 0; i < valueLength; i++) {
+        ASSERT_EQ(static_cast<uint8_t>(tupleIndex), kvPair.getValue()[i]);
+      }
+
+      tupleIndex++;
+    }
+
+    EXPECT_EQ(numTuples, tupleIndex);
+
+    // Writes to the mapping shouldn't reach the file.
+    uint8_t* rawBuffer = const_cast<uint8_t*>(buffer.getRawBuffer());
+    memset(rawBuffer, 0xff, buffer.getCurrentSize());
+  }
+
+  File file(filename);
+  file.open(File::READ);
+  uint8_t header[KeyValuePair::HEADER_SIZE];
+  file.read(header, KeyValuePair::HEADER_SIZE);
+  file.close();
+
+  EXPECT_EQ(keyLength, KeyValuePair::keyLength(header));
+
+  file.unlink();
+}
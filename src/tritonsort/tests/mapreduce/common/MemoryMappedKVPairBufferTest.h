@@ -0,0 +1,16 @@
+#ifndef MAPRED_MEMORY_MAPPED_KV_PAIR_BUFFER_TEST_H
+#define MAPRED_MEMORY_MAPPED_KV_PAIR_BUFFER_TEST_H
+
+#include <string>
+
+#include "tests/mapreduce/common/MemoryAllocatingTestFixture.h"
+
+class MemoryMappedKVPairBufferTest : public MemoryAllocatingTestFixture {
+protected:
+  /// Write a file containing numTuples tuples whose keys and values are
+  /// filled with the tuple's index
+  std::string writeTestFile(
+    uint64_t numTuples, uint32_t keyLength, uint32_t valueLength);
+};
+
+#endif // MAPRED_MEMORY_MAPPED_KV_PAIR_BUFFER_TEST_H
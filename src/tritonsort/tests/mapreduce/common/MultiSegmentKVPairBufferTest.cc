@@ -0,0 +1,79 @@
+#include "MultiSegmentKVPairBufferTest.h"
+#include "TestMemoryBackedKVPair.h"
+
+#include "mapreduce/common/buffers/MultiSegmentKVPairBuffer.h"
+
+TEST_F(MultiSegmentKVPairBufferTest, testIterateAcrossSegments) {
+  TestMemoryBackedKVPair p1(20, 80);
+  TestMemoryBackedKVPair p2(70, 30);
+  TestMemoryBackedKVPair p3(5, 35);
+
+  KVPairBuffer* segment1 = new KVPairBuffer(
+    *memoryAllocator, callerID, p1.getWriteSize() + p2.getWriteSize());
+  segment1->addKVPair(p1);
+  segment1->addKVPair(p2);
+  segment1->addJobID(4);
+
+  // An empty segment in the middle should be skipped
+  KVPairBuffer* segment2 = new KVPairBuffer(*memoryAllocator, callerID, 100);
+  segment2->addJobID(4);
+
+  KVPairBuffer* segment3 = new KVPairBuffer(
+    *memoryAllocator, callerID, p3.getWriteSize());
+  segment3->addKVPair(p3);
+  segment3->addJobID(4);
+
+  MultiSegmentKVPairBuffer buffer;
+  buffer.addSegment(segment1);
+  buffer.addSegment(segment2);
+  buffer.addSegment(segment3);
+
+  EXPECT_EQ(static_cast<uint64_t>(3), buffer.getNumSegments());
+  EXPECT_EQ(p1.getWriteSize() + p2.getWriteSize() + p3.getWriteSize(),
+            buffer.getCurrentSize());
+  EXPECT_EQ(static_cast<uint64_t>(3), buffer.getNumTuples());
+  EXPECT_EQ(static_cast<uint32_t>(5), buffer.getMinKeyLength());
+  EXPECT_EQ(static_cast<uint32_t>(70), buffer.getMaxKeyLength());
+
+  const std::set<uint64_t>& jobIDs = buffer.getJobIDs();
+  EXPECT_EQ(static_cast<uint64_t>(1), jobIDs.size());
+  EXPECT_EQ(static_cast<uint64_t>(4), *(jobIDs.begin()));
+
+  TestMemoryBackedKVPair* expectedPairs[3] = { &p1, &p2, &p3 };
+
+  // Iterate twice to make sure that resetting the iterator resets every
+  // segment
+  for (uint64_t pass = 0; pass < 2; pass++) {
+    buffer.resetIterator();
+
+    KeyValuePair kvPair;
+    uint64_t numTuples = 0;
+
+    while (buffer.getNextKVPair(kvPair)) {
+      ASSERT_GT(static_cast<uint64_t>(3), numTuples);
+
+      TestMemoryBackedKVPair* expected = expectedPairs[numTuples];
+      ASSERT_EQ(expected->getKeyLength(), kvPair.getKeyLength());
+      ASSERT_EQ(expected->getValueLength(), kvPair.getValueLength());
+      EXPECT_EQ(0, memcmp(expected->getKey(), kvPair.getKey(),
+                          kvPair.getKeyLength()));
+      EXPECT_EQ(0, memcmp(expected->getValue(), kvPair.getValue(),
+                          kvPair.getValueLength()));
+      numTuples++;
+    }
+
+    EXPECT_EQ(static_cast<uint64_t>(3), numTuples);
+  }
+}
+
+TEST_F(MultiSegmentKVPairBufferTest, testEmpty) {
+  MultiSegmentKVPairBuffer buffer;
+
+  EXPECT_EQ(static_cast<uint64_t>(0), buffer.getNumSegments());
+  EXPECT_EQ(static_cast<uint64_t>(0), buffer.getCurrentSize());
+  EXPECT_EQ(static_cast<uint64_t>(0), buffer.getNumTuples());
+
+  KeyValuePair kvPair;
+  buffer.resetIterator();
+  EXPECT_FALSE(buffer.getNextKVPair(kvPair));
+}
@@ -0,0 +1,9 @@
+#ifndef MAPRED_MULTI_SEGMENT_KV_PAIR_BUFFER_TEST_H
+#define MAPRED_MULTI_SEGMENT_KV_PAIR_BUFFER_TEST_H
+
+#include "tests/mapreduce/common/MemoryAllocatingTestFixture.h"
+
+class MultiSegmentKVPairBufferTest : public MemoryAllocatingTestFixture {
+};
+
+#endif // MAPRED_MULTI_SEGMENT_KV_PAIR_BUFFER_TEST_H
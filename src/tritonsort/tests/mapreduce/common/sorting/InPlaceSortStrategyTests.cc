@@ -0,0 +1,98 @@
+#include <string.h>
+
+#include "core/MemoryUtils.h"
+#include "mapreduce/common/sorting/InPlaceSortStrategy.h"
+#include "mapreduce/common/sorting/QuickSortStrategy.h"
+#include "tests/mapreduce/common/sorting/InPlaceSortStrategyTests.h"
+
+void InPlaceSortStrategyTests::testUniformSize(
+  uint64_t numRecords, uint64_t keyLength, uint64_t valueLength,
+  bool secondaryKeys) {
+
+  InPlaceSortStrategy strategy(secondaryKeys);
+
+  setupUniformRecordSizeBuffer(numRecords, keyLength, valueLength);
+  ASSERT_TRUE(strategy.canSort(inputBuffer));
+
+  // Sort a copy of the input with quick sort to compare against
+  setupOutputBuffer();
+  QuickSortStrategy quickSort(secondaryKeys);
+  setupScratchSpace(quickSort);
+  quickSort.sort(inputBuffer, outputBuffer);
+  delete[] scratchMemory;
+
+  setupScratchSpace(strategy);
+  strategy.sort(inputBuffer, NULL);
+  delete[] scratchMemory;
+
+  EXPECT_EQ(numRecords, inputBuffer->getNumTuples());
+  assertSorted(inputBuffer, secondaryKeys);
+
+  // Keys plus secondary keys determine the whole tuple, so both sorts should
+  // produce exactly the same bytes.
+  if (secondaryKeys) {
+    ASSERT_EQ(outputBuffer->getCurrentSize(), inputBuffer->getCurrentSize());
+    EXPECT_EQ(0, memcmp(
+                outputBuffer->getRawBuffer(), inputBuffer->getRawBuffer(),
+                inputBuffer->getCurrentSize()));
+  }
+}
+
+TEST_F(InPlaceSortStrategyTests, testNormal) {
+  testUniformSize(5000, 10, 90, false);
+}
+
+TEST_F(InPlaceSortStrategyTests, testSecondaryKeys) {
+  testUniformSize(5000, 10, 90, true);
+}
+
+TEST_F(InPlaceSortStrategyTests, testSmallBuffer) {
+  // Few enough records that the whole buffer is insertion sorted
+  testUniformSize(20, 10, 90, true);
+}
+
+TEST_F(InPlaceSortStrategyTests, testShortKeys) {
+  // Single-byte keys leave most tuples in large buckets of equal keys
+  testUniformSize(5000, 1, 9, false);
+}
+
+TEST_F(InPlaceSortStrategyTests, testVariableKeyLengths) {
+  // Tuples are all the same size, but their keys are not; shorter keys must
+  // sort before longer keys that they prefix.
+  uint64_t numRecords = 1000;
+  uint64_t recordSize = 20;
+  uint64_t memorySize = numRecords * KeyValuePair::tupleSize(0, recordSize);
+
+  inputBufferMemory = new (themis::memcheck) uint8_t[memorySize];
+  inputBuffer = new KVPairBuffer(inputBufferMemory, memorySize);
+
+  uint8_t* key = NULL;
+  uint8_t* value = NULL;
+
+  for (uint64_t i = 0; i < numRecords; i++) {
+    uint32_t keyLength = (i * 7) % (recordSize + 1);
+    uint32_t valueLength = recordSize - keyLength;
+
+    inputBuffer->setupAppendKVPair(keyLength, valueLength, key, value);
+    memset(key, (i * 13) % 3, keyLength);
+    memset(value, 0, valueLength);
+    inputBuffer->commitAppendKVPair(key, value, valueLength);
+  }
+
+  InPlaceSortStrategy strategy(false);
+  ASSERT_TRUE(strategy.canSort(inputBuffer));
+
+  setupScratchSpace(strategy);
+  strategy.sort(inputBuffer, NULL);
+  delete[] scratchMemory;
+
+  EXPECT_EQ(numRecords, inputBuffer->getNumTuples());
+  assertSorted(inputBuffer, false);
+}
+
+TEST_F(InPlaceSortStrategyTests, testRejectsVariableSizeTuples) {
+  setupRandomlySizedRecordsBuffer(100);
+
+  InPlaceSortStrategy strategy(false);
+  EXPECT_FALSE(strategy.canSort(inputBuffer));
+}
@@ -0,0 +1,13 @@
+#ifndef THEMIS_IN_PLACE_SORT_STRATEGY_TESTS_H
+#define THEMIS_IN_PLACE_SORT_STRATEGY_TESTS_H
+
+#include "tests/mapreduce/common/sorting/SortStrategyTestSuite.h"
+
+class InPlaceSortStrategyTests : public SortStrategyTestSuite {
+protected:
+  void testUniformSize(
+    uint64_t numRecords, uint64_t keyLength, uint64_t valueLength,
+    bool secondaryKeys);
+};
+
+#endif // THEMIS_IN_PLACE_SORT_STRATEGY_TESTS_H
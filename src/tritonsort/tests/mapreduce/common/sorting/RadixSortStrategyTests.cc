@@ -18,3 +18,11 @@ TEST_F(RadixSortStrategyTests, testNormal) {
 TEST_F(RadixSortStrategyTests, testSecondaryKeys) {
   testUniformSize(5000, 10, 90, true);
 }
+
+TEST_F(RadixSortStrategyTests, testVariableSizeRecords) {
+  // Keys vary in length, and some keys are all 0s, so keys that are prefixes
+  // of other keys must be ordered by length.
+  RadixSortStrategy strategy(false);
+
+  testVariableSizeRecords(strategy, 5000, false);
+}
@@ -0,0 +1,118 @@
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <stdlib.h>
+
+#include "core/Params.h"
+#include "mapreduce/functions/map/KMeansMapFunction.h"
+#include "tests/mapreduce/functions/map/KMeansMapFunctionTest.h"
+#include "tests/mapreduce/functions/map/StringListVerifyingWriter.h"
+
+extern const char* TEST_WRITE_ROOT;
+
+void KMeansMapFunctionTest::writeCentersFile(
+  const std::string& filename, uint64_t k, uint64_t dimension,
+  uint64_t maxCoordinate, unsigned short* randomState) {
+
+  std::ofstream outfile(filename.c_str());
+  ASSERT_TRUE(outfile.is_open());
+
+  centers.clear();
+  ids.clear();
+
+  for (uint64_t i = 0; i < k; i++) {
+    uint64_t id = nrand48(randomState);
+    ids.push_back(id);
+    centers.push_back(std::vector<uint64_t>());
+
+    outfile << i << ' ' << id;
+    for (uint64_t j = 0; j < dimension; j++) {
+      uint64_t coordinate = nrand48(randomState) % maxCoordinate;
+      centers.back().push_back(coordinate);
+      outfile << ' ' << coordinate;
+    }
+    outfile << std::endl;
+  }
+
+  outfile.close();
+}
+
+uint64_t KMeansMapFunctionTest::nearestCenter(
+  const uint64_t* point, uint64_t dimension) {
+
+  uint64_t minSquaredDistance = 0;
+  uint64_t minCenterID = 0;
+
+  for (uint64_t i = 0; i < centers.size(); i++) {
+    uint64_t squaredDistance = 0;
+    for (uint64_t j = 0; j < dimension; j++) {
+      int64_t dist = centers[i][j] - point[j];
+      squaredDistance += dist * dist;
+    }
+
+    if (i == 0 || squaredDistance < minSquaredDistance) {
+      minSquaredDistance = squaredDistance;
+      minCenterID = ids[i];
+    }
+  }
+
+  return minCenterID;
+}
+
+TEST_F(KMeansMapFunctionTest, testBatchMatchesBruteForce) {
+  // Neither k nor the dimension is a multiple of the center block size or the
+  // early-abandon interval, so padding and partial blocks are exercised.
+  const uint64_t k = 21;
+  const uint64_t dimension = 37;
+  const uint64_t numPoints = 100;
+  // Small coordinates make ties between centers likely.
+  const uint64_t maxCoordinate = 4;
+
+  unsigned short randomState[3] = {42, 43, 44};
+
+  std::string centersFilename(
+    (boost::filesystem::path(TEST_WRITE_ROOT) /
+     "kmeans_map_function_test.centers").string());
+
+  writeCentersFile(centersFilename, k, dimension, maxCoordinate, randomState);
+
+  std::vector<uint64_t> points(numPoints * dimension);
+  for (uint64_t i = 0; i < points.size(); i++) {
+    points[i] = nrand48(randomState) % maxCoordinate;
+  }
+
+  KeyValuePair kvPairs[numPoints];
+  for (uint64_t i = 0; i < numPoints; i++) {
+    kvPairs[i].setKey(reinterpret_cast<const uint8_t*>(&i), sizeof(i));
+    kvPairs[i].setValue(
+      reinterpret_cast<const uint8_t*>(&points[i * dimension]),
+      dimension * sizeof(uint64_t));
+  }
+
+  Params params;
+  KMeansMapFunction mapFunction(dimension, k, centersFilename);
+  StringListVerifyingWriter writer;
+
+  mapFunction.init(params);
+  // Map the first point on its own and the rest as a batch.
+  mapFunction.map(kvPairs[0], writer);
+  mapFunction.mapBatch(kvPairs + 1, numPoints - 1, writer);
+  mapFunction.teardown(writer);
+
+  unlink(centersFilename.c_str());
+
+  ASSERT_EQ(numPoints, writer.keys.size());
+
+  std::list<std::string>::iterator keyIter = writer.keys.begin();
+  std::list<std::string>::iterator valueIter = writer.values.begin();
+
+  for (uint64_t i = 0; i < numPoints; i++, keyIter++, valueIter++) {
+    const uint64_t* point = &points[i * dimension];
+    uint64_t expectedCenterID = nearestCenter(point, dimension);
+
+    ASSERT_EQ(sizeof(uint64_t), keyIter->size());
+    EXPECT_EQ(expectedCenterID,
+              *reinterpret_cast<const uint64_t*>(keyIter->data()));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(point),
+                          dimension * sizeof(uint64_t)), *valueIter);
+  }
+}
@@ -0,0 +1,24 @@
+#ifndef THEMIS_MAPRED_K_MEANS_MAP_FUNCTION_TEST_H
+#define THEMIS_MAPRED_K_MEANS_MAP_FUNCTION_TEST_H
+
+#include <string>
+#include <vector>
+
+#include "third-party/googletest.h"
+
+class KMeansMapFunctionTest : public ::testing::Test {
+protected:
+  /// Write k random centers to a centers file in the format produced by
+  /// GenRandomKMeansDataMapFunction, and remember them in centers and ids
+  void writeCentersFile(
+    const std::string& filename, uint64_t k, uint64_t dimension,
+    uint64_t maxCoordinate, unsigned short* randomState);
+
+  /// \return the ID of the center nearest to point, found by brute force
+  uint64_t nearestCenter(const uint64_t* point, uint64_t dimension);
+
+  std::vector< std::vector<uint64_t> > centers;
+  std::vector<uint64_t> ids;
+};
+
+#endif // THEMIS_MAPRED_K_MEANS_MAP_FUNCTION_TEST_H
@@ -0,0 +1,128 @@
+#include <sstream>
+
+#include "core/BufferTracer.h"
+#include "core/File.h"
+#include "core/Params.h"
+#include "core/Traceable.h"
+#include "core/Utils.h"
+#include "tests/themis_core/BufferTracerTest.h"
+#include "tests/themis_core/CountWorkUnit.h"
+
+extern const char* TEST_WRITE_ROOT;
+
+class TracedWorkUnit : public CountWorkUnit, public Traceable {
+public:
+  TracedWorkUnit() : CountWorkUnit(0) {
+  }
+};
+
+static std::string readTraceLog() {
+  std::string hostname;
+  getHostname(hostname);
+
+  File logFile(
+    std::string(TEST_WRITE_ROOT) + "/" + hostname + "_buffer_trace.log");
+  logFile.open(File::READ);
+
+  uint64_t fileSize = logFile.getCurrentSize();
+  std::string contents(fileSize, '\0');
+  logFile.read(
+    reinterpret_cast<uint8_t*>(const_cast<char*>(contents.data())), fileSize);
+  logFile.close();
+
+  return contents;
+}
+
+TEST_F(BufferTracerTest, testDisabledByDefault) {
+  Params params;
+
+  BufferTracer::init(params);
+  EXPECT_FALSE(BufferTracer::isEnabled());
+
+  TracedWorkUnit workUnit;
+  EXPECT_EQ(0u, workUnit.getTraceID());
+
+  BufferTracer::teardown();
+}
+
+TEST_F(BufferTracerTest, testLifecycle) {
+  Params params;
+  params.add<bool>("BUFFER_TRACE", true);
+  params.add<uint64_t>("BUFFER_TRACE_RING_SIZE", 100);
+  params.add<std::string>("LOG_DIR", TEST_WRITE_ROOT);
+
+  BufferTracer::init(params);
+  ASSERT_TRUE(BufferTracer::isEnabled());
+
+  uint64_t stageID = BufferTracer::registerStage("test_phase.test_stage");
+  EXPECT_EQ(1u, stageID);
+
+  BufferTracer::setThreadContext(stageID, 3);
+
+  TracedWorkUnit* workUnit = new TracedWorkUnit();
+  uint64_t traceID = workUnit->getTraceID();
+  EXPECT_NE(0u, traceID);
+
+  // Work units that aren't Traceable are ignored.
+  CountWorkUnit untracedWorkUnit(0);
+  BufferTracer::trace(&untracedWorkUnit, BufferTracer::ENQUEUE, stageID);
+
+  BufferTracer::trace(workUnit, BufferTracer::ENQUEUE, stageID);
+  BufferTracer::trace(workUnit, BufferTracer::DEQUEUE);
+  delete workUnit;
+
+  BufferTracer::teardown();
+  EXPECT_FALSE(BufferTracer::isEnabled());
+
+  std::string contents = readTraceLog();
+
+  EXPECT_NE(std::string::npos, contents.find("STAGE\t0\tunknown\n"));
+  EXPECT_NE(
+    std::string::npos, contents.find("STAGE\t1\ttest_phase.test_stage\n"));
+
+  const char* eventNames[] = { "ENQUEUE", "DEQUEUE", "DESTROY" };
+  uint64_t numEvents = 0;
+  size_t position = 0;
+  for (uint64_t i = 0; i < 3; i++) {
+    std::ostringstream oss;
+    oss << "EVENT\t" << traceID << '\t' << eventNames[i] << "\t1\t3\t";
+    position = contents.find(oss.str(), position);
+    EXPECT_NE(std::string::npos, position) << oss.str();
+    numEvents++;
+  }
+
+  // Only the three events for the traced work unit were recorded.
+  uint64_t numEventLines = 0;
+  for (position = contents.find("EVENT\t"); position != std::string::npos;
+       position = contents.find("EVENT\t", position + 1)) {
+    numEventLines++;
+  }
+  EXPECT_EQ(numEvents, numEventLines);
+}
+
+TEST_F(BufferTracerTest, testRingOverflow) {
+  Params params;
+  params.add<bool>("BUFFER_TRACE", true);
+  params.add<uint64_t>("BUFFER_TRACE_RING_SIZE", 4);
+  params.add<std::string>("LOG_DIR", TEST_WRITE_ROOT);
+
+  BufferTracer::init(params);
+  BufferTracer::setThreadContext(0, 0);
+
+  for (uint64_t i = 1; i <= 10; i++) {
+    BufferTracer::trace(i, BufferTracer::EMIT);
+  }
+
+  BufferTracer::teardown();
+
+  std::string contents = readTraceLog();
+
+  // Only the four most recent events survive.
+  EXPECT_EQ(std::string::npos, contents.find("EVENT\t6\t"));
+  for (uint64_t i = 7; i <= 10; i++) {
+    std::ostringstream oss;
+    oss << "EVENT\t" << i << "\tEMIT\t";
+    EXPECT_NE(std::string::npos, contents.find(oss.str())) << oss.str();
+  }
+  EXPECT_NE(std::string::npos, contents.find("DROPPED\t6\n"));
+}
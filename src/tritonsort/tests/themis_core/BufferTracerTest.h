@@ -0,0 +1,9 @@
+#ifndef THEMIS_BUFFER_TRACER_TEST_H
+#define THEMIS_BUFFER_TRACER_TEST_H
+
+#include "third-party/googletest.h"
+
+class BufferTracerTest : public ::testing::Test {
+};
+
+#endif // THEMIS_BUFFER_TRACER_TEST_H
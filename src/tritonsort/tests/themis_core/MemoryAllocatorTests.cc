@@ -25,3 +25,29 @@ TEST_F(MemoryAllocatorTests, testLargeMemoryAllocationFails) {
 
   ASSERT_THROW(allocator.allocate(context), AssertionFailedException);
 }
+
+TEST_F(MemoryAllocatorTests, testFailIfMemoryNotAvailableImmediately) {
+  FCFSMemoryAllocatorPolicy policy;
+  NopDeadlockResolver deadlockResolver;
+  MemoryAllocator allocator(1000, 500000, policy, deadlockResolver);
+
+  DummyWorker dummyWorker(0, "test");
+
+  uint64_t callerID = allocator.registerCaller(dummyWorker);
+
+  MemoryAllocationContext context(callerID, 600);
+  MemoryAllocationContext nonBlockingContext(callerID, 600, true);
+
+  void* memory = allocator.allocate(context);
+  ASSERT_TRUE(memory != NULL);
+
+  // There isn't room for another allocation, so this would otherwise block
+  // forever.
+  EXPECT_TRUE(allocator.allocate(nonBlockingContext) == NULL);
+
+  allocator.deallocate(memory);
+
+  memory = allocator.allocate(nonBlockingContext);
+  ASSERT_TRUE(memory != NULL);
+  allocator.deallocate(memory);
+}
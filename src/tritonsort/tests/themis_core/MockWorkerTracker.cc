@@ -70,6 +70,11 @@ bool MockWorkerTracker::attemptGetNewWork(
   return false;
 }
 
+bool MockWorkerTracker::waitForWork(uint64_t queueID, uint64_t timeoutMicros) {
+  ABORT("Shouldn't be getting work from a MockWorkerTracker");
+  return false;
+}
+
 MockWorkerTracker::MockWorkerTracker(const std::string& _stageName)
   : stageName(_stageName) {
 }
@@ -72,6 +72,9 @@ public:
   /// Aborts, since we shouldn't be adding work to a mock tracker
   bool attemptGetNewWork(uint64_t queueID, Resource*& workUnit);
 
+  /// Aborts, since we shouldn't be adding work to a mock tracker
+  bool waitForWork(uint64_t queueID, uint64_t timeoutMicros);
+
   /**
      Provide direct access to the work queue for testing purposes
 
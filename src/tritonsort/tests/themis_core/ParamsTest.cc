@@ -54,6 +54,23 @@ TEST_F(ParamsTest, testAdd) {
   EXPECT_EQ(47, blah);
 }
 
+TEST_F(ParamsTest, testCopy) {
+  Params params;
+  params.add<uint64_t>("FOO", 40);
+  params.add<std::string>("BAR", "baz");
+
+  Params copy(params);
+
+  // The copy is unaffected by later changes to the original, and vice versa
+  params.add<uint64_t>("FOO", 41);
+  copy.add<uint64_t>("QUX", 7);
+
+  EXPECT_EQ((uint64_t) 40, copy.get<uint64_t>("FOO"));
+  EXPECT_EQ("baz", copy.get<std::string>("BAR"));
+  EXPECT_EQ((uint64_t) 41, params.get<uint64_t>("FOO"));
+  EXPECT_TRUE(!params.contains("QUX"));
+}
+
 TEST_F(ParamsTest, testParseCommandLine) {
   Params params;
   char* testArgv[5];
@@ -0,0 +1,52 @@
+#include "core/PerfCounters.h"
+#include "tests/themis_core/PerfCountersTest.h"
+
+TEST_F(PerfCountersTest, testCounterNames) {
+  EXPECT_STREQ("cycles", PerfCounters::getCounterName(PerfCounters::CYCLES));
+  EXPECT_STREQ("instructions", PerfCounters::getCounterName(
+                 PerfCounters::INSTRUCTIONS));
+  EXPECT_STREQ("cache_misses", PerfCounters::getCounterName(
+                 PerfCounters::CACHE_MISSES));
+  EXPECT_STREQ("branch_misses", PerfCounters::getCounterName(
+                 PerfCounters::BRANCH_MISSES));
+}
+
+TEST_F(PerfCountersTest, testCountsWork) {
+  PerfCounters counters;
+
+  if (!counters.open()) {
+    // Virtual machines and locked-down kernels don't expose hardware
+    // counters, so there's nothing to test.
+    EXPECT_FALSE(counters.isOpen());
+    return;
+  }
+
+  EXPECT_TRUE(counters.isOpen());
+
+  counters.start();
+
+  volatile uint64_t sum = 0;
+  for (uint64_t i = 0; i < 1000000; i++) {
+    sum += i;
+  }
+
+  counters.stop();
+
+  uint64_t values[PerfCounters::NUM_COUNTERS];
+  counters.read(values);
+
+  EXPECT_GT(values[PerfCounters::INSTRUCTIONS], 1000000u);
+  EXPECT_GT(values[PerfCounters::CYCLES], 0u);
+
+  // Counters don't advance while stopped.
+  uint64_t stoppedValues[PerfCounters::NUM_COUNTERS];
+  counters.read(stoppedValues);
+  EXPECT_EQ(values[PerfCounters::INSTRUCTIONS],
+            stoppedValues[PerfCounters::INSTRUCTIONS]);
+
+  Json::Value obj(Json::objectValue);
+  counters.addToJson(obj, 1000);
+  EXPECT_TRUE(obj.isMember("instructions"));
+  EXPECT_TRUE(obj.isMember("instructions_per_byte"));
+  EXPECT_TRUE(obj.isMember("instructions_per_cycle"));
+}
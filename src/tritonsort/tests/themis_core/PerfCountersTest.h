@@ -0,0 +1,9 @@
+#ifndef THEMIS_PERF_COUNTERS_TEST_H
+#define THEMIS_PERF_COUNTERS_TEST_H
+
+#include "third-party/googletest.h"
+
+class PerfCountersTest : public ::testing::Test {
+};
+
+#endif // THEMIS_PERF_COUNTERS_TEST_H
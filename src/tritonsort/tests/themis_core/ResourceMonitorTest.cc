@@ -0,0 +1,103 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "core/Params.h"
+#include "core/ResourceMonitor.h"
+#include "core/Socket.h"
+#include "core/TritonSortAssert.h"
+#include "core/Utils.h"
+#include "tests/themis_core/ResourceMonitorTest.h"
+#include "third-party/jsoncpp.h"
+
+static const char* STREAM_PORT = "24517";
+
+static void readStreamLine(Socket& socket, Json::Value& line) {
+  std::string lineString;
+  char character;
+
+  while (true) {
+    ssize_t bytesReceived = recv(socket.getFD(), &character, 1, 0);
+    ABORT_IF(bytesReceived != 1, "recv() from resource monitor stream failed "
+             "with error %d: %s", errno, strerror(errno));
+
+    if (character == '\n') {
+      break;
+    }
+
+    lineString.push_back(character);
+  }
+
+  loadJsonString(lineString.c_str(), lineString.size(), line);
+}
+
+TEST_F(ResourceMonitorTest, testStreamCounterDeltas) {
+  Params params;
+  params.add<std::string>("MONITOR_STREAM_PORT", STREAM_PORT);
+  params.add<uint64_t>("MONITOR_STREAM_INTERVAL_MICROS", 10000);
+  params.add<int32_t>("TCP_RECEIVE_BUFFER_SIZE", 0);
+
+  uint64_t counterA = 5;
+  uint64_t counterB = 1;
+  uint64_t duplicateCounter = 100;
+
+  ResourceMonitor::init(&params);
+  ResourceMonitor::registerCounter(&counterA, "stage.%d.a", 0);
+  ResourceMonitor::spawn();
+
+  Socket socket;
+  socket.connect("127.0.0.1", STREAM_PORT, 0, 10000, 100);
+
+  // The first line describes every counter.
+  Json::Value line;
+  readStreamLine(socket, line);
+
+  EXPECT_TRUE(line["full"].asBool());
+  EXPECT_EQ(1u, line["counters"].size());
+  EXPECT_EQ(5u, line["counters"]["stage.0.a"].asUInt64());
+
+  counterA = 7;
+  ResourceMonitor::registerCounter(&counterB, "stage.%d.b", 0);
+
+  // A second counter with a name that's already taken isn't streamed.
+  ResourceMonitor::registerCounter(&duplicateCounter, "stage.%d.a", 0);
+
+  // Later lines only describe counters that changed or appeared. Both changes
+  // may not make it into the same line.
+  Json::Value changedCounters(Json::objectValue);
+
+  while (changedCounters.size() < 2) {
+    readStreamLine(socket, line);
+    EXPECT_FALSE(line.isMember("full"));
+
+    const Json::Value& counters = line["counters"];
+    for (Json::Value::const_iterator iter = counters.begin();
+         iter != counters.end(); iter++) {
+      EXPECT_FALSE(changedCounters.isMember(iter.key().asString()));
+      changedCounters[iter.key().asString()] = *iter;
+    }
+  }
+
+  EXPECT_EQ(2u, changedCounters.size());
+  EXPECT_EQ(7u, changedCounters["stage.0.a"].asUInt64());
+  EXPECT_EQ(1u, changedCounters["stage.0.b"].asUInt64());
+
+  readStreamLine(socket, line);
+  EXPECT_EQ(0u, line["counters"].size());
+  EXPECT_EQ(0u, line["removed"].size());
+
+  ResourceMonitor::unregisterCounter(&counterB);
+
+  do {
+    readStreamLine(socket, line);
+  } while (line["removed"].size() == 0);
+
+  EXPECT_EQ(1u, line["removed"].size());
+  EXPECT_EQ("stage.0.b", line["removed"][0].asString());
+  EXPECT_EQ(0u, line["counters"].size());
+
+  socket.close();
+
+  ResourceMonitor::unregisterCounter(&counterA);
+  ResourceMonitor::teardown();
+}
@@ -0,0 +1,9 @@
+#ifndef THEMIS_RESOURCE_MONITOR_TEST_H
+#define THEMIS_RESOURCE_MONITOR_TEST_H
+
+#include "third-party/googletest.h"
+
+class ResourceMonitorTest : public ::testing::Test {
+};
+
+#endif // THEMIS_RESOURCE_MONITOR_TEST_H
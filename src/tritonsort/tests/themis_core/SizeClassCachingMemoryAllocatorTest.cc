@@ -0,0 +1,209 @@
+#include "common/DummyWorker.h"
+#include "core/MemoryAllocationContext.h"
+#include "core/MemoryAllocator.h"
+#include "core/SizeClassCachingMemoryAllocator.h"
+#include "tests/themis_core/FCFSMemoryAllocatorPolicy.h"
+#include "tests/themis_core/NopDeadlockResolver.h"
+#include "tests/themis_core/SizeClassCachingMemoryAllocatorTest.h"
+
+/// Counts allocations and deallocations that reach the underlying allocator
+class CountingMemoryAllocator : public MemoryAllocatorInterface {
+public:
+  CountingMemoryAllocator()
+    : numAllocations(0),
+      numDeallocations(0),
+      lastAllocationSize(0) {
+  }
+
+  uint64_t registerCaller(BaseWorker& caller) {
+    return 0;
+  }
+
+  void* allocate(const MemoryAllocationContext& context) {
+    uint64_t dummySize = 0;
+    return allocate(context, dummySize);
+  }
+
+  void* allocate(const MemoryAllocationContext& context, uint64_t& size) {
+    size = context.getSizes().front();
+    numAllocations++;
+    lastAllocationSize = size;
+    return new uint8_t[size];
+  }
+
+  void deallocate(void* memory) {
+    numDeallocations++;
+    delete[] static_cast<uint8_t*>(memory);
+  }
+
+  uint64_t numAllocations;
+  uint64_t numDeallocations;
+  uint64_t lastAllocationSize;
+};
+
+TEST_F(SizeClassCachingMemoryAllocatorTest, testReuseWithinSizeClass) {
+  CountingMemoryAllocator parent;
+
+  {
+    SizeClassCachingMemoryAllocator cache(parent, 1000000, "test", 0);
+
+    MemoryAllocationContext smallContext(0, 1000);
+    void* region = cache.allocate(smallContext);
+    EXPECT_EQ(1u, parent.numAllocations);
+    // The whole size class is allocated from the parent.
+    uint64_t granularity =
+      SizeClassCachingMemoryAllocator::SIZE_CLASS_GRANULARITY;
+    EXPECT_EQ(granularity, parent.lastAllocationSize);
+
+    cache.deallocate(region);
+    EXPECT_EQ(0u, parent.numDeallocations);
+
+    // A different size in the same class reuses the cached region.
+    MemoryAllocationContext similarContext(0, 4000);
+    uint64_t size = 0;
+    void* secondRegion = cache.allocate(similarContext, size);
+    EXPECT_EQ(region, secondRegion);
+    EXPECT_EQ(4000u, size);
+    EXPECT_EQ(1u, parent.numAllocations);
+
+    // A size in a different class goes to the parent.
+    MemoryAllocationContext largeContext(0, 5000);
+    void* thirdRegion = cache.allocate(largeContext);
+    EXPECT_EQ(2u, parent.numAllocations);
+
+    cache.deallocate(secondRegion);
+    cache.deallocate(thirdRegion);
+    EXPECT_EQ(0u, parent.numDeallocations);
+  }
+
+  // Cached regions are returned to the parent on destruction.
+  EXPECT_EQ(2u, parent.numDeallocations);
+}
+
+TEST_F(SizeClassCachingMemoryAllocatorTest, testCapacityAndEviction) {
+  CountingMemoryAllocator parent;
+  uint64_t granularity =
+    SizeClassCachingMemoryAllocator::SIZE_CLASS_GRANULARITY;
+
+  {
+    SizeClassCachingMemoryAllocator cache(parent, 2 * granularity, "test", 0);
+
+    // Leave room for the header at the start of each region.
+    uint64_t headerSize = SizeClassCachingMemoryAllocator::REGION_HEADER_SIZE;
+    MemoryAllocationContext smallContext(0, granularity - headerSize);
+    void* region1 = cache.allocate(smallContext);
+    void* region2 = cache.allocate(smallContext);
+    void* region3 = cache.allocate(smallContext);
+
+    // Only two regions fit in the cache, so the third is returned.
+    cache.deallocate(region1);
+    cache.deallocate(region2);
+    EXPECT_EQ(0u, parent.numDeallocations);
+    cache.deallocate(region3);
+    EXPECT_EQ(1u, parent.numDeallocations);
+
+    // Making room for a region from a larger class evicts the smaller ones.
+    MemoryAllocationContext largeContext(0, 2 * granularity - headerSize);
+    void* largeRegion = cache.allocate(largeContext);
+    EXPECT_EQ(4u, parent.numAllocations);
+    EXPECT_EQ(3u, parent.numDeallocations);
+
+    cache.deallocate(largeRegion);
+    EXPECT_EQ(3u, parent.numDeallocations);
+
+    void* cachedLargeRegion = cache.allocate(largeContext);
+    EXPECT_EQ(largeRegion, cachedLargeRegion);
+    EXPECT_EQ(4u, parent.numAllocations);
+
+    cache.deallocate(cachedLargeRegion);
+  }
+
+  EXPECT_EQ(4u, parent.numDeallocations);
+}
+
+TEST_F(SizeClassCachingMemoryAllocatorTest, testMultipleSizesPassThrough) {
+  CountingMemoryAllocator parent;
+
+  SizeClassCachingMemoryAllocator cache(parent, 1000000, "test", 0);
+
+  MemoryAllocationContext context(0, 1000);
+  context.addSize(2000);
+
+  void* region = cache.allocate(context);
+  EXPECT_EQ(1u, parent.numAllocations);
+
+  cache.deallocate(region);
+  EXPECT_EQ(1u, parent.numDeallocations);
+}
+
+TEST_F(SizeClassCachingMemoryAllocatorTest, testAccountingStaysExact) {
+  uint64_t granularity =
+    SizeClassCachingMemoryAllocator::SIZE_CLASS_GRANULARITY;
+
+  FCFSMemoryAllocatorPolicy policy;
+  NopDeadlockResolver deadlockResolver;
+  // The underlying allocator only has room for two regions. FCFS schedules
+  // requests strictly smaller than the available memory.
+  MemoryAllocator allocator(
+    2 * granularity + 1, 500000, policy, deadlockResolver);
+
+  {
+    SizeClassCachingMemoryAllocator cache(
+      allocator, 2 * granularity, "test", 0);
+
+    DummyWorker dummyWorker(0, "test");
+    uint64_t callerID = cache.registerCaller(dummyWorker);
+
+    MemoryAllocationContext context(callerID, granularity - 100);
+
+    void* region1 = cache.allocate(context);
+    void* region2 = cache.allocate(context);
+    cache.deallocate(region1);
+    cache.deallocate(region2);
+
+    // Both regions are still allocated from the underlying allocator, so
+    // these would block forever if they weren't served from the cache.
+    region1 = cache.allocate(context);
+    region2 = cache.allocate(context);
+    cache.deallocate(region1);
+    cache.deallocate(region2);
+  }
+
+  // The underlying allocator checks that all of its memory has been returned
+  // when it is destroyed.
+}
+
+TEST_F(SizeClassCachingMemoryAllocatorTest, testFlushBeforeBlocking) {
+  uint64_t granularity =
+    SizeClassCachingMemoryAllocator::SIZE_CLASS_GRANULARITY;
+  uint64_t headerSize = SizeClassCachingMemoryAllocator::REGION_HEADER_SIZE;
+
+  FCFSMemoryAllocatorPolicy policy;
+  NopDeadlockResolver deadlockResolver;
+  MemoryAllocator allocator(
+    2 * granularity + 1, 500000, policy, deadlockResolver);
+
+  {
+    // The cache is big enough to hold everything the underlying allocator
+    // has.
+    SizeClassCachingMemoryAllocator cache(
+      allocator, 4 * granularity, "test", 0);
+
+    DummyWorker dummyWorker(0, "test");
+    uint64_t callerID = cache.registerCaller(dummyWorker);
+
+    MemoryAllocationContext smallContext(callerID, granularity - headerSize);
+    void* region1 = cache.allocate(smallContext);
+    void* region2 = cache.allocate(smallContext);
+    cache.deallocate(region1);
+    cache.deallocate(region2);
+
+    // All of the underlying allocator's memory is sitting in the cache, so
+    // this would block forever if the cache weren't flushed first.
+    MemoryAllocationContext largeContext(
+      callerID, 2 * granularity - headerSize);
+    void* largeRegion = cache.allocate(largeContext);
+    ASSERT_TRUE(largeRegion != NULL);
+    cache.deallocate(largeRegion);
+  }
+}
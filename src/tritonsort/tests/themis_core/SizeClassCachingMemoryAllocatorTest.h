@@ -0,0 +1,9 @@
+#ifndef THEMIS_SIZE_CLASS_CACHING_MEMORY_ALLOCATOR_TEST_H
+#define THEMIS_SIZE_CLASS_CACHING_MEMORY_ALLOCATOR_TEST_H
+
+#include "third-party/googletest.h"
+
+class SizeClassCachingMemoryAllocatorTest : public ::testing::Test {
+};
+
+#endif // THEMIS_SIZE_CLASS_CACHING_MEMORY_ALLOCATOR_TEST_H
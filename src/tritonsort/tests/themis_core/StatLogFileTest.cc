@@ -0,0 +1,87 @@
+#include "core/LogLineDescriptor.h"
+#include "core/StatLogFile.h"
+#include "core/StatLogReader.h"
+#include "tests/themis_core/StatLogFileTest.h"
+
+extern const char* TEST_WRITE_ROOT;
+
+static void writeTestLogLines(StatLogFile& file) {
+  LogLineDescriptor descriptor;
+  descriptor.setLogLineTypeName("TEST")
+    .addConstantStringField("logger_name", "test_logger")
+    .addConstantUIntField("id", 7)
+    .addField("uint_value", LogLineFieldInfo::UNSIGNED_INTEGER)
+    .addField("int_value", LogLineFieldInfo::SIGNED_INTEGER)
+    .addField("str_value", LogLineFieldInfo::STRING)
+    .finalize();
+
+  // A copy of a descriptor shares its schema.
+  LogLineDescriptor descriptorCopy(descriptor);
+
+  descriptor.writeLogLine(
+    &file, "phase_one", static_cast<uint64_t>(0), static_cast<uint64_t>(42),
+    static_cast<int64_t>(-5), "min");
+  descriptor.writeLogLine(
+    &file, "phase_one", static_cast<uint64_t>(1), static_cast<uint64_t>(0),
+    static_cast<int64_t>(9), "max");
+  descriptorCopy.writeLogLine(
+    &file, "phase_two", static_cast<uint64_t>(0),
+    static_cast<uint64_t>(18446744073709551615ULL),
+    static_cast<int64_t>(-9223372036854775807LL), "");
+
+  LogLineDescriptor otherDescriptor;
+  otherDescriptor.setLogLineTypeName("OTHR")
+    .addField("uint_value", LogLineFieldInfo::UNSIGNED_INTEGER)
+    .finalize();
+
+  otherDescriptor.writeLogLine(
+    &file, "phase_two", static_cast<uint64_t>(3), static_cast<uint64_t>(1));
+}
+
+static void readLogLines(
+  const std::string& filename, bool expectBinary,
+  std::vector<std::string>& lines) {
+
+  StatLogReader reader(filename);
+  EXPECT_EQ(expectBinary, reader.isBinary());
+
+  std::string line;
+  while (reader.getNextLine(line)) {
+    lines.push_back(line);
+  }
+}
+
+TEST_F(StatLogFileTest, testBinaryMatchesText) {
+  std::string textFilename(
+    std::string(TEST_WRITE_ROOT) + "/stat_log_file_test_text.log");
+  std::string binaryFilename(
+    std::string(TEST_WRITE_ROOT) + "/stat_log_file_test_binary.log");
+
+  StatLogFile textFile(textFilename, StatLogFile::TEXT);
+  writeTestLogLines(textFile);
+  textFile.close();
+
+  StatLogFile binaryFile(binaryFilename, StatLogFile::BINARY);
+  writeTestLogLines(binaryFile);
+  binaryFile.close();
+
+  std::vector<std::string> textLines;
+  readLogLines(textFilename, false, textLines);
+
+  std::vector<std::string> binaryLines;
+  readLogLines(binaryFilename, true, binaryLines);
+
+  ASSERT_EQ(4u, textLines.size());
+  EXPECT_EQ("TEST\tphase_one\t0\ttest_logger\t7\t42\t-5\tmin", textLines[0]);
+  EXPECT_EQ("OTHR\tphase_two\t3\t1", textLines[3]);
+
+  ASSERT_EQ(textLines.size(), binaryLines.size());
+  for (uint64_t i = 0; i < textLines.size(); i++) {
+    EXPECT_EQ(textLines[i], binaryLines[i]);
+  }
+}
+
+TEST_F(StatLogFileTest, testParseFormat) {
+  EXPECT_EQ(StatLogFile::TEXT, StatLogFile::parseFormat("text"));
+  EXPECT_EQ(StatLogFile::BINARY, StatLogFile::parseFormat("binary"));
+}
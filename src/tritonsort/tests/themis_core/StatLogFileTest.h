@@ -0,0 +1,9 @@
+#ifndef THEMIS_STAT_LOG_FILE_TEST_H
+#define THEMIS_STAT_LOG_FILE_TEST_H
+
+#include "third-party/googletest.h"
+
+class StatLogFileTest : public ::testing::Test {
+};
+
+#endif // THEMIS_STAT_LOG_FILE_TEST_H
@@ -5,6 +5,7 @@
 
 #include "core/File.h"
 #include "core/Params.h"
+#include "core/StatLogReader.h"
 #include "core/StatWriter.h"
 #include "core/Utils.h"
 
@@ -138,3 +139,130 @@ TEST_F(StatWriterTest, testNormalOperation) {
 
   delete[] buffer;
 }
+
+TEST_F(StatWriterTest, testBinaryFormat) {
+  Params params;
+  params.add<bool>("ENABLE_STAT_WRITER", true);
+  params.add<std::string>("LOG_DIR", TEST_WRITE_ROOT);
+  params.add<std::string>("STAT_LOG_FORMAT", "binary");
+
+  StatWriter::init(params);
+  StatWriter::setCurrentPhaseName("test_phase");
+
+  StatLogger* testLogger = new StatLogger("test_logger");
+  uint64_t dummyStatID = testLogger->registerStat("dummy_stat");
+
+  StatWriter::spawn();
+
+  testLogger->add(dummyStatID, 42);
+  testLogger->add(dummyStatID, 64);
+  testLogger->logDatum("dummy_datum", static_cast<uint64_t>(17));
+
+  delete testLogger;
+  testLogger = NULL;
+
+  StatWriter::teardown();
+
+  std::string hostname;
+  getHostname(hostname);
+
+  StatLogReader reader(
+    std::string(TEST_WRITE_ROOT) + "/" + hostname + "_stats.log");
+  EXPECT_TRUE(reader.isBinary());
+
+  std::vector<std::string> lines;
+  std::string line;
+  while (reader.getNextLine(line)) {
+    lines.push_back(line);
+  }
+
+  // Two stats, six summary statistics and one datum
+  ASSERT_EQ(9u, lines.size());
+
+  RE2 collLineRegex(
+    "COLL\\s+test_phase\\s+0\\s+test_logger\\s+dummy_stat\\s+[0-9]+\\s+"
+    "([0-9]+)");
+  RE2 datumLineRegex(
+    "DATM\\s+test_phase\\s+0\\s+test_logger\\s+dummy_datum\\s+([0-9]+)");
+
+  uint64_t stat;
+  uint64_t numCollLines = 0;
+  uint64_t numDatumLines = 0;
+
+  for (std::vector<std::string>::iterator iter = lines.begin();
+       iter != lines.end(); iter++) {
+    if (RE2::FullMatch(*iter, collLineRegex, &stat)) {
+      EXPECT_EQ(numCollLines == 0 ? 42u : 64u, stat);
+      numCollLines++;
+    } else if (RE2::FullMatch(*iter, datumLineRegex, &stat)) {
+      EXPECT_EQ(17u, stat);
+      numDatumLines++;
+    }
+  }
+
+  EXPECT_EQ(2u, numCollLines);
+  EXPECT_EQ(1u, numDatumLines);
+}
+
+TEST_F(StatWriterTest, testThreadPhaseName) {
+  Params params;
+  params.add<bool>("ENABLE_STAT_WRITER", true);
+  params.add<std::string>("LOG_DIR", TEST_WRITE_ROOT);
+  params.add<std::string>("STAT_LOG_FORMAT", "binary");
+
+  StatWriter::init(params);
+  StatWriter::setCurrentPhaseName("test_phase");
+
+  StatLogger* testLogger = new StatLogger("test_logger");
+
+  StatWriter::setThreadPhaseName("overlapped_phase");
+  EXPECT_EQ("overlapped_phase", StatWriter::getThreadPhaseName());
+  StatLogger* overlappedLogger = new StatLogger("overlapped_logger");
+  StatWriter::clearThreadPhaseName();
+  EXPECT_EQ("", StatWriter::getThreadPhaseName());
+
+  StatWriter::spawn();
+
+  testLogger->logDatum("dummy_datum", static_cast<uint64_t>(17));
+  overlappedLogger->logDatum("dummy_datum", static_cast<uint64_t>(18));
+
+  delete testLogger;
+  testLogger = NULL;
+  delete overlappedLogger;
+  overlappedLogger = NULL;
+
+  StatWriter::teardown();
+
+  std::string hostname;
+  getHostname(hostname);
+
+  StatLogReader reader(
+    std::string(TEST_WRITE_ROOT) + "/" + hostname + "_stats.log");
+
+  RE2 datumLineRegex(
+    "DATM\\s+(\\S+)\\s+0\\s+(\\S+)\\s+dummy_datum\\s+([0-9]+)");
+
+  std::string line;
+  std::string phaseName;
+  std::string loggerName;
+  uint64_t datum;
+  uint64_t numDatumLines = 0;
+
+  while (reader.getNextLine(line)) {
+    if (RE2::FullMatch(line, datumLineRegex, &phaseName, &loggerName,
+                       &datum)) {
+      if (loggerName == "overlapped_logger") {
+        EXPECT_EQ("overlapped_phase", phaseName);
+        EXPECT_EQ(18u, datum);
+      } else {
+        EXPECT_EQ("test_logger", loggerName);
+        EXPECT_EQ("test_phase", phaseName);
+        EXPECT_EQ(17u, datum);
+      }
+
+      numDatumLines++;
+    }
+  }
+
+  EXPECT_EQ(2u, numDatumLines);
+}
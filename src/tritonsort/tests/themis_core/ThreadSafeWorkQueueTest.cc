@@ -0,0 +1,57 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include "ThreadSafeWorkQueueTest.h"
+#include "UInt64Resource.h"
+#include "core/ThreadSafeWorkQueue.h"
+#include "core/Timer.h"
+
+static void* delayedPusherThread(void* arg) {
+  ThreadSafeWorkQueue* queue = static_cast<ThreadSafeWorkQueue*>(arg);
+  usleep(10000);
+  queue->push(new UInt64Resource(42));
+  return NULL;
+}
+
+TEST_F(ThreadSafeWorkQueueTest, testWaitForWorkTimesOut) {
+  ThreadSafeWorkQueue queue;
+
+  Timer timer;
+  timer.start();
+  EXPECT_FALSE(queue.waitForWork(5000));
+  timer.stop();
+
+  EXPECT_LE(5000u, timer.getElapsed());
+}
+
+TEST_F(ThreadSafeWorkQueueTest, testWaitForWorkWakesOnPush) {
+  ThreadSafeWorkQueue queue;
+
+  pthread_t pusherThreadID;
+  EXPECT_EQ(0, pthread_create(
+              &pusherThreadID, NULL, &delayedPusherThread, &queue));
+
+  // Wait far longer than the pusher takes; the push should wake us early.
+  Timer timer;
+  timer.start();
+  EXPECT_TRUE(queue.waitForWork(10000000));
+  timer.stop();
+
+  EXPECT_EQ(0, pthread_join(pusherThreadID, NULL));
+  EXPECT_GT(10000000u, timer.getElapsed());
+
+  // Waiting doesn't consume the work unit.
+  EXPECT_EQ(1u, queue.size());
+  Resource* resource = queue.blockingPop();
+  EXPECT_TRUE(resource != NULL);
+  delete resource;
+}
+
+TEST_F(ThreadSafeWorkQueueTest, testWaitForWorkReturnsAtEndOfWork) {
+  ThreadSafeWorkQueue queue;
+  queue.push(NULL);
+
+  // A queue that will never receive more work shouldn't block.
+  EXPECT_TRUE(queue.waitForWork(0));
+  EXPECT_TRUE(queue.blockingPop() == NULL);
+}
@@ -0,0 +1,9 @@
+#ifndef _TRITONSORT_THREADSAFEWORKQUEUETEST_H
+#define _TRITONSORT_THREADSAFEWORKQUEUETEST_H
+
+#include "third-party/googletest.h"
+
+class ThreadSafeWorkQueueTest : public ::testing::Test {
+};
+
+#endif //_TRITONSORT_THREADSAFEWORKQUEUETEST_H